@@ -66,6 +66,8 @@ STATIC UINT64  mNumDataBytes;
 STATIC UINT64  mBytesReceivedSoFar;
 // .. and the buffer to save data into
 STATIC UINT8  *mDataBuffer = NULL;
+// .. and the allocated size of that buffer, kept across downloads
+STATIC UINT64  mDataBufferSize;
 
 // Event notify functions, from which gBS->Exit shouldn't be called, can signal
 // this event when the application should exit
@@ -86,6 +88,13 @@ STATIC EFI_EVENT  mFatalSendErrorEvent;
 #define FASTBOOT_STRING_MAX_LENGTH   256
 #define FASTBOOT_COMMAND_MAX_LENGTH  64
 
+//
+// Largest download accepted. The host splits larger images into Android
+// sparse images no bigger than this, which the platform expands while
+// flashing, so flashing memory use is bounded regardless of image size.
+//
+#define FASTBOOT_MAX_DOWNLOAD_SIZE  SIZE_256MB
+
 STATIC
 VOID
 HandleGetVar (
@@ -98,6 +107,9 @@ HandleGetVar (
   // Respond to getvar:version with 0.4 (version of Fastboot protocol)
   if (!AsciiStrnCmp ("version", CmdArg, sizeof ("version") - 1)) {
     SEND_LITERAL ("OKAY" ANDROID_FASTBOOT_VERSION);
+  } else if (!AsciiStrnCmp ("max-download-size", CmdArg, sizeof ("max-download-size") - 1)) {
+    AsciiSPrint (Response, sizeof (Response), "OKAY0x%08x", FASTBOOT_MAX_DOWNLOAD_SIZE);
+    mTransport->Send (AsciiStrLen (Response), Response, &mFatalSendErrorEvent);
   } else {
     // All other variables are assumed to be platform specific
     Status = mPlatform->GetVar (CmdArg, Response + 4);
@@ -122,14 +134,19 @@ HandleDownload (
   // that will be sent in the data phase.
   // Response is "DATA" + that same 8-character string.
 
-  // Replace any previously downloaded data
-  if (mDataBuffer != NULL) {
+  // Parse out number of data bytes to expect
+  mNumDataBytes = AsciiStrHexToUint64 (NumBytesString);
+
+  // Replace any previously downloaded data, reusing the buffer if it is big
+  // enough so a split sparse image does not reallocate for every part
+  if ((mDataBuffer != NULL) &&
+      ((mNumDataBytes == 0) || (mNumDataBytes > mDataBufferSize)))
+  {
     FreePool (mDataBuffer);
-    mDataBuffer = NULL;
+    mDataBuffer     = NULL;
+    mDataBufferSize = 0;
   }
 
-  // Parse out number of data bytes to expect
-  mNumDataBytes = AsciiStrHexToUint64 (NumBytesString);
   if (mNumDataBytes == 0) {
     mTextOut->OutputString (mTextOut, L"ERROR: Fail to get the number of bytes to download.\r\n");
     FastbootMenuSetStatus (L"Fastboot: download failed (invalid size)");
@@ -137,11 +154,21 @@ HandleDownload (
     return;
   }
 
+  if (mNumDataBytes > FASTBOOT_MAX_DOWNLOAD_SIZE) {
+    FastbootMenuSetStatus (L"Fastboot: download failed (too large)");
+    SEND_LITERAL ("FAILDownload larger than max-download-size");
+    return;
+  }
+
   UnicodeSPrint (OutputString, sizeof (OutputString), L"Downloading %d bytes\r\n", mNumDataBytes);
   mTextOut->OutputString (mTextOut, OutputString);
   FastbootMenuSetStatus (L"Fastboot: download starting (%Lu bytes)", mNumDataBytes);
 
-  mDataBuffer = AllocatePool (mNumDataBytes);
+  if (mDataBuffer == NULL) {
+    mDataBuffer     = AllocatePool (mNumDataBytes);
+    mDataBufferSize = (mDataBuffer == NULL) ? 0 : mNumDataBytes;
+  }
+
   if (mDataBuffer == NULL) {
     SEND_LITERAL ("FAILNot enough memory");
   } else {
@@ -1134,7 +1161,8 @@ FastbootAppEntryPoint (
   mFinishedEvent       = NULL;
   mFatalSendErrorEvent = NULL;
 
-  mDataBuffer = NULL;
+  mDataBuffer     = NULL;
+  mDataBufferSize = 0;
   DEBUG ((DEBUG_ERROR, "Fastboot: Entry\n"));
 
   Status = gBS->LocateProtocol (
@@ -20,9 +20,12 @@
 #include <Library/PrintLib.h>
 #include <Library/TimerLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/PcdLib.h>
 #include <Ppi/SecPerformance.h>
 #include <Protocol/KernelCmdLineUpdate.h>
 
+#include "BasicProfilerDxe.h"
+
 #define PROFILER_CMD_MAX_LEN   200
 #define PROFILER_UEFI_OFFSET   (SIZE_16KB + SIZE_4KB)
 #define PROFILER_UEFI_SIZE     SIZE_4KB
@@ -61,6 +64,8 @@ OnExitBootServices (
 
   gBS->CloseEvent (Event);
 
+  BootTraceStop ();
+
   Hob = GetFirstGuidHob (&gEfiFirmwarePerformanceGuid);
   if ((Hob != NULL) &&
       (GET_GUID_HOB_DATA_SIZE (Hob) == sizeof (FIRMWARE_SEC_PERFORMANCE)))
@@ -112,6 +117,7 @@ BasicProfilerDxeInitialize (
   EFI_EVENT                     ExitBootServicesEvent;
   UINTN                         ProfilerBase;
   UINTN                         ProfilerSize;
+  UINTN                         TraceSize;
   EFI_HANDLE                    Handle;
   VOID                          *Hob;
   TEGRA_PLATFORM_RESOURCE_INFO  *PlatformResourceInfo;
@@ -137,16 +143,36 @@ BasicProfilerDxeInitialize (
     return EFI_NOT_FOUND;
   }
 
-  Status = gBS->CreateEventEx (
-                  EVT_NOTIFY_SIGNAL,
-                  TPL_NOTIFY,
-                  OnExitBootServices,
-                  (CONST VOID *)ProfilerBase,
-                  &gEfiEventExitBootServicesGuid,
-                  &ExitBootServicesEvent
-                  );
+  // The boot trace buffer is carved from the end of the kernel data region
+  TraceSize = PcdGet32 (PcdBootTraceBufferSize);
+  if ((TraceSize != 0) &&
+      (((TraceSize % SIZE_4KB) != 0) ||
+       (ProfilerSize < (FW_PROFILER_DATA_SIZE + TraceSize + SIZE_64KB))))
+  {
+    DEBUG ((DEBUG_ERROR, "Profiler carveout too small for boot trace of 0x%x bytes\n", TraceSize));
+    TraceSize = 0;
+  }
+
+  if (TraceSize != 0) {
+    Status = BootTraceInitialize (ProfilerBase + ProfilerSize - TraceSize, TraceSize);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Failed to initialize boot trace: %r\n", Status));
+      TraceSize = 0;
+    }
+  }
+
+  ExitBootServicesEvent = NULL;
+  Status                = gBS->CreateEventEx (
+                                 EVT_NOTIFY_SIGNAL,
+                                 TPL_NOTIFY,
+                                 OnExitBootServices,
+                                 (CONST VOID *)ProfilerBase,
+                                 &gEfiEventExitBootServicesGuid,
+                                 &ExitBootServicesEvent
+                                 );
   if (EFI_ERROR (Status)) {
-    return Status;
+    ExitBootServicesEvent = NULL;
+    goto Exit;
   }
 
   Status = gRT->SetVariable (
@@ -158,7 +184,7 @@ BasicProfilerDxeInitialize (
                   );
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Failed to set ProfilerBase variable: %r\n", Status));
-    return Status;
+    goto Exit;
   }
 
   Status = gRT->SetVariable (
@@ -170,7 +196,25 @@ BasicProfilerDxeInitialize (
                   );
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Failed to set ProfilerSize variable: %r\n", Status));
-    return Status;
+    goto Exit;
+  }
+
+  if (TraceSize != 0) {
+    Status = gRT->SetVariable (
+                    L"BootTraceSize",
+                    &gNVIDIAPublicVariableGuid,
+                    EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
+                    sizeof (TraceSize),
+                    &TraceSize
+                    );
+    if (EFI_ERROR (Status)) {
+      //
+      // The trace protocol is already installed and keeps recording; the
+      // buffer is still reachable from ProfilerBase + ProfilerSize, so this
+      // is not fatal to the profiler.
+      //
+      DEBUG ((DEBUG_WARN, "Failed to set BootTraceSize variable: %r\n", Status));
+    }
   }
 
   Handle                                       = NULL;
@@ -179,7 +223,7 @@ BasicProfilerDxeInitialize (
     mProfilerNewCommandLineArgument,
     PROFILER_CMD_MAX_LEN,
     "bl_prof_dataptr=%lu@0x%lx bl_prof_ro_ptr=%lu@0x%lx",
-    ProfilerSize - FW_PROFILER_DATA_SIZE,
+    ProfilerSize - FW_PROFILER_DATA_SIZE - TraceSize,
     ProfilerBase + FW_PROFILER_DATA_SIZE,
     FW_PROFILER_DATA_SIZE,
     ProfilerBase
@@ -192,5 +236,20 @@ BasicProfilerDxeInitialize (
                                                    NULL
                                                    );
 
+Exit:
+  if (EFI_ERROR (Status)) {
+    //
+    // The image is unloaded on failure, so nothing may be left pointing
+    // into it.
+    //
+    if (ExitBootServicesEvent != NULL) {
+      gBS->CloseEvent (ExitBootServicesEvent);
+    }
+
+    if (TraceSize != 0) {
+      BootTraceDeinitialize ();
+    }
+  }
+
   return Status;
 }
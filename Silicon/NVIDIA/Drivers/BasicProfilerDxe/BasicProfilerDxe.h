@@ -0,0 +1,56 @@
+/** @file
+ *  Basic Profiler Dxe private definitions
+ *
+ *  SPDX-FileCopyrightText: Copyright (c) 2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#ifndef BASIC_PROFILER_DXE_H__
+#define BASIC_PROFILER_DXE_H__
+
+#include <Uefi/UefiBaseType.h>
+
+// Fraction of the trace buffer used for the name string table
+#define BOOT_TRACE_STRING_TABLE_DIVISOR  4
+
+// Number of buckets used to intern span names, must be a power of 2
+#define BOOT_TRACE_NAME_HASH_SIZE  1024
+
+#define BOOT_TRACE_MAX_IMAGE_NAME_LEN  48
+
+/**
+  Initializes the boot trace buffer and installs the boot trace protocol.
+
+  @param[in]  TraceBase           Base of the trace buffer in the profiler carveout.
+  @param[in]  TraceSize           Size of the trace buffer.
+
+  @retval EFI_SUCCESS             Boot tracing started
+  @retval others                  Error occurred
+**/
+EFI_STATUS
+BootTraceInitialize (
+  IN UINTN  TraceBase,
+  IN UINTN  TraceSize
+  );
+
+/**
+  Uninstalls the boot trace protocol and releases the resources created by
+  BootTraceInitialize. Used when the driver fails to load after tracing
+  was started.
+**/
+VOID
+BootTraceDeinitialize (
+  VOID
+  );
+
+/**
+  Stops recording new trace records.
+**/
+VOID
+BootTraceStop (
+  VOID
+  );
+
+#endif
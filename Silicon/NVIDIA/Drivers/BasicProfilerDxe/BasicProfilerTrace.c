@@ -0,0 +1,431 @@
+/** @file
+ *  Basic Profiler Dxe boot trace support
+ *
+ *  SPDX-FileCopyrightText: Copyright (c) 2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#include <PiDxe.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PeCoffGetEntryPointLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include <Protocol/BootTrace.h>
+#include <Protocol/LoadedImage.h>
+
+#include "BasicProfilerDxe.h"
+
+STATIC NVIDIA_BOOT_TRACE_HEADER  *mTraceHeader  = NULL;
+STATIC NVIDIA_BOOT_TRACE_RECORD  *mTraceRecords = NULL;
+STATIC CHAR8                     *mTraceStrings = NULL;
+STATIC UINT16                    *mNameHash     = NULL;
+STATIC BOOLEAN                   mTraceEnabled  = FALSE;
+STATIC VOID                      *mLoadedImageRegistration;
+STATIC EFI_EVENT                 mLoadedImageEvent;
+STATIC EFI_HANDLE                mBootTraceHandle;
+
+/**
+  Returns the FNV-1a hash of a name.
+
+  @param[in]  Name               Name to hash
+
+  @retval Hash of the name
+**/
+STATIC
+UINT32
+BootTraceHashName (
+  IN CONST CHAR8  *Name
+  )
+{
+  UINT32  Hash;
+
+  Hash = 0x811C9DC5;
+  while (*Name != '\0') {
+    Hash ^= (UINT8)*Name++;
+    Hash *= 0x01000193;
+  }
+
+  return Hash;
+}
+
+/**
+  Finds or adds a name in the string table.
+
+  @param[in]  Name               Name to intern
+  @param[out] Offset             Offset of the name in the string table
+
+  @retval TRUE                   Name was found or added
+  @retval FALSE                  String table or hash is full
+**/
+STATIC
+BOOLEAN
+BootTraceInternName (
+  IN  CONST CHAR8  *Name,
+  OUT UINT16       *Offset
+  )
+{
+  UINT32  Bucket;
+  UINT32  Probe;
+  UINTN   Length;
+  UINT16  Entry;
+
+  Bucket = BootTraceHashName (Name) & (BOOT_TRACE_NAME_HASH_SIZE - 1);
+  for (Probe = 0; Probe < BOOT_TRACE_NAME_HASH_SIZE; Probe++) {
+    Entry = mNameHash[(Bucket + Probe) & (BOOT_TRACE_NAME_HASH_SIZE - 1)];
+    if (Entry == 0) {
+      break;
+    }
+
+    if (AsciiStrCmp (&mTraceStrings[Entry - 1], Name) == 0) {
+      *Offset = Entry - 1;
+      return TRUE;
+    }
+  }
+
+  if (Probe == BOOT_TRACE_NAME_HASH_SIZE) {
+    return FALSE;
+  }
+
+  Length = AsciiStrLen (Name) + 1;
+  if (((mTraceHeader->StringTableUsed + Length) > mTraceHeader->StringTableSize) ||
+      ((mTraceHeader->StringTableUsed + 1) > MAX_UINT16))
+  {
+    return FALSE;
+  }
+
+  *Offset = (UINT16)mTraceHeader->StringTableUsed;
+  CopyMem (&mTraceStrings[*Offset], Name, Length);
+  mTraceHeader->StringTableUsed += (UINT32)Length;
+
+  mNameHash[(Bucket + Probe) & (BOOT_TRACE_NAME_HASH_SIZE - 1)] = *Offset + 1;
+  return TRUE;
+}
+
+/**
+  Appends a record to the trace buffer.
+
+  @param[in]  Type               NVIDIA_BOOT_TRACE_RECORD_TYPE
+  @param[in]  Category           NVIDIA_BOOT_TRACE_CATEGORY
+  @param[in]  Name               Name of the record, NULL to reuse NameOffset
+  @param[in]  NameOffset         Name offset used when Name is NULL
+  @param[in]  Argument           Record argument
+
+  @retval Index of the record plus one, or NVIDIA_BOOT_TRACE_INVALID_SPAN
+**/
+STATIC
+UINT32
+BootTraceAppend (
+  IN UINT8        Type,
+  IN UINT8        Category,
+  IN CONST CHAR8  *Name OPTIONAL,
+  IN UINT16       NameOffset,
+  IN UINT32       Argument
+  )
+{
+  EFI_TPL                   OldTpl;
+  NVIDIA_BOOT_TRACE_RECORD  *Record;
+  UINT32                    Index;
+  UINT64                    Timestamp;
+
+  if (!mTraceEnabled) {
+    return NVIDIA_BOOT_TRACE_INVALID_SPAN;
+  }
+
+  Timestamp = GetPerformanceCounter ();
+  Index     = NVIDIA_BOOT_TRACE_INVALID_SPAN;
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  if ((Name != NULL) && !BootTraceInternName (Name, &NameOffset)) {
+    mTraceHeader->DroppedRecords++;
+  } else if (mTraceHeader->RecordCount >= mTraceHeader->MaxRecords) {
+    mTraceHeader->DroppedRecords++;
+  } else {
+    Record             = &mTraceRecords[mTraceHeader->RecordCount];
+    Record->Timestamp  = Timestamp;
+    Record->Argument   = Argument;
+    Record->NameOffset = NameOffset;
+    Record->Type       = Type;
+    Record->Category   = Category;
+    Index              = ++mTraceHeader->RecordCount;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  return Index;
+}
+
+/**
+  Records the beginning of a span.
+
+  @param[in]  This              Instance of the protocol.
+  @param[in]  Category          NVIDIA_BOOT_TRACE_CATEGORY of the span.
+  @param[in]  Name              Name of the span.
+  @param[in]  Argument          Caller defined argument.
+
+  @retval Span id to pass to End, or NVIDIA_BOOT_TRACE_INVALID_SPAN
+**/
+STATIC
+UINT32
+EFIAPI
+BootTraceBegin (
+  IN NVIDIA_BOOT_TRACE_PROTOCOL  *This,
+  IN UINT8                       Category,
+  IN CONST CHAR8                 *Name,
+  IN UINT32                      Argument
+  )
+{
+  if (Name == NULL) {
+    return NVIDIA_BOOT_TRACE_INVALID_SPAN;
+  }
+
+  return BootTraceAppend (BootTraceRecordBegin, Category, Name, 0, Argument);
+}
+
+/**
+  Records the end of a span.
+
+  @param[in]  This              Instance of the protocol.
+  @param[in]  SpanId            Span id returned by Begin.
+**/
+STATIC
+VOID
+EFIAPI
+BootTraceEnd (
+  IN NVIDIA_BOOT_TRACE_PROTOCOL  *This,
+  IN UINT32                      SpanId
+  )
+{
+  NVIDIA_BOOT_TRACE_RECORD  *Begin;
+
+  if (!mTraceEnabled ||
+      (SpanId == NVIDIA_BOOT_TRACE_INVALID_SPAN) ||
+      (SpanId > mTraceHeader->RecordCount))
+  {
+    return;
+  }
+
+  Begin = &mTraceRecords[SpanId - 1];
+  if (Begin->Type != BootTraceRecordBegin) {
+    return;
+  }
+
+  BootTraceAppend (BootTraceRecordEnd, Begin->Category, NULL, Begin->NameOffset, SpanId);
+}
+
+/**
+  Records an instant event.
+
+  @param[in]  This              Instance of the protocol.
+  @param[in]  Category          NVIDIA_BOOT_TRACE_CATEGORY of the event.
+  @param[in]  Name              Name of the event.
+  @param[in]  Argument          Caller defined argument.
+**/
+STATIC
+VOID
+EFIAPI
+BootTraceInstant (
+  IN NVIDIA_BOOT_TRACE_PROTOCOL  *This,
+  IN UINT8                       Category,
+  IN CONST CHAR8                 *Name,
+  IN UINT32                      Argument
+  )
+{
+  if (Name == NULL) {
+    return;
+  }
+
+  BootTraceAppend (BootTraceRecordInstant, Category, Name, 0, Argument);
+}
+
+STATIC NVIDIA_BOOT_TRACE_PROTOCOL  mBootTraceProtocol = {
+  BootTraceBegin,
+  BootTraceEnd,
+  BootTraceInstant
+};
+
+/**
+  Records an image event for every newly loaded image, named after the
+  image's PDB file.
+
+  @param[in]  Event            Event
+  @param[in]  Context          Unused
+**/
+STATIC
+VOID
+EFIAPI
+BootTraceOnLoadedImage (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  EFI_STATUS                 Status;
+  EFI_HANDLE                 Handle;
+  UINTN                      BufferSize;
+  EFI_LOADED_IMAGE_PROTOCOL  *LoadedImage;
+  CHAR8                      *PdbPath;
+  CHAR8                      *Start;
+  CHAR8                      ImageName[BOOT_TRACE_MAX_IMAGE_NAME_LEN];
+  UINTN                      Index;
+
+  while (TRUE) {
+    BufferSize = sizeof (Handle);
+    Status     = gBS->LocateHandle (ByRegisterNotify, NULL, mLoadedImageRegistration, &BufferSize, &Handle);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    Status = gBS->HandleProtocol (Handle, &gEfiLoadedImageProtocolGuid, (VOID **)&LoadedImage);
+    if (EFI_ERROR (Status)) {
+      continue;
+    }
+
+    PdbPath = PeCoffLoaderGetPdbPointer (LoadedImage->ImageBase);
+    if (PdbPath == NULL) {
+      BootTraceAppend (BootTraceRecordInstant, BootTraceCategoryImage, "UnknownImage", 0, 0);
+      continue;
+    }
+
+    Start = PdbPath;
+    for ( ; *PdbPath != '\0'; PdbPath++) {
+      if ((*PdbPath == '/') || (*PdbPath == '\\')) {
+        Start = PdbPath + 1;
+      }
+    }
+
+    for (Index = 0; Index < (BOOT_TRACE_MAX_IMAGE_NAME_LEN - 1); Index++) {
+      if ((Start[Index] == '\0') || (Start[Index] == '.')) {
+        break;
+      }
+
+      ImageName[Index] = Start[Index];
+    }
+
+    ImageName[Index] = '\0';
+    BootTraceAppend (BootTraceRecordInstant, BootTraceCategoryImage, ImageName, 0, 0);
+  }
+}
+
+/**
+  Initializes the boot trace buffer and installs the boot trace protocol.
+
+  @param[in]  TraceBase           Base of the trace buffer in the profiler carveout.
+  @param[in]  TraceSize           Size of the trace buffer.
+
+  @retval EFI_SUCCESS             Boot tracing started
+  @retval others                  Error occurred
+**/
+EFI_STATUS
+BootTraceInitialize (
+  IN UINTN  TraceBase,
+  IN UINTN  TraceSize
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       StringTableSize;
+  UINT64      Frequency;
+
+  if ((TraceBase == 0) || (TraceSize <= sizeof (NVIDIA_BOOT_TRACE_HEADER))) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  mNameHash = (UINT16 *)AllocateZeroPool (BOOT_TRACE_NAME_HASH_SIZE * sizeof (UINT16));
+  if (mNameHash == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  StringTableSize = MIN (TraceSize / BOOT_TRACE_STRING_TABLE_DIVISOR, MAX_UINT16);
+  Frequency       = GetPerformanceCounterProperties (NULL, NULL);
+
+  mTraceHeader = (NVIDIA_BOOT_TRACE_HEADER *)TraceBase;
+  ZeroMem (mTraceHeader, TraceSize);
+  mTraceHeader->Signature         = NVIDIA_BOOT_TRACE_SIGNATURE;
+  mTraceHeader->Version           = NVIDIA_BOOT_TRACE_VERSION;
+  mTraceHeader->HeaderSize        = sizeof (NVIDIA_BOOT_TRACE_HEADER);
+  mTraceHeader->RecordSize        = sizeof (NVIDIA_BOOT_TRACE_RECORD);
+  mTraceHeader->MaxRecords        = (UINT32)((TraceSize - sizeof (NVIDIA_BOOT_TRACE_HEADER) - StringTableSize) / sizeof (NVIDIA_BOOT_TRACE_RECORD));
+  mTraceHeader->TimerFrequency    = Frequency;
+  mTraceHeader->StringTableSize   = (UINT32)StringTableSize;
+  mTraceHeader->StringTableOffset = (UINT32)(TraceSize - StringTableSize);
+
+  mTraceRecords = (NVIDIA_BOOT_TRACE_RECORD *)(mTraceHeader + 1);
+  mTraceStrings = (CHAR8 *)(TraceBase + mTraceHeader->StringTableOffset);
+  mTraceEnabled = TRUE;
+
+  mLoadedImageEvent = EfiCreateProtocolNotifyEvent (
+                        &gEfiLoadedImageProtocolGuid,
+                        TPL_CALLBACK,
+                        BootTraceOnLoadedImage,
+                        NULL,
+                        &mLoadedImageRegistration
+                        );
+
+  mBootTraceHandle = NULL;
+  Status           = gBS->InstallMultipleProtocolInterfaces (
+                            &mBootTraceHandle,
+                            &gNVIDIABootTraceProtocolGuid,
+                            &mBootTraceProtocol,
+                            NULL
+                            );
+  if (EFI_ERROR (Status)) {
+    mBootTraceHandle = NULL;
+    BootTraceDeinitialize ();
+    return Status;
+  }
+
+  DEBUG ((DEBUG_INFO, "Boot trace at 0x%lx, %u records\n", TraceBase, mTraceHeader->MaxRecords));
+  return EFI_SUCCESS;
+}
+
+/**
+  Uninstalls the boot trace protocol and releases the resources created by
+  BootTraceInitialize. Used when the driver fails to load after tracing
+  was started.
+**/
+VOID
+BootTraceDeinitialize (
+  VOID
+  )
+{
+  mTraceEnabled = FALSE;
+
+  if (mBootTraceHandle != NULL) {
+    gBS->UninstallMultipleProtocolInterfaces (
+           mBootTraceHandle,
+           &gNVIDIABootTraceProtocolGuid,
+           &mBootTraceProtocol,
+           NULL
+           );
+    mBootTraceHandle = NULL;
+  }
+
+  if (mLoadedImageEvent != NULL) {
+    gBS->CloseEvent (mLoadedImageEvent);
+    mLoadedImageEvent = NULL;
+  }
+
+  if (mNameHash != NULL) {
+    FreePool (mNameHash);
+    mNameHash = NULL;
+  }
+}
+
+/**
+  Stops recording new trace records.
+**/
+VOID
+BootTraceStop (
+  VOID
+  )
+{
+  if (mTraceEnabled) {
+    BootTraceAppend (BootTraceRecordInstant, BootTraceCategoryOther, "ExitBootServices", 0, 0);
+    mTraceEnabled = FALSE;
+  }
+}
@@ -1,7 +1,7 @@
 /** @file
   Implement the RNDIS interface.
 
-  SPDX-FileCopyrightText: Copyright (c) 2022-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2022-2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -670,6 +670,9 @@ RndisReceiveDequeue (
 /**
   This function receives data from USB device and push it to queue for later use.
 
+  A single bulk-in transfer may carry several RNDIS packet messages when the
+  device aggregates packets. Each one is queued separately.
+
   @param[in]      Private       Pointer to private data.
 
   @retval EFI_SUCCESS           function is finished successfully.
@@ -683,6 +686,7 @@ UsbRndisReceive (
 {
   RNDIS_PACKET_MSG_DATA  *RndisPacketMessage;
   UINTN                  Length;
+  UINTN                  Offset;
   UINT8                  *RndisBuffer;
   EFI_STATUS             Status;
 
@@ -694,48 +698,68 @@ UsbRndisReceive (
     return EFI_NOT_READY;
   }
 
-  Length      = Private->UsbData.MaxTransferSize;
-  RndisBuffer = AllocateZeroPool (Length);
-  if (RndisBuffer == NULL) {
-    return EFI_OUT_OF_RESOURCES;
+  if (Private->RxTransferBuffer == NULL) {
+    return EFI_NOT_READY;
   }
 
   //
   // Receive data on bulk-in endpoint.
   //
+  Length = Private->RxTransferBufferSize;
   Status = RndisReceiveMessage (
              Private->UsbIoDataProtocol,
              Private->UsbData.EndPoint.BulkIn,
-             (RNDIS_MSG_HEADER *)RndisBuffer,
+             (RNDIS_MSG_HEADER *)Private->RxTransferBuffer,
              &Length
              );
   if (EFI_ERROR (Status) || (Length == 0)) {
     DEBUG ((USB_DEBUG_SNP_TRACE, "%a, RndisReceiveMessage: %r Length: %u\n", __FUNCTION__, Status, Length));
-    Status = EFI_NOT_READY;
-    goto OnRelease;
+    return EFI_NOT_READY;
   }
 
-  RndisPacketMessage = (RNDIS_PACKET_MSG_DATA *)RndisBuffer;
-  if ((RndisPacketMessage->MessageType != RNDIS_PACKET_MSG) || (RndisPacketMessage->DataOffset != (sizeof (RNDIS_PACKET_MSG_DATA) - 8))) {
-    Status = EFI_DEVICE_ERROR;
-    goto OnRelease;
-  }
+  Private->RxTransfers++;
 
   //
-  // Enqueue
+  // Split the transfer into packet messages
   //
-  Status = RndisReceiveEnqueue (&Private->UsbData, RndisBuffer, Private->UsbData.MaxTransferSize);
-  if (EFI_ERROR (Status)) {
-    goto OnRelease;
-  }
+  Offset = 0;
+  while (Length - Offset >= sizeof (RNDIS_PACKET_MSG_DATA)) {
+    RndisPacketMessage = (RNDIS_PACKET_MSG_DATA *)(Private->RxTransferBuffer + Offset);
+    if ((RndisPacketMessage->MessageType != RNDIS_PACKET_MSG) ||
+        (RndisPacketMessage->MessageLength < sizeof (RNDIS_PACKET_MSG_DATA)) ||
+        (RndisPacketMessage->MessageLength > Length - Offset) ||
+        (RndisPacketMessage->DataOffset != (sizeof (RNDIS_PACKET_MSG_DATA) - 8)) ||
+        (RndisPacketMessage->DataLength > RndisPacketMessage->MessageLength - sizeof (RNDIS_PACKET_MSG_DATA)))
+    {
+      Private->Statistics.RxDroppedFrames++;
+      return (Offset == 0) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+    }
 
-  return EFI_SUCCESS;
+    Private->Statistics.RxTotalFrames++;
+    Private->Statistics.RxTotalBytes += RndisPacketMessage->DataLength;
 
-OnRelease:
+    RndisBuffer = NULL;
+    if (Private->UsbData.QueueCount < RNDIS_RECEIVE_QUEUE_MAX) {
+      RndisBuffer = AllocateCopyPool (RndisPacketMessage->MessageLength, RndisPacketMessage);
+    }
+
+    if (RndisBuffer == NULL) {
+      Private->Statistics.RxDroppedFrames++;
+    } else {
+      //
+      // Enqueue
+      //
+      Status = RndisReceiveEnqueue (&Private->UsbData, RndisBuffer, RndisPacketMessage->MessageLength);
+      if (EFI_ERROR (Status)) {
+        Private->Statistics.RxDroppedFrames++;
+        FreePool (RndisBuffer);
+      }
+    }
 
-  FreePool (RndisBuffer);
+    Offset += RndisPacketMessage->MessageLength;
+  }
 
-  return Status;
+  return EFI_SUCCESS;
 }
 
 /**
@@ -978,6 +1002,12 @@ UsbRndisInitialRndisDevice (
     return Status;
   }
 
+  Status = RndisSetupTransferBuffers (Private);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a, RndisSetupTransferBuffers: %r\n", __FUNCTION__, Status));
+    return Status;
+  }
+
   //
   // OID_GEN_MEDIA_CONNECT_STATUS
   //
@@ -1246,3 +1276,309 @@ RndisReceiveWorker (
 
   return Status;
 }
+
+/**
+  Allocate the bulk transfer buffers for the transfer sizes negotiated with
+  the device in UsbRndisInitialDevice.
+
+  @param[in]      Private       Pointer to private data
+
+  @retval EFI_SUCCESS           function is finished successfully.
+  @retval Others                Error occurs.
+
+**/
+EFI_STATUS
+RndisSetupTransferBuffers (
+  IN USB_RNDIS_PRIVATE_DATA  *Private
+  )
+{
+  UINTN  RxSize;
+  UINTN  TxSize;
+
+  if (Private == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // The device may send up to the transfer size advertised in the
+  // initialize message, and accepts up to the size it reported back.
+  // One extra byte is kept for the short packet padding.
+  //
+  RxSize = MAX (RNDIS_MAX_TRANSFER_SIZE, Private->UsbData.MaxTransferSize);
+  TxSize = Private->UsbData.MaxTransferSize + 1;
+
+  RndisTransmitFlush (Private);
+
+  if (Private->RxTransferBufferSize != RxSize) {
+    FREE_NON_NULL (Private->RxTransferBuffer);
+    Private->RxTransferBuffer     = AllocatePool (RxSize);
+    Private->RxTransferBufferSize = (Private->RxTransferBuffer == NULL) ? 0 : RxSize;
+  }
+
+  if (Private->TxTransferBufferSize != TxSize) {
+    FREE_NON_NULL (Private->TxTransferBuffer);
+    Private->TxTransferBuffer     = AllocatePool (TxSize);
+    Private->TxTransferBufferSize = (Private->TxTransferBuffer == NULL) ? 0 : TxSize;
+  }
+
+  if ((Private->RxTransferBuffer == NULL) || (Private->TxTransferBuffer == NULL)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  DEBUG ((
+    USB_DEBUG_RNDIS,
+    "%a, Rx transfer: 0x%x Tx transfer: 0x%x packets per transfer: %u\n",
+    __FUNCTION__,
+    Private->RxTransferBufferSize,
+    Private->TxTransferBufferSize,
+    Private->UsbData.MaxPacketsPerTransfer
+    ));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Release the bulk transfer buffers and any queued receive messages.
+
+  @param[in]      Private       Pointer to private data
+
+**/
+VOID
+RndisFreeTransferBuffers (
+  IN USB_RNDIS_PRIVATE_DATA  *Private
+  )
+{
+  UINT8  *Buffer;
+  UINTN  BufferSize;
+
+  if (Private == NULL) {
+    return;
+  }
+
+  while (!EFI_ERROR (RndisReceiveDequeue (&Private->UsbData, &Buffer, &BufferSize))) {
+    FreePool (Buffer);
+  }
+
+  FREE_NON_NULL (Private->RxTransferBuffer);
+  FREE_NON_NULL (Private->TxTransferBuffer);
+  Private->RxTransferBufferSize = 0;
+  Private->TxTransferBufferSize = 0;
+  Private->TxTransferLength     = 0;
+  Private->TxTransferPackets    = 0;
+}
+
+/**
+  Grow the last message in the transmit transfer buffer by zero padding.
+  MessageLength must cover the padding, since receivers find the next
+  message of a transfer by adding MessageLength to the current offset.
+
+  @param[in]      Private       Pointer to private data
+  @param[in]      Padding       Number of padding bytes to append.
+
+**/
+STATIC
+VOID
+RndisTransmitPadLastMessage (
+  IN USB_RNDIS_PRIVATE_DATA  *Private,
+  IN UINTN                   Padding
+  )
+{
+  RNDIS_PACKET_MSG_DATA  *LastMessage;
+
+  LastMessage                 = (RNDIS_PACKET_MSG_DATA *)(Private->TxTransferBuffer + Private->TxTransferLastMessage);
+  LastMessage->MessageLength += (UINT32)Padding;
+  ZeroMem (Private->TxTransferBuffer + Private->TxTransferLength, Padding);
+  Private->TxTransferLength += Padding;
+}
+
+/**
+  Send the packets batched in the transmit transfer buffer.
+
+  @param[in]      Private       Pointer to private data
+
+  @retval EFI_SUCCESS           function is finished successfully.
+  @retval Others                Error occurs.
+
+**/
+EFI_STATUS
+RndisTransmitFlush (
+  IN USB_RNDIS_PRIVATE_DATA  *Private
+  )
+{
+  RNDIS_PACKET_MSG_DATA  *LastMessage;
+  UINTN                  Length;
+  EFI_STATUS             Status;
+
+  if ((Private == NULL) || (Private->TxTransferPackets == 0)) {
+    return EFI_SUCCESS;
+  }
+
+  if (Private->TxFlushTimer != NULL) {
+    gBS->SetTimer (Private->TxFlushTimer, TimerCancel, 0);
+  }
+
+  //
+  // Avoid a transfer that is a multiple of the endpoint packet size, which
+  // would need a zero length packet, by growing the last packet by one byte.
+  //
+  if ((Private->UsbData.EndPoint.MaxPacketSize != 0) &&
+      ((Private->TxTransferLength % Private->UsbData.EndPoint.MaxPacketSize) == 0))
+  {
+    RndisTransmitPadLastMessage (Private, 1);
+    LastMessage              = (RNDIS_PACKET_MSG_DATA *)(Private->TxTransferBuffer + Private->TxTransferLastMessage);
+    LastMessage->DataLength += 1;
+  }
+
+  Length = Private->TxTransferLength;
+
+  Status = RndisTransmitMessage (
+             Private->UsbIoDataProtocol,
+             Private->UsbData.EndPoint.BulkOut,
+             (RNDIS_MSG_HEADER *)Private->TxTransferBuffer,
+             &Length
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a, RndisTransmitMessage: %r Length: %u\n", __FUNCTION__, Status, Length));
+    Private->Statistics.TxDroppedFrames += Private->TxTransferPackets;
+    Private->TxStatus                    = Status;
+  } else {
+    Private->Statistics.TxGoodFrames += Private->TxTransferPackets;
+    Private->TxTransfers++;
+  }
+
+  //
+  // The bulk-out transfer is done, so every queued caller buffer can now be
+  // recycled through GetStatus.
+  //
+  Private->TxQueueCompleted  = Private->TxQueueCount;
+  Private->TxTransferLength  = 0;
+  Private->TxTransferPackets = 0;
+
+  return Status;
+}
+
+/**
+  Add a packet to the transmit transfer buffer. The buffer is sent when it
+  holds MaxPacketsPerTransfer packets, when the next packet does not fit, or
+  when the flush timer expires. Buffer is queued for GetStatus and is only
+  recycled once the transfer carrying it has completed.
+
+  @param[in]      Private       Pointer to private data
+  @param[in]      Buffer        Ethernet frame to send.
+  @param[in]      BufferSize    Size of the frame in bytes.
+
+  @retval EFI_SUCCESS           function is finished successfully.
+  @retval EFI_NOT_READY         Transmitted buffers must be recycled first.
+  @retval Others                Error occurs.
+
+**/
+EFI_STATUS
+RndisTransmitPacket (
+  IN USB_RNDIS_PRIVATE_DATA  *Private,
+  IN VOID                    *Buffer,
+  IN UINTN                   BufferSize
+  )
+{
+  RNDIS_PACKET_MSG_DATA  *RndisPacketMsg;
+  UINTN                  Alignment;
+  UINTN                  Offset;
+  UINTN                  Length;
+  EFI_STATUS             Status;
+
+  if ((Private == NULL) || (Buffer == NULL) || (Private->TxTransferBuffer == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Private->TxQueueCount >= USB_RNDIS_TX_QUEUE_MAX) {
+    RndisTransmitFlush (Private);
+    return EFI_NOT_READY;
+  }
+
+  Length = sizeof (RNDIS_PACKET_MSG_DATA) + BufferSize;
+
+  //
+  // Packets after the first start on a 2^PacketAlignmentFactor boundary
+  //
+  Alignment = (UINTN)1 << MIN (Private->UsbData.PacketAlignmentFactor, RNDIS_PACKET_ALIGNMENT_FACTOR_MAX);
+  Offset    = ALIGN_VALUE (Private->TxTransferLength, Alignment);
+  if ((Private->TxTransferPackets != 0) &&
+      ((Private->TxTransferPackets >= Private->UsbData.MaxPacketsPerTransfer) ||
+       (Offset + Length >= Private->TxTransferBufferSize)))
+  {
+    RndisTransmitFlush (Private);
+    Offset = 0;
+  }
+
+  if (Offset + Length >= Private->TxTransferBufferSize) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  if (Offset != Private->TxTransferLength) {
+    RndisTransmitPadLastMessage (Private, Offset - Private->TxTransferLength);
+  }
+
+  RndisPacketMsg = (RNDIS_PACKET_MSG_DATA *)(Private->TxTransferBuffer + Offset);
+  ZeroMem (RndisPacketMsg, sizeof (RNDIS_PACKET_MSG_DATA));
+  RndisPacketMsg->MessageType   = RNDIS_PACKET_MSG;
+  RndisPacketMsg->MessageLength = (UINT32)Length;
+  RndisPacketMsg->DataOffset    = sizeof (RNDIS_PACKET_MSG_DATA) - 8;
+  RndisPacketMsg->DataLength    = (UINT32)BufferSize;
+  CopyMem (RndisPacketMsg + 1, Buffer, BufferSize);
+
+  Private->TxTransferLastMessage = Offset;
+  Private->TxTransferLength      = Offset + Length;
+  Private->TxTransferPackets++;
+  Private->Statistics.TxTotalFrames++;
+  Private->Statistics.TxTotalBytes += BufferSize;
+
+  Private->TxQueue[(Private->TxQueueHead + Private->TxQueueCount) % USB_RNDIS_TX_QUEUE_MAX] = Buffer;
+  Private->TxQueueCount++;
+
+  if ((Private->UsbData.MaxPacketsPerTransfer > 1) &&
+      (Private->TxFlushTimer != NULL) &&
+      (Private->TxTransferPackets < Private->UsbData.MaxPacketsPerTransfer) &&
+      (Private->TxQueueCount < USB_RNDIS_TX_QUEUE_MAX))
+  {
+    Status = gBS->SetTimer (Private->TxFlushTimer, TimerRelative, RNDIS_TX_FLUSH_INTERVAL);
+    if (!EFI_ERROR (Status)) {
+      return EFI_SUCCESS;
+    }
+  }
+
+  Status = RndisTransmitFlush (Private);
+  if (EFI_ERROR (Status)) {
+    //
+    // The error is returned for this packet, so the caller keeps its buffer.
+    // Earlier packets of the batch were accepted and are still recycled.
+    //
+    Private->TxQueueCount--;
+    Private->TxQueueCompleted--;
+    Private->TxStatus = EFI_SUCCESS;
+  }
+
+  return Status;
+}
+
+/**
+  This is the timer sending a partially filled transmit batch.
+
+  @param[in]  Event        The event this notify function registered to.
+  @param[in]  Context      Pointer to the context data registered to the event.
+
+**/
+VOID
+EFIAPI
+RndisTransmitFlushTimer (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  USB_RNDIS_PRIVATE_DATA  *Private;
+
+  Private = (USB_RNDIS_PRIVATE_DATA *)Context;
+  if ((Private == NULL) || Private->DeviceLost) {
+    return;
+  }
+
+  RndisTransmitFlush (Private);
+}
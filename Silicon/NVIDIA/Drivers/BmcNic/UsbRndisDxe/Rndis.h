@@ -2,7 +2,7 @@
   Definitions for USB RNDIS interface.
 
   Copyright (c) 2007 - 2018, Intel Corporation. All rights reserved.<BR>
-  Copyright (c) 2022-2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  Copyright (c) 2022-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -37,6 +37,7 @@
 #define RNDIS_USB_TRANSMIT_TIMEOUT          3000
 #define RNDIS_USB_RECEIVE_TIMEOUT           1
 #define RNDIS_RECEIVE_QUEUE_MAX             0x00FF
+#define RNDIS_PACKET_ALIGNMENT_FACTOR_MAX   6
 
 #define USB_SEND_ENCAPSULATED_CMD  0x00000000
 #define USB_GET_ENCAPSULATED_RES   0x00000001
@@ -50,6 +51,7 @@
 #define USB_RESET_REQUEST_ID(a)     ((a) = 0x1)
 #define USB_BACKGROUND_PULL_INTERVAL  (10 * TICKS_PER_MS) // slow down polling to 10 ms interval.
 #define USB_LANGUAGE_ID_ENGLISH       0x0409              // English
+#define RNDIS_TX_FLUSH_INTERVAL       (1 * TICKS_PER_MS)  // send a partial transmit batch after 1 ms.
 
 //
 // Per MS-RNDIS
@@ -501,4 +503,78 @@ RndisReceiveWorker (
   IN USB_RNDIS_PRIVATE_DATA  *Private
   );
 
+/**
+  Allocate the bulk transfer buffers for the transfer sizes negotiated with
+  the device in UsbRndisInitialDevice.
+
+  @param[in]      Private       Pointer to private data
+
+  @retval EFI_SUCCESS           function is finished successfully.
+  @retval Others                Error occurs.
+
+**/
+EFI_STATUS
+RndisSetupTransferBuffers (
+  IN USB_RNDIS_PRIVATE_DATA  *Private
+  );
+
+/**
+  Release the bulk transfer buffers and any queued receive messages.
+
+  @param[in]      Private       Pointer to private data
+
+**/
+VOID
+RndisFreeTransferBuffers (
+  IN USB_RNDIS_PRIVATE_DATA  *Private
+  );
+
+/**
+  Send the packets batched in the transmit transfer buffer.
+
+  @param[in]      Private       Pointer to private data
+
+  @retval EFI_SUCCESS           function is finished successfully.
+  @retval Others                Error occurs.
+
+**/
+EFI_STATUS
+RndisTransmitFlush (
+  IN USB_RNDIS_PRIVATE_DATA  *Private
+  );
+
+/**
+  Add a packet to the transmit transfer buffer. The buffer is sent when it
+  holds MaxPacketsPerTransfer packets, when the next packet does not fit, or
+  when the flush timer expires.
+
+  @param[in]      Private       Pointer to private data
+  @param[in]      Buffer        Ethernet frame to send.
+  @param[in]      BufferSize    Size of the frame in bytes.
+
+  @retval EFI_SUCCESS           function is finished successfully.
+  @retval Others                Error occurs.
+
+**/
+EFI_STATUS
+RndisTransmitPacket (
+  IN USB_RNDIS_PRIVATE_DATA  *Private,
+  IN VOID                    *Buffer,
+  IN UINTN                   BufferSize
+  );
+
+/**
+  This is the timer sending a partially filled transmit batch.
+
+  @param[in]  Event        The event this notify function registered to.
+  @param[in]  Context      Pointer to the context data registered to the event.
+
+**/
+VOID
+EFIAPI
+RndisTransmitFlushTimer (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  );
+
 #endif //  RNDIS_H_
@@ -1,7 +1,7 @@
 /** @file
   Provides the Simple Network functions.
 
-  SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2022-2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -157,7 +157,11 @@ UsbRndisSnpInitialize (
 
   TplPrevious = gBS->RaiseTPL (TPL_CALLBACK);
 
-  Status                     = UsbRndisInitialDevice (Private->UsbIoProtocol, USB_INCREASE_REQUEST_ID (Private->UsbData.RequestId), &Private->UsbData);
+  Status = UsbRndisInitialDevice (Private->UsbIoProtocol, USB_INCREASE_REQUEST_ID (Private->UsbData.RequestId), &Private->UsbData);
+  if (!EFI_ERROR (Status)) {
+    Status = RndisSetupTransferBuffers (Private);
+  }
+
   Private->SnpModeData.State = EfiSimpleNetworkInitialized;
 
   gBS->RestoreTPL (TplPrevious);
@@ -257,6 +261,18 @@ UsbRndisSnpShutdown (
 
   TplPrevious = gBS->RaiseTPL (TPL_CALLBACK);
 
+  RndisTransmitFlush (Private);
+
+  DEBUG ((
+    USB_DEBUG_SNP,
+    "%a, Rx: %lu frames in %lu transfers, Tx: %lu frames in %lu transfers\n",
+    __FUNCTION__,
+    Private->Statistics.RxTotalFrames,
+    Private->RxTransfers,
+    Private->Statistics.TxTotalFrames,
+    Private->TxTransfers
+    ));
+
   Status = UsbRndisShutdownDevice (Private->UsbIoProtocol);
   if (!EFI_ERROR (Status)) {
     USB_RESET_REQUEST_ID (Private->UsbData.RequestId);
@@ -408,6 +424,32 @@ UsbRndisSnpStationAddress (
   return EFI_UNSUPPORTED;
 }
 
+/**
+  Reset the statistics of the network interface. Counters that are not
+  maintained by this driver are reported as unsupported (all bits set).
+
+  @param[in]      Private       Pointer to private data
+
+**/
+STATIC
+VOID
+UsbRndisResetStatistics (
+  IN  USB_RNDIS_PRIVATE_DATA  *Private
+  )
+{
+  SetMem (&Private->Statistics, sizeof (EFI_NETWORK_STATISTICS), 0xFF);
+  Private->Statistics.RxTotalFrames   = 0;
+  Private->Statistics.RxGoodFrames    = 0;
+  Private->Statistics.RxDroppedFrames = 0;
+  Private->Statistics.RxTotalBytes    = 0;
+  Private->Statistics.TxTotalFrames   = 0;
+  Private->Statistics.TxGoodFrames    = 0;
+  Private->Statistics.TxDroppedFrames = 0;
+  Private->Statistics.TxTotalBytes    = 0;
+  Private->RxTransfers                = 0;
+  Private->TxTransfers                = 0;
+}
+
 /**
   Resets or collects the statistics on a network interface.
 
@@ -437,9 +479,52 @@ UsbRndisSnpStatistics (
   OUT EFI_NETWORK_STATISTICS      *StatisticsTable  OPTIONAL
   )
 {
+  USB_RNDIS_PRIVATE_DATA  *Private;
+  EFI_TPL                 TplPrevious;
+  EFI_STATUS              Status;
+
   DEBUG ((USB_DEBUG_SNP_TRACE, "%a\n", __FUNCTION__));
 
-  return EFI_UNSUPPORTED;
+  if ((This == NULL) || (This->Mode == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (!Reset && (StatisticsSize == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((StatisticsSize != NULL) && (*StatisticsSize != 0) && (StatisticsTable == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (This->Mode->State < EfiSimpleNetworkStarted) {
+    return EFI_NOT_STARTED;
+  } else if (This->Mode->State < EfiSimpleNetworkInitialized) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  Private = USB_RNDIS_PRIVATE_DATA_FROM_SNP_THIS (This);
+
+  TplPrevious = gBS->RaiseTPL (TPL_CALLBACK);
+
+  Status = EFI_SUCCESS;
+  if (StatisticsSize != NULL) {
+    if ((StatisticsTable == NULL) || (*StatisticsSize < sizeof (EFI_NETWORK_STATISTICS))) {
+      Status = EFI_BUFFER_TOO_SMALL;
+    } else {
+      CopyMem (StatisticsTable, &Private->Statistics, sizeof (EFI_NETWORK_STATISTICS));
+    }
+
+    *StatisticsSize = sizeof (EFI_NETWORK_STATISTICS);
+  }
+
+  if (Reset && !EFI_ERROR (Status)) {
+    UsbRndisResetStatistics (Private);
+  }
+
+  gBS->RestoreTPL (TplPrevious);
+
+  return Status;
 }
 
 /**
@@ -607,10 +692,20 @@ UsbRndisSnpGetStatus (
   }
 
   if (TxBuf != NULL) {
+    //
+    // The flush timer cannot run while the caller polls at TPL_CALLBACK, so
+    // send the pending batch now rather than never completing it.
+    //
+    if ((Private->TxQueueCompleted == 0) && (Private->TxQueueCount != 0)) {
+      RndisTransmitFlush (Private);
+    }
+
     *TxBuf = NULL;
-    if (Private->TxBuffer != NULL) {
-      *TxBuf            = Private->TxBuffer;
-      Private->TxBuffer = NULL;
+    if (Private->TxQueueCompleted != 0) {
+      *TxBuf               = Private->TxQueue[Private->TxQueueHead];
+      Private->TxQueueHead = (Private->TxQueueHead + 1) % USB_RNDIS_TX_QUEUE_MAX;
+      Private->TxQueueCount--;
+      Private->TxQueueCompleted--;
     }
   }
 
@@ -669,11 +764,7 @@ UsbRndisSnpTransmit (
 {
   USB_RNDIS_PRIVATE_DATA  *Private;
   ETHERNET_HEADER         *EthernetHeader;
-  RNDIS_PACKET_MSG_DATA   *RndisPacketMsg;
-  UINTN                   Length;
-  UINTN                   DataSize;
   EFI_TPL                 TplPrevious;
-  UINT8                   *DataPointer;
   EFI_STATUS              Status;
 
   DEBUG ((USB_DEBUG_SNP_TRACE, "%a\n", __FUNCTION__));
@@ -730,6 +821,16 @@ UsbRndisSnpTransmit (
 
   TplPrevious = gBS->RaiseTPL (TPL_CALLBACK);
 
+  //
+  // Report a batch that failed after an earlier Transmit had returned.
+  //
+  if (EFI_ERROR (Private->TxStatus)) {
+    Status            = Private->TxStatus;
+    Private->TxStatus = EFI_SUCCESS;
+    gBS->RestoreTPL (TplPrevious);
+    return Status;
+  }
+
   //
   // Fill the media header in buffer
   //
@@ -746,40 +847,15 @@ UsbRndisSnpTransmit (
   }
 
   //
-  // Prepare RNDIS package
+  // Add the packet to the current bulk-out transfer. It is sent when the
+  // batch is full or the flush timer expires, and Buffer is returned by
+  // GetStatus once that transfer has completed.
   //
-  DataSize = BufferSize;
-  if ((sizeof (RNDIS_PACKET_MSG_DATA) + (UINT32)BufferSize) % Private->UsbData.EndPoint.MaxPacketSize == 0) {
-    DataSize += 1;
-  }
-
-  Length         = sizeof (RNDIS_PACKET_MSG_DATA) + (UINT32)DataSize;
-  RndisPacketMsg = AllocateZeroPool (Length);
-  if (RndisPacketMsg == NULL) {
-    gBS->RestoreTPL (TplPrevious);
-    return EFI_OUT_OF_RESOURCES;
-  }
-
-  RndisPacketMsg->MessageType   = RNDIS_PACKET_MSG;
-  RndisPacketMsg->MessageLength = Length;
-  RndisPacketMsg->DataOffset    = sizeof (RNDIS_PACKET_MSG_DATA) - 8;
-  RndisPacketMsg->DataLength    = (UINT32)DataSize;
-  DataPointer                   = ((UINT8 *)RndisPacketMsg) + sizeof (RNDIS_PACKET_MSG_DATA);
-
-  CopyMem (DataPointer, Buffer, BufferSize);
-  Status = RndisTransmitMessage (
-             Private->UsbIoDataProtocol,
-             Private->UsbData.EndPoint.BulkOut,
-             (RNDIS_MSG_HEADER *)RndisPacketMsg,
-             &Length
-             );
+  Status = RndisTransmitPacket (Private, Buffer, BufferSize);
   if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a, RndisTransmitMessage: %r Length: %u\n", __FUNCTION__, Status, Length));
+    DEBUG ((DEBUG_ERROR, "%a, RndisTransmitPacket: %r BufferSize: %u\n", __FUNCTION__, Status, BufferSize));
   }
 
-  Private->TxBuffer = Buffer;
-  FreePool (RndisPacketMsg);
-
   if (!EFI_ERROR (Status)) {
     //
     // Transmit successfully. Switch to fast receive mode because we are expecting packets.
@@ -905,6 +981,7 @@ UsbRndisSnpReceive (
   //
   CopyMem (Buffer, (RndisBuffer + RndisPacketMsg->DataOffset + 8), RndisPacketMsg->DataLength);
   *BufferSize = RndisPacketMsg->DataLength;
+  Private->Statistics.RxGoodFrames++;
 
   if (HeaderSize != NULL) {
     *HeaderSize = Private->SnpModeData.MediaHeaderSize;
@@ -1005,6 +1082,8 @@ UsbRndisInitialSnpService (
   Private->SnpProtocol.WaitForPacket  = NULL;
   Private->SnpProtocol.Mode           = &Private->SnpModeData;
 
+  UsbRndisResetStatistics (Private);
+
   Status = UsbRndisInitialRndisDevice (Private);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "%a, UsbRndisInitialRndisDevice: %r\n", __FUNCTION__, Status));
@@ -3,7 +3,7 @@
 
   Copyright (c) 2011, Intel Corporation. All rights reserved.
   Copyright (c) 2020, ARM Limited. All rights reserved
-  Copyright (c) 2022-2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  Copyright (c) 2022-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -57,6 +57,21 @@ NewUsbRndisPrivate (
     DEBUG ((DEBUG_ERROR, "%a, failed to create event: %r\n", __FUNCTION__, Status));
   }
 
+  //
+  // transmit batch flush timer. Packets are sent one at a time without it.
+  //
+  Status = gBS->CreateEvent (
+                  EVT_NOTIFY_SIGNAL | EVT_TIMER,
+                  TPL_CALLBACK,
+                  RndisTransmitFlushTimer,
+                  NewBuf,
+                  &NewBuf->TxFlushTimer
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a, failed to create flush event: %r\n", __FUNCTION__, Status));
+    NewBuf->TxFlushTimer = NULL;
+  }
+
   return NewBuf;
 }
 
@@ -86,6 +101,14 @@ ReleaseUsbRndisPrivate (
     Private->ReceiverControlTimer = NULL;
   }
 
+  if (Private->TxFlushTimer != NULL) {
+    gBS->SetTimer (Private->TxFlushTimer, TimerCancel, 0);
+    gBS->CloseEvent (Private->TxFlushTimer);
+    Private->TxFlushTimer = NULL;
+  }
+
+  RndisFreeTransferBuffers (Private);
+
   if (Private->UsbIoProtocol != NULL) {
     gBS->CloseProtocol (
            Private->Controller,
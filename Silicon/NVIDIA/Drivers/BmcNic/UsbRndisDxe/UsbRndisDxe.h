@@ -1,7 +1,7 @@
 /** @file
   Definition of USB RNDIS driver.
 
-  SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2022-2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -45,6 +45,8 @@
 //
 #define USB_RNDIS_VERSION  0x0A
 
+#define USB_RNDIS_TX_QUEUE_MAX  0x0020
+
 //
 // Private Context Data Structure
 //
@@ -131,7 +133,40 @@ typedef struct {
   EFI_EVENT                       ReceiverControlTimer;
   BOOLEAN                         ReceiverSlowWaitFlag;
   BOOLEAN                         DeviceLost;
-  VOID                            *TxBuffer;
+
+  //
+  // Caller transmit buffers in submission order. The first TxQueueCompleted
+  // entries belong to bulk-out transfers that have finished and are handed
+  // back by GetStatus; the rest are still batched in TxTransferBuffer.
+  // TxStatus keeps the error of a transfer sent outside of Transmit until
+  // the next Transmit reports it.
+  //
+  VOID                            *TxQueue[USB_RNDIS_TX_QUEUE_MAX];
+  UINTN                           TxQueueHead;
+  UINTN                           TxQueueCount;
+  UINTN                           TxQueueCompleted;
+  EFI_STATUS                      TxStatus;
+
+  //
+  // Bulk transfer buffers. A bulk-in transfer may carry several RNDIS packet
+  // messages, and up to MaxPacketsPerTransfer transmitted packets are batched
+  // into one bulk-out transfer.
+  //
+  UINT8                           *RxTransferBuffer;
+  UINTN                           RxTransferBufferSize;
+  UINT8                           *TxTransferBuffer;
+  UINTN                           TxTransferBufferSize;
+  UINTN                           TxTransferLength;
+  UINTN                           TxTransferLastMessage;
+  UINT32                          TxTransferPackets;
+  EFI_EVENT                       TxFlushTimer;
+
+  //
+  // Statistics
+  //
+  EFI_NETWORK_STATISTICS          Statistics;
+  UINT64                          RxTransfers;
+  UINT64                          TxTransfers;
 } USB_RNDIS_PRIVATE_DATA;
 
 #define USB_RNDIS_PRIVATE_DATA_FROM_SNP_THIS(a) \
@@ -10,6 +10,7 @@
 #include "BpmpIpcDxePrivate.h"
 #include "BpmpIpcPrivate.h"
 #include <Library/ArmLib.h>
+#include <Library/BootTraceLib.h>
 #include <Library/IoLib.h>
 #include <Library/PcdLib.h>
 
@@ -349,6 +350,7 @@ BpmpIpcCommunicate (
   BPMP_PENDING_TRANSACTION      *PendingTransaction = NULL;
   BOOLEAN                       NeedQueue           = FALSE;
   UINT32                        ChannelNo           = 0;
+  UINT32                        SpanId;
 
   if (NULL == This) {
     return EFI_INVALID_PARAMETER;
@@ -426,6 +428,9 @@ BpmpIpcCommunicate (
   if (Blocking) {
     // prevent threaded device discovery callbacks until this blocking call completes
     EntryTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    SpanId   = BootTraceBegin (BootTraceCategoryBpmpIpc, "BpmpIpc", MessageRequest);
+  } else {
+    BootTraceInstant (BootTraceCategoryBpmpIpc, "BpmpIpcQueued", MessageRequest);
   }
 
   OldTpl    = gBS->RaiseTPL (TPL_NOTIFY);
@@ -454,6 +459,7 @@ BpmpIpcCommunicate (
       gBS->Stall (TIMEOUT_STALL_US);
     }
 
+    BootTraceEnd (SpanId);
     gBS->RestoreTPL (EntryTpl);
 
     gBS->CloseEvent (Token->Event);
@@ -19,6 +19,7 @@
 #include <Protocol/ArmScmiClockProtocol.h>
 #include <Protocol/ArmScmiClock2Protocol.h>
 #include <Protocol/BpmpIpc.h>
+#include <Protocol/ClockNodeProtocol.h>
 #include <Protocol/ClockParents.h>
 
 #include "BpmpScmiClockProtocolPrivate.h"
@@ -2,7 +2,7 @@
 
   EEPROM Driver
 
-  SPDX-FileCopyrightText: Copyright (c) 2019-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2019-2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -15,6 +15,7 @@
 #include <Library/HobLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/DevicePathLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/TegraPlatformInfoLib.h>
@@ -33,6 +34,25 @@
 #define EEPROM_DUMMY_SERIALNUM  "DummySN"
 #define EEPROM_DUMMY_PRODUCTID  "DummyProd"
 
+//
+// Images read over I2C are cached in a boot services variable per EEPROM,
+// named from the CRC32 of the EEPROM device path.
+//
+#define EEPROM_CACHE_VARIABLE_NAME_FORMAT  L"EepromCache%08x"
+#define EEPROM_CACHE_VARIABLE_NAME_LENGTH  (sizeof ("EepromCache00000000"))
+#define EEPROM_CACHE_VERSION               1
+
+typedef struct {
+  UINT32    Version;
+  UINT32    Crc32;                         // Of Data
+  UINT8     Data[EEPROM_DATA_SIZE];
+} EEPROM_CACHE;
+
+typedef struct {
+  UINTN                OperationCount;
+  EFI_I2C_OPERATION    Operation[2];
+} EEPROM_I2C_REQUEST_PACKET;
+
 EFI_STATUS
 EFIAPI
 PopulateEepromData (
@@ -112,6 +132,186 @@ ValidateEepromData (
   return EFI_SUCCESS;
 }
 
+/**
+  Reads from the EEPROM.
+
+  @param[in]  I2cIo        I2C IO protocol of the EEPROM.
+  @param[in]  Offset       Offset to read from.
+  @param[out] Buffer       Buffer to read into.
+  @param[in]  Length       Number of bytes to read.
+
+  @retval EFI_SUCCESS      The data was read.
+  @retval Others           The I2C transaction failed.
+**/
+STATIC
+EFI_STATUS
+EepromRead (
+  IN  EFI_I2C_IO_PROTOCOL  *I2cIo,
+  IN  UINT8                Offset,
+  OUT UINT8                *Buffer,
+  IN  UINT32               Length
+  )
+{
+  EEPROM_I2C_REQUEST_PACKET  Request;
+
+  Request.OperationCount             = 2;
+  Request.Operation[0].Flags         = 0;
+  Request.Operation[0].LengthInBytes = sizeof (Offset);
+  Request.Operation[0].Buffer        = &Offset;
+  Request.Operation[1].Flags         = I2C_FLAG_READ;
+  Request.Operation[1].LengthInBytes = Length;
+  Request.Operation[1].Buffer        = Buffer;
+  return I2cIo->QueueRequest (I2cIo, 0, NULL, (EFI_I2C_REQUEST_PACKET *)&Request, NULL);
+}
+
+/**
+  Gets the name of the cache variable of an EEPROM.
+
+  @param[in]  Controller   Handle of the EEPROM.
+  @param[out] Name         Variable name, EEPROM_CACHE_VARIABLE_NAME_LENGTH characters.
+
+  @retval EFI_SUCCESS      The name was returned.
+  @retval Others           The EEPROM has no device path.
+**/
+STATIC
+EFI_STATUS
+EepromCacheGetName (
+  IN  EFI_HANDLE  Controller,
+  OUT CHAR16      *Name
+  )
+{
+  EFI_STATUS                Status;
+  EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
+  UINT32                    Crc32;
+
+  Status = gBS->HandleProtocol (Controller, &gEfiDevicePathProtocolGuid, (VOID **)&DevicePath);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->CalculateCrc32 (DevicePath, GetDevicePathSize (DevicePath), &Crc32);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  UnicodeSPrint (Name, EEPROM_CACHE_VARIABLE_NAME_LENGTH * sizeof (CHAR16), EEPROM_CACHE_VARIABLE_NAME_FORMAT, Crc32);
+  return EFI_SUCCESS;
+}
+
+/**
+  Loads the cached image of an EEPROM.
+
+  The cache is used only if it was written by this version of the driver, its
+  CRC32 matches, and the serial number and checksum read back from the EEPROM
+  match the cached image. This detects a board being swapped or reprogrammed
+  with a 16 byte read instead of reading the whole EEPROM.
+
+  @param[in]  I2cIo        I2C IO protocol of the EEPROM.
+  @param[in]  Name         Name of the cache variable.
+  @param[out] RawData      EEPROM image, EEPROM_DATA_SIZE bytes.
+
+  @retval TRUE      The cached image is valid and was copied to RawData.
+  @retval FALSE     The EEPROM must be read.
+**/
+STATIC
+BOOLEAN
+EepromCacheLoad (
+  IN  EFI_I2C_IO_PROTOCOL  *I2cIo,
+  IN  CONST CHAR16         *Name,
+  OUT UINT8                *RawData
+  )
+{
+  EFI_STATUS        Status;
+  EEPROM_CACHE      *Cache;
+  UINTN             DataSize;
+  UINT32            Crc32;
+  T234_EEPROM_DATA  *CachedData;
+  UINT8             SerialNumber[sizeof (CachedData->SerialNumber)];
+  UINT8             Checksum;
+  BOOLEAN           Loaded;
+
+  Cache = AllocatePool (sizeof (EEPROM_CACHE));
+  if (Cache == NULL) {
+    return FALSE;
+  }
+
+  Loaded   = FALSE;
+  DataSize = sizeof (EEPROM_CACHE);
+  Status   = gRT->GetVariable ((CHAR16 *)Name, &gNVIDIATokenSpaceGuid, NULL, &DataSize, Cache);
+  if (EFI_ERROR (Status) ||
+      (DataSize != sizeof (EEPROM_CACHE)) ||
+      (Cache->Version != EEPROM_CACHE_VERSION))
+  {
+    goto Exit;
+  }
+
+  Status = gBS->CalculateCrc32 (Cache->Data, sizeof (Cache->Data), &Crc32);
+  if (EFI_ERROR (Status) || (Crc32 != Cache->Crc32)) {
+    goto Exit;
+  }
+
+  CachedData = (T234_EEPROM_DATA *)Cache->Data;
+  Status     = EepromRead (I2cIo, OFFSET_OF (T234_EEPROM_DATA, SerialNumber), SerialNumber, sizeof (SerialNumber));
+  if (EFI_ERROR (Status) ||
+      (CompareMem (SerialNumber, CachedData->SerialNumber, sizeof (SerialNumber)) != 0))
+  {
+    goto Exit;
+  }
+
+  Status = EepromRead (I2cIo, OFFSET_OF (T234_EEPROM_DATA, Checksum), &Checksum, sizeof (Checksum));
+  if (EFI_ERROR (Status) || (Checksum != CachedData->Checksum)) {
+    goto Exit;
+  }
+
+  CopyMem (RawData, Cache->Data, EEPROM_DATA_SIZE);
+  Loaded = TRUE;
+
+Exit:
+  FreePool (Cache);
+  return Loaded;
+}
+
+/**
+  Saves the image of an EEPROM so later starts skip reading it.
+
+  @param[in]  Name         Name of the cache variable.
+  @param[in]  RawData      EEPROM image, EEPROM_DATA_SIZE bytes.
+**/
+STATIC
+VOID
+EepromCacheSave (
+  IN CONST CHAR16  *Name,
+  IN CONST UINT8   *RawData
+  )
+{
+  EFI_STATUS    Status;
+  EEPROM_CACHE  *Cache;
+
+  Cache = AllocatePool (sizeof (EEPROM_CACHE));
+  if (Cache == NULL) {
+    return;
+  }
+
+  Cache->Version = EEPROM_CACHE_VERSION;
+  CopyMem (Cache->Data, RawData, EEPROM_DATA_SIZE);
+  Status = gBS->CalculateCrc32 (Cache->Data, sizeof (Cache->Data), &Cache->Crc32);
+  if (!EFI_ERROR (Status)) {
+    Status = gRT->SetVariable (
+                    (CHAR16 *)Name,
+                    &gNVIDIATokenSpaceGuid,
+                    EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+                    sizeof (EEPROM_CACHE),
+                    Cache
+                    );
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "%a: Failed to save %s (%r)\r\n", __FUNCTION__, Name, Status));
+  }
+
+  FreePool (Cache);
+}
+
 /**
   Tests to see if this driver supports a given controller. If a child device is provided,
   it further tests to see if this driver supports creating a handle for the specified child device.
@@ -269,20 +469,22 @@ EepromDxeDriverBindingStart (
   EFI_STATUS               Status;
   EFI_I2C_IO_PROTOCOL      *I2cIo       = NULL;
   EFI_RNG_PROTOCOL         *RngProtocol = NULL;
-  EFI_I2C_REQUEST_PACKET   *Request     = NULL;
-  UINT8                    Address      = 0;
   UINT8                    *RawData;
   TEGRA_PLATFORM_TYPE      PlatformType;
   BOOLEAN                  CvmEeprom;
   TEGRA_EEPROM_BOARD_INFO  *CvmBoardInfo;
   TEGRA_EEPROM_BOARD_INFO  *IdBoardInfo;
   BOOLEAN                  SkipEepromCRC;
+  CHAR16                   CacheName[EEPROM_CACHE_VARIABLE_NAME_LENGTH];
+  BOOLEAN                  Cached;
 
   RawData       = NULL;
   CvmBoardInfo  = NULL;
   IdBoardInfo   = NULL;
   CvmEeprom     = FALSE;
   SkipEepromCRC = FALSE;
+  Cached        = FALSE;
+  CacheName[0]  = L'\0';
 
   PlatformType = TegraGetPlatform ();
   if (PlatformType == TEGRA_PLATFORM_SILICON) {
@@ -307,28 +509,19 @@ EepromDxeDriverBindingStart (
       goto ErrorExit;
     }
 
-    Request = (EFI_I2C_REQUEST_PACKET *)AllocateZeroPool (sizeof (EFI_I2C_REQUEST_PACKET) + sizeof (EFI_I2C_OPERATION));
-    if (Request == NULL) {
-      Status = EFI_OUT_OF_RESOURCES;
-      goto ErrorExit;
+    Status = EepromCacheGetName (Controller, CacheName);
+    if (!EFI_ERROR (Status)) {
+      Cached = EepromCacheLoad (I2cIo, CacheName, RawData);
     }
 
-    Request->OperationCount             = 2;
-    Request->Operation[0].Flags         = 0;
-    Request->Operation[0].LengthInBytes = sizeof (Address);
-    Request->Operation[0].Buffer        = &Address;
-    Request->Operation[1].Flags         = I2C_FLAG_READ;
-    Request->Operation[1].LengthInBytes = EEPROM_DATA_SIZE;
-    Request->Operation[1].Buffer        = RawData;
-    Status                              = I2cIo->QueueRequest (I2cIo, 0, NULL, Request, NULL);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_INFO, "Failed to read eeprom (%r)\r\n", Status));
-      goto ErrorExit;
+    if (!Cached) {
+      Status = EepromRead (I2cIo, 0, RawData, EEPROM_DATA_SIZE);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_INFO, "Failed to read eeprom (%r)\r\n", Status));
+        goto ErrorExit;
+      }
     }
 
-    FreePool (Request);
-    Request = NULL;
-
     if (0 == AsciiStrnCmp (
                (CHAR8 *)&RawData[CAMERA_EEPROM_PART_OFFSET],
                CAMERA_EEPROM_PART_NAME,
@@ -344,6 +537,14 @@ EepromDxeDriverBindingStart (
       goto ErrorExit;
     }
 
+    //
+    // Images without a checksum cannot be change detected, so only cache
+    // images that passed the CRC check.
+    //
+    if (!Cached && !SkipEepromCRC && (CacheName[0] != L'\0')) {
+      EepromCacheSave (CacheName, RawData);
+    }
+
     IdBoardInfo = (TEGRA_EEPROM_BOARD_INFO *)AllocateZeroPool (sizeof (TEGRA_EEPROM_BOARD_INFO));
     if (IdBoardInfo == NULL) {
       Status = EFI_OUT_OF_RESOURCES;
@@ -428,10 +629,6 @@ ErrorExit:
       FreePool (RawData);
     }
 
-    if (Request != NULL) {
-      FreePool (Request);
-    }
-
     if (I2cIo != NULL) {
       gBS->CloseProtocol (
              Controller,
@@ -0,0 +1,522 @@
+/** @file
+  Host based throughput benchmarks of FvbNorFlashDxe and of the NOR flash
+  protocol it sits on, run against a virtual NOR flash device with the
+  latencies of a typical quad SPI NOR device.
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#include <HostBasedTestStubLib/HostBenchmarkLib.h>
+#include <HostBasedTestStubLib/NorFlashStubLib.h>
+
+// So that we can reference FvbPrivate declarations
+#include "../FvbPrivate.h"
+
+#define UNIT_TEST_APP_NAME     "FvbNorFlash Benchmark Application"
+#define UNIT_TEST_APP_VERSION  "0.1"
+
+#define BLOCK_SIZE            SIZE_64KB
+#define NUM_BLOCKS            16
+#define TOTAL_NOR_FLASH_SIZE  (NUM_BLOCKS * BLOCK_SIZE)
+#define PARTITION_OFFSET      (2 * BLOCK_SIZE)
+#define PARTITION_BLOCKS      8
+#define PARTITION_SIZE        (PARTITION_BLOCKS * BLOCK_SIZE)
+#define ACCESS_ITERATIONS     4096
+#define ERASE_ITERATIONS      256
+
+typedef struct {
+  CONST CHAR8    *Name;
+  UINT32         Size;      // Bytes per read or write
+  BOOLEAN        Shadowed;  // FVB keeps an in-memory copy of the partition
+} BENCHMARK_CONTEXT;
+
+EFI_STATUS
+EFIAPI
+FvbRead (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL  *This,
+  IN        EFI_LBA                              Lba,
+  IN        UINTN                                Offset,
+  IN OUT    UINTN                                *NumBytes,
+  IN OUT    UINT8                                *Buffer
+  );
+
+EFI_STATUS
+EFIAPI
+FvbWrite (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL  *This,
+  IN        EFI_LBA                              Lba,
+  IN        UINTN                                Offset,
+  IN OUT    UINTN                                *NumBytes,
+  IN        UINT8                                *Buffer
+  );
+
+EFI_STATUS
+EFIAPI
+FvbEraseBlocks (
+  IN CONST EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL  *This,
+  ...
+  );
+
+STATIC UINT8                      *mFlashMemory;
+STATIC NVIDIA_NOR_FLASH_PROTOCOL  *mNorFlash;
+STATIC NVIDIA_FVB_PRIVATE_DATA    *mFvbPrivate;
+STATIC UINT8                      *mShadow;
+STATIC UINT8                      *mBuffer;
+
+STATIC BENCHMARK_CONTEXT  mNorRead64     = { "NorFlash read 64B", 64, FALSE };
+STATIC BENCHMARK_CONTEXT  mNorRead4K     = { "NorFlash read 4KB", SIZE_4KB, FALSE };
+STATIC BENCHMARK_CONTEXT  mNorWrite64    = { "NorFlash write 64B", 64, FALSE };
+STATIC BENCHMARK_CONTEXT  mNorWrite256   = { "NorFlash write 256B", 256, FALSE };
+STATIC BENCHMARK_CONTEXT  mNorErase      = { "NorFlash erase 64KB", BLOCK_SIZE, FALSE };
+STATIC BENCHMARK_CONTEXT  mFvbRead64     = { "Fvb read 64B", 64, FALSE };
+STATIC BENCHMARK_CONTEXT  mFvbRead64Shd  = { "Fvb read 64B shadowed", 64, TRUE };
+STATIC BENCHMARK_CONTEXT  mFvbRead4K     = { "Fvb read 4KB", SIZE_4KB, FALSE };
+STATIC BENCHMARK_CONTEXT  mFvbRead4KShd  = { "Fvb read 4KB shadowed", SIZE_4KB, TRUE };
+STATIC BENCHMARK_CONTEXT  mFvbWrite64    = { "Fvb write 64B", 64, FALSE };
+STATIC BENCHMARK_CONTEXT  mFvbWrite64Shd = { "Fvb write 64B shadowed", 64, TRUE };
+STATIC BENCHMARK_CONTEXT  mFvbErase      = { "Fvb erase 64KB", BLOCK_SIZE, FALSE };
+STATIC BENCHMARK_CONTEXT  mFvbEraseShd   = { "Fvb erase 64KB shadowed", BLOCK_SIZE, TRUE };
+
+/**
+  Erase the flash and point the FVB at the benchmark partition, with or
+  without an in-memory copy of the partition.
+
+  @param Context                      Benchmark to prepare for
+
+  @retval UNIT_TEST_PASSED            Setup succeeded.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BenchmarkSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  EFI_STATUS         Status;
+
+  Bench = (BENCHMARK_CONTEXT *)Context;
+
+  Status = mNorFlash->Erase (mNorFlash, 0, NUM_BLOCKS);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  if (Bench->Shadowed) {
+    SetMem (mShadow, PARTITION_SIZE, FVB_ERASED_BYTE);
+    mFvbPrivate->PartitionData = mShadow;
+  } else {
+    mFvbPrivate->PartitionData = NULL;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Read through the whole NOR flash device.
+
+  @param Context                      Benchmark to run
+
+  @retval UNIT_TEST_PASSED            All assertions passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+NorFlashReadBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  HOST_BENCHMARK     Benchmark;
+  EFI_STATUS         Status;
+  UINT32             Offset;
+  UINTN              Index;
+
+  Bench  = (BENCHMARK_CONTEXT *)Context;
+  Offset = 0;
+
+  HostBenchmarkStart (&Benchmark, Bench->Name, mNorFlash);
+  for (Index = 0; Index < ACCESS_ITERATIONS; Index++) {
+    Status = mNorFlash->Read (mNorFlash, Offset, Bench->Size, mBuffer);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    Offset = (Offset + Bench->Size) % TOTAL_NOR_FLASH_SIZE;
+  }
+
+  HostBenchmarkStop (&Benchmark, ACCESS_ITERATIONS);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Program the erased NOR flash device sequentially.
+
+  @param Context                      Benchmark to run
+
+  @retval UNIT_TEST_PASSED            All assertions passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+NorFlashWriteBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  HOST_BENCHMARK     Benchmark;
+  EFI_STATUS         Status;
+  UINT32             Offset;
+  UINTN              Index;
+
+  Bench  = (BENCHMARK_CONTEXT *)Context;
+  Offset = 0;
+  SetMem (mBuffer, Bench->Size, 0x5A);
+
+  HostBenchmarkStart (&Benchmark, Bench->Name, mNorFlash);
+  for (Index = 0; Index < ACCESS_ITERATIONS; Index++) {
+    Status = mNorFlash->Write (mNorFlash, Offset, Bench->Size, mBuffer);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    Offset = (Offset + Bench->Size) % TOTAL_NOR_FLASH_SIZE;
+  }
+
+  HostBenchmarkStop (&Benchmark, ACCESS_ITERATIONS);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Erase the blocks of the NOR flash device one at a time.
+
+  @param Context                      Benchmark to run
+
+  @retval UNIT_TEST_PASSED            All assertions passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+NorFlashEraseBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  HOST_BENCHMARK     Benchmark;
+  EFI_STATUS         Status;
+  UINTN              Index;
+
+  Bench = (BENCHMARK_CONTEXT *)Context;
+
+  HostBenchmarkStart (&Benchmark, Bench->Name, mNorFlash);
+  for (Index = 0; Index < ERASE_ITERATIONS; Index++) {
+    Status = mNorFlash->Erase (mNorFlash, Index % NUM_BLOCKS, 1);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  HostBenchmarkStop (&Benchmark, ERASE_ITERATIONS);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Read through the whole FVB partition.
+
+  @param Context                      Benchmark to run
+
+  @retval UNIT_TEST_PASSED            All assertions passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+FvbReadBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  HOST_BENCHMARK     Benchmark;
+  EFI_STATUS         Status;
+  UINTN              NumBytes;
+  UINT32             Offset;
+  UINTN              Index;
+
+  Bench  = (BENCHMARK_CONTEXT *)Context;
+  Offset = 0;
+
+  HostBenchmarkStart (&Benchmark, Bench->Name, mNorFlash);
+  for (Index = 0; Index < ACCESS_ITERATIONS; Index++) {
+    NumBytes = Bench->Size;
+    Status   = FvbRead (&mFvbPrivate->FvbProtocol, Offset / BLOCK_SIZE, Offset % BLOCK_SIZE, &NumBytes, mBuffer);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    UT_ASSERT_EQUAL (NumBytes, Bench->Size);
+    Offset = (Offset + Bench->Size) % PARTITION_SIZE;
+  }
+
+  HostBenchmarkStop (&Benchmark, ACCESS_ITERATIONS);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Write the erased FVB partition sequentially, the way variable updates
+  are appended to the variable store.
+
+  @param Context                      Benchmark to run
+
+  @retval UNIT_TEST_PASSED            All assertions passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+FvbWriteBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  HOST_BENCHMARK     Benchmark;
+  EFI_STATUS         Status;
+  UINTN              NumBytes;
+  UINT32             Offset;
+  UINTN              Index;
+
+  Bench  = (BENCHMARK_CONTEXT *)Context;
+  Offset = 0;
+  SetMem (mBuffer, Bench->Size, 0x5A);
+
+  HostBenchmarkStart (&Benchmark, Bench->Name, mNorFlash);
+  for (Index = 0; Index < ACCESS_ITERATIONS; Index++) {
+    NumBytes = Bench->Size;
+    Status   = FvbWrite (&mFvbPrivate->FvbProtocol, Offset / BLOCK_SIZE, Offset % BLOCK_SIZE, &NumBytes, mBuffer);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    UT_ASSERT_EQUAL (NumBytes, Bench->Size);
+    Offset = (Offset + Bench->Size) % PARTITION_SIZE;
+  }
+
+  HostBenchmarkStop (&Benchmark, ACCESS_ITERATIONS);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Erase the blocks of the FVB partition one at a time.
+
+  @param Context                      Benchmark to run
+
+  @retval UNIT_TEST_PASSED            All assertions passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+FvbEraseBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  HOST_BENCHMARK     Benchmark;
+  EFI_STATUS         Status;
+  UINTN              Index;
+
+  Bench = (BENCHMARK_CONTEXT *)Context;
+
+  HostBenchmarkStart (&Benchmark, Bench->Name, mNorFlash);
+  for (Index = 0; Index < ERASE_ITERATIONS; Index++) {
+    Status = FvbEraseBlocks (
+               &mFvbPrivate->FvbProtocol,
+               (EFI_LBA)(Index % PARTITION_BLOCKS),
+               (UINTN)1,
+               EFI_LBA_LIST_TERMINATOR
+               );
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  HostBenchmarkStop (&Benchmark, ERASE_ITERATIONS);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Creates the virtual NOR flash device and the FVB instance on top of it.
+
+  @retval EFI_SUCCESS           The benchmark data was set up.
+  @retval EFI_OUT_OF_RESOURCES  The benchmark data couldn't be allocated.
+**/
+STATIC
+EFI_STATUS
+InitBenchmarkData (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = HostBenchmarkCreateNorFlash (TOTAL_NOR_FLASH_SIZE, BLOCK_SIZE, &mFlashMemory, &mNorFlash);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  mFvbPrivate = AllocateZeroPool (sizeof (NVIDIA_FVB_PRIVATE_DATA));
+  mShadow     = AllocatePool (PARTITION_SIZE);
+  mBuffer     = AllocatePool (BLOCK_SIZE);
+  if ((mFvbPrivate == NULL) || (mShadow == NULL) || (mBuffer == NULL)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  mFvbPrivate->Signature        = NVIDIA_FVB_SIGNATURE;
+  mFvbPrivate->NorFlashProtocol = mNorFlash;
+  mFvbPrivate->PartitionOffset  = PARTITION_OFFSET;
+  mFvbPrivate->PartitionSize    = PARTITION_SIZE;
+
+  return mNorFlash->GetAttributes (mNorFlash, &mFvbPrivate->FlashAttributes);
+}
+
+/**
+  Frees the virtual NOR flash device and the FVB instance.
+**/
+STATIC
+VOID
+CleanUpBenchmarkData (
+  VOID
+  )
+{
+  HostBenchmarkDestroyNorFlash (mFlashMemory, mNorFlash);
+
+  if (mFvbPrivate != NULL) {
+    FreePool (mFvbPrivate);
+  }
+
+  if (mShadow != NULL) {
+    FreePool (mShadow);
+  }
+
+  if (mBuffer != NULL) {
+    FreePool (mBuffer);
+  }
+}
+
+/**
+  Initialze the unit test framework and suites for the benchmarks and run
+  them.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Fw;
+  UNIT_TEST_SUITE_HANDLE      NorFlashSuite;
+  UNIT_TEST_SUITE_HANDLE      FvbSuite;
+
+  Fw = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  Status = InitBenchmarkData ();
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to setup Benchmark Data %r\n", Status));
+    goto ExitUnitTestingEntry;
+  }
+
+  Status = InitUnitTestFramework (
+             &Fw,
+             UNIT_TEST_APP_NAME,
+             gEfiCallerBaseName,
+             UNIT_TEST_APP_VERSION
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto ExitUnitTestingEntry;
+  }
+
+  Status = CreateUnitTestSuite (
+             &NorFlashSuite,
+             Fw,
+             "NorFlash Benchmarks",
+             "FvbNorFlash.NorFlashBenchmarkSuite",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for NorFlash\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto ExitUnitTestingEntry;
+  }
+
+  Status = CreateUnitTestSuite (
+             &FvbSuite,
+             Fw,
+             "Fvb Benchmarks",
+             "FvbNorFlash.FvbBenchmarkSuite",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Fvb\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto ExitUnitTestingEntry;
+  }
+
+  // AddTestCase Args:
+  //  Suite | Description
+  //  Class Name | Function
+  //  Pre | Post | Context
+
+  AddTestCase (NorFlashSuite, "NorFlash 64B reads", "NorRead64", NorFlashReadBenchmark, BenchmarkSetup, NULL, &mNorRead64);
+  AddTestCase (NorFlashSuite, "NorFlash 4KB reads", "NorRead4K", NorFlashReadBenchmark, BenchmarkSetup, NULL, &mNorRead4K);
+  AddTestCase (NorFlashSuite, "NorFlash 64B writes", "NorWrite64", NorFlashWriteBenchmark, BenchmarkSetup, NULL, &mNorWrite64);
+  AddTestCase (NorFlashSuite, "NorFlash 256B writes", "NorWrite256", NorFlashWriteBenchmark, BenchmarkSetup, NULL, &mNorWrite256);
+  AddTestCase (NorFlashSuite, "NorFlash block erases", "NorErase", NorFlashEraseBenchmark, BenchmarkSetup, NULL, &mNorErase);
+
+  AddTestCase (FvbSuite, "Fvb 64B reads", "FvbRead64", FvbReadBenchmark, BenchmarkSetup, NULL, &mFvbRead64);
+  AddTestCase (FvbSuite, "Fvb 64B shadowed reads", "FvbRead64Shadowed", FvbReadBenchmark, BenchmarkSetup, NULL, &mFvbRead64Shd);
+  AddTestCase (FvbSuite, "Fvb 4KB reads", "FvbRead4K", FvbReadBenchmark, BenchmarkSetup, NULL, &mFvbRead4K);
+  AddTestCase (FvbSuite, "Fvb 4KB shadowed reads", "FvbRead4KShadowed", FvbReadBenchmark, BenchmarkSetup, NULL, &mFvbRead4KShd);
+  AddTestCase (FvbSuite, "Fvb 64B writes", "FvbWrite64", FvbWriteBenchmark, BenchmarkSetup, NULL, &mFvbWrite64);
+  AddTestCase (FvbSuite, "Fvb 64B shadowed writes", "FvbWrite64Shadowed", FvbWriteBenchmark, BenchmarkSetup, NULL, &mFvbWrite64Shd);
+  AddTestCase (FvbSuite, "Fvb block erases", "FvbErase", FvbEraseBenchmark, BenchmarkSetup, NULL, &mFvbErase);
+  AddTestCase (FvbSuite, "Fvb shadowed block erases", "FvbEraseShadowed", FvbEraseBenchmark, BenchmarkSetup, NULL, &mFvbEraseShd);
+
+  Status = RunAllTestSuites (Fw);
+
+ExitUnitTestingEntry:
+  if (Fw) {
+    FreeUnitTestFramework (Fw);
+  }
+
+  CleanUpBenchmarkData ();
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UnitTestingEntry ();
+}
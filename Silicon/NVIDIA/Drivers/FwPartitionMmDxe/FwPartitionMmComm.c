@@ -23,7 +23,7 @@ MmInitCommBuffer (
   FW_PARTITION_COMM_HEADER   *FwImageCommHeader;
 
   if (DataSize + OFFSET_OF (EFI_MM_COMMUNICATE_HEADER, Data) +
-      FW_PARTITION_COMM_HEADER_SIZE > FW_PARTITION_COMM_BUFFER_SIZE)
+      FW_PARTITION_COMM_HEADER_SIZE > mMmCommBufferSize)
   {
     return EFI_INVALID_PARAMETER;
   }
@@ -2,7 +2,7 @@
 
   MM FW partition protocol communication
 
-  SPDX-FileCopyrightText: Copyright (c) 2022-2024, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2022-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
   Copyright (c) 2010 - 2019, Intel Corporation. All rights reserved.<BR>
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
@@ -12,8 +12,9 @@
 #ifndef __FW_PARTITION_MM_COMM_H__
 #define __FW_PARTITION_MM_COMM_H__
 
-#define FW_PARTITION_COMM_BUFFER_SIZE  (65 * 1024)
-#define FW_PARTITION_COMM_HEADER_SIZE  (OFFSET_OF (FW_PARTITION_COMM_HEADER, Data))
+#define FW_PARTITION_COMM_BUFFER_SIZE      (65 * 1024)
+#define FW_PARTITION_COMM_BUFFER_MAX_SIZE  SIZE_1MB
+#define FW_PARTITION_COMM_HEADER_SIZE      (OFFSET_OF (FW_PARTITION_COMM_HEADER, Data))
 
 //
 // FW partition protocol MM communications function codes
@@ -72,6 +73,11 @@ typedef struct {
   UINT8     Data[1];
 } FW_PARTITION_COMM_WRITE_DATA;
 
+// comm buffer bytes preceding the data of a READ_DATA or WRITE_DATA request
+#define FW_PARTITION_COMM_DATA_OFFSET  (OFFSET_OF (EFI_MM_COMMUNICATE_HEADER, Data) + \
+                                        FW_PARTITION_COMM_HEADER_SIZE +                \
+                                        OFFSET_OF (FW_PARTITION_COMM_READ_DATA, Data))
+
 EFI_STATUS
 EFIAPI
 MmInitCommBuffer (
@@ -125,6 +131,7 @@ MmSendWriteData (
 extern EFI_MM_COMMUNICATION2_PROTOCOL  *mMmCommProtocol;
 extern EFI_MM_COMMUNICATION2_PROTOCOL  *mMmPrmCommProtocol;
 extern VOID                            *mMmCommBuffer;
+extern UINTN                           mMmCommBufferSize;
 extern VOID                            *mMmCommBufferPhysical;
 
 #endif
@@ -16,6 +16,7 @@
 #include <Library/PcdLib.h>
 #include <Library/PlatformResourceLib.h>
 #include <Library/TegraPlatformInfoLib.h>
+#include <Library/TimerLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiLib.h>
 #include <Library/UefiRuntimeLib.h>
@@ -36,14 +37,79 @@ typedef struct {
   FW_PARTITION_DEVICE_INFO    DeviceInfo;
 } FW_PARTITION_MM_INFO;
 
-STATIC FW_PARTITION_MM_INFO  *mMmInfo            = NULL;
-STATIC UINTN                 mNumPartitions      = 0;
-STATIC EFI_EVENT             mAddressChangeEvent = NULL;
+// MM data transfer statistics
+typedef struct {
+  UINT64    Entries;
+  UINT64    Bytes;
+  UINT64    Ns;
+} FW_PARTITION_MM_STATS;
+
+STATIC FW_PARTITION_MM_INFO   *mMmInfo            = NULL;
+STATIC UINTN                  mNumPartitions      = 0;
+STATIC EFI_EVENT              mAddressChangeEvent = NULL;
+STATIC UINTN                  mMmTransferSize     = FW_PARTITION_MM_TRANSFER_SIZE;
+STATIC FW_PARTITION_MM_STATS  mMmStats;
 
 EFI_MM_COMMUNICATION2_PROTOCOL  *mMmCommProtocol       = NULL;
 EFI_MM_COMMUNICATION2_PROTOCOL  *mMmPrmCommProtocol    = NULL;
 VOID                            *mMmCommBuffer         = NULL;
 VOID                            *mMmCommBufferPhysical = NULL;
+UINTN                           mMmCommBufferSize      = FW_PARTITION_COMM_BUFFER_SIZE;
+
+/**
+  Account for a data transfer and report throughput and MM entry count for
+  transfers that took more than one MM entry.
+
+  @param[in]  Operation         Operation name
+  @param[in]  PartitionName     Partition name
+  @param[in]  Bytes             Bytes transferred
+  @param[in]  Entries           Number of MM entries used
+  @param[in]  StartTicks        Performance counter at start of transfer
+
+  @retval None
+
+**/
+STATIC
+VOID
+EFIAPI
+FPMmTransferDone (
+  IN  CONST CHAR8   *Operation,
+  IN  CONST CHAR16  *PartitionName,
+  IN  UINTN         Bytes,
+  IN  UINTN         Entries,
+  IN  UINT64        StartTicks
+  )
+{
+  UINT64  Ns;
+  UINT64  KBPerSec;
+
+  Ns                = GetTimeInNanoSecond (GetPerformanceCounter () - StartTicks);
+  mMmStats.Entries += Entries;
+  mMmStats.Bytes   += Bytes;
+  mMmStats.Ns      += Ns;
+
+  if ((Entries < 2) || EfiAtRuntime ()) {
+    return;
+  }
+
+  KBPerSec = 0;
+  if (Ns != 0) {
+    KBPerSec = DivU64x64Remainder (MultU64x32 (Bytes, 1000000000 / SIZE_1KB), Ns, NULL);
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: %a %s Bytes=%u Entries=%u %lluKB/s, total Bytes=%llu Entries=%llu\n",
+    __FUNCTION__,
+    Operation,
+    PartitionName,
+    Bytes,
+    Entries,
+    KBPerSec,
+    mMmStats.Bytes,
+    mMmStats.Entries
+    ));
+}
 
 STATIC
 EFI_STATUS
@@ -99,10 +165,20 @@ FPMmRead (
 {
   EFI_STATUS  Status;
   UINTN       ReadBytes;
+  UINTN       TransferSize;
+  UINTN       TotalBytes;
+  UINTN       Entries;
+  UINT64      StartTicks;
+
+  // PRM buffer size is not published, keep to the size it is known to hold
+  TransferSize = (IsMmPrm) ? FW_PARTITION_MM_TRANSFER_SIZE : mMmTransferSize;
+  TotalBytes   = Bytes;
+  Entries      = 0;
+  StartTicks   = GetPerformanceCounter ();
 
   Status = EFI_SUCCESS;
   while (Bytes > 0) {
-    ReadBytes = MIN (FW_PARTITION_MM_TRANSFER_SIZE, Bytes);
+    ReadBytes = MIN (TransferSize, Bytes);
 
     Status = MmSendReadData (PartitionName, Offset, ReadBytes, Buffer, IsMmPrm);
     DEBUG ((
@@ -113,6 +189,7 @@ FPMmRead (
       Offset,
       ReadBytes
       ));
+    Entries++;
     if (EFI_ERROR (Status)) {
       break;
     }
@@ -122,6 +199,8 @@ FPMmRead (
     Buffer  = ((UINT8 *)Buffer + ReadBytes);
   }
 
+  FPMmTransferDone ("read", PartitionName, TotalBytes - Bytes, Entries, StartTicks);
+
   return Status;
 }
 
@@ -180,6 +259,10 @@ FPMmWrite (
 {
   FW_PARTITION_MM_INFO  *MmInfo;
   EFI_STATUS            Status;
+  UINTN                 WriteBytes;
+  UINTN                 TotalBytes;
+  UINTN                 Entries;
+  UINT64                StartTicks;
 
   MmInfo = CR (
              DeviceInfo,
@@ -188,20 +271,45 @@ FPMmWrite (
              FW_PARTITION_MM_INFO_SIGNATURE
              );
 
-  Status = MmSendWriteData (PartitionName, Offset, Bytes, Buffer);
-  DEBUG ((
-    DEBUG_VERBOSE,
-    "%a: write %s Offset=%lu, Bytes=%u\n",
-    __FUNCTION__,
-    PartitionName,
-    Offset,
-    Bytes
-    ));
+  // pseudo partition write is a single command to MM and can't be split
+  if (MmInfo->IsPseudoPartition) {
+    Status = MmSendWriteData (PartitionName, Offset, Bytes, Buffer);
+    if (!EFI_ERROR (Status)) {
+      Status = FPMmInstallProtocols ();
+    }
 
-  if (!EFI_ERROR (Status) && MmInfo->IsPseudoPartition) {
-    Status = FPMmInstallProtocols ();
+    return Status;
   }
 
+  TotalBytes = Bytes;
+  Entries    = 0;
+  StartTicks = GetPerformanceCounter ();
+
+  Status = EFI_SUCCESS;
+  while (Bytes > 0) {
+    WriteBytes = MIN (mMmTransferSize, Bytes);
+
+    Status = MmSendWriteData (PartitionName, Offset, WriteBytes, Buffer);
+    DEBUG ((
+      DEBUG_VERBOSE,
+      "%a: write %s Offset=%lu, Bytes=%u\n",
+      __FUNCTION__,
+      PartitionName,
+      Offset,
+      WriteBytes
+      ));
+    Entries++;
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    Bytes  -= WriteBytes;
+    Offset += WriteBytes;
+    Buffer  = ((CONST UINT8 *)Buffer + WriteBytes);
+  }
+
+  FPMmTransferDone ("write", PartitionName, TotalBytes - Bytes, Entries, StartTicks);
+
   return Status;
 }
 
@@ -372,6 +480,7 @@ FwPartitionMmDxeInitialize (
   BOOLEAN                     PcdOverwriteActiveFwPartition;
   UINTN                       ChipId;
   FW_PARTITION_MM_INFO        *MmInfo;
+  UINT64                      MmBufferSize;
 
   ChipId                        = TegraGetChipID ();
   PcdOverwriteActiveFwPartition = PcdGetBool (PcdOverwriteActiveFwPartition);
@@ -421,7 +530,29 @@ FwPartitionMmDxeInitialize (
     mMmPrmCommProtocol = NULL;
   }
 
-  mMmCommBuffer = AllocateRuntimePool (FW_PARTITION_COMM_BUFFER_SIZE);
+  //
+  // Size the comm buffer to the MM shared buffer so each READ_DATA/WRITE_DATA
+  // carries as much data as the shared buffer holds, keeping the number of
+  // MM entries for large transfers low.  MM NOR writes only erase when the
+  // offset is erase block aligned, so each chunk must be a multiple of the
+  // erase block; 64KB covers the common sizes until the actual one is known.
+  //
+  MmBufferSize = MIN (PcdGet64 (PcdMmBufferSize), FW_PARTITION_COMM_BUFFER_MAX_SIZE);
+  if (MmBufferSize >= FW_PARTITION_COMM_DATA_OFFSET + SIZE_64KB) {
+    mMmTransferSize = (UINTN)(MmBufferSize - FW_PARTITION_COMM_DATA_OFFSET) & ~(SIZE_64KB - 1);
+  }
+
+  mMmCommBufferSize = MAX (FW_PARTITION_COMM_BUFFER_SIZE, (UINTN)MmBufferSize);
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: MmBufferSize=%llu CommBufferSize=%u TransferSize=%u\n",
+    __FUNCTION__,
+    PcdGet64 (PcdMmBufferSize),
+    mMmCommBufferSize,
+    mMmTransferSize
+    ));
+
+  mMmCommBuffer = AllocateRuntimePool (mMmCommBufferSize);
   if (mMmCommBuffer == NULL) {
     DEBUG ((DEBUG_ERROR, "mMmCommBuffer allocation failed\n"));
     Status = EFI_OUT_OF_RESOURCES;
@@ -488,6 +619,20 @@ FwPartitionMmDxeInitialize (
     goto Done;
   }
 
+  // keep write chunks aligned to the erase block reported by MM
+  if ((BrBctEraseBlockSize != 0) &&
+      (mMmTransferSize > FW_PARTITION_MM_TRANSFER_SIZE) &&
+      ((mMmTransferSize % BrBctEraseBlockSize) != 0))
+  {
+    if (mMmTransferSize > BrBctEraseBlockSize) {
+      mMmTransferSize -= mMmTransferSize % BrBctEraseBlockSize;
+    } else {
+      mMmTransferSize = FW_PARTITION_MM_TRANSFER_SIZE;
+    }
+
+    DEBUG ((DEBUG_INFO, "%a: EraseBlockSize=%u TransferSize=%u\n", __FUNCTION__, BrBctEraseBlockSize, mMmTransferSize));
+  }
+
   // install FwPartition protocols for all partitions
   Status = FPMmInstallProtocols ();
   if (EFI_ERROR (Status)) {
@@ -35,9 +35,29 @@
 #define BMC_SMBALERT_TIMEOUT    5000000
 #define BMC_SMBALERT_POLL_TIME  100
 
+//
+// Response polling backs off exponentially from the expected BMC latency,
+// learned from previous commands, up to BMC_RETRY_DELAY per poll.
+//
+#define BMC_RESPONSE_DELAY_MIN       100
+#define BMC_RESPONSE_TIMEOUT_NS      (1000ULL * BMC_RETRY_COUNT * BMC_RETRY_DELAY)
+#define BMC_RESPONSE_LATENCY_WEIGHT  3  // Estimate moves 1/8 towards each new sample
+
+#define MAX_SSIF_COMMAND_STATS  32
+
 #define MAX_SSIF_TRANSACTION_TIME_ENTRIES  4
 #define MAX_SSIF_AVG_TRANSACTION_TIME_NS   3000000000ULL
 
+// Latency statistics of one IPMI command
+typedef struct {
+  UINT8     NetFunction;
+  UINT8     Command;
+  UINT32    Count;
+  UINT32    Retries;
+  UINT64    TotalTimeNs;
+  UINT64    MaxTimeNs;
+} BMC_SSIF_COMMAND_STATS;
+
 // Private data structure
 typedef struct {
   UINT64                     Signature;
@@ -58,6 +78,11 @@ typedef struct {
 
   UINT64                     LastTransactionTimes[MAX_SSIF_TRANSACTION_TIME_ENTRIES];
   UINT8                      TransactionTimeIndex;
+
+  UINT64                     ResponseLatencyScaled;  // Estimate in ns << BMC_RESPONSE_LATENCY_WEIGHT
+  EFI_EVENT                  ReadyToBootEvent;
+  UINTN                      CommandStatsCount;
+  BMC_SSIF_COMMAND_STATS     CommandStats[MAX_SSIF_COMMAND_STATS];
 } BMC_SSIF_PRIVATE_DATA;
 
 #define BMC_SSIF_PRIVATE_DATA_FROM_IPMI(a)  CR (a, BMC_SSIF_PRIVATE_DATA, IpmiTransport, BMC_SSIF_SIGNATURE)
@@ -91,6 +116,158 @@ typedef struct {
   EFI_I2C_OPERATION    Operation[2];
 } SSIF_REQUEST_PACKET;
 
+/**
+  Returns the response latency estimate, rounded to the nearest nanosecond.
+
+  @param[in]  BmcSsifPrivate    Private data
+
+  @retval Response latency in nanoseconds
+**/
+STATIC
+UINT64
+I2cIoBmcSsifResponseLatency (
+  IN BMC_SSIF_PRIVATE_DATA  *BmcSsifPrivate
+  )
+{
+  return RShiftU64 (
+           BmcSsifPrivate->ResponseLatencyScaled + LShiftU64 (1, BMC_RESPONSE_LATENCY_WEIGHT - 1),
+           BMC_RESPONSE_LATENCY_WEIGHT
+           );
+}
+
+/**
+  Returns the delay before the first response read, based on the response
+  latency seen for previous commands.
+
+  @param[in]  BmcSsifPrivate    Private data
+
+  @retval Delay in microseconds
+**/
+STATIC
+UINTN
+I2cIoBmcSsifResponseDelay (
+  IN BMC_SSIF_PRIVATE_DATA  *BmcSsifPrivate
+  )
+{
+  UINT64  Delay;
+
+  //
+  // Poll early rather than late, the backoff covers slower responses.
+  //
+  Delay = I2cIoBmcSsifResponseLatency (BmcSsifPrivate) / 2000;
+  Delay = MAX (Delay, BMC_RESPONSE_DELAY_MIN);
+  Delay = MIN (Delay, BMC_RETRY_DELAY);
+
+  return (UINTN)Delay;
+}
+
+/**
+  Updates the response latency estimate with a new sample. The estimate is
+  kept scaled by 2^BMC_RESPONSE_LATENCY_WEIGHT so that the fractional part
+  is not truncated away on every update.
+
+  @param[in]  BmcSsifPrivate    Private data
+  @param[in]  LatencyNs         Time from the end of the request to the response
+**/
+STATIC
+VOID
+I2cIoBmcSsifUpdateResponseLatency (
+  IN BMC_SSIF_PRIVATE_DATA  *BmcSsifPrivate,
+  IN UINT64                 LatencyNs
+  )
+{
+  if (BmcSsifPrivate->ResponseLatencyScaled == 0) {
+    BmcSsifPrivate->ResponseLatencyScaled = LShiftU64 (LatencyNs, BMC_RESPONSE_LATENCY_WEIGHT);
+  } else {
+    BmcSsifPrivate->ResponseLatencyScaled -= I2cIoBmcSsifResponseLatency (BmcSsifPrivate);
+    BmcSsifPrivate->ResponseLatencyScaled += LatencyNs;
+  }
+}
+
+/**
+  Records the latency of a completed command.
+
+  @param[in]  BmcSsifPrivate    Private data
+  @param[in]  NetFunction       Net function of the command
+  @param[in]  Command           IPMI command
+  @param[in]  TimeNs            Time spent in the command
+  @param[in]  Retries           Number of response polls that were NAKed
+**/
+STATIC
+VOID
+I2cIoBmcSsifRecordCommand (
+  IN BMC_SSIF_PRIVATE_DATA  *BmcSsifPrivate,
+  IN UINT8                  NetFunction,
+  IN UINT8                  Command,
+  IN UINT64                 TimeNs,
+  IN UINT32                 Retries
+  )
+{
+  UINTN                   Index;
+  BMC_SSIF_COMMAND_STATS  *Stats;
+
+  for (Index = 0; Index < BmcSsifPrivate->CommandStatsCount; Index++) {
+    Stats = &BmcSsifPrivate->CommandStats[Index];
+    if ((Stats->NetFunction == NetFunction) && (Stats->Command == Command)) {
+      break;
+    }
+  }
+
+  if (Index == BmcSsifPrivate->CommandStatsCount) {
+    if (Index == MAX_SSIF_COMMAND_STATS) {
+      return;
+    }
+
+    BmcSsifPrivate->CommandStatsCount++;
+    Stats              = &BmcSsifPrivate->CommandStats[Index];
+    Stats->NetFunction = NetFunction;
+    Stats->Command     = Command;
+  }
+
+  Stats->Count++;
+  Stats->Retries     += Retries;
+  Stats->TotalTimeNs += TimeNs;
+  Stats->MaxTimeNs    = MAX (Stats->MaxTimeNs, TimeNs);
+}
+
+/**
+  Prints the command latency statistics at ready to boot.
+
+  @param[in]  Event                Event that caused this notification.
+  @param[in]  Context              Context pointer for this notification
+**/
+STATIC
+VOID
+EFIAPI
+I2cIoBmcSsifReadyToBoot (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  BMC_SSIF_PRIVATE_DATA   *BmcSsifPrivate;
+  BMC_SSIF_COMMAND_STATS  *Stats;
+  UINTN                   Index;
+
+  gBS->CloseEvent (Event);
+
+  BmcSsifPrivate = (BMC_SSIF_PRIVATE_DATA *)Context;
+  DEBUG ((DEBUG_INFO, "%a: response latency estimate %luus\r\n", __FUNCTION__, I2cIoBmcSsifResponseLatency (BmcSsifPrivate) / 1000));
+  for (Index = 0; Index < BmcSsifPrivate->CommandStatsCount; Index++) {
+    Stats = &BmcSsifPrivate->CommandStats[Index];
+    DEBUG ((
+      DEBUG_INFO,
+      "%a: NetFn 0x%02x Cmd 0x%02x: %u commands, %u retries, avg %luus, max %luus\r\n",
+      __FUNCTION__,
+      Stats->NetFunction,
+      Stats->Command,
+      Stats->Count,
+      Stats->Retries,
+      DivU64x32 (Stats->TotalTimeNs, Stats->Count) / 1000,
+      Stats->MaxTimeNs / 1000
+      ));
+  }
+}
+
 /**
   This service enables submitting commands via Ipmi.
 
@@ -131,18 +308,21 @@ I2cIoBmcSsifIpmiSubmitCommand (
   UINT32                 DataSize;
   UINT8                  ExpectedBlock;
   UINT32                 ResponseDataBufferSize;
-  UINT32                 RetryCount;
   UINT32                 OverallRetryCount;
   UINT64                 Timeout;
   UINTN                  GpioValue;
   UINT64                 StartTime, EndTime;
   UINT64                 TransactionTime;
   UINT64                 AvgTransactionTime;
+  UINT64                 RequestDoneTime;
+  UINTN                  ResponseDelay;
+  UINT32                 Retries;
 
   BmcSsifPrivate         = BMC_SSIF_PRIVATE_DATA_FROM_IPMI (This);
   ResponseDataBufferSize = *ResponseDataSize;
 
   TransactionTime = GetTimeInNanoSecond (GetPerformanceCounter ());
+  Retries         = 0;
 
   for (OverallRetryCount = 0; OverallRetryCount < BMC_RETRY_COUNT; OverallRetryCount++) {
     // Transmit data
@@ -218,6 +398,9 @@ I2cIoBmcSsifIpmiSubmitCommand (
     }
 
     if (ResponseData != NULL) {
+      RequestDoneTime = GetTimeInNanoSecond (GetPerformanceCounter ());
+      ResponseDelay   = I2cIoBmcSsifResponseDelay (BmcSsifPrivate);
+
       if (BmcSsifPrivate->SmbAlertSupported) {
         StartTime = GetTimeInNanoSecond (GetPerformanceCounter ());
         Timeout   = BMC_SMBALERT_TIMEOUT/BMC_SMBALERT_POLL_TIME;
@@ -244,10 +427,10 @@ I2cIoBmcSsifIpmiSubmitCommand (
           DEBUG ((DEBUG_INFO, "%a: SMBALERT gpio Time %dus\r\n", __FUNCTION__, (EndTime-StartTime)/1000));
         }
       } else {
-        gBS->Stall (BMC_RETRY_DELAY);
+        gBS->Stall (ResponseDelay);
       }
 
-      for (RetryCount = 0; RetryCount < BMC_RETRY_COUNT; RetryCount++) {
+      while (TRUE) {
         // Get response data
         WriteData[0] = BMC_SSIF_SINGLE_PART_READ_CMD;
 
@@ -261,19 +444,28 @@ I2cIoBmcSsifIpmiSubmitCommand (
 
         Status = BmcSsifPrivate->I2cMaster->StartRequest (BmcSsifPrivate->I2cMaster, BmcSsifPrivate->SlaveAddress, (EFI_I2C_REQUEST_PACKET *)&Packet, NULL, NULL);
         if (EFI_ERROR (Status)) {
-          BmcSsifPrivate->SoftErrorCount++;
-          BmcSsifPrivate->BmcStatus = BMC_SOFTFAIL;
-          DEBUG ((DEBUG_ERROR, "%a: Failed to send read command - %r\r\n", __FUNCTION__, Status));
+          //
+          // The BMC NAKs the read until the response is ready, so back off
+          // and poll again until the response timeout.
+          //
           if ((Status == EFI_NO_RESPONSE) &&
-              !BmcSsifPrivate->SmbAlertSupported)
+              !BmcSsifPrivate->SmbAlertSupported &&
+              ((GetTimeInNanoSecond (GetPerformanceCounter ()) - RequestDoneTime) < BMC_RESPONSE_TIMEOUT_NS))
           {
-            gBS->Stall (BMC_RETRY_DELAY);
+            Retries++;
+            ResponseDelay = MIN (ResponseDelay * 2, BMC_RETRY_DELAY);
+            gBS->Stall (ResponseDelay);
             continue;
-          } else {
-            break;
           }
+
+          BmcSsifPrivate->SoftErrorCount++;
+          BmcSsifPrivate->BmcStatus = BMC_SOFTFAIL;
+          DEBUG ((DEBUG_ERROR, "%a: Failed to send read command - %r\r\n", __FUNCTION__, Status));
+          break;
         }
 
+        I2cIoBmcSsifUpdateResponseLatency (BmcSsifPrivate, GetTimeInNanoSecond (GetPerformanceCounter ()) - RequestDoneTime);
+
         // Sanity check size
         if (ReadData[0] < SSIF_HEADER_SIZE) {
           BmcSsifPrivate->SoftErrorCount++;
@@ -400,6 +592,13 @@ I2cIoBmcSsifIpmiSubmitCommand (
 
   // Record the time spent in the last couple of transactions
   BmcSsifPrivate->LastTransactionTimes[BmcSsifPrivate->TransactionTimeIndex] = GetTimeInNanoSecond (GetPerformanceCounter ()) - TransactionTime;
+  I2cIoBmcSsifRecordCommand (
+    BmcSsifPrivate,
+    NetFunction,
+    Command,
+    BmcSsifPrivate->LastTransactionTimes[BmcSsifPrivate->TransactionTimeIndex],
+    Retries
+    );
 
   BmcSsifPrivate->TransactionTimeIndex = (BmcSsifPrivate->TransactionTimeIndex + 1) % MAX_SSIF_TRANSACTION_TIME_ENTRIES;
 
@@ -658,5 +857,14 @@ I2cIoBmcSsifDxeDriverEntryPoint (
     return EFI_OUT_OF_RESOURCES;
   }
 
+  DEBUG_CODE_BEGIN ();
+  EfiCreateEventReadyToBootEx (
+    TPL_CALLBACK,
+    I2cIoBmcSsifReadyToBoot,
+    BmcSsifPrivate,
+    &BmcSsifPrivate->ReadyToBootEvent
+    );
+  DEBUG_CODE_END ();
+
   return EFI_SUCCESS;
 }
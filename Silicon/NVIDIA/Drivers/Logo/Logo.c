@@ -15,6 +15,7 @@
 #include <Protocol/PlatformLogo.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/DebugLib.h>
 #include <Library/DxeServicesLib.h>
 #include <Library/MemoryAllocationLib.h>
@@ -28,6 +29,7 @@
 EFI_HII_IMAGE_EX_PROTOCOL  *mHiiImageEx;
 EFI_HII_HANDLE             mHiiHandle;
 EFI_IMAGE_INPUT            mLogoImage = { 0 };
+STATIC UINT32              mPackageListCrc;
 
 /**
   Calculates the absolute value of an INT64 number.
@@ -46,6 +48,262 @@ Abs (
   return (Value < 0) ? (UINT64)(-Value) : (UINT64)Value;
 }
 
+/**
+  Select the logo image that best fits the target size.
+
+  Only the image headers are read, the selected image is decoded by the caller.
+
+  @param[in]  TargetWidth       Target width of the logo.
+  @param[in]  TargetHeight      Target height of the logo.
+  @param[in]  LogoScreenRatio   Logo to screen ratio, 0 if the logo is not scaled.
+  @param[out] ImageId           Id of the selected image.
+
+  @retval EFI_SUCCESS      An image was selected.
+  @retval EFI_NOT_FOUND    No suitable image was found.
+  @retval Others           Failed to read an image header.
+**/
+STATIC
+EFI_STATUS
+LogoSelectImage (
+  IN  UINT64        TargetWidth,
+  IN  UINT64        TargetHeight,
+  IN  UINT64        LogoScreenRatio,
+  OUT EFI_IMAGE_ID  *ImageId
+  )
+{
+  EFI_STATUS        Status;
+  UINTN             CurrentLogo;
+  EFI_IMAGE_OUTPUT  CurrentImage;
+  EFI_IMAGE_OUTPUT  SelectedImage;
+  EFI_IMAGE_ID      SelectedImageId;
+
+  ZeroMem (&SelectedImage, sizeof (SelectedImage));
+  SelectedImageId = 0;
+
+  for (CurrentLogo = 0; CurrentLogo < mLogoImageIdCount; CurrentLogo++) {
+    Status = mHiiImageEx->GetImageInfo (
+                            mHiiImageEx,
+                            mHiiHandle,
+                            mLogoImageId[CurrentLogo],
+                            &CurrentImage
+                            );
+    if (EFI_ERROR (Status)) {
+      if (Status == EFI_NOT_FOUND) {
+        break;
+      }
+
+      DEBUG ((DEBUG_ERROR, "%a: Failed to get logo image info: %r\n", __func__, Status));
+      return Status;
+    }
+
+    DEBUG ((DEBUG_VERBOSE, "%a: Found logo %ux%u\r\n", __func__, CurrentImage.Width, CurrentImage.Height));
+    if (LogoScreenRatio == 0) {
+      // If larger that display or this is smaller then previous image skip
+      if ((CurrentImage.Height > TargetHeight) ||
+          (CurrentImage.Width > TargetWidth) ||
+          (CurrentImage.Height < SelectedImage.Height) ||
+          (CurrentImage.Width < SelectedImage.Width))
+      {
+        continue;
+      }
+    } else if (SelectedImage.Height != 0) {
+      // Skip the image if previous image is closer to the target height.
+      if (Abs (CurrentImage.Height - TargetHeight) > Abs (SelectedImage.Height - TargetHeight)) {
+        continue;
+      }
+    }
+
+    CopyMem (&SelectedImage, &CurrentImage, sizeof (EFI_IMAGE_OUTPUT));
+    SelectedImageId = mLogoImageId[CurrentLogo];
+  }
+
+  if (SelectedImage.Height == 0) {
+    return EFI_NOT_FOUND;
+  }
+
+  *ImageId = SelectedImageId;
+  return EFI_SUCCESS;
+}
+
+/**
+  Load the scaled logo saved by a previous boot.
+
+  @param[in]  Key          Expected cache header, only the fields before Width
+                           are compared.
+  @param[out] Image        Cached logo, Bitmap must be freed by the caller.
+  @param[out] Uncacheable  Set if a previous boot found the logo for Key too
+                           large to cache.
+
+  @retval TRUE      The cached logo matches Key and was loaded.
+  @retval FALSE     There is no usable cached logo.
+**/
+STATIC
+BOOLEAN
+LogoCacheLoad (
+  IN  CONST LOGO_CACHE_HEADER  *Key,
+  OUT EFI_IMAGE_INPUT          *Image,
+  OUT BOOLEAN                  *Uncacheable
+  )
+{
+  EFI_STATUS                     Status;
+  UINTN                          DataSize;
+  LOGO_CACHE_HEADER              *Header;
+  LOGO_CACHE_RUN                 *Run;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Bitmap;
+  UINTN                          PixelCount;
+  UINTN                          Pixel;
+  UINTN                          Index;
+  UINT32                         Length;
+  BOOLEAN                        Loaded;
+
+  *Uncacheable = FALSE;
+
+  DataSize = 0;
+  Status   = gRT->GetVariable (LOGO_CACHE_VARIABLE_NAME, &gNVIDIATokenSpaceGuid, NULL, &DataSize, NULL);
+  if ((Status != EFI_BUFFER_TOO_SMALL) || (DataSize < sizeof (LOGO_CACHE_HEADER))) {
+    return FALSE;
+  }
+
+  Header = AllocatePool (DataSize);
+  if (Header == NULL) {
+    return FALSE;
+  }
+
+  Bitmap = NULL;
+  Loaded = FALSE;
+
+  Status = gRT->GetVariable (LOGO_CACHE_VARIABLE_NAME, &gNVIDIATokenSpaceGuid, NULL, &DataSize, Header);
+  if (EFI_ERROR (Status) ||
+      (CompareMem (Header, Key, OFFSET_OF (LOGO_CACHE_HEADER, Width)) != 0))
+  {
+    goto Exit;
+  }
+
+  if ((Header->RunCount == 0) && (DataSize == sizeof (LOGO_CACHE_HEADER))) {
+    *Uncacheable = TRUE;
+    goto Exit;
+  }
+
+  if ((Header->Width == 0) || (Header->Height == 0) ||
+      (DataSize != sizeof (LOGO_CACHE_HEADER) + (Header->RunCount * sizeof (LOGO_CACHE_RUN))))
+  {
+    goto Exit;
+  }
+
+  PixelCount = (UINTN)Header->Width * Header->Height;
+  Bitmap     = AllocatePool (PixelCount * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  if (Bitmap == NULL) {
+    goto Exit;
+  }
+
+  Run   = (LOGO_CACHE_RUN *)(Header + 1);
+  Pixel = 0;
+  for (Index = 0; Index < Header->RunCount; Index++) {
+    if (Run[Index].Length > PixelCount - Pixel) {
+      goto Exit;
+    }
+
+    for (Length = 0; Length < Run[Index].Length; Length++) {
+      Bitmap[Pixel++] = Run[Index].Pixel;
+    }
+  }
+
+  if (Pixel != PixelCount) {
+    goto Exit;
+  }
+
+  Image->Flags  = 0;
+  Image->Width  = Header->Width;
+  Image->Height = Header->Height;
+  Image->Bitmap = Bitmap;
+  Loaded        = TRUE;
+
+Exit:
+  if (!Loaded && (Bitmap != NULL)) {
+    FreePool (Bitmap);
+  }
+
+  FreePool (Header);
+  return Loaded;
+}
+
+/**
+  Save the scaled logo so later boots at the same resolution skip scaling.
+
+  A logo that does not fit in a single variable is recorded as a header
+  without runs, so later boots with the same key neither scale it into the
+  cache again nor rewrite the variable.
+
+  @param[in]  Key          Cache header describing the logo, RunCount is filled in.
+  @param[in]  Image        Scaled logo.
+**/
+STATIC
+VOID
+LogoCacheSave (
+  IN CONST LOGO_CACHE_HEADER  *Key,
+  IN CONST EFI_IMAGE_INPUT    *Image
+  )
+{
+  EFI_STATUS         Status;
+  UINTN              PixelCount;
+  UINTN              Pixel;
+  UINT32             RunCount;
+  UINTN              DataSize;
+  LOGO_CACHE_HEADER  *Header;
+  LOGO_CACHE_RUN     *Run;
+
+  PixelCount = (UINTN)Image->Width * Image->Height;
+  RunCount   = 1;
+  for (Pixel = 1; Pixel < PixelCount; Pixel++) {
+    if (CompareMem (&Image->Bitmap[Pixel], &Image->Bitmap[Pixel - 1], sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)) != 0) {
+      RunCount++;
+    }
+  }
+
+  DataSize = sizeof (LOGO_CACHE_HEADER) + (RunCount * sizeof (LOGO_CACHE_RUN));
+  if (DataSize > PcdGet32 (PcdMaxVariableSize)) {
+    DEBUG ((DEBUG_INFO, "%a: Scaled logo needs %lu bytes, not cached\n", __func__, DataSize));
+    RunCount = 0;
+    DataSize = sizeof (LOGO_CACHE_HEADER);
+  }
+
+  Header = AllocatePool (DataSize);
+  if (Header == NULL) {
+    return;
+  }
+
+  CopyMem (Header, Key, sizeof (LOGO_CACHE_HEADER));
+  Header->RunCount = RunCount;
+
+  if (RunCount != 0) {
+    Run           = (LOGO_CACHE_RUN *)(Header + 1);
+    Run[0].Length = 1;
+    Run[0].Pixel  = Image->Bitmap[0];
+    for (Pixel = 1; Pixel < PixelCount; Pixel++) {
+      if (CompareMem (&Image->Bitmap[Pixel], &Run->Pixel, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)) == 0) {
+        Run->Length++;
+      } else {
+        Run++;
+        Run->Length = 1;
+        Run->Pixel  = Image->Bitmap[Pixel];
+      }
+    }
+  }
+
+  Status = gRT->SetVariable (
+                  LOGO_CACHE_VARIABLE_NAME,
+                  &gNVIDIATokenSpaceGuid,
+                  EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+                  DataSize,
+                  Header
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "%a: Failed to save scaled logo: %r\n", __func__, Status));
+  }
+
+  FreePool (Header);
+}
+
 /**
   Load a platform logo image and return its data and attributes.
 
@@ -72,7 +330,6 @@ GetImage (
 {
   EFI_STATUS                     Status;
   EFI_GRAPHICS_OUTPUT_PROTOCOL   *GraphicsOutput;
-  UINTN                          CurrentLogo;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *ScaledImage;
   UINT64                         ScreenHeight;
   UINT64                         ScreenWidth;
@@ -81,8 +338,10 @@ GetImage (
   UINT64                         TargetWidth;
   UINT64                         LogoScreenRatio;
   UINT64                         LogoScreenCenterY;
-  EFI_IMAGE_INPUT                CurrentImage;
+  EFI_IMAGE_ID                   SelectedImageId;
   EFI_IMAGE_INPUT                SelectedImage;
+  LOGO_CACHE_HEADER              CacheKey;
+  BOOLEAN                        Uncacheable;
 
   if ((This == NULL) || (Instance == NULL) || (Image == NULL) ||
       (Attribute == NULL) || (OffsetX == NULL) || (OffsetY == NULL))
@@ -96,11 +355,6 @@ GetImage (
 
   (*Instance)++;
 
-  if (mLogoImage.Bitmap != NULL) {
-    CopyMem (Image, &mLogoImage, sizeof (EFI_IMAGE_INPUT));
-    return EFI_SUCCESS;
-  }
-
   Status = gBS->HandleProtocol (gST->ConsoleOutHandle, &gEfiGraphicsOutputProtocolGuid, (VOID **)&GraphicsOutput);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "%a: Failed to get graphics output protocol\n", __func__));
@@ -122,6 +376,11 @@ GetImage (
     LogoScreenCenterY = 1000;
   }
 
+  if (mLogoImage.Bitmap != NULL) {
+    CopyMem (Image, &mLogoImage, sizeof (EFI_IMAGE_INPUT));
+    goto Placement;
+  }
+
   // Adjusted screen height is used for logo selection only and adjusts to the
   // screen size to account for the fact that the logo might not be centered on
   // the screen. The available space is reduced by amount it is shifted from the
@@ -140,47 +399,36 @@ GetImage (
     TargetWidth  = ScreenWidth;
   }
 
-  ZeroMem (&SelectedImage, sizeof (EFI_IMAGE_INPUT));
-
-  for (CurrentLogo = 0; CurrentLogo < mLogoImageIdCount; CurrentLogo++) {
-    Status = mHiiImageEx->GetImageEx (
-                            mHiiImageEx,
-                            mHiiHandle,
-                            mLogoImageId[CurrentLogo],
-                            &CurrentImage
-                            );
-    if (EFI_ERROR (Status)) {
-      if (Status == EFI_NOT_FOUND) {
-        break;
-      }
-
-      DEBUG ((DEBUG_ERROR, "%a: Failed to get logo image: %r\n", __func__, Status));
-      return Status;
-    }
-
-    DEBUG ((DEBUG_VERBOSE, "%a: Found logo %ux%u\r\n", __func__, CurrentImage.Width, CurrentImage.Height));
-    if (LogoScreenRatio == 0) {
-      // If larger that display or this is smaller then previous image skip
-      if ((CurrentImage.Height > TargetHeight) ||
-          (CurrentImage.Width > TargetWidth) ||
-          (CurrentImage.Height < SelectedImage.Height) ||
-          (CurrentImage.Width < SelectedImage.Width))
-      {
-        continue;
-      }
-    } else if (SelectedImage.Height != 0) {
-      // Skip the image if previous image is closer to the target height.
-      if (Abs (CurrentImage.Height - TargetHeight) > Abs (SelectedImage.Height - TargetHeight)) {
-        continue;
-      }
-    }
+  Status = LogoSelectImage (TargetWidth, TargetHeight, LogoScreenRatio, &SelectedImageId);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_VERBOSE, "%a: No suitable logo found\n", __func__));
+    return Status;
+  }
 
-    CopyMem (&SelectedImage, &CurrentImage, sizeof (EFI_IMAGE_INPUT));
+  ZeroMem (&CacheKey, sizeof (CacheKey));
+  CacheKey.Signature       = LOGO_CACHE_SIGNATURE;
+  CacheKey.PackageListCrc  = mPackageListCrc;
+  CacheKey.ScreenWidth     = (UINT32)ScreenWidth;
+  CacheKey.ScreenHeight    = (UINT32)ScreenHeight;
+  CacheKey.LogoScreenRatio = (UINT16)LogoScreenRatio;
+  CacheKey.ImageId         = SelectedImageId;
+
+  Uncacheable = FALSE;
+  if ((LogoScreenRatio != 0) && LogoCacheLoad (&CacheKey, &mLogoImage, &Uncacheable)) {
+    DEBUG ((DEBUG_VERBOSE, "%a: Using cached %ux%u logo\n", __func__, mLogoImage.Width, mLogoImage.Height));
+    CopyMem (Image, &mLogoImage, sizeof (EFI_IMAGE_INPUT));
+    goto Placement;
   }
 
-  if (SelectedImage.Bitmap == NULL) {
-    DEBUG ((DEBUG_VERBOSE, "%a: No suitable logo found\n", __func__));
-    return EFI_NOT_FOUND;
+  Status = mHiiImageEx->GetImageEx (
+                          mHiiImageEx,
+                          mHiiHandle,
+                          SelectedImageId,
+                          &SelectedImage
+                          );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: Failed to get logo image: %r\n", __func__, Status));
+    return Status;
   }
 
   mLogoImage.Flags = 0;
@@ -203,6 +451,7 @@ GetImage (
                (UINTN)TargetHeight,
                &ScaledImage
                );
+    FreePool (SelectedImage.Bitmap);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "%a: Failed to scale image: %r\n", __func__, Status));
       return Status;
@@ -211,12 +460,19 @@ GetImage (
     mLogoImage.Bitmap = ScaledImage;
     mLogoImage.Width  = TargetWidth;
     mLogoImage.Height = TargetHeight;
+
+    if (!Uncacheable) {
+      CacheKey.Width  = mLogoImage.Width;
+      CacheKey.Height = mLogoImage.Height;
+      LogoCacheSave (&CacheKey, &mLogoImage);
+    }
   } else {
     CopyMem (&mLogoImage, &SelectedImage, sizeof (EFI_IMAGE_INPUT));
   }
 
   CopyMem (Image, &mLogoImage, sizeof (EFI_IMAGE_INPUT));
 
+Placement:
   // Center horizontally
   *Attribute = EdkiiPlatformLogoDisplayAttributeCenterTop;
   *OffsetX   = 0;
@@ -288,6 +544,12 @@ InitializeLogo (
     return Status;
   }
 
+  //
+  // Key the cached scaled logo to the logos built into this image
+  //
+  Status = gBS->CalculateCrc32 (PackageList, PackageList->PackageLength, &mPackageListCrc);
+  NV_ASSERT_EFI_ERROR_RETURN (Status, return Status);
+
   //
   // Publish HII package list to HII Database.
   //
@@ -1,7 +1,7 @@
 /** @file
   Logo DXE Driver private header file
 
-  SPDX-FileCopyrightText: Copyright (c) 2025, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2025-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
   SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
@@ -12,6 +12,35 @@
 #include <Protocol/HiiDatabase.h>
 #include <Protocol/HiiImageEx.h>
 #include <Protocol/HiiPackageList.h>
+#include <Protocol/GraphicsOutput.h>
+
+#define LOGO_CACHE_VARIABLE_NAME  L"LogoCache"
+#define LOGO_CACHE_SIGNATURE      SIGNATURE_32 ('L', 'O', 'G', 'C')
+
+//
+// The last scaled logo is stored run length encoded in the LogoCache variable
+// as a LOGO_CACHE_HEADER followed by RunCount LOGO_CACHE_RUN entries. It is
+// only used if every field of the header matches the current boot. A header
+// with no runs records that the logo is too large to cache.
+//
+#pragma pack(1)
+typedef struct {
+  UINT32    Signature;
+  UINT32    PackageListCrc;           // CRC32 of the logo HII package list
+  UINT32    ScreenWidth;
+  UINT32    ScreenHeight;
+  UINT16    LogoScreenRatio;
+  UINT16    ImageId;
+  UINT16    Width;
+  UINT16    Height;
+  UINT32    RunCount;
+} LOGO_CACHE_HEADER;
+
+typedef struct {
+  UINT32                           Length;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL    Pixel;
+} LOGO_CACHE_RUN;
+#pragma pack()
 
 extern EFI_IMAGE_ID  mLogoImageId[];
 extern UINTN         mLogoImageIdCount;
@@ -1,7 +1,7 @@
 /** @file
 
   Copyright (C) 2016, Linaro Ltd. All rights reserved.<BR>
-  SPDX-FileCopyrightText: Copyright (c) 2021-2025, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2021-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -262,6 +262,7 @@ NonDiscoverablePciDeviceStop (
          DeviceHandle
          );
 
+  NonCoherentFreeBouncePool (Dev);
   FreePool (Dev);
 
   return EFI_SUCCESS;
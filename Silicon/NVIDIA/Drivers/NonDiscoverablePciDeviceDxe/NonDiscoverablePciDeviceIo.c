@@ -20,11 +20,19 @@
 
 #include <PlatformToDriverStructures.h>
 
+//
+// Limits on the bounce buffers kept per device for reuse by Map(). Larger
+// buffers are freed on Unmap() rather than pooled.
+//
+#define NON_DISCOVERABLE_BOUNCE_POOL_MAX_PAGES         64
+#define NON_DISCOVERABLE_BOUNCE_POOL_MAX_BUFFER_PAGES  16
+
 typedef struct {
-  EFI_PHYSICAL_ADDRESS             AllocAddress;
-  VOID                             *HostAddress;
-  EFI_PCI_IO_PROTOCOL_OPERATION    Operation;
-  UINTN                            NumberOfBytes;
+  EFI_PHYSICAL_ADDRESS                     AllocAddress;
+  VOID                                     *HostAddress;
+  EFI_PCI_IO_PROTOCOL_OPERATION            Operation;
+  UINTN                                    NumberOfBytes;
+  NON_DISCOVERABLE_DEVICE_BOUNCE_BUFFER    *BounceBuffer;
 } NON_DISCOVERABLE_PCI_DEVICE_MAP_INFO;
 
 /**
@@ -1149,6 +1157,153 @@ FreeBuffer:
   return Status;
 }
 
+/**
+  Get a bounce buffer of at least the given number of pages, from the device's
+  pool if one fits, otherwise by allocating a new uncached buffer.
+
+  @param  This                  A pointer to the EFI_PCI_IO_PROTOCOL instance.
+  @param  Pages                 The number of pages needed.
+
+  @retval Pointer to the bounce buffer, or NULL if none could be allocated.
+
+**/
+STATIC
+NON_DISCOVERABLE_DEVICE_BOUNCE_BUFFER *
+NonCoherentGetBounceBuffer (
+  IN  EFI_PCI_IO_PROTOCOL  *This,
+  IN  UINTN                Pages
+  )
+{
+  NON_DISCOVERABLE_PCI_DEVICE            *Dev;
+  LIST_ENTRY                             *Entry;
+  NON_DISCOVERABLE_DEVICE_BOUNCE_BUFFER  *Buffer;
+  NON_DISCOVERABLE_DEVICE_BOUNCE_BUFFER  *Best;
+  BOOLEAN                                Below4GB;
+  EFI_STATUS                             Status;
+
+  Dev      = NON_DISCOVERABLE_PCI_DEVICE_FROM_PCI_IO (This);
+  Below4GB = ((Dev->Attributes & EFI_PCI_IO_ATTRIBUTE_DUAL_ADDRESS_CYCLE) == 0);
+
+  //
+  // Use the smallest pooled buffer that fits. The device attributes may have
+  // changed since the buffer was allocated, so check it is still addressable.
+  //
+  Best = NULL;
+  for (Entry = Dev->BouncePool.ForwardLink;
+       Entry != &Dev->BouncePool;
+       Entry = Entry->ForwardLink)
+  {
+    Buffer = BASE_CR (Entry, NON_DISCOVERABLE_DEVICE_BOUNCE_BUFFER, List);
+    if ((Buffer->NumPages < Pages) ||
+        ((Best != NULL) && (Buffer->NumPages >= Best->NumPages)))
+    {
+      continue;
+    }
+
+    if (Below4GB &&
+        ((EFI_PHYSICAL_ADDRESS)(UINTN)Buffer->HostAddress + EFI_PAGES_TO_SIZE (Buffer->NumPages) > SIZE_4GB))
+    {
+      continue;
+    }
+
+    Best = Buffer;
+  }
+
+  if (Best != NULL) {
+    RemoveEntryList (&Best->List);
+    Dev->BouncePoolPages -= Best->NumPages;
+    Dev->BouncePoolHits++;
+    return Best;
+  }
+
+  Dev->BouncePoolMisses++;
+
+  Buffer = AllocatePool (sizeof *Buffer);
+  if (Buffer == NULL) {
+    return NULL;
+  }
+
+  Status = NonCoherentPciIoAllocateBuffer (
+             This,
+             AllocateAnyPages,
+             EfiBootServicesData,
+             Pages,
+             &Buffer->HostAddress,
+             EFI_PCI_ATTRIBUTE_MEMORY_WRITE_COMBINE
+             );
+  if (EFI_ERROR (Status)) {
+    FreePool (Buffer);
+    return NULL;
+  }
+
+  Buffer->NumPages = Pages;
+  return Buffer;
+}
+
+/**
+  Return a bounce buffer to the device's pool, or free it if the pool is full
+  or the buffer is too large to keep.
+
+  @param  This                  A pointer to the EFI_PCI_IO_PROTOCOL instance.
+  @param  Buffer                The bounce buffer.
+
+**/
+STATIC
+VOID
+NonCoherentPutBounceBuffer (
+  IN  EFI_PCI_IO_PROTOCOL                    *This,
+  IN  NON_DISCOVERABLE_DEVICE_BOUNCE_BUFFER  *Buffer
+  )
+{
+  NON_DISCOVERABLE_PCI_DEVICE  *Dev;
+
+  Dev = NON_DISCOVERABLE_PCI_DEVICE_FROM_PCI_IO (This);
+  if ((Buffer->NumPages <= NON_DISCOVERABLE_BOUNCE_POOL_MAX_BUFFER_PAGES) &&
+      (Dev->BouncePoolPages + Buffer->NumPages <= NON_DISCOVERABLE_BOUNCE_POOL_MAX_PAGES))
+  {
+    InsertHeadList (&Dev->BouncePool, &Buffer->List);
+    Dev->BouncePoolPages += Buffer->NumPages;
+    return;
+  }
+
+  NonCoherentPciIoFreeBuffer (This, Buffer->NumPages, Buffer->HostAddress);
+  FreePool (Buffer);
+}
+
+/**
+  Free the bounce buffers pooled for a device.
+
+  @param  Device            Point to NON_DISCOVERABLE_PCI_DEVICE instance.
+**/
+VOID
+NonCoherentFreeBouncePool (
+  NON_DISCOVERABLE_PCI_DEVICE  *Device
+  )
+{
+  NON_DISCOVERABLE_DEVICE_BOUNCE_BUFFER  *Buffer;
+
+  if ((Device->DirectMaps != 0) || (Device->BouncePoolHits != 0) || (Device->BouncePoolMisses != 0)) {
+    DEBUG ((
+      DEBUG_INFO,
+      "%a: DirectMaps=%llu BouncedBytes=%llu PoolHits=%llu PoolMisses=%llu\n",
+      __FUNCTION__,
+      Device->DirectMaps,
+      Device->BouncedBytes,
+      Device->BouncePoolHits,
+      Device->BouncePoolMisses
+      ));
+  }
+
+  while (!IsListEmpty (&Device->BouncePool)) {
+    Buffer = BASE_CR (GetFirstNode (&Device->BouncePool), NON_DISCOVERABLE_DEVICE_BOUNCE_BUFFER, List);
+    RemoveEntryList (&Buffer->List);
+    NonCoherentPciIoFreeBuffer (&Device->PciIo, Buffer->NumPages, Buffer->HostAddress);
+    FreePool (Buffer);
+  }
+
+  Device->BouncePoolPages = 0;
+}
+
 /**
   Provides the PCI controller-specific addresses needed to access system memory.
 
@@ -1184,7 +1339,6 @@ NonCoherentPciIoMap (
   EFI_STATUS                            Status;
   NON_DISCOVERABLE_PCI_DEVICE_MAP_INFO  *MapInfo;
   UINTN                                 AlignMask;
-  VOID                                  *AllocAddress;
   EFI_GCD_MEMORY_SPACE_DESCRIPTOR       GcdDescriptor;
   BOOLEAN                               Bounce;
 
@@ -1211,6 +1365,7 @@ NonCoherentPciIoMap (
   MapInfo->HostAddress   = HostAddress;
   MapInfo->Operation     = Operation;
   MapInfo->NumberOfBytes = *NumberOfBytes;
+  MapInfo->BounceBuffer  = NULL;
 
   Dev = NON_DISCOVERABLE_PCI_DEVICE_FROM_PCI_IO (This);
 
@@ -1224,6 +1379,13 @@ NonCoherentPciIoMap (
   if (!Bounce) {
     switch (Operation) {
       case EfiPciIoOperationBusMasterRead:
+        //
+        // The device only reads the buffer, so cleaning the caches is
+        // sufficient at any alignment: cache lines shared with adjacent data
+        // are written back, never discarded.
+        //
+        break;
+
       case EfiPciIoOperationBusMasterWrite:
         //
         // For streaming DMA, it is sufficient if the buffer is aligned to
@@ -1263,25 +1425,24 @@ NonCoherentPciIoMap (
       goto FreeMapInfo;
     }
 
-    Status = NonCoherentPciIoAllocateBuffer (
-               This,
-               AllocateAnyPages,
-               EfiBootServicesData,
-               EFI_SIZE_TO_PAGES (MapInfo->NumberOfBytes),
-               &AllocAddress,
-               EFI_PCI_ATTRIBUTE_MEMORY_WRITE_COMBINE
-               );
-    if (EFI_ERROR (Status)) {
+    MapInfo->BounceBuffer = NonCoherentGetBounceBuffer (
+                              This,
+                              EFI_SIZE_TO_PAGES (MapInfo->NumberOfBytes)
+                              );
+    if (MapInfo->BounceBuffer == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
       goto FreeMapInfo;
     }
 
-    MapInfo->AllocAddress = (EFI_PHYSICAL_ADDRESS)(UINTN)AllocAddress;
+    MapInfo->AllocAddress = (EFI_PHYSICAL_ADDRESS)(UINTN)MapInfo->BounceBuffer->HostAddress;
     if (Operation == EfiPciIoOperationBusMasterRead) {
-      gBS->CopyMem (AllocAddress, HostAddress, *NumberOfBytes);
+      gBS->CopyMem (MapInfo->BounceBuffer->HostAddress, HostAddress, *NumberOfBytes);
     }
 
-    *DeviceAddress = MapInfo->AllocAddress;
+    Dev->BouncedBytes += *NumberOfBytes;
+    *DeviceAddress     = MapInfo->AllocAddress;
   } else {
+    Dev->DirectMaps++;
     MapInfo->AllocAddress = 0;
     *DeviceAddress        = (EFI_PHYSICAL_ADDRESS)(UINTN)HostAddress;
 
@@ -1339,7 +1500,7 @@ NonCoherentPciIoUnmap (
   if (MapInfo->AllocAddress != 0) {
     //
     // We are using a bounce buffer: copy back the data if necessary,
-    // and free the buffer.
+    // and return the buffer to the pool.
     //
     if (MapInfo->Operation == EfiPciIoOperationBusMasterWrite) {
       gBS->CopyMem (
@@ -1349,11 +1510,7 @@ NonCoherentPciIoUnmap (
              );
     }
 
-    NonCoherentPciIoFreeBuffer (
-      This,
-      EFI_SIZE_TO_PAGES (MapInfo->NumberOfBytes),
-      (VOID *)(UINTN)MapInfo->AllocAddress
-      );
+    NonCoherentPutBounceBuffer (This, MapInfo->BounceBuffer);
   } else {
     //
     // We are *not* using a bounce buffer: if this is a bus master write,
@@ -1882,6 +2039,7 @@ InitializePciIoProtocol (
   INTN                               Idx;
 
   InitializeListHead (&Dev->UncachedAllocationList);
+  InitializeListHead (&Dev->BouncePool);
 
   Dev->ConfigSpace.Hdr.VendorId = PCI_ID_VENDOR_UNKNOWN;
   Dev->ConfigSpace.Hdr.DeviceId = PCI_ID_DEVICE_DONTCARE;
@@ -1,7 +1,7 @@
 /** @file
 
   Copyright (C) 2016, Linaro Ltd. All rights reserved.<BR>
-  SPDX-FileCopyrightText: Copyright (c) 2021-2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2021-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -58,6 +58,21 @@ typedef struct {
   UINT64        Attributes;
 } NON_DISCOVERABLE_DEVICE_UNCACHED_ALLOCATION;
 
+typedef struct {
+  //
+  // The linked-list next pointer, used while the buffer is in the pool
+  //
+  LIST_ENTRY    List;
+  //
+  // The address of the uncached allocation backing the buffer
+  //
+  VOID          *HostAddress;
+  //
+  // The number of pages in the allocation
+  //
+  UINTN         NumPages;
+} NON_DISCOVERABLE_DEVICE_BOUNCE_BUFFER;
+
 typedef struct {
   UINT32                     Signature;
   //
@@ -97,6 +112,21 @@ typedef struct {
   //
   LIST_ENTRY                 UncachedAllocationList;
   //
+  // Pool of free bounce buffers kept by Map() for reuse, and the number of
+  // pages it holds. The buffers are already uncached so reusing one avoids
+  // the page allocation and memory attribute change.
+  //
+  LIST_ENTRY                 BouncePool;
+  UINTN                      BouncePoolPages;
+  //
+  // Map() statistics: mappings done without a bounce buffer, bytes bounced,
+  // and bounce buffer requests satisfied from the pool or by allocation
+  //
+  UINT64                     DirectMaps;
+  UINT64                     BouncedBytes;
+  UINT64                     BouncePoolHits;
+  UINT64                     BouncePoolMisses;
+  //
   // Unique ID for this device instance: needed so that we can report unique
   // segment/bus/device number for each device instance. Note that this number
   // may change when disconnecting/reconnecting the driver.
@@ -119,6 +149,16 @@ InitializePciIoProtocol (
   EFI_HANDLE                   ControllerHandle
   );
 
+/**
+  Free the bounce buffers pooled for a device.
+
+  @param  Device            Point to NON_DISCOVERABLE_PCI_DEVICE instance.
+**/
+VOID
+NonCoherentFreeBouncePool (
+  NON_DISCOVERABLE_PCI_DEVICE  *Device
+  );
+
 extern EFI_COMPONENT_NAME_PROTOCOL   gComponentName;
 extern EFI_COMPONENT_NAME2_PROTOCOL  gComponentName2;
 
@@ -9,6 +9,7 @@
 **/
 
 #include <NorFlashPrivate.h>
+#include <Library/BootTraceLib.h>
 
 EFI_BLOCK_IO_MEDIA  Media = {
   0,         // Media ID gets updated during Start
@@ -888,6 +889,7 @@ NorFlashReadBlock (
 {
   EFI_STATUS              Status;
   NOR_FLASH_PRIVATE_DATA  *Private;
+  UINT32                  SpanId;
 
   if ((This == NULL) ||
       (Buffer == NULL) ||
@@ -902,12 +904,14 @@ NorFlashReadBlock (
     return EFI_MEDIA_CHANGED;
   }
 
+  SpanId = BootTraceBegin (BootTraceCategoryFlash, "NorFlashRead", (UINT32)Lba);
   Status = NorFlashRead (
              &Private->NorFlashProtocol,
              (Lba * Private->PrivateFlashAttributes.FlashAttributes.BlockSize),
              BufferSize,
              Buffer
              );
+  BootTraceEnd (SpanId);
 
   return Status;
 }
@@ -1094,6 +1098,7 @@ NorFlashEraseBlock (
 {
   EFI_STATUS              Status;
   NOR_FLASH_PRIVATE_DATA  *Private;
+  UINT32                  SpanId;
 
   if ((This == NULL) ||
       (Token == NULL) ||
@@ -1108,12 +1113,14 @@ NorFlashEraseBlock (
     return EFI_MEDIA_CHANGED;
   }
 
+  SpanId = BootTraceBegin (BootTraceCategoryFlash, "NorFlashErase", (UINT32)LBA);
   Status = NorFlashErase (
              &Private->NorFlashProtocol,
              LBA,
              Size / Private->PrivateFlashAttributes.FlashAttributes.BlockSize,
              FALSE
              );
+  BootTraceEnd (SpanId);
 
   if (Token->Event != NULL) {
     Token->TransactionStatus = Status;
@@ -1311,6 +1318,7 @@ NorFlashWriteBlock (
   UINT32                  PageSize;
   UINT32                  BlockSize;
   UINT8                   *Data;
+  UINT32                  SpanId;
 
   if ((This == NULL) ||
       (Buffer == NULL))
@@ -1324,6 +1332,7 @@ NorFlashWriteBlock (
     return EFI_MEDIA_CHANGED;
   }
 
+  SpanId = BootTraceBegin (BootTraceCategoryFlash, "NorFlashWrite", (UINT32)Lba);
   Status = NorFlashErase (
              &Private->NorFlashProtocol,
              Lba,
@@ -1345,6 +1354,7 @@ NorFlashWriteBlock (
                Data
                );
     if (EFI_ERROR (Status)) {
+      BootTraceEnd (SpanId);
       return Status;
     }
 
@@ -1353,6 +1363,7 @@ NorFlashWriteBlock (
     Data += PageSize;
   }
 
+  BootTraceEnd (SpanId);
   return Status;
 }
 
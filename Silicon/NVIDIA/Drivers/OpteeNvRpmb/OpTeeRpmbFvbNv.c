@@ -3,7 +3,7 @@
   FV block I/O protocol driver for RPMB eMMC accessed via OP-TEE
 
   Copyright (c) 2020, Linaro Ltd. All rights reserved.<BR>
-  SPDX-FileCopyrightText: Copyright (c) 2022-2025 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2022-2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -16,6 +16,7 @@
 #include <Library/MmServicesTableLib.h>
 #include <Library/PcdLib.h>
 #include <Library/StandaloneMmOpteeDeviceMem.h>
+#include <Library/TimerLib.h>
 
 #include <IndustryStandard/ArmFfaSvc.h>
 #include <IndustryStandard/ArmMmSvc.h>
@@ -120,6 +121,128 @@ ReadWriteRpmb (
   return Status;
 }
 
+/**
+  Write a range of the RPMB file and update the memory copy.
+
+  While the memory copy is known to match the RPMB, only the span from the
+  first to the last byte that differs from it is written, and nothing is
+  written if the range is unchanged. The write is still complete when this
+  function returns, so callers relying on each write being flushed are not
+  affected.
+
+  @param[in] Instance    MEM_INSTANCE of the RPMB file
+  @param[in] Offset      Offset into the RPMB file
+  @param[in] NumBytes    Number of bytes to write
+  @param[in] Buffer      Data to write
+
+  @retval    EFI_SUCCESS           write ok
+  @retval    Others                write failed, see ReadWriteRpmb()
+**/
+STATIC
+EFI_STATUS
+RpmbWriteRange (
+  IN MEM_INSTANCE  *Instance,
+  IN UINTN         Offset,
+  IN UINTN         NumBytes,
+  IN CONST UINT8   *Buffer
+  )
+{
+  UINT8       *Mirror;
+  UINTN       First;
+  UINTN       Last;
+  UINT64      StartTicks;
+  EFI_STATUS  Status;
+
+  Mirror = (UINT8 *)(UINTN)Instance->MemBaseAddress + Offset;
+  First  = 0;
+  Last   = NumBytes;
+
+  if (Instance->MirrorValid) {
+    while ((First < Last) && (Buffer[First] == Mirror[First])) {
+      First++;
+    }
+
+    while ((Last > First) && (Buffer[Last - 1] == Mirror[Last - 1])) {
+      Last--;
+    }
+  }
+
+  Instance->RpmbSkippedBytes += NumBytes - (Last - First);
+  if (First == Last) {
+    return EFI_SUCCESS;
+  }
+
+  StartTicks = GetPerformanceCounter ();
+  Status     = ReadWriteRpmb (
+                 SP_SVC_RPMB_WRITE,
+                 (UINTN)&Buffer[First],
+                 Last - First,
+                 Offset + First
+                 );
+  Instance->RpmbWriteNs += GetTimeInNanoSecond (GetPerformanceCounter () - StartTicks);
+  Instance->RpmbWrites++;
+  if (EFI_ERROR (Status)) {
+    // the RPMB may hold part of the write, stop trusting the memory copy
+    Instance->MirrorValid = FALSE;
+    return Status;
+  }
+
+  Instance->RpmbWriteBytes += Last - First;
+  CopyMem (&Mirror[First], &Buffer[First], Last - First);
+
+  DEBUG ((
+    DEBUG_VERBOSE,
+    "%a: Offset=0x%x Bytes=0x%x wrote 0x%x at 0x%x, total Writes=%llu Bytes=%llu Skipped=%llu Ns=%llu\n",
+    __FUNCTION__,
+    Offset,
+    NumBytes,
+    Last - First,
+    Offset + First,
+    Instance->RpmbWrites,
+    Instance->RpmbWriteBytes,
+    Instance->RpmbSkippedBytes,
+    Instance->RpmbWriteNs
+    ));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Erase a range of blocks of the RPMB file and update the memory copy.
+
+  @param[in] Instance    MEM_INSTANCE of the RPMB file
+  @param[in] Start       First block to erase
+  @param[in] NumLba      Number of blocks to erase
+
+  @retval    EFI_SUCCESS           erase ok
+  @retval    EFI_DEVICE_ERROR      buffer allocation failed
+  @retval    Others                write failed, see ReadWriteRpmb()
+**/
+STATIC
+EFI_STATUS
+RpmbEraseRange (
+  IN MEM_INSTANCE  *Instance,
+  IN EFI_LBA       Start,
+  IN UINTN         NumLba
+  )
+{
+  UINTN       NumBytes;
+  VOID        *Buf;
+  EFI_STATUS  Status;
+
+  NumBytes = NumLba * Instance->BlockSize;
+  Buf      = AllocatePool (NumBytes);
+  if (Buf == NULL) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  SetMem64 (Buf, NumBytes, ~0UL);
+  Status = RpmbWriteRange (Instance, Start * Instance->BlockSize, NumBytes, Buf);
+  FreePool (Buf);
+
+  return Status;
+}
+
 /**
   The GetAttributes() function retrieves the attributes and
   current settings of the block.
@@ -389,7 +512,6 @@ OpTeeRpmbFvbWrite (
 {
   MEM_INSTANCE  *Instance;
   EFI_STATUS    Status;
-  VOID          *Base;
 
   Instance = INSTANCE_FROM_FVB_THIS (This);
   if (!Instance->Initialized) {
@@ -399,22 +521,13 @@ OpTeeRpmbFvbWrite (
     }
   }
 
-  Base = (VOID *)(UINTN)Instance->MemBaseAddress + (Lba * Instance->BlockSize) +
-         Offset;
-  Status = ReadWriteRpmb (
-             SP_SVC_RPMB_WRITE,
-             (UINTN)Buffer,
-             *NumBytes,
-             (Lba * Instance->BlockSize) + Offset
-             );
-  if (EFI_ERROR (Status)) {
-    return Status;
-  }
-
-  // Update the memory copy
-  CopyMem (Base, Buffer, *NumBytes);
-
-  return Status;
+  // Write the changed part of the range and update the memory copy
+  return RpmbWriteRange (
+           Instance,
+           (Lba * Instance->BlockSize) + Offset,
+           *NumBytes,
+           Buffer
+           );
 }
 
 /**
@@ -471,16 +584,16 @@ OpTeeRpmbFvbErase (
   )
 {
   MEM_INSTANCE  *Instance;
-  UINTN         NumBytes;
   UINTN         NumLba;
   EFI_LBA       Start;
-  VOID          *Base;
-  VOID          *Buf;
+  EFI_LBA       RangeStart;
+  UINTN         RangeLba;
   VA_LIST       Args;
   EFI_STATUS    Status;
 
   Instance = INSTANCE_FROM_FVB_THIS (This);
 
+  // Verify the entire list before erasing anything
   VA_START (Args, This);
   for (Start = VA_ARG (Args, EFI_LBA);
        Start != EFI_LBA_LIST_TERMINATOR;
@@ -488,38 +601,46 @@ OpTeeRpmbFvbErase (
   {
     NumLba = VA_ARG (Args, UINTN);
     if ((NumLba == 0) || (Start + NumLba > Instance->NBlocks)) {
+      VA_END (Args);
       return EFI_INVALID_PARAMETER;
     }
+  }
+
+  VA_END (Args);
 
-    NumBytes = NumLba * Instance->BlockSize;
-    Base     = (VOID *)(UINTN)Instance->MemBaseAddress +
-               (Start * Instance->BlockSize);
-    Buf = AllocatePool (NumLba * Instance->BlockSize);
-    if (Buf == NULL) {
-      return EFI_DEVICE_ERROR;
+  // Erase each run of adjacent ranges with a single write
+  Status     = EFI_SUCCESS;
+  RangeStart = 0;
+  RangeLba   = 0;
+  VA_START (Args, This);
+  for (Start = VA_ARG (Args, EFI_LBA);
+       Start != EFI_LBA_LIST_TERMINATOR;
+       Start = VA_ARG (Args, EFI_LBA))
+  {
+    NumLba = VA_ARG (Args, UINTN);
+    if ((RangeLba != 0) && (Start == RangeStart + RangeLba)) {
+      RangeLba += NumLba;
+      continue;
     }
 
-    SetMem64 (Buf, NumLba * Instance->BlockSize, ~0UL);
-    // Write the device
-    Status = ReadWriteRpmb (
-               SP_SVC_RPMB_WRITE,
-               (UINTN)Buf,
-               NumBytes,
-               Start * Instance->BlockSize
-               );
-    if (EFI_ERROR (Status)) {
-      FreePool (Buf);
-      return Status;
+    if (RangeLba != 0) {
+      Status = RpmbEraseRange (Instance, RangeStart, RangeLba);
+      if (EFI_ERROR (Status)) {
+        break;
+      }
     }
 
-    // Update the in memory copy
-    SetMem64 (Base, NumLba * Instance->BlockSize, ~0UL);
-    FreePool (Buf);
+    RangeStart = Start;
+    RangeLba   = NumLba;
   }
 
   VA_END (Args);
 
-  return EFI_SUCCESS;
+  if (!EFI_ERROR (Status) && (RangeLba != 0)) {
+    Status = RpmbEraseRange (Instance, RangeStart, RangeLba);
+  }
+
+  return Status;
 }
 
 /**
@@ -534,24 +655,27 @@ ReadEntireFlash (
   IN MEM_INSTANCE  *Instance
   )
 {
-  UINTN  ReadAddr;
-  UINTN  StorageFtwWorkingSize;
-  UINTN  StorageVariableSize;
-  UINTN  StorageFtwSpareSize;
+  UINTN       ReadAddr;
+  UINTN       StorageFtwWorkingSize;
+  UINTN       StorageVariableSize;
+  UINTN       StorageFtwSpareSize;
+  EFI_STATUS  Status;
 
   StorageFtwWorkingSize = PcdGet32 (PcdFlashNvStorageFtwWorkingSize);
   StorageVariableSize   = PcdGet32 (PcdFlashNvStorageVariableSize);
   StorageFtwSpareSize   = PcdGet32 (PcdFlashNvStorageFtwSpareSize);
 
   ReadAddr = Instance->MemBaseAddress;
-  // There's no need to check if the read failed here. The upper EDK2 layers
-  // will initialize the flash correctly if the in-memory copy is wrong
-  ReadWriteRpmb (
-    SP_SVC_RPMB_READ,
-    ReadAddr,
-    StorageVariableSize + StorageFtwWorkingSize + StorageFtwSpareSize,
-    0
-    );
+  // There's no need to fail if the read failed here. The upper EDK2 layers
+  // will initialize the flash correctly if the in-memory copy is wrong, but
+  // writes can only be trimmed against the in-memory copy if it was read.
+  Status = ReadWriteRpmb (
+             SP_SVC_RPMB_READ,
+             ReadAddr,
+             StorageVariableSize + StorageFtwWorkingSize + StorageFtwSpareSize,
+             0
+             );
+  Instance->MirrorValid = !EFI_ERROR (Status);
 }
 
 /**
@@ -807,6 +931,8 @@ FvbInitialize (
       return Status;
     }
 
+    Instance->MirrorValid = TRUE;
+
     // Install all appropriate headers
     DEBUG ((
       DEBUG_INFO,
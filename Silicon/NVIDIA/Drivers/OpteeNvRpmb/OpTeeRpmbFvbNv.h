@@ -1,6 +1,6 @@
 /** @file
 
-  Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  Copyright (c) 2022-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
   Copyright (c) 2020, Linaro Ltd. All rights reserved.<BR>
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -60,6 +60,16 @@ struct _MEM_INSTANCE {
   UINT16                                BlockSize;
   /// Number of allocated blocks
   UINT16                                NBlocks;
+  /// Set to true while the memory copy is known to match the RPMB contents
+  BOOLEAN                               MirrorValid;
+  /// Number of RPMB write transactions issued
+  UINT64                                RpmbWrites;
+  /// Number of bytes written to the RPMB
+  UINT64                                RpmbWriteBytes;
+  /// Number of bytes not written because the RPMB already held them
+  UINT64                                RpmbSkippedBytes;
+  /// Time spent in RPMB write transactions
+  UINT64                                RpmbWriteNs;
 };
 
 #endif
@@ -16,6 +16,7 @@
 
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/CoroutineLib.h>
 #include <Library/DebugLib.h>
 #include <Library/DeviceDiscoveryDriverLib.h>
 #include <Library/DevicePathLib.h>
@@ -96,6 +97,10 @@ extern EFI_PCI_PLATFORM_PROTOCOL  mPciPlatformProtocol;
 BOOLEAN  gDpcFatalOnlyRead                                                   = FALSE;
 UINT8    gDpcFatalOnly[TEGRABL_SOC_MAX_SOCKETS][TEGRABL_MAX_PCIE_PER_SOCKET] = { 0 };
 
+// Controllers brought up by this driver, used to report link status once all are trained
+STATIC PCIE_CONTROLLER_PRIVATE  *mPcieControllers[TEGRABL_SOC_MAX_SOCKETS * TEGRABL_MAX_PCIE_PER_SOCKET];
+STATIC UINT32                   mPcieControllerCount = 0;
+
 /**
   PCI configuration space access.
 
@@ -359,6 +364,28 @@ PCIeFindExtCapMmio (
   return 0;
 }
 
+/**
+  Delays controller bring up. Controllers that do not need C2C initialization
+  yield to the other controllers while waiting, so that their PERST and link
+  training delays overlap.
+
+  @param[in]  Private           Controller private data.
+  @param[in]  DelayUs           Delay in microseconds.
+**/
+STATIC
+VOID
+PcieControllerDelay (
+  IN PCIE_CONTROLLER_PRIVATE  *Private,
+  IN UINTN                    DelayUs
+  )
+{
+  if (Private->C2cInitRequired) {
+    MicroSecondDelay (DelayUs);
+  } else {
+    DeviceDiscoveryThreadMicroSecondDelay (DelayUs);
+  }
+}
+
 STATIC
 BOOLEAN
 WaitForBit16 (
@@ -370,16 +397,17 @@ WaitForBit16 (
   BOOLEAN                  Status
   )
 {
-  UINT32  Index = 0;
+  UINT32      Index = 0;
+  EFI_STATUS  PollStatus;
+
+  if (!Private->C2cInitRequired) {
+    PollStatus = CoroutinePollMmio16 ((UINTN)Feat, BIT (Pos), Status ? BIT (Pos) : 0, TimeUs, Count * TimeUs);
+    return !EFI_ERROR (PollStatus);
+  }
 
   while (Index < Count) {
     if (!!(*Feat & BIT (Pos)) != Status) {
-      if (Private->C2cInitRequired) {
-        MicroSecondDelay (TimeUs);
-      } else {
-        DeviceDiscoveryThreadMicroSecondDelay (TimeUs);
-      }
-
+      MicroSecondDelay (TimeUs);
       Index++;
     } else {
       return TRUE;
@@ -413,11 +441,7 @@ RetrainLink (
         /* Clear Link Bandwith */
         PciExpCap->LinkStatus.Bits.LinkBandwidthManagement = 1;
         /* Wait for 20 ms for link to appear */
-        if (Private->C2cInitRequired) {
-          MicroSecondDelay (20*1000);
-        } else {
-          DeviceDiscoveryThreadMicroSecondDelay (20*1000);
-        }
+        PcieControllerDelay (Private, 20*1000);
 
         DEBUG ((
           DEBUG_ERROR,
@@ -721,11 +745,13 @@ InitializeController (
   }
 
   /* Wait for 100ms before releasing PERST# */
-  MicroSecondDelay (100 * 1000);
+  Private->InitStartNs = GetTimeInNanoSecond (GetPerformanceCounter ());
+  PcieControllerDelay (Private, 100 * 1000);
 
   val  = MmioRead32 (Private->XtlPriBase + XTL_RC_MGMT_PERST_CONTROL);
   val |= XTL_RC_MGMT_PERST_CONTROL_PERST_O_N;
   MmioWrite32 (Private->XtlPriBase + XTL_RC_MGMT_PERST_CONTROL, val);
+  Private->PerstReleaseNs = GetTimeInNanoSecond (GetPerformanceCounter ());
 
   /* Add a delay after PERST if requested by the user */
   CheckAndAddDelayAfterPERST (Private->SocketId, Private->CtrlId, Private->C2cInitRequired);
@@ -737,6 +763,8 @@ InitializeController (
   PciExpCap = (PCI_CAPABILITY_PCIEXP *)(Private->EcamBase + Private->PCIeCapOff);
 
   if ( WaitForBit16 (Private, &PciExpCap->LinkStatus.Uint16, 13, 10000, 100, TRUE)) {
+    Private->LinkUp   = TRUE;
+    Private->LinkUpNs = GetTimeInNanoSecond (GetPerformanceCounter ());
     DEBUG ((
       DEBUG_ERROR,
       "PCIe Socket-0x%x:Ctrl-0x%x Link is UP (Capable: Gen-%d,x%d  Negotiated: Gen-%d,x%d)\r\n",
@@ -753,7 +781,7 @@ InitializeController (
      * before issuing Configuration Requests, as required
      * for Downstream Ports supporting link speeds > 5.0 GT/s
      */
-    MicroSecondDelay (100 * 1000);
+    PcieControllerDelay (Private, 100 * 1000);
     if (ChipId == TH500_CHIP_ID) {
       /**
        * Re-train link if disable_ltssm_auto_train set in BCT.
@@ -805,9 +833,75 @@ InitializeController (
       ));
   }
 
+  Private->InitEndNs = GetTimeInNanoSecond (GetPerformanceCounter ());
+
   return EFI_SUCCESS;
 }
 
+/**
+  Reports the link status and bring up time of all controllers in a single
+  pass once they have all been initialized.
+**/
+STATIC
+VOID
+ReportControllerLinkStatus (
+  VOID
+  )
+{
+  UINT32                   Index;
+  PCIE_CONTROLLER_PRIVATE  *Private;
+  PCI_CAPABILITY_PCIEXP    *PciExpCap;
+  UINT64                   FirstStartNs;
+  UINT64                   LastEndNs;
+  UINT64                   TotalNs;
+
+  if (mPcieControllerCount == 0) {
+    return;
+  }
+
+  FirstStartNs = MAX_UINT64;
+  LastEndNs    = 0;
+  TotalNs      = 0;
+
+  for (Index = 0; Index < mPcieControllerCount; Index++) {
+    Private   = mPcieControllers[Index];
+    PciExpCap = (PCI_CAPABILITY_PCIEXP *)(Private->EcamBase + Private->PCIeCapOff);
+
+    if (Private->LinkUp) {
+      DEBUG ((
+        DEBUG_INFO,
+        "PCIe Socket-0x%x:Ctrl-0x%x: UP Gen-%d,x%d, link up %llu ms after PERST#, init %llu ms\r\n",
+        Private->SocketId,
+        Private->CtrlId,
+        PciExpCap->LinkStatus.Bits.CurrentLinkSpeed,
+        PciExpCap->LinkStatus.Bits.NegotiatedLinkWidth,
+        (Private->LinkUpNs - Private->PerstReleaseNs) / 1000000,
+        (Private->InitEndNs - Private->InitStartNs) / 1000000
+        ));
+    } else {
+      DEBUG ((
+        DEBUG_INFO,
+        "PCIe Socket-0x%x:Ctrl-0x%x: DOWN, init %llu ms\r\n",
+        Private->SocketId,
+        Private->CtrlId,
+        (Private->InitEndNs - Private->InitStartNs) / 1000000
+        ));
+    }
+
+    FirstStartNs = MIN (FirstStartNs, Private->InitStartNs);
+    LastEndNs    = MAX (LastEndNs, Private->InitEndNs);
+    TotalNs     += Private->InitEndNs - Private->InitStartNs;
+  }
+
+  DEBUG ((
+    DEBUG_ERROR,
+    "PCIe: %u controller(s) initialized in %llu ms (%llu ms if serialized)\r\n",
+    mPcieControllerCount,
+    (LastEndNs - FirstStartNs) / 1000000,
+    TotalNs / 1000000
+    ));
+}
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -977,75 +1071,72 @@ PcieFindExtCap (
   return 0;
 }
 
-typedef
-EFI_STATUS
-(EFIAPI *PROTOCOL_INSTANCE_CALLBACK)(
-  IN EFI_HANDLE           Handle,
-  IN VOID                 *Instance,
-  IN VOID                 *Context
-  );
+/**
+  Orders cached PCIe devices by segment, bus, device and function, so that
+  each root port is followed by the devices below it.
+
+  @param[in]  Buffer1           First PCIE_DEVICE_INFO to compare.
+  @param[in]  Buffer2           Second PCIE_DEVICE_INFO to compare.
 
+  @retval <0                    Buffer1 is ordered before Buffer2.
+  @retval 0                     Buffer1 and Buffer2 are the same function.
+  @retval >0                    Buffer1 is ordered after Buffer2.
+**/
 STATIC
-EFI_STATUS
-VisitAllInstancesOfProtocol (
-  IN EFI_GUID                    *Id,
-  IN PROTOCOL_INSTANCE_CALLBACK  CallBackFunction,
-  IN VOID                        *Context
+INTN
+EFIAPI
+ComparePcieDeviceInfo (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
   )
 {
-  EFI_STATUS  Status;
-  UINTN       HandleCount;
-  EFI_HANDLE  *HandleBuffer;
-  UINTN       Index;
-  VOID        *Instance;
-
-  /* Start to check all the PciIo to find all possible device */
-  HandleCount  = 0;
-  HandleBuffer = NULL;
-  Status       = gBS->LocateHandleBuffer (
-                        ByProtocol,
-                        Id,
-                        NULL,
-                        &HandleCount,
-                        &HandleBuffer
-                        );
-  if (EFI_ERROR (Status)) {
-    return Status;
+  CONST PCIE_DEVICE_INFO  *Info1;
+  CONST PCIE_DEVICE_INFO  *Info2;
+  UINT64                  Key1;
+  UINT64                  Key2;
+
+  Info1 = (CONST PCIE_DEVICE_INFO *)Buffer1;
+  Info2 = (CONST PCIE_DEVICE_INFO *)Buffer2;
+  Key1  = PCIE_DEVICE_INFO_KEY (Info1);
+  Key2  = PCIE_DEVICE_INFO_KEY (Info2);
+
+  if (Key1 < Key2) {
+    return -1;
+  } else if (Key1 > Key2) {
+    return 1;
   }
 
-  for (Index = 0; Index < HandleCount; Index++) {
-    Status = gBS->HandleProtocol (HandleBuffer[Index], Id, &Instance);
-    if (EFI_ERROR (Status)) {
-      continue;
-    }
-
-    Status = (*CallBackFunction)(HandleBuffer[Index], Instance, Context);
-  }
+  return 0;
+}
 
-  gBS->FreePool (HandleBuffer);
+/**
+  Builds a cache of all PCIe functions with their location and the offsets
+  of the capabilities used by the post enumeration configuration, so that
+  each capability list is walked only once.
 
-  return EFI_SUCCESS;
-}
+  @param[out] Devices           Sorted array of cached devices, to be freed
+                                by the caller.
+  @param[out] DeviceCount       Number of entries in Devices.
 
+  @retval EFI_SUCCESS           The cache was built.
+  @retval EFI_OUT_OF_RESOURCES  The cache could not be allocated.
+  @retval others                No PCI IO instances were found.
+**/
 STATIC
-EFI_PCI_IO_PROTOCOL *
-GetRPDev (
-  EFI_PCI_IO_PROTOCOL  *PciIo
+EFI_STATUS
+BuildPcieTopology (
+  OUT PCIE_DEVICE_INFO  **Devices,
+  OUT UINTN             *DeviceCount
   )
 {
   EFI_STATUS           Status;
   UINTN                HandleCount;
   EFI_HANDLE           *HandleBuffer;
   UINTN                Index;
-  VOID                 *Instance;
-  EFI_PCI_IO_PROTOCOL  *ParentPciIo;
-  UINTN                Segment, Bus, Device, Function;
-  UINTN                PSegment, PBus, PDevice, PFunction;
-
-  Status = PciIo->GetLocation (PciIo, &Segment, &Bus, &Device, &Function);
-  ASSERT_EFI_ERROR (Status);
+  UINTN                Count;
+  PCIE_DEVICE_INFO     *Info;
+  EFI_PCI_IO_PROTOCOL  *PciIo;
 
-  /* Start to check all the PciIo to find all possible devices */
   HandleCount  = 0;
   HandleBuffer = NULL;
   Status       = gBS->LocateHandleBuffer (
@@ -1056,36 +1147,55 @@ GetRPDev (
                         &HandleBuffer
                         );
   if (EFI_ERROR (Status)) {
-    return NULL;
+    return Status;
+  }
+
+  *Devices = AllocateZeroPool (HandleCount * sizeof (PCIE_DEVICE_INFO));
+  if (*Devices == NULL) {
+    gBS->FreePool (HandleBuffer);
+    return EFI_OUT_OF_RESOURCES;
   }
 
+  Count = 0;
   for (Index = 0; Index < HandleCount; Index++) {
-    Status = gBS->HandleProtocol (HandleBuffer[Index], &gEfiPciIoProtocolGuid, &Instance);
+    Status = gBS->HandleProtocol (HandleBuffer[Index], &gEfiPciIoProtocolGuid, (VOID **)&PciIo);
     if (EFI_ERROR (Status)) {
       continue;
     }
 
-    ParentPciIo = Instance;
-    Status      = ParentPciIo->GetLocation (ParentPciIo, &PSegment, &PBus, &PDevice, &PFunction);
-    ASSERT_EFI_ERROR (Status);
+    Info        = &(*Devices)[Count];
+    Info->PciIo = PciIo;
+    Status      = PciIo->GetLocation (PciIo, &Info->Segment, &Info->Bus, &Info->Device, &Info->Function);
+    if (EFI_ERROR (Status)) {
+      continue;
+    }
 
-    if ((PSegment == Segment) && (PBus == 0)) {
-      gBS->FreePool (HandleBuffer);
-      return ParentPciIo;
+    Info->PciExpCapOffset = PcieFindCap (PciIo, EFI_PCI_CAPABILITY_ID_PCIEXP);
+    if (Info->PciExpCapOffset != 0) {
+      Info->AerCapOffset = PcieFindExtCap (PciIo, PCI_EXPRESS_EXTENDED_CAPABILITY_ADVANCED_ERROR_REPORTING_ID);
+      Info->DpcCapOffset = PcieFindExtCap (PciIo, PCI_EXPRESS_EXTENDED_CAPABILITY_DPC_ID);
     }
+
+    Count++;
   }
 
   gBS->FreePool (HandleBuffer);
-  return NULL;
+
+  PerformQuickSort (*Devices, Count, sizeof (PCIE_DEVICE_INFO), ComparePcieDeviceInfo);
+  *DeviceCount = Count;
+
+  return EFI_SUCCESS;
 }
 
 STATIC
 EFI_STATUS
 PcieEnableErrorReporting (
-  EFI_PCI_IO_PROTOCOL  *PciIo
+  IN CONST PCIE_DEVICE_INFO  *Info,
+  IN CONST PCIE_DEVICE_INFO  *RootPort OPTIONAL
   )
 {
   EFI_STATUS                    Status;
+  EFI_PCI_IO_PROTOCOL           *PciIo;
   UINTN                         Segment, Bus, Device, Function;
   PCI_REG_PCIE_CAPABILITY       Capability;
   UINT32                        PciExpCapOffset, AerCapOffset, Offset, DevCapOffset;
@@ -1113,8 +1223,11 @@ PcieEnableErrorReporting (
     ASSERT (Mb1Config);
   }
 
-  Status = PciIo->GetLocation (PciIo, &Segment, &Bus, &Device, &Function);
-  ASSERT_EFI_ERROR (Status);
+  PciIo    = Info->PciIo;
+  Segment  = Info->Segment;
+  Bus      = Info->Bus;
+  Device   = Info->Device;
+  Function = Info->Function;
 
   Socket = PcieIdToSocket (Segment);
   Ctrl   = PcieIdToInterface (Segment);
@@ -1122,7 +1235,7 @@ PcieEnableErrorReporting (
   /* Check and get DPC configuration for this socket/controller */
   CheckAndGetDpcConfiguration (Socket, Ctrl);
 
-  PciExpCapOffset = PcieFindCap (PciIo, EFI_PCI_CAPABILITY_ID_PCIEXP);
+  PciExpCapOffset = Info->PciExpCapOffset;
 
   if (!PciExpCapOffset) {
     DEBUG ((
@@ -1136,7 +1249,7 @@ PcieEnableErrorReporting (
     return EFI_UNSUPPORTED;
   }
 
-  AerCapOffset = PcieFindExtCap (PciIo, PCI_EXPRESS_EXTENDED_CAPABILITY_ADVANCED_ERROR_REPORTING_ID);
+  AerCapOffset = Info->AerCapOffset;
   if (AerCapOffset) {
     // Clear AER Correctable Errror Status
     Offset = AerCapOffset + OFFSET_OF (PCI_EXPRESS_EXTENDED_CAPABILITIES_ADVANCED_ERROR_REPORTING, CorrectableErrorStatus);
@@ -1277,7 +1390,7 @@ PcieEnableErrorReporting (
         }
       }
 
-      Offset = PcieFindExtCap (PciIo, PCI_EXPRESS_EXTENDED_CAPABILITY_DPC_ID);
+      Offset = Info->DpcCapOffset;
       if (Offset) {
         /* First clear the stale status */
         Val_16 = (PCIE_DPC_STS_TRIGGER_STATUS | PCIE_DPC_STS_SIG_SFW_STATUS);
@@ -1351,13 +1464,12 @@ PcieEnableErrorReporting (
           ));
 
         /* If this is a switch downstream port, disable the DPC in the upstream RP */
-        if (Bus > 0) {
+        if ((Bus > 0) && (RootPort != NULL)) {
           UINT32               RpDpcCapOffset;
-          UINTN                RPSegment, RPBus, RPDevice, RPFunction;
           EFI_PCI_IO_PROTOCOL  *RPPciIo;
 
-          RPPciIo        = GetRPDev (PciIo);
-          RpDpcCapOffset = PcieFindExtCap (RPPciIo, PCI_EXPRESS_EXTENDED_CAPABILITY_DPC_ID);
+          RPPciIo        = RootPort->PciIo;
+          RpDpcCapOffset = RootPort->DpcCapOffset;
           if (RpDpcCapOffset) {
             Status = RPPciIo->Pci.Read (
                                     RPPciIo,
@@ -1386,15 +1498,13 @@ PcieEnableErrorReporting (
               return EFI_DEVICE_ERROR;
             }
 
-            Status = RPPciIo->GetLocation (RPPciIo, &RPSegment, &RPBus, &RPDevice, &RPFunction);
-            ASSERT_EFI_ERROR (Status);
             DEBUG ((
               DEBUG_INFO,
               "Device [%04x:%02x:%02x.%x] : Disabled DPC in the corresponding RootPort\n",
-              RPSegment,
-              RPBus,
-              RPDevice,
-              RPFunction
+              RootPort->Segment,
+              RootPort->Bus,
+              RootPort->Device,
+              RootPort->Function
               ));
           }
         }
@@ -1572,10 +1682,11 @@ PcieEnableErrorReporting (
 STATIC
 EFI_STATUS
 PcieEnableECRC (
-  EFI_PCI_IO_PROTOCOL  *PciIo
+  IN CONST PCIE_DEVICE_INFO  *Info
   )
 {
   EFI_STATUS                    Status;
+  EFI_PCI_IO_PROTOCOL           *PciIo;
   UINTN                         Segment, Bus, Device, Function;
   UINT32                        AerCapOffset, Offset;
   UINT32                        Val, New_Val;
@@ -1584,9 +1695,12 @@ PcieEnableECRC (
   TEGRABL_EARLY_BOOT_VARIABLES  *Mb1Config = NULL;
   UINTN                         ChipId;
 
-  ChipId = TegraGetChipID ();
-  Status = PciIo->GetLocation (PciIo, &Segment, &Bus, &Device, &Function);
-  ASSERT_EFI_ERROR (Status);
+  ChipId   = TegraGetChipID ();
+  PciIo    = Info->PciIo;
+  Segment  = Info->Segment;
+  Bus      = Info->Bus;
+  Device   = Info->Device;
+  Function = Info->Function;
 
   Socket = PcieIdToSocket (Segment);
   Ctrl   = PcieIdToInterface (Segment);
@@ -1615,7 +1729,7 @@ PcieEnableECRC (
     }
   }
 
-  AerCapOffset = PcieFindExtCap (PciIo, PCI_EXPRESS_EXTENDED_CAPABILITY_ADVANCED_ERROR_REPORTING_ID);
+  AerCapOffset = Info->AerCapOffset;
   if (AerCapOffset) {
     Offset = AerCapOffset + OFFSET_OF (PCI_EXPRESS_EXTENDED_CAPABILITIES_ADVANCED_ERROR_REPORTING, AdvancedErrorCapabilitiesAndControl);
     Status = PciIo->Pci.Read (
@@ -1666,127 +1780,41 @@ PcieEnableECRC (
 }
 
 /**
-  Get next PCI IO protocol
-
-  @param  PciIo               The PCI IO protocol instance.
-  @param  HandleCount         Handle Count of PCI IO protocol
-  @param  HandleBuffer        Handle Buffer of PCI IO protocol
-
-  @retval                     Next PciIo protocol. If NULL, means the input
-                              pciio protocol is the last one within handle buffer
-
-**/
-STATIC
-EFI_PCI_IO_PROTOCOL *
-GetNextPciIoInstance (
-  IN EFI_PCI_IO_PROTOCOL  *PciIo,
-  IN UINTN                HandleCount,
-  IN EFI_HANDLE           *HandleBuffer
-  )
-{
-  EFI_STATUS           Status;
-  UINTN                Index;
-  EFI_PCI_IO_PROTOCOL  *TempPciIo;
-
-  if ((HandleBuffer == NULL) || (HandleCount == 0)) {
-    return NULL;
-  }
-
-  TempPciIo = NULL;
-
-  for (Index = 0; Index < HandleCount; Index++) {
-    Status = gBS->HandleProtocol (
-                    HandleBuffer[Index],
-                    &gEfiPciIoProtocolGuid,
-                    (VOID **)&TempPciIo
-                    );
-    if (EFI_ERROR (Status)) {
-      continue;
-    }
+  Checks if a device supports being a 10Bit Tag Completer
 
-    //
-    // Matching the instance.
-    //
-    if (TempPciIo == PciIo) {
-      //
-      // moving to the next instance.
-      //
-      Index++;
-      break;
-    }
-  }
-
-  //
-  // Get the next valid PciIo protocol.
-  //
-  if (TempPciIo != NULL) {
-    for (TempPciIo = NULL; Index < HandleCount; Index++) {
-      Status = gBS->HandleProtocol (
-                      HandleBuffer[Index],
-                      &gEfiPciIoProtocolGuid,
-                      (VOID **)&TempPciIo
-                      );
-      if (!EFI_ERROR (Status)) {
-        break;
-      }
-    }
-  }
-
-  return TempPciIo;
-}
-
-/**
-  Checks if Root Port and tree below given root port supports
-  10Bit Tag Completer supported
-
-  @param  PciIo               The PCI IO protocol instance.
-  @param  RpSegment           Root port segment
-  @param  HandleCount         Handle Count of PCI IO protocol
-  @param  HandleBuffer        Handle Buffer of PCI IO protocol
+  @param  Info                Cached device.
 
   @retval  TRUE
            FALSE  Otherwise
 **/
 STATIC
 BOOLEAN
-Recursive10BitTagCompleterCheck (
-  IN EFI_PCI_IO_PROTOCOL  *PciIo,
-  IN UINTN                RpSegment,
-  IN UINTN                HandleCount,
-  IN EFI_HANDLE           *HandleBuffer
+Pcie10BitTagCompleterSupported (
+  IN CONST PCIE_DEVICE_INFO  *Info
   )
 {
   EFI_STATUS                       Status;
-  UINT32                           ExtTag10BitCompleterSupport;
-  UINT32                           SubTree10BitTagSupport;
-  EFI_PCI_IO_PROTOCOL              *NextPciIo;
-  UINTN                            Segment, Bus, Device, Function;
+  EFI_PCI_IO_PROTOCOL              *PciIo;
   PCI_REG_PCIE_DEVICE_CAPABILITY   DeviceCapability;
   PCI_REG_PCIE_DEVICE_CAPABILITY2  DeviceCapability2;
-  UINT32                           PciExpCapOffset, Offset;
+  UINT32                           Offset;
 
-  ExtTag10BitCompleterSupport = FALSE;
-  SubTree10BitTagSupport      = FALSE;
-  NextPciIo                   = NULL;
+  PciIo = Info->PciIo;
 
-  Status = PciIo->GetLocation (PciIo, &Segment, &Bus, &Device, &Function);
-  ASSERT_EFI_ERROR (Status);
-
-  PciExpCapOffset = PcieFindCap (PciIo, EFI_PCI_CAPABILITY_ID_PCIEXP);
-  if (PciExpCapOffset == 0) {
+  if (Info->PciExpCapOffset == 0) {
     DEBUG ((
       DEBUG_INFO,
       "Device [%04x:%02x:%02x.%x] doesn't support ExtendedTag. \
          Hence skipping 10-bit tags configuration\n",
-      Segment,
-      Bus,
-      Device,
-      Function
+      Info->Segment,
+      Info->Bus,
+      Info->Device,
+      Info->Function
       ));
-    goto Done;
+    return FALSE;
   }
 
-  Offset = PciExpCapOffset + OFFSET_OF (PCI_CAPABILITY_PCIEXP, DeviceCapability);
+  Offset = Info->PciExpCapOffset + OFFSET_OF (PCI_CAPABILITY_PCIEXP, DeviceCapability);
   Status = PciIo->Pci.Read (
                         PciIo,
                         EfiPciIoWidthUint32,
@@ -1800,15 +1828,15 @@ Recursive10BitTagCompleterCheck (
       DEBUG_INFO,
       "Device [%04x:%02x:%02x.%x] doesn't support ExtendedTag. \
          Hence skipping 10-bit tags configuration\n",
-      Segment,
-      Bus,
-      Device,
-      Function
+      Info->Segment,
+      Info->Bus,
+      Info->Device,
+      Info->Function
       ));
-    goto Done;
+    return FALSE;
   }
 
-  Offset = PciExpCapOffset + OFFSET_OF (PCI_CAPABILITY_PCIEXP, DeviceCapability2);
+  Offset = Info->PciExpCapOffset + OFFSET_OF (PCI_CAPABILITY_PCIEXP, DeviceCapability2);
   Status = PciIo->Pci.Read (
                         PciIo,
                         EfiPciIoWidthUint32,
@@ -1824,84 +1852,57 @@ Recursive10BitTagCompleterCheck (
       DEBUG_ERROR,
       "Device [%04x:%02x:%02x.%x] doesn't support 10 bit tag completer. \
          Hence skipping 10-bit tags configuration\n",
-      Segment,
-      Bus,
-      Device,
-      Function
+      Info->Segment,
+      Info->Bus,
+      Info->Device,
+      Info->Function
       ));
-    goto Done;
-  }
-
-  ExtTag10BitCompleterSupport = TRUE;
-
-  if (ExtTag10BitCompleterSupport == TRUE) {
-    NextPciIo = GetNextPciIoInstance (PciIo, HandleCount, HandleBuffer);
-    if (NextPciIo != NULL) {
-      if (!EFI_ERROR (Status) && (Segment == RpSegment)) {
-        SubTree10BitTagSupport = Recursive10BitTagCompleterCheck (
-                                   NextPciIo,
-                                   RpSegment,
-                                   HandleCount,
-                                   HandleBuffer
-                                   );
-        ExtTag10BitCompleterSupport &= SubTree10BitTagSupport;
-      }
-    }
+    return FALSE;
   }
 
-Done:
-  return ExtTag10BitCompleterSupport;
+  return TRUE;
 }
 
 /**
-  Enable 10Bit tag requester for all the downstream devices.
+  Enable Extended Tag and 10Bit tag requester for a device.
 
-  @param  PciIo               The PCI IO protocol instance.
-  @param  RpSegment           Root port segment
-  @param  HandleCount         Handle Count of PCI IO protocol
-  @param  HandleBuffer        Handle Buffer of PCI IO protocol
+  @param  Info                Cached device.
 
   @retval EFI_STATUS          Returns EFI_SUCCESS if 10Bit tag requester
                               enabled successfully.
 **/
+STATIC
 EFI_STATUS
-Recursive10BitTagRequestSet (
-  EFI_PCI_IO_PROTOCOL  *PciIo,
-  UINTN                RpSegment,
-  UINTN                HandleCount,
-  EFI_HANDLE           *HandleBuffer
+Pcie10BitTagRequestSet (
+  IN CONST PCIE_DEVICE_INFO  *Info
   )
 {
-  EFI_PCI_IO_PROTOCOL              *NextPciIo;
   EFI_STATUS                       Status;
-  UINTN                            Segment, Bus, Device, Function;
+  EFI_PCI_IO_PROTOCOL              *PciIo;
   PCI_REG_PCIE_DEVICE_CAPABILITY2  DeviceCapability2;
   PCI_REG_PCIE_DEVICE_CONTROL      DeviceControl;
   PCI_REG_PCIE_DEVICE_CONTROL2     DeviceControl2;
-  UINT32                           PciExpCapOffset, Offset;
+  UINT32                           Offset;
 
-  NextPciIo = NULL;
-  Status    = PciIo->GetLocation (PciIo, &Segment, &Bus, &Device, &Function);
-  ASSERT_EFI_ERROR (Status);
+  PciIo = Info->PciIo;
 
   /* Enable Extended Tag */
-  PciExpCapOffset = PcieFindCap (PciIo, EFI_PCI_CAPABILITY_ID_PCIEXP);
-  Offset          = PciExpCapOffset + OFFSET_OF (PCI_CAPABILITY_PCIEXP, DeviceControl);
-  Status          = PciIo->Pci.Read (
-                                 PciIo,
-                                 EfiPciIoWidthUint16,
-                                 Offset,
-                                 1,
-                                 &DeviceControl.Uint16
-                                 );
+  Offset = Info->PciExpCapOffset + OFFSET_OF (PCI_CAPABILITY_PCIEXP, DeviceControl);
+  Status = PciIo->Pci.Read (
+                        PciIo,
+                        EfiPciIoWidthUint16,
+                        Offset,
+                        1,
+                        &DeviceControl.Uint16
+                        );
   if (EFI_ERROR (Status)) {
     DEBUG ((
       DEBUG_ERROR,
       "Device [%04x:%02x:%02x.%x] : Enabled ExtendedTagField failed\n",
-      Segment,
-      Bus,
-      Device,
-      Function
+      Info->Segment,
+      Info->Bus,
+      Info->Device,
+      Info->Function
       ));
   }
 
@@ -1918,14 +1919,14 @@ Recursive10BitTagRequestSet (
     DEBUG ((
       DEBUG_ERROR,
       "Device [%04x:%02x:%02x.%x] : Enabled ExtendedTagField failed\n",
-      Segment,
-      Bus,
-      Device,
-      Function
+      Info->Segment,
+      Info->Bus,
+      Info->Device,
+      Info->Function
       ));
   }
 
-  Offset = PciExpCapOffset + OFFSET_OF (PCI_CAPABILITY_PCIEXP, DeviceCapability2);
+  Offset = Info->PciExpCapOffset + OFFSET_OF (PCI_CAPABILITY_PCIEXP, DeviceCapability2);
   Status = PciIo->Pci.Read (
                         PciIo,
                         EfiPciIoWidthUint32,
@@ -1935,7 +1936,7 @@ Recursive10BitTagRequestSet (
                         );
 
   if (!EFI_ERROR (Status) && (DeviceCapability2.Bits.TenBitTagRequesterSupported == TRUE)) {
-    Offset = PciExpCapOffset + OFFSET_OF (PCI_CAPABILITY_PCIEXP, DeviceControl2);
+    Offset = Info->PciExpCapOffset + OFFSET_OF (PCI_CAPABILITY_PCIEXP, DeviceControl2);
     Status = PciIo->Pci.Read (
                           PciIo,
                           EfiPciIoWidthUint16,
@@ -1957,35 +1958,24 @@ Recursive10BitTagRequestSet (
         DEBUG ((
           DEBUG_ERROR,
           "Device [%04x:%02x:%02x.%x] : Enabled 10Bit tag requester failed\n",
-          Segment,
-          Bus,
-          Device,
-          Function
+          Info->Segment,
+          Info->Bus,
+          Info->Device,
+          Info->Function
           ));
       }
     }
   }
 
-  NextPciIo = GetNextPciIoInstance (PciIo, HandleCount, HandleBuffer);
-  if (NextPciIo != NULL) {
-    Status = NextPciIo->GetLocation (NextPciIo, &Segment, &Bus, &Device, &Function);
-    if (!EFI_ERROR (Status) && (Segment == RpSegment)) {
-      Recursive10BitTagRequestSet (
-        NextPciIo,
-        RpSegment,
-        HandleCount,
-        HandleBuffer
-        );
-    }
-  }
-
   return Status;
 }
 
 /**
-  10Bit tag requester config.
+  10Bit tag requester config for a root port and the devices below it.
 
-  @param  PciIo               The PCI IO protocol instance.
+  @param  Devices             Cached devices of the root port subtree, starting
+                              with the root port.
+  @param  DeviceCount         Number of entries in Devices.
 
   @retval EFI_STATUS          Returns EFI_SUCCESS if 10Bit tag requester
                               configured successfully.
@@ -1993,26 +1983,16 @@ Recursive10BitTagRequestSet (
 STATIC
 EFI_STATUS
 PcieEnable10BitExtendedTag (
-  EFI_PCI_IO_PROTOCOL  *PciIo
+  IN CONST PCIE_DEVICE_INFO  *Devices,
+  IN UINTN                   DeviceCount
   )
 {
   EFI_STATUS  Status;
-  UINTN       Segment, Bus, Device, Function;
+  UINTN       Index;
   BOOLEAN     ExtTag10BitCompleterSupport;
-  UINTN       HandleCount;
-  EFI_HANDLE  *HandleBuffer;
   UINT64      Ext10bitTagReqEnable;
   UINTN       BufferSize;
 
-  Status = PciIo->GetLocation (PciIo, &Segment, &Bus, &Device, &Function);
-  ASSERT_EFI_ERROR (Status);
-  //
-  // Run on root port only
-  //
-  if (Bus != 0) {
-    return EFI_SUCCESS;
-  }
-
   BufferSize = sizeof (Ext10bitTagReqEnable);
   Status     = gRT->GetVariable (
                       L"Ext10bitTagReq",
@@ -2023,81 +2003,78 @@ PcieEnable10BitExtendedTag (
                       );
   if (EFI_ERROR (Status) ||
       (BufferSize != sizeof (Ext10bitTagReqEnable)) ||
-      ((Ext10bitTagReqEnable & (1ULL << Segment)) == 0ULL))
+      ((Ext10bitTagReqEnable & (1ULL << Devices[0].Segment)) == 0ULL))
   {
     DEBUG ((
       DEBUG_ERROR,
       "Device [%04x:%02x:%02x.%x] : Skipping 10Bit tag requester Enable\n",
-      Segment,
-      Bus,
-      Device,
-      Function
+      Devices[0].Segment,
+      Devices[0].Bus,
+      Devices[0].Device,
+      Devices[0].Function
       ));
 
     return EFI_SUCCESS;
   }
 
-  HandleCount  = 0;
-  HandleBuffer = NULL;
-  Status       = gBS->LocateHandleBuffer (
-                        ByProtocol,
-                        &gEfiPciIoProtocolGuid,
-                        NULL,
-                        &HandleCount,
-                        &HandleBuffer
-                        );
-  if (EFI_ERROR (Status)) {
-    return EFI_NOT_FOUND;
-  }
-
   //
-  // Check 10-bit tag completer capability before setting 10-bit tag requester.
+  // Check 10-bit tag completer capability of the whole subtree before setting
+  // 10-bit tag requester.
   //
-  ExtTag10BitCompleterSupport = Recursive10BitTagCompleterCheck (
-                                  PciIo,
-                                  Segment,
-                                  HandleCount,
-                                  HandleBuffer
-                                  );
+  ExtTag10BitCompleterSupport = TRUE;
+  for (Index = 0; Index < DeviceCount; Index++) {
+    if (!Pcie10BitTagCompleterSupported (&Devices[Index])) {
+      ExtTag10BitCompleterSupport = FALSE;
+      break;
+    }
+  }
+
   if (ExtTag10BitCompleterSupport == TRUE) {
-    Recursive10BitTagRequestSet (PciIo, Segment, HandleCount, HandleBuffer);
+    for (Index = 0; Index < DeviceCount; Index++) {
+      Pcie10BitTagRequestSet (&Devices[Index]);
+    }
   } else {
     DEBUG ((
       DEBUG_INFO,
       "Device [%04x:%02x:%02x.%x] : 10Bit tag requester not supported\n",
-      Segment,
-      Bus,
-      Device,
-      Function
+      Devices[0].Segment,
+      Devices[0].Bus,
+      Devices[0].Device,
+      Devices[0].Function
       ));
   }
 
-  if (HandleBuffer != NULL) {
-    gBS->FreePool (HandleBuffer);
-  }
-
   return EFI_SUCCESS;
 }
 
+/**
+  Applies the post enumeration configuration to a root port and the devices
+  below it.
+
+  @param  Devices             Cached devices of one segment, sorted by bus.
+  @param  DeviceCount         Number of entries in Devices.
+**/
 STATIC
-EFI_STATUS
-EFIAPI
-VisitEachPcieDevice (
-  IN EFI_HANDLE  Handle,
-  IN VOID        *Instance,
-  IN VOID        *Context
+VOID
+PcieConfigSubtree (
+  IN CONST PCIE_DEVICE_INFO  *Devices,
+  IN UINTN                   DeviceCount
   )
 {
-  EFI_PCI_IO_PROTOCOL  *PciIo;
+  CONST PCIE_DEVICE_INFO  *RootPort;
+  UINTN                   Index;
 
-  PciIo = Instance;
+  RootPort = (Devices[0].Bus == 0) ? &Devices[0] : NULL;
 
-  PcieEnable10BitExtendedTag (PciIo);
-  PcieConfigGPUDevice (PciIo);
-  PcieEnableErrorReporting (PciIo);
-  PcieEnableECRC (PciIo);
+  if (RootPort != NULL) {
+    PcieEnable10BitExtendedTag (Devices, DeviceCount);
+  }
 
-  return EFI_SUCCESS;
+  for (Index = 0; Index < DeviceCount; Index++) {
+    PcieConfigGPUDevice (Devices[Index].PciIo);
+    PcieEnableErrorReporting (&Devices[Index], RootPort);
+    PcieEnableECRC (&Devices[Index]);
+  }
 }
 
 STATIC
@@ -2107,11 +2084,39 @@ PcieConfigDevices (
   IN  VOID       *Context
   )
 {
-  VisitAllInstancesOfProtocol (
-    &gEfiPciIoProtocolGuid,
-    VisitEachPcieDevice,
-    NULL
-    );
+  EFI_STATUS        Status;
+  PCIE_DEVICE_INFO  *Devices;
+  UINTN             DeviceCount;
+  UINTN             Start;
+  UINTN             End;
+  UINT64            StartTime;
+
+  StartTime = GetTimeInNanoSecond (GetPerformanceCounter ());
+
+  Status = BuildPcieTopology (&Devices, &DeviceCount);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  for (Start = 0; Start < DeviceCount; Start = End) {
+    for (End = Start + 1; End < DeviceCount; End++) {
+      if (Devices[End].Segment != Devices[Start].Segment) {
+        break;
+      }
+    }
+
+    PcieConfigSubtree (&Devices[Start], End - Start);
+  }
+
+  FreePool (Devices);
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: Configured %u PCIe function(s) in %llu us\n",
+    __FUNCTION__,
+    DeviceCount,
+    (GetTimeInNanoSecond (GetPerformanceCounter ()) - StartTime) / 1000
+    ));
 }
 
 /**
@@ -2816,10 +2821,16 @@ DeviceDiscoveryNotify (
         break;
       }
 
+      if (mPcieControllerCount < ARRAY_SIZE (mPcieControllers)) {
+        mPcieControllers[mPcieControllerCount++] = Private;
+      }
+
       break;
 
     case DeviceDiscoveryEnumerationCompleted:
 
+      ReportControllerLinkStatus ();
+
       EfiCreateProtocolNotifyEvent (
         &gNVIDIABdsDeviceConnectCompleteGuid,
         TPL_CALLBACK,
@@ -16,6 +16,7 @@
 #include <ConfigurationManagerObject.h>
 #include <Protocol/ConfigurationManagerDataProtocol.h>
 #include <Protocol/EmbeddedGpio.h>
+#include <Protocol/PciIo.h>
 #include <TH500/TH500Definitions.h>
 
 #define BIT(x)  (1 << (x))
@@ -88,6 +89,13 @@ typedef struct {
   BOOLEAN                                             C2cInitSuccessful;
   NVIDIA_C2C_NODE_PROTOCOL                            *C2cProtocol;
 
+  // Bring up timing
+  BOOLEAN                                             LinkUp;
+  UINT64                                              InitStartNs;
+  UINT64                                              PerstReleaseNs;
+  UINT64                                              LinkUpNs;
+  UINT64                                              InitEndNs;
+
   // Configuration data
   CM_ARCH_COMMON_PCI_CONFIG_SPACE_INFO                ConfigSpaceInfo;
   UINT32                                              AddressMapCount;
@@ -99,6 +107,21 @@ typedef struct {
 } PCIE_CONTROLLER_PRIVATE;
 #define PCIE_CONTROLLER_PRIVATE_DATA_FROM_THIS(a)  CR(a, PCIE_CONTROLLER_PRIVATE, PcieRootBridgeConfigurationIo, PCIE_CONTROLLER_SIGNATURE)
 
+// Cached PCIe function used by the post enumeration configuration
+typedef struct {
+  EFI_PCI_IO_PROTOCOL    *PciIo;
+  UINTN                  Segment;
+  UINTN                  Bus;
+  UINTN                  Device;
+  UINTN                  Function;
+  UINT32                 PciExpCapOffset;
+  UINT32                 AerCapOffset;
+  UINT32                 DpcCapOffset;
+} PCIE_DEVICE_INFO;
+
+#define PCIE_DEVICE_INFO_KEY(a)  \
+  (LShiftU64 ((a)->Segment, 16) | ((a)->Bus << 8) | ((a)->Device << 3) | (a)->Function)
+
 #define PCIE_DEVICETREE_PREFETCHABLE  BIT30
 #define PCIE_DEVICETREE_SPACE_CODE    (BIT24 | BIT25)
 #define PCIE                          DEVICETREE_SPACE_CONF   0
@@ -13,7 +13,9 @@
 #include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/PrintLib.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/UefiLib.h>
 #include <Library/IoLib.h>
 #include <Library/DeviceDiscoveryDriverLib.h>
@@ -26,6 +28,323 @@
 
 #include "SdMmcControllerPrivate.h"
 
+#define MAX_SD_CONTROLLERS  16
+
+typedef struct {
+  EFI_PHYSICAL_ADDRESS    BaseAddress;
+  SDHCI_MODE_RECORD       Record;
+  SDHCI_SPEED_MODE        Target;   // Timing picked for this boot
+} SDHCI_SLOT_MODE;
+
+STATIC SDHCI_SLOT_MODE  mSlotModes[MAX_SD_CONTROLLERS];
+STATIC UINT32           mNumberOfSlotModes = 0;
+STATIC EFI_EVENT        mReadyToBootEvent  = NULL;
+
+/**
+  Get the eMMC bus timing the device tree allows for a slot.
+
+  @param[in]  DeviceTreeBase    Base of the device tree.
+  @param[in]  NodeOffset        Offset of the controller node.
+  @param[out] Mode              Fastest timing listed in the device tree.
+
+  @retval TRUE                  The device tree lists a timing.
+  @retval FALSE                 The device tree does not list a timing.
+**/
+STATIC
+BOOLEAN
+SdMmcGetDtSpeedMode (
+  IN  CONST VOID        *DeviceTreeBase,
+  IN  INT32             NodeOffset,
+  OUT SDHCI_SPEED_MODE  *Mode
+  )
+{
+  if (FdtGetProperty (DeviceTreeBase, NodeOffset, "mmc-hs400-1_8v", NULL) != NULL) {
+    *Mode = SdhciSpeedHs400;
+  } else if (FdtGetProperty (DeviceTreeBase, NodeOffset, "mmc-hs200-1_8v", NULL) != NULL) {
+    *Mode = SdhciSpeedHs200;
+  } else if (FdtGetProperty (DeviceTreeBase, NodeOffset, "mmc-ddr-1_8v", NULL) != NULL) {
+    *Mode = SdhciSpeedDdr;
+  } else {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Get the fastest eMMC bus timing allowed for a slot.
+
+  PcdSdhciHighSpeedDisable limits every slot to high speed, since only fixed
+  tap and trim values are programmed. Otherwise the timings listed in the
+  device tree are used, or all timings when it lists none.
+
+  @param[in]  DeviceTreeBase    Base of the device tree.
+  @param[in]  NodeOffset        Offset of the controller node.
+
+  @retval Fastest allowed SDHCI_SPEED_MODE
+**/
+STATIC
+SDHCI_SPEED_MODE
+SdMmcGetSpeedPolicy (
+  IN CONST VOID  *DeviceTreeBase,
+  IN INT32       NodeOffset
+  )
+{
+  SDHCI_SPEED_MODE  Mode;
+
+  if (PcdGetBool (PcdSdhciHighSpeedDisable)) {
+    return SdhciSpeedHs;
+  }
+
+  if (!SdMmcGetDtSpeedMode (DeviceTreeBase, NodeOffset, &Mode)) {
+    Mode = SdhciSpeedHs400;
+  }
+
+  if ((Mode > SdhciSpeedHs200) &&
+      (FdtGetProperty (DeviceTreeBase, NodeOffset, "no-mmc-hs400", NULL) != NULL))
+  {
+    Mode = SdhciSpeedHs200;
+  }
+
+  if (FdtGetProperty (DeviceTreeBase, NodeOffset, "no-1-8-v", NULL) != NULL) {
+    Mode = SdhciSpeedHs;
+  }
+
+  return Mode;
+}
+
+/**
+  Save the bus timing record of a slot.
+
+  @param[in]  SlotMode          Slot to save.
+**/
+STATIC
+VOID
+SdMmcSaveModeRecord (
+  IN SDHCI_SLOT_MODE  *SlotMode
+  )
+{
+  EFI_STATUS  Status;
+  CHAR16      Name[SDHCI_MODE_VARIABLE_NAME_LEN];
+
+  UnicodeSPrint (Name, sizeof (Name), SDHCI_MODE_VARIABLE_NAME_FORMAT, SlotMode->BaseAddress);
+  Status = gRT->SetVariable (
+                  Name,
+                  &gNVIDIATokenSpaceGuid,
+                  EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+                  sizeof (SlotMode->Record),
+                  &SlotMode->Record
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "%a: Failed to save %s: %r\n", __FUNCTION__, Name, Status));
+  }
+}
+
+/**
+  Step a slot down from the timing that failed on it.
+
+  @param[in,out]  Record        Bus timing record of the slot.
+  @param[in]      Failed        Timing that failed.
+**/
+STATIC
+VOID
+SdMmcStepDown (
+  IN OUT SDHCI_MODE_RECORD  *Record,
+  IN     SDHCI_SPEED_MODE   Failed
+  )
+{
+  Record->Limit        = (Failed > SdhciSpeedHs) ? (UINT8)(Failed - 1) : SdhciSpeedHs;
+  Record->FailedTrials = 0;
+  Record->GoodBoots    = 0;
+  Record->Recovering   = 1;
+}
+
+/**
+  Pick the bus timing to request for an embedded slot.
+
+  A timing faster than any that has worked before is put on trial and
+  recorded as pending. A boot that leaves a timing pending did not reach
+  ReadyToBoot, which a power loss also causes, so the slot only steps down
+  after SDHCI_MODE_MAX_FAILED_TRIALS such boots in a row.  The timing is
+  picked once per boot; later calls for the slot return the same timing.
+
+  @param[in]  BaseAddress       Base address of the slot.
+  @param[in]  MaxMode           Fastest timing allowed by policy and capabilities.
+
+  @retval SDHCI_SPEED_MODE to request
+**/
+STATIC
+SDHCI_SPEED_MODE
+SdMmcGetStableMode (
+  IN EFI_PHYSICAL_ADDRESS  BaseAddress,
+  IN SDHCI_SPEED_MODE      MaxMode
+  )
+{
+  EFI_STATUS         Status;
+  SDHCI_SLOT_MODE    *SlotMode;
+  SDHCI_MODE_RECORD  Original;
+  SDHCI_SPEED_MODE   Target;
+  UINTN              DataSize;
+  UINT32             Index;
+  CHAR16             Name[SDHCI_MODE_VARIABLE_NAME_LEN];
+
+  for (Index = 0; Index < mNumberOfSlotModes; Index++) {
+    if (mSlotModes[Index].BaseAddress == BaseAddress) {
+      return mSlotModes[Index].Target;
+    }
+  }
+
+  if (mNumberOfSlotModes == MAX_SD_CONTROLLERS) {
+    return MaxMode;
+  }
+
+  SlotMode              = &mSlotModes[mNumberOfSlotModes++];
+  SlotMode->BaseAddress = BaseAddress;
+
+  UnicodeSPrint (Name, sizeof (Name), SDHCI_MODE_VARIABLE_NAME_FORMAT, BaseAddress);
+  DataSize = sizeof (SlotMode->Record);
+  Status   = gRT->GetVariable (Name, &gNVIDIATokenSpaceGuid, NULL, &DataSize, &SlotMode->Record);
+  CopyMem (&Original, &SlotMode->Record, sizeof (Original));
+
+  if (EFI_ERROR (Status) ||
+      (DataSize != sizeof (SlotMode->Record)) ||
+      (SlotMode->Record.Version != SDHCI_MODE_RECORD_VERSION) ||
+      (SlotMode->Record.Policy != MaxMode))
+  {
+    ZeroMem (&SlotMode->Record, sizeof (SlotMode->Record));
+    SlotMode->Record.Version   = SDHCI_MODE_RECORD_VERSION;
+    SlotMode->Record.Policy    = (UINT8)MaxMode;
+    SlotMode->Record.Limit     = (UINT8)MaxMode;
+    SlotMode->Record.Confirmed = SdhciSpeedUnknown;
+    SlotMode->Record.Pending   = SdhciSpeedUnknown;
+  }
+
+  if (SlotMode->Record.Pending != SdhciSpeedUnknown) {
+    SlotMode->Record.FailedTrials++;
+    DEBUG ((
+      DEBUG_WARN,
+      "%a: %lx: timing %u did not come up last boot (%u)\n",
+      __FUNCTION__,
+      BaseAddress,
+      SlotMode->Record.Pending,
+      SlotMode->Record.FailedTrials
+      ));
+    if (SlotMode->Record.FailedTrials >= SDHCI_MODE_MAX_FAILED_TRIALS) {
+      SdMmcStepDown (&SlotMode->Record, SlotMode->Record.Pending);
+    }
+
+    SlotMode->Record.Pending = SdhciSpeedUnknown;
+  }
+
+  Target = MIN (MaxMode, (SDHCI_SPEED_MODE)SlotMode->Record.Limit);
+  if ((Target > SdhciSpeedHs) &&
+      ((SlotMode->Record.Confirmed == SdhciSpeedUnknown) || (Target > SlotMode->Record.Confirmed)))
+  {
+    SlotMode->Record.Pending = (UINT8)Target;
+  }
+
+  SlotMode->Target = Target;
+  if (CompareMem (&Original, &SlotMode->Record, sizeof (Original)) != 0) {
+    SdMmcSaveModeRecord (SlotMode);
+  }
+
+  return Target;
+}
+
+/**
+  Check which bus timing each embedded slot on trial came up in.
+
+  @param[in]  Event             Event whose notification function is being invoked.
+  @param[in]  Context           Pointer to the notification function's context.
+**/
+STATIC
+VOID
+EFIAPI
+SdMmcReadyToBoot (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  SDHCI_SLOT_MODE   *SlotMode;
+  SDHCI_SPEED_MODE  Achieved;
+  UINT16            HostCtrl2;
+  UINT32            Index;
+  BOOLEAN           Running;
+
+  for (Index = 0; Index < mNumberOfSlotModes; Index++) {
+    SlotMode = &mSlotModes[Index];
+    Running  = ((MmioRead16 (SlotMode->BaseAddress + SD_MMC_HC_CLOCK_CTRL) & SD_MMC_CLK_CTRL_SD_CLK_EN) != 0);
+
+    if (SlotMode->Record.Pending == SdhciSpeedUnknown) {
+      //
+      // A slot that stepped down gets the faster timing back on trial after
+      // enough good boots at the slower one.
+      //
+      if (Running && (SlotMode->Record.Recovering != 0) && (SlotMode->Record.Limit < SlotMode->Record.Policy)) {
+        SlotMode->Record.GoodBoots++;
+        if (SlotMode->Record.GoodBoots >= SDHCI_MODE_RECOVERY_BOOTS) {
+          SlotMode->Record.Limit++;
+          SlotMode->Record.GoodBoots = 0;
+        }
+
+        SdMmcSaveModeRecord (SlotMode);
+      }
+
+      continue;
+    }
+
+    //
+    // A slot that was never brought up tells nothing about the timing
+    //
+    if (!Running) {
+      SlotMode->Record.Pending = SdhciSpeedUnknown;
+      SdMmcSaveModeRecord (SlotMode);
+      continue;
+    }
+
+    HostCtrl2 = MmioRead16 (SlotMode->BaseAddress + SD_MMC_HC_HOST_CTRL2);
+    switch (HostCtrl2 & SD_MMC_HC_UHS_MODE_MASK) {
+      case SD_MMC_HC_UHS_MODE_HS400:
+        Achieved = SdhciSpeedHs400;
+        break;
+      case SD_MMC_HC_UHS_MODE_HS200:
+        Achieved = SdhciSpeedHs200;
+        break;
+      case SD_MMC_HC_UHS_MODE_DDR:
+        Achieved = SdhciSpeedDdr;
+        break;
+      default:
+        Achieved = SdhciSpeedHs;
+        break;
+    }
+
+    if ((Achieved == SdhciSpeedHs200) && ((HostCtrl2 & SD_MMC_HC_SAMPLING_CLK_SELT) == 0)) {
+      //
+      // Tuning failed, so the device was left unusable in this timing
+      //
+      DEBUG ((DEBUG_WARN, "%a: %lx: HS200 tuning failed\n", __FUNCTION__, SlotMode->BaseAddress));
+      SdMmcStepDown (&SlotMode->Record, SdhciSpeedHs200);
+    } else {
+      //
+      // The device may support less than the host, in which case the slower
+      // timing it came up in is as fast as this slot gets and there is
+      // nothing to recover.
+      //
+      if (Achieved < SlotMode->Record.Pending) {
+        SlotMode->Record.Recovering = 0;
+      }
+
+      SlotMode->Record.Confirmed    = (UINT8)Achieved;
+      SlotMode->Record.Limit        = (UINT8)Achieved;
+      SlotMode->Record.FailedTrials = 0;
+    }
+
+    DEBUG ((DEBUG_INFO, "%a: %lx: requested timing %u, running %u\n", __FUNCTION__, SlotMode->BaseAddress, SlotMode->Record.Pending, Achieved));
+    SlotMode->Record.Pending = SdhciSpeedUnknown;
+    SdMmcSaveModeRecord (SlotMode);
+  }
+}
+
 /**
 
   Override function for SDHCI capability bits
@@ -50,6 +369,14 @@ SdMmcCapability (
 {
   EFI_STATUS                        Status;
   NVIDIA_DEVICE_TREE_NODE_PROTOCOL  *Node;
+  EFI_PHYSICAL_ADDRESS              SlotBaseAddress;
+  UINTN                             SlotSize;
+  CONST VOID                        *Property;
+  INT32                             PropertyLen;
+  UINT64                            RawCapability;
+  SDHCI_SPEED_MODE                  DtMode;
+  SDHCI_SPEED_MODE                  MaxMode;
+  SDHCI_SPEED_MODE                  Target;
 
   SD_MMC_HC_SLOT_CAP  *Capability = (SD_MMC_HC_SLOT_CAP *)SdMmcHcSlotCapability;
 
@@ -63,6 +390,22 @@ SdMmcCapability (
     return Status;
   }
 
+  //
+  // Generic SDHCI binding to mask and force capability bits, e.g. DMA modes
+  //
+  CopyMem (&RawCapability, Capability, sizeof (RawCapability));
+  Property = FdtGetProp (Node->DeviceTreeBase, Node->NodeOffset, "sdhci-caps-mask", &PropertyLen);
+  if ((Property != NULL) && (PropertyLen == sizeof (UINT64))) {
+    RawCapability &= ~Fdt64ToCpu (ReadUnaligned64 (Property));
+  }
+
+  Property = FdtGetProp (Node->DeviceTreeBase, Node->NodeOffset, "sdhci-caps", &PropertyLen);
+  if ((Property != NULL) && (PropertyLen == sizeof (UINT64))) {
+    RawCapability |= Fdt64ToCpu (ReadUnaligned64 (Property));
+  }
+
+  CopyMem (Capability, &RawCapability, sizeof (RawCapability));
+
   if (NULL != FdtGetProperty (Node->DeviceTreeBase, Node->NodeOffset, "non-removable", NULL)) {
     Capability->SlotType = 0x1; // Embedded slot
   }
@@ -75,6 +418,57 @@ SdMmcCapability (
     Capability->Adma2 = 0;
   }
 
+  Property = FdtGetProp (Node->DeviceTreeBase, Node->NodeOffset, "bus-width", &PropertyLen);
+  if ((Property != NULL) && (PropertyLen == sizeof (UINT32)) && (Fdt32ToCpu (ReadUnaligned32 (Property)) < 8)) {
+    Capability->BusWidth8 = 0;
+  }
+
+  //
+  // Timings listed in the device tree are advertised even when the
+  // controller does not report them, unless high speed timings are disabled.
+  //
+  if (!PcdGetBool (PcdSdhciHighSpeedDisable) &&
+      SdMmcGetDtSpeedMode (Node->DeviceTreeBase, Node->NodeOffset, &DtMode))
+  {
+    Capability->Ddr50  = (FdtGetProperty (Node->DeviceTreeBase, Node->NodeOffset, "mmc-ddr-1_8v", NULL) != NULL) ? 1 : Capability->Ddr50;
+    Capability->Sdr104 = (DtMode >= SdhciSpeedHs200) ? 1 : Capability->Sdr104;
+    Capability->Hs400  = (DtMode >= SdhciSpeedHs400) ? 1 : Capability->Hs400;
+  }
+
+  if ((Capability->Hs400 != 0) && (Capability->BusWidth8 != 0)) {
+    MaxMode = SdhciSpeedHs400;
+  } else if (Capability->Sdr104 != 0) {
+    MaxMode = SdhciSpeedHs200;
+  } else if (Capability->Ddr50 != 0) {
+    MaxMode = SdhciSpeedDdr;
+  } else {
+    MaxMode = SdhciSpeedHs;
+  }
+
+  MaxMode = MIN (MaxMode, SdMmcGetSpeedPolicy (Node->DeviceTreeBase, Node->NodeOffset));
+
+  Target = MaxMode;
+  if ((Capability->SlotType == 0x1) &&
+      !EFI_ERROR (DeviceDiscoveryGetMmioRegion (ControllerHandle, Slot, &SlotBaseAddress, &SlotSize)))
+  {
+    Target = SdMmcGetStableMode (SlotBaseAddress, MaxMode);
+  }
+
+  if (Target < SdhciSpeedHs400) {
+    Capability->Hs400 = 0;
+  }
+
+  if (Target < SdhciSpeedHs200) {
+    Capability->Sdr104 = 0;
+    Capability->Sdr50  = 0;
+  }
+
+  if (Target < SdhciSpeedDdr) {
+    Capability->Ddr50 = 0;
+  }
+
+  DEBUG ((DEBUG_INFO, "%a: slot %u max timing %u, requesting %u\n", __FUNCTION__, Slot, MaxMode, Target));
+
   return EFI_SUCCESS;
 }
 
@@ -159,7 +553,6 @@ NVIDIA_DEVICE_DISCOVERY_CONFIG  gDeviceDiscoverDriverConfig = {
   .DisableInRcm                    = TRUE
 };
 
-#define MAX_SD_CONTROLLERS  16
 STATIC EFI_PHYSICAL_ADDRESS  mSdhciBaseAddress[MAX_SD_CONTROLLERS];
 STATIC UINT32                mNumberOfSdhciControllers = 0;
 
@@ -218,6 +611,18 @@ DeviceDiscoveryNotify (
 
   switch (Phase) {
     case DeviceDiscoveryDriverStart:
+      Status = gBS->CreateEventEx (
+                      EVT_NOTIFY_SIGNAL,
+                      TPL_CALLBACK,
+                      SdMmcReadyToBoot,
+                      NULL,
+                      &gEfiEventReadyToBootGuid,
+                      &mReadyToBootEvent
+                      );
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "%a: Failed to create ReadyToBoot event: %r\n", __FUNCTION__, Status));
+      }
+
       return gBS->InstallMultipleProtocolInterfaces (
                     &DriverHandle,
                     &gEdkiiSdMmcOverrideProtocolGuid,
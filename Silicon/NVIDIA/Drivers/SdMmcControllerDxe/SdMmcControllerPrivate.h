@@ -2,7 +2,7 @@
 
   SD MMC Controller Driver private structures
 
-  SPDX-FileCopyrightText: Copyright (c) 2018-2024, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2018-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -51,6 +51,45 @@
 #define SD_MMC_HC_64_ADDR_EN           13
 #define SD_MMC_HC_26_DATA_LEN_ADMA_EN  10
 
+// UHS mode select and sampling clock select fields of HOST_CTRL2
+#define SD_MMC_HC_UHS_MODE_MASK      (BIT0 | BIT1 | BIT2)
+#define SD_MMC_HC_UHS_MODE_HS200     0x3
+#define SD_MMC_HC_UHS_MODE_DDR       0x4
+#define SD_MMC_HC_UHS_MODE_HS400     0x5
+#define SD_MMC_HC_SAMPLING_CLK_SELT  BIT7
+
+///
+/// eMMC bus timings the capability override can allow, slowest first
+///
+typedef enum {
+  SdhciSpeedHs,
+  SdhciSpeedDdr,
+  SdhciSpeedHs200,
+  SdhciSpeedHs400,
+  SdhciSpeedUnknown = 0xFF
+} SDHCI_SPEED_MODE;
+
+//
+// Per slot record of which bus timing came up, so a timing that fails to
+// tune is not retried on every boot. Keyed by the slot base address.
+//
+#define SDHCI_MODE_VARIABLE_NAME_FORMAT  L"SdhciMode%lx"
+#define SDHCI_MODE_VARIABLE_NAME_LEN     32
+#define SDHCI_MODE_RECORD_VERSION        2
+#define SDHCI_MODE_MAX_FAILED_TRIALS     3  // Unfinished boots in a row before stepping down
+#define SDHCI_MODE_RECOVERY_BOOTS        8  // Good boots before retrying a faster timing
+
+typedef struct {
+  UINT8    Version;
+  UINT8    Policy;       // SDHCI_SPEED_MODE allowed by DT and PCDs when written
+  UINT8    Limit;        // Fastest SDHCI_SPEED_MODE not known to fail
+  UINT8    Confirmed;    // Fastest SDHCI_SPEED_MODE seen working, or unknown
+  UINT8    Pending;      // SDHCI_SPEED_MODE on trial this boot, or unknown
+  UINT8    FailedTrials; // Boots in a row that left Pending set
+  UINT8    GoodBoots;    // Good boots since the last step down
+  UINT8    Recovering;   // Limit was lowered by a failure, not by the device
+} SDHCI_MODE_RECORD;
+
 typedef struct {
   UINT32    TimeoutFreq   : 6; // bit 0:5
   UINT32    Reserved      : 1; // bit 6
@@ -0,0 +1,420 @@
+/** @file
+  Host based throughput benchmarks of the sequential record storage, run
+  against a virtual NOR flash device with the latencies of a typical quad
+  SPI NOR device.
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/MmServicesTableLib.h>
+#include <Library/UnitTestLib.h>
+
+#include <HostBasedTestStubLib/HostBenchmarkLib.h>
+#include <HostBasedTestStubLib/MmServicesTableStubLib.h>
+#include <HostBasedTestStubLib/NorFlashStubLib.h>
+#include <HostBasedTestStubLib/StandaloneMmOpteeStubLib.h>
+
+// So that we can reference SequentialRecord declarations
+#include "../SequentialRecordPrivate.h"
+
+#define UNIT_TEST_APP_NAME     "SequentialRecord Benchmark Application"
+#define UNIT_TEST_APP_VERSION  "0.1"
+
+#define BLOCK_SIZE            SIZE_64KB
+#define NUM_BLOCKS            8
+#define TOTAL_NOR_FLASH_SIZE  (NUM_BLOCKS * BLOCK_SIZE)
+#define PARTITION_OFFSET      BLOCK_SIZE
+#define PARTITION_BLOCKS      4
+#define PARTITION_SIZE        (PARTITION_BLOCKS * BLOCK_SIZE)
+#define MAX_RECORD_SIZE       SIZE_1KB
+#define WRITE_ITERATIONS      1024
+#define READ_ITERATIONS       1024
+#define PREFILL_RECORDS       128   // Fit in one block so all can be read back
+#define SOCKET                0
+
+typedef struct {
+  CONST CHAR8    *Name;
+  UINT32         Size;      // Bytes per record
+  UINT32         Prefill;   // Records written before timing starts
+} BENCHMARK_CONTEXT;
+
+EFI_STATUS
+EFIAPI
+SequentialStorageInit (
+  IN EFI_HANDLE           ImageHandle,
+  IN EFI_MM_SYSTEM_TABLE  *MmSystemTable
+  );
+
+STATIC UINT8                       *mFlashMemory;
+STATIC NVIDIA_NOR_FLASH_PROTOCOL   *mNorFlash;
+STATIC NVIDIA_SEQ_RECORD_PROTOCOL  *mSeqProtocol;
+STATIC UINT8                       *mBuffer;
+
+STATIC BENCHMARK_CONTEXT  mWrite64  = { "SeqRecord write 64B", 64, 0 };
+STATIC BENCHMARK_CONTEXT  mWrite256 = { "SeqRecord write 256B", 256, 0 };
+STATIC BENCHMARK_CONTEXT  mWrite1K  = { "SeqRecord write 1KB", SIZE_1KB, 0 };
+STATIC BENCHMARK_CONTEXT  mReadLast = { "SeqRecord read last 256B", 256, PREFILL_RECORDS };
+STATIC BENCHMARK_CONTEXT  mReadNth  = { "SeqRecord read nth from end 256B", 256, PREFILL_RECORDS };
+
+/**
+  Partition lookup used by SequentialStorageInit. Only the RAS error log
+  partition is present in the benchmark flash layout.
+
+  @param[in]   PartitionIndex  Index of the partition to look up.
+  @param[out]  PartitionInfo   Offset and size of the partition.
+
+  @retval      EFI_SUCCESS     The partition was found.
+  @retval      EFI_NOT_FOUND   The partition isn't part of the layout.
+**/
+EFI_STATUS
+GetPartitionData (
+  IN  UINT32          PartitionIndex,
+  OUT PARTITION_INFO  *PartitionInfo
+  )
+{
+  if (PartitionIndex != TEGRABL_RAS_ERROR_LOGS) {
+    return EFI_NOT_FOUND;
+  }
+
+  PartitionInfo->PartitionByteOffset = PARTITION_OFFSET;
+  PartitionInfo->PartitionSize       = PARTITION_SIZE;
+  PartitionInfo->PartitionIndex      = PartitionIndex;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Capture the sequential record protocol installed by SequentialStorageInit.
+
+  @param[in, out]  UserHandle     Handle to install the protocol on.
+  @param[in]       Protocol       GUID of the protocol.
+  @param[in]       InterfaceType  Type of the interface.
+  @param[in]       Interface      Protocol interface.
+
+  @retval          EFI_SUCCESS    The interface was captured.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkInstallProtocolInterface (
+  IN OUT EFI_HANDLE      *UserHandle,
+  IN EFI_GUID            *Protocol,
+  IN EFI_INTERFACE_TYPE  InterfaceType,
+  IN VOID                *Interface
+  )
+{
+  if (CompareGuid (Protocol, &gNVIDIASequentialStorageGuid)) {
+    mSeqProtocol = (NVIDIA_SEQ_RECORD_PROTOCOL *)Interface;
+  }
+
+  *UserHandle = (EFI_HANDLE)Interface;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Erase the flash and write the records a benchmark reads back.
+
+  @param Context                      Benchmark to prepare for
+
+  @retval UNIT_TEST_PASSED            Setup succeeded.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BenchmarkSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  EFI_STATUS         Status;
+  UINTN              Index;
+
+  Bench = (BENCHMARK_CONTEXT *)Context;
+
+  Status = mSeqProtocol->ErasePartition (mSeqProtocol, SOCKET);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  for (Index = 0; Index < Bench->Prefill; Index++) {
+    SetMem (mBuffer, Bench->Size, (UINT8)Index);
+    Status = mSeqProtocol->WriteNext (mSeqProtocol, SOCKET, mBuffer, Bench->Size);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Append records to the partition, wrapping around its blocks.
+
+  @param Context                      Benchmark to run
+
+  @retval UNIT_TEST_PASSED            All assertions passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+WriteNextBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  HOST_BENCHMARK     Benchmark;
+  EFI_STATUS         Status;
+  UINTN              Index;
+
+  Bench = (BENCHMARK_CONTEXT *)Context;
+  SetMem (mBuffer, Bench->Size, 0x5A);
+
+  HostBenchmarkStart (&Benchmark, Bench->Name, mNorFlash);
+  for (Index = 0; Index < WRITE_ITERATIONS; Index++) {
+    Status = mSeqProtocol->WriteNext (mSeqProtocol, SOCKET, mBuffer, Bench->Size);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  HostBenchmarkStop (&Benchmark, WRITE_ITERATIONS);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Read the last record of the partition.
+
+  @param Context                      Benchmark to run
+
+  @retval UNIT_TEST_PASSED            All assertions passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReadLastBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  HOST_BENCHMARK     Benchmark;
+  EFI_STATUS         Status;
+  UINTN              Index;
+
+  Bench = (BENCHMARK_CONTEXT *)Context;
+
+  HostBenchmarkStart (&Benchmark, Bench->Name, mNorFlash);
+  for (Index = 0; Index < READ_ITERATIONS; Index++) {
+    Status = mSeqProtocol->ReadLast (mSeqProtocol, SOCKET, mBuffer, MAX_RECORD_SIZE);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  HostBenchmarkStop (&Benchmark, READ_ITERATIONS);
+
+  UT_ASSERT_EQUAL (mBuffer[0], (UINT8)(Bench->Prefill - 1));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Look up records by their position from the end of the partition.
+
+  @param Context                      Benchmark to run
+
+  @retval UNIT_TEST_PASSED            All assertions passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReadNthBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  HOST_BENCHMARK     Benchmark;
+  EFI_STATUS         Status;
+  UINT32             Nth;
+  UINTN              Index;
+
+  Bench = (BENCHMARK_CONTEXT *)Context;
+
+  HostBenchmarkStart (&Benchmark, Bench->Name, mNorFlash);
+  for (Index = 0; Index < READ_ITERATIONS; Index++) {
+    Nth    = (Index % Bench->Prefill) + 1;
+    Status = mSeqProtocol->ReadNthRecordFromEnd (mSeqProtocol, SOCKET, Nth, mBuffer, MAX_RECORD_SIZE);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  HostBenchmarkStop (&Benchmark, READ_ITERATIONS);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Creates the virtual NOR flash device and initializes the sequential record
+  storage on top of it.
+
+  @retval EFI_SUCCESS           The benchmark data was set up.
+  @retval EFI_OUT_OF_RESOURCES  The benchmark data couldn't be allocated.
+  @retval EFI_NOT_FOUND         The storage didn't install its protocol.
+**/
+STATIC
+EFI_STATUS
+InitBenchmarkData (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = HostBenchmarkCreateNorFlash (TOTAL_NOR_FLASH_SIZE, BLOCK_SIZE, &mFlashMemory, &mNorFlash);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  mBuffer = AllocatePool (MAX_RECORD_SIZE);
+  if (mBuffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  StandaloneMmOpteeStubLibInitialize ();
+  Status = MockGetSocketNorFlashProtocol (SOCKET, mNorFlash);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  MmServicesTableInit ();
+  gMmst->MmInstallProtocolInterface = BenchmarkInstallProtocolInterface;
+
+  SequentialStorageInit (NULL, gMmst);
+  if (mSeqProtocol == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Frees the sequential record storage and the virtual NOR flash device.
+**/
+STATIC
+VOID
+CleanUpBenchmarkData (
+  VOID
+  )
+{
+  if (gMmst != NULL) {
+    MmServicesTableDeinit ();
+  }
+
+  StandaloneMmOpteeStubLibDestroy ();
+  HostBenchmarkDestroyNorFlash (mFlashMemory, mNorFlash);
+
+  if (mSeqProtocol != NULL) {
+    FreePool (mSeqProtocol);
+  }
+
+  if (mBuffer != NULL) {
+    FreePool (mBuffer);
+  }
+}
+
+/**
+  Initialze the unit test framework and suite for the benchmarks and run
+  them.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Fw;
+  UNIT_TEST_SUITE_HANDLE      SeqRecordSuite;
+
+  Fw = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  Status = InitBenchmarkData ();
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to setup Benchmark Data %r\n", Status));
+    goto ExitUnitTestingEntry;
+  }
+
+  Status = InitUnitTestFramework (
+             &Fw,
+             UNIT_TEST_APP_NAME,
+             gEfiCallerBaseName,
+             UNIT_TEST_APP_VERSION
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto ExitUnitTestingEntry;
+  }
+
+  Status = CreateUnitTestSuite (
+             &SeqRecordSuite,
+             Fw,
+             "SequentialRecord Benchmarks",
+             "SequentialRecord.BenchmarkSuite",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for SequentialRecord\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto ExitUnitTestingEntry;
+  }
+
+  // AddTestCase Args:
+  //  Suite | Description
+  //  Class Name | Function
+  //  Pre | Post | Context
+
+  AddTestCase (SeqRecordSuite, "64B record writes", "Write64", WriteNextBenchmark, BenchmarkSetup, NULL, &mWrite64);
+  AddTestCase (SeqRecordSuite, "256B record writes", "Write256", WriteNextBenchmark, BenchmarkSetup, NULL, &mWrite256);
+  AddTestCase (SeqRecordSuite, "1KB record writes", "Write1K", WriteNextBenchmark, BenchmarkSetup, NULL, &mWrite1K);
+  AddTestCase (SeqRecordSuite, "Last record reads", "ReadLast", ReadLastBenchmark, BenchmarkSetup, NULL, &mReadLast);
+  AddTestCase (SeqRecordSuite, "Nth from end record reads", "ReadNth", ReadNthBenchmark, BenchmarkSetup, NULL, &mReadNth);
+
+  Status = RunAllTestSuites (Fw);
+
+ExitUnitTestingEntry:
+  if (Fw) {
+    FreeUnitTestFramework (Fw);
+  }
+
+  CleanUpBenchmarkData ();
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UnitTestingEntry ();
+}
@@ -0,0 +1,46 @@
+/** @file
+
+  Android sparse image format, as produced by img2simg and the fastboot host
+  tool when an image is larger than max-download-size.
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __ANDROID_SPARSE_IMAGE_H__
+#define __ANDROID_SPARSE_IMAGE_H__
+
+#include <Uefi/UefiBaseType.h>
+
+#define SPARSE_HEADER_MAGIC          0xED26FF3A
+#define SPARSE_HEADER_MAJOR_VERSION  1
+
+#define SPARSE_CHUNK_TYPE_RAW        0xCAC1
+#define SPARSE_CHUNK_TYPE_FILL       0xCAC2
+#define SPARSE_CHUNK_TYPE_DONT_CARE  0xCAC3
+#define SPARSE_CHUNK_TYPE_CRC32      0xCAC4
+
+#pragma pack(1)
+typedef struct {
+  UINT32    Magic;
+  UINT16    MajorVersion;
+  UINT16    MinorVersion;
+  UINT16    FileHeaderSize;         // Size of this header, may be larger than the struct
+  UINT16    ChunkHeaderSize;        // Size of SPARSE_CHUNK_HEADER, may be larger than the struct
+  UINT32    BlockSize;              // Must be a multiple of 4
+  UINT32    TotalBlocks;            // Blocks in the expanded image
+  UINT32    TotalChunks;
+  UINT32    ImageChecksum;
+} SPARSE_HEADER;
+
+typedef struct {
+  UINT16    ChunkType;
+  UINT16    Reserved;
+  UINT32    ChunkSize;              // In blocks of the expanded image
+  UINT32    TotalSize;              // In bytes, including this header
+} SPARSE_CHUNK_HEADER;
+#pragma pack()
+
+#endif
@@ -24,6 +24,8 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 
+#include "AndroidSparseImage.h"
+
 #define GPT_PARTITION_NAME_LENGTH  36
 
 //
@@ -46,7 +48,14 @@
 #define FB_LARGE_HEAD_BYTES      ((UINT64)256 * SIZE_1MB)
 #define FB_FULL_ERASE_THRESHOLD  ((UINT64)512 * SIZE_1MB)
 
-STATIC UINT8  *mEraseBuffer = NULL;
+#define FB_ERASE_PATTERN  MAX_UINT32
+
+//
+// The erase buffer is also the source for sparse image FILL chunks; it is
+// only refilled when the requested pattern differs from its contents.
+//
+STATIC UINT8   *mEraseBuffer = NULL;
+STATIC UINT32  mEraseBufferPattern;
 
 /**
   Locate a GPT partition by ASCII name. Returns the BlockIo (and
@@ -143,13 +152,15 @@ FindGptPartition (
 }
 
 /**
-  Get-or-allocate a 4 MiB page-aligned scratch buffer prefilled with
-  0xFF, used as the source for partition wiping.
+  Get-or-allocate a 4 MiB page-aligned scratch buffer filled with the
+  32-bit Pattern, used as the source for partition wiping and sparse
+  image FILL chunks.
 **/
 STATIC
 EFI_STATUS
-GetEraseBuffer (
-  OUT UINT8  **BufOut
+GetFillBuffer (
+  IN  UINT32  Pattern,
+  OUT UINT8   **BufOut
   )
 {
   if (mEraseBuffer == NULL) {
@@ -158,13 +169,289 @@ GetEraseBuffer (
       return EFI_OUT_OF_RESOURCES;
     }
 
-    SetMem (mEraseBuffer, FB_ERASE_BUF_SIZE, 0xFF);
+    mEraseBufferPattern = ~Pattern;
+  }
+
+  if (mEraseBufferPattern != Pattern) {
+    SetMem32 (mEraseBuffer, FB_ERASE_BUF_SIZE, Pattern);
+    mEraseBufferPattern = Pattern;
   }
 
   *BufOut = mEraseBuffer;
   return EFI_SUCCESS;
 }
 
+/**
+  Get-or-allocate a 4 MiB page-aligned scratch buffer prefilled with
+  0xFF, used as the source for partition wiping.
+**/
+STATIC
+EFI_STATUS
+GetEraseBuffer (
+  OUT UINT8  **BufOut
+  )
+{
+  return GetFillBuffer (FB_ERASE_PATTERN, BufOut);
+}
+
+/**
+  Write Length bytes of the 32-bit Pattern at Offset, FB_ERASE_BUF_SIZE
+  bytes per DiskIo call.
+**/
+STATIC
+EFI_STATUS
+WriteFill (
+  IN EFI_DISK_IO_PROTOCOL  *DiskIo,
+  IN UINT32                MediaId,
+  IN UINT64                Offset,
+  IN UINT64                Length,
+  IN UINT32                Pattern
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       *Buf;
+  UINTN       ChunkLength;
+
+  Status = GetFillBuffer (Pattern, &Buf);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  while (Length > 0) {
+    ChunkLength = (UINTN)MIN (Length, FB_ERASE_BUF_SIZE);
+    Status      = DiskIo->WriteDisk (DiskIo, MediaId, Offset, ChunkLength, Buf);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Offset += ChunkLength;
+    Length -= ChunkLength;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Check whether Image is an Android sparse image.
+**/
+STATIC
+BOOLEAN
+IsSparseImage (
+  IN UINTN  Size,
+  IN VOID   *Image
+  )
+{
+  return (Size >= sizeof (SPARSE_HEADER)) &&
+         (((SPARSE_HEADER *)Image)->Magic == SPARSE_HEADER_MAGIC);
+}
+
+/**
+  Validate an Android sparse image before anything is written.
+
+  Every chunk header is checked against the size of the downloaded image,
+  and the chunks together against the expanded size and the partition, so
+  a malformed or truncated image is rejected without touching the
+  partition.
+
+  @param[in] PartitionSize  Size of the partition in bytes.
+  @param[in] Size           Size of Image in bytes.
+  @param[in] Image          Sparse image.
+
+  @retval EFI_SUCCESS            The image can be expanded onto the partition.
+  @retval EFI_INVALID_PARAMETER  The image is malformed or truncated.
+  @retval EFI_VOLUME_FULL        The expanded image is larger than the partition.
+**/
+STATIC
+EFI_STATUS
+ValidateSparseImage (
+  IN UINT64  PartitionSize,
+  IN UINTN   Size,
+  IN VOID    *Image
+  )
+{
+  SPARSE_HEADER        *Header;
+  SPARSE_CHUNK_HEADER  *Chunk;
+  UINT8                *Data;
+  UINTN                Remaining;
+  UINTN                PayloadSize;
+  UINT32               ChunkIndex;
+  UINT64               ExpandedSize;
+  UINT64               Offset;
+  UINT64               ChunkBytes;
+
+  Header = (SPARSE_HEADER *)Image;
+  if ((Header->MajorVersion != SPARSE_HEADER_MAJOR_VERSION) ||
+      (Header->FileHeaderSize < sizeof (SPARSE_HEADER)) ||
+      (Header->FileHeaderSize > Size) ||
+      (Header->ChunkHeaderSize < sizeof (SPARSE_CHUNK_HEADER)) ||
+      (Header->BlockSize == 0) ||
+      ((Header->BlockSize % sizeof (UINT32)) != 0))
+  {
+    DEBUG ((DEBUG_ERROR, "%a: invalid sparse header\n", __FUNCTION__));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ExpandedSize = MultU64x32 (Header->TotalBlocks, Header->BlockSize);
+  if (ExpandedSize > PartitionSize) {
+    DEBUG ((DEBUG_ERROR, "%a: image of %llu bytes exceeds partition of %llu bytes\n", __FUNCTION__, ExpandedSize, PartitionSize));
+    return EFI_VOLUME_FULL;
+  }
+
+  Data      = (UINT8 *)Image + Header->FileHeaderSize;
+  Remaining = Size - Header->FileHeaderSize;
+  Offset    = 0;
+
+  for (ChunkIndex = 0; ChunkIndex < Header->TotalChunks; ChunkIndex++) {
+    if (Remaining < Header->ChunkHeaderSize) {
+      DEBUG ((DEBUG_ERROR, "%a: image truncated at chunk %u\n", __FUNCTION__, ChunkIndex));
+      return EFI_INVALID_PARAMETER;
+    }
+
+    Chunk = (SPARSE_CHUNK_HEADER *)Data;
+    if ((Chunk->TotalSize < Header->ChunkHeaderSize) || (Chunk->TotalSize > Remaining)) {
+      DEBUG ((DEBUG_ERROR, "%a: chunk %u has invalid size %u\n", __FUNCTION__, ChunkIndex, Chunk->TotalSize));
+      return EFI_INVALID_PARAMETER;
+    }
+
+    PayloadSize = Chunk->TotalSize - Header->ChunkHeaderSize;
+    ChunkBytes  = MultU64x32 (Chunk->ChunkSize, Header->BlockSize);
+    if (ChunkBytes > ExpandedSize - Offset) {
+      DEBUG ((DEBUG_ERROR, "%a: chunk %u exceeds the image size\n", __FUNCTION__, ChunkIndex));
+      return EFI_INVALID_PARAMETER;
+    }
+
+    switch (Chunk->ChunkType) {
+      case SPARSE_CHUNK_TYPE_RAW:
+        if (PayloadSize != ChunkBytes) {
+          DEBUG ((DEBUG_ERROR, "%a: raw chunk %u has %u bytes for %llu\n", __FUNCTION__, ChunkIndex, PayloadSize, ChunkBytes));
+          return EFI_INVALID_PARAMETER;
+        }
+
+        break;
+
+      case SPARSE_CHUNK_TYPE_FILL:
+      case SPARSE_CHUNK_TYPE_CRC32:
+        if (PayloadSize != sizeof (UINT32)) {
+          DEBUG ((DEBUG_ERROR, "%a: chunk %u has invalid payload size %u\n", __FUNCTION__, ChunkIndex, PayloadSize));
+          return EFI_INVALID_PARAMETER;
+        }
+
+        break;
+
+      case SPARSE_CHUNK_TYPE_DONT_CARE:
+        break;
+
+      default:
+        DEBUG ((DEBUG_ERROR, "%a: chunk %u has unknown type 0x%x\n", __FUNCTION__, ChunkIndex, Chunk->ChunkType));
+        return EFI_INVALID_PARAMETER;
+    }
+
+    Offset    += ChunkBytes;
+    Data      += Chunk->TotalSize;
+    Remaining -= Chunk->TotalSize;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Expand an Android sparse image onto a partition.
+
+  The whole image is validated first, so nothing is written unless every
+  chunk fits the download and the partition. RAW chunks are then written
+  straight from the download buffer, FILL chunks are written from the fill
+  buffer and DONT_CARE chunks are skipped, so only the blocks described by
+  the image are touched. CRC32 chunks are accepted but not verified.
+
+  @param[in] BlockIo        BlockIo of the partition.
+  @param[in] DiskIo         DiskIo of the partition.
+  @param[in] Size           Size of Image in bytes.
+  @param[in] Image          Sparse image.
+
+  @retval EFI_SUCCESS            The image was written.
+  @retval EFI_INVALID_PARAMETER  The image is malformed or truncated.
+  @retval EFI_VOLUME_FULL        The expanded image is larger than the partition.
+  @retval Others                 A write failed.
+**/
+STATIC
+EFI_STATUS
+FlashSparseImage (
+  IN EFI_BLOCK_IO_PROTOCOL  *BlockIo,
+  IN EFI_DISK_IO_PROTOCOL   *DiskIo,
+  IN UINTN                  Size,
+  IN VOID                   *Image
+  )
+{
+  EFI_STATUS           Status;
+  SPARSE_HEADER        *Header;
+  SPARSE_CHUNK_HEADER  *Chunk;
+  UINT8                *Data;
+  UINT8                *Payload;
+  UINT32               ChunkIndex;
+  UINT32               MediaId;
+  UINT64               Offset;
+  UINT64               ChunkBytes;
+  UINT64               WrittenBytes;
+
+  Status = ValidateSparseImage (
+             MultU64x32 (BlockIo->Media->LastBlock + 1, BlockIo->Media->BlockSize),
+             Size,
+             Image
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Header       = (SPARSE_HEADER *)Image;
+  MediaId      = BlockIo->Media->MediaId;
+  Data         = (UINT8 *)Image + Header->FileHeaderSize;
+  Offset       = 0;
+  WrittenBytes = 0;
+
+  for (ChunkIndex = 0; ChunkIndex < Header->TotalChunks; ChunkIndex++) {
+    Chunk      = (SPARSE_CHUNK_HEADER *)Data;
+    Payload    = Data + Header->ChunkHeaderSize;
+    ChunkBytes = MultU64x32 (Chunk->ChunkSize, Header->BlockSize);
+
+    switch (Chunk->ChunkType) {
+      case SPARSE_CHUNK_TYPE_RAW:
+        Status = DiskIo->WriteDisk (DiskIo, MediaId, Offset, (UINTN)ChunkBytes, Payload);
+        if (EFI_ERROR (Status)) {
+          return Status;
+        }
+
+        WrittenBytes += ChunkBytes;
+        break;
+
+      case SPARSE_CHUNK_TYPE_FILL:
+        Status = WriteFill (DiskIo, MediaId, Offset, ChunkBytes, ReadUnaligned32 ((UINT32 *)Payload));
+        if (EFI_ERROR (Status)) {
+          return Status;
+        }
+
+        WrittenBytes += ChunkBytes;
+        break;
+
+      default:
+        break;
+    }
+
+    Offset += ChunkBytes;
+    Data   += Chunk->TotalSize;
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: wrote %llu of %llu bytes from %u chunks\n",
+    __FUNCTION__,
+    WrittenBytes,
+    MultU64x32 (Header->TotalBlocks, Header->BlockSize),
+    Header->TotalChunks
+    ));
+
+  return EFI_SUCCESS;
+}
+
 /*
   Do any initialisation that needs to be done in order to be able to respond to
   commands.
@@ -203,6 +490,8 @@ TegraFastbootPlatformUnInit (
   Flash the partition named (according to a platform-specific scheme)
   PartitionName, with the image pointed to by Buffer, whose size is BufferSize.
 
+  Android sparse images are expanded onto the partition as they are parsed.
+
   @param[in] PartitionName  Null-terminated name of partition to write.
   @param[in] BufferSize     Size of Buffer in byets.
   @param[in] Buffer         Data to write to partition.
@@ -292,12 +581,6 @@ TegraFastbootPlatformFlashPartition (
     goto NoFlashExit;
   }
 
-  PartitionSize = (BlockIo->Media->LastBlock + 1) * BlockIo->Media->BlockSize;
-  if (PartitionSize < Size) {
-    Status =  EFI_VOLUME_FULL;
-    goto NoFlashExit;
-  }
-
   DiskIo = NULL;
   Status = gBS->HandleProtocol (
                   HandleBuffer[Index],
@@ -309,11 +592,24 @@ TegraFastbootPlatformFlashPartition (
     goto NoFlashExit;
   }
 
-  MediaId = BlockIo->Media->MediaId;
+  if (IsSparseImage (Size, Image)) {
+    Status = FlashSparseImage (BlockIo, DiskIo, Size, Image);
+    if (EFI_ERROR (Status)) {
+      goto NoFlashExit;
+    }
+  } else {
+    PartitionSize = (BlockIo->Media->LastBlock + 1) * BlockIo->Media->BlockSize;
+    if (PartitionSize < Size) {
+      Status =  EFI_VOLUME_FULL;
+      goto NoFlashExit;
+    }
+
+    MediaId = BlockIo->Media->MediaId;
 
-  Status = DiskIo->WriteDisk (DiskIo, MediaId, 0, Size, Image);
-  if (EFI_ERROR (Status)) {
-    goto NoFlashExit;
+    Status = DiskIo->WriteDisk (DiskIo, MediaId, 0, Size, Image);
+    if (EFI_ERROR (Status)) {
+      goto NoFlashExit;
+    }
   }
 
   BlockIo->FlushBlocks (BlockIo);
@@ -2,7 +2,7 @@
 
   Tegra I2c Controller Driver private structures
 
-  SPDX-FileCopyrightText: Copyright (c) 2018-2025, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2018-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -24,6 +24,48 @@
 #define MAX_I2C_DEVICES        16
 #define MAX_SLAVES_PER_DEVICE  1
 
+#define TEGRA_I2C_REQUEST_SIGNATURE  SIGNATURE_32('T','I','2','R')
+
+typedef enum {
+  TegraI2cRequestStateOperation,      // Start the next operation of the request packet
+  TegraI2cRequestStateHeader,         // Send the header of the next packet
+  TegraI2cRequestStateTransmit,       // Fill the TX FIFO with the packet payload
+  TegraI2cRequestStateReceive,        // Drain the RX FIFO into the operation buffer
+  TegraI2cRequestStateComplete        // Wait for the controller to finish the operation
+} TEGRA_I2C_REQUEST_STATE;
+
+//
+// A transaction queued on a controller. The controller services the request
+// at the head of its queue from a timer, or from the caller for synchronous
+// requests, without waiting on the FIFOs.
+//
+typedef struct {
+  UINT32                     Signature;
+  LIST_ENTRY                 Link;
+
+  UINTN                      SlaveAddress;
+  EFI_I2C_REQUEST_PACKET     *RequestPacket;
+  EFI_EVENT                  Event;
+  EFI_STATUS                 *I2cStatus;
+  EFI_STATUS                 Status;
+  BOOLEAN                    Done;
+
+  TEGRA_I2C_REQUEST_STATE    State;
+  UINT64                     Deadline;          // In nanoseconds, refreshed on progress
+  UINTN                      OperationIndex;
+  UINT32                     LengthRemaining;
+  UINT32                     PacketRemaining;
+  UINT32                     BufferOffset;
+  BOOLEAN                    ReadOperation;
+  BOOLEAN                    LastOperation;
+  BOOLEAN                    BlockTransfer;
+  BOOLEAN                    PecSupported;
+  UINT8                      Crc8;
+  UINT8                      ReadCrc8;
+} TEGRA_I2C_REQUEST;
+
+#define TEGRA_I2C_REQUEST_FROM_LINK(a)  CR(a, TEGRA_I2C_REQUEST, Link, TEGRA_I2C_REQUEST_SIGNATURE)
+
 typedef struct {
   //
   // Standard signature used to identify TegraI2c private data
@@ -70,6 +112,12 @@ typedef struct {
   UINT32                                           PinControlId;
   BOOLEAN                                          PinControlConfigured;
   BOOLEAN                                          SkipOnExitDisabled;
+
+  //
+  // Queued transactions and the timer servicing asynchronous ones
+  //
+  LIST_ENTRY                                       RequestQueue;
+  EFI_EVENT                                        ServiceTimer;
 } NVIDIA_TEGRA_I2C_PRIVATE_DATA;
 
 #define TEGRA_I2C_PRIVATE_DATA_FROM_MASTER(a)     CR(a, NVIDIA_TEGRA_I2C_PRIVATE_DATA, I2cMaster, TEGRA_I2C_SIGNATURE)
@@ -203,5 +251,6 @@ typedef struct {
 #define RX_FIFO_FULL_CNT_SHIFT        0
 #define RX_FIFO_FULL_CNT_MASK         0x0000FF
 #define I2C_TIMEOUT                   (25000 * 2)
+#define I2C_SERVICE_INTERVAL          1000 // 100 us, in 100 ns units
 
 #endif
@@ -151,6 +151,10 @@ TegraI2cSetBusFrequency (
   }
 
   Private = TEGRA_I2C_PRIVATE_DATA_FROM_MASTER (This);
+  if (!IsListEmpty (&Private->RequestQueue)) {
+    return EFI_ALREADY_STARTED;
+  }
+
   // Load relevent prod settings
   Status = DeviceDiscoverySetProd (Private->ControllerHandle, Private->DeviceTreeNode, "prod");
   if (EFI_ERROR (Status) && (Status != EFI_NOT_FOUND)) {
@@ -215,35 +219,23 @@ TegraI2cSetBusFrequency (
 }
 
 /**
-  Reset the I2C controller and configure it for use
+  Reset the I2C controller.
 
-  This routine must be called at or below TPL_NOTIFY.
-
-  The I2C controller is reset.  The caller must call SetBusFrequench() after
-  calling Reset().
+  @param[in] Private            Pointer to an NVIDIA_TEGRA_I2C_PRIVATE_DATA structure
 
-  @param[in]     This       Pointer to an EFI_I2C_MASTER_PROTOCOL structure.
-
-  @retval EFI_SUCCESS         The reset completed successfully.
-  @retval EFI_ALREADY_STARTED The controller is busy with another transaction.
-  @retval EFI_DEVICE_ERROR    The reset operation failed.
+  @retval EFI_SUCCESS           The reset completed successfully.
+  @retval Others                The reset operation failed.
 
 **/
+STATIC
 EFI_STATUS
-TegraI2cReset (
-  IN CONST EFI_I2C_MASTER_PROTOCOL  *This
+TegraI2cResetController (
+  IN NVIDIA_TEGRA_I2C_PRIVATE_DATA  *Private
   )
 {
-  NVIDIA_TEGRA_I2C_PRIVATE_DATA  *Private = NULL;
-  UINT32                         Data32;
-  UINTN                          Timeout;
-  EFI_STATUS                     Status;
-
-  if (This == NULL) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  Private = TEGRA_I2C_PRIVATE_DATA_FROM_MASTER (This);
+  UINT32      Data32;
+  UINTN       Timeout;
+  EFI_STATUS  Status;
 
   MmioWrite32 (Private->BaseAddress + I2C_I2C_MASTER_RESET_CNTRL_0_OFFSET, I2C_I2C_MASTER_RESET_CNTRL_0_SOFT_RESET);
   MicroSecondDelay (I2C_SOFT_RESET_DELAY);
@@ -275,6 +267,56 @@ TegraI2cReset (
   return EFI_SUCCESS;
 }
 
+/**
+  Reset the I2C controller and configure it for use
+
+  This routine must be called at or below TPL_NOTIFY.
+
+  The I2C controller is reset.  The caller must call SetBusFrequench() after
+  calling Reset().
+
+  @param[in]     This       Pointer to an EFI_I2C_MASTER_PROTOCOL structure.
+
+  @retval EFI_SUCCESS         The reset completed successfully.
+  @retval EFI_ALREADY_STARTED The controller is busy with another transaction.
+  @retval EFI_DEVICE_ERROR    The reset operation failed.
+
+**/
+EFI_STATUS
+TegraI2cReset (
+  IN CONST EFI_I2C_MASTER_PROTOCOL  *This
+  )
+{
+  NVIDIA_TEGRA_I2C_PRIVATE_DATA  *Private = NULL;
+
+  if (This == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = TEGRA_I2C_PRIVATE_DATA_FROM_MASTER (This);
+  if (!IsListEmpty (&Private->RequestQueue)) {
+    return EFI_ALREADY_STARTED;
+  }
+
+  return TegraI2cResetController (Private);
+}
+
+/**
+  Writes the packet header for the next packet of a transaction.
+
+  The caller must make sure the TX FIFO has room for the three header words.
+
+  @param[in] Private            Pointer to an NVIDIA_TEGRA_I2C_PRIVATE_DATA structure
+  @param[in] SlaveAddress       Address of the device on the I2C bus
+  @param[in] PayloadSize        Size of the packet payload in bytes
+  @param[in] ReadOperation      TRUE if the packet reads from the device
+  @param[in] LastOperation      TRUE if the packet belongs to the last operation
+  @param[in] ContinueTransfer   TRUE if more packets follow for this operation
+
+  @retval EFI_SUCCESS           The header was written.
+  @retval Others                The header could not be written.
+
+**/
 STATIC
 EFI_STATUS
 TegraI2cSendHeader (
@@ -288,8 +330,6 @@ TegraI2cSendHeader (
 {
   UINT32      PacketHeader[3];
   EFI_STATUS  Status;
-  UINT32      Data32;
-  UINT32      Timeout;
 
   if (PayloadSize > MAX_UINT16) {
     return EFI_INVALID_PARAMETER;
@@ -333,20 +373,6 @@ TegraI2cSendHeader (
   PacketHeader[2] |= ((SlaveAddress << I2C_HEADER_SLAVE_ADDR_SHIFT) & I2C_HEADER_SLAVE_ADDR_MASK);
   MmioWrite32 (Private->BaseAddress + I2C_INTERRUPT_STATUS_REGISTER_0_OFFSET, MAX_UINT32);
 
-  Timeout = I2C_TIMEOUT;
-  do {
-    Data32 = MmioRead32 (Private->BaseAddress + I2C_MST_FIFO_STATUS_0_OFFSET);
-    Data32 = (Data32 & TX_FIFO_EMPTY_CNT_MASK) >> TX_FIFO_EMPTY_CNT_SHIFT;
-    if (Data32 < 3) {
-      MicroSecondDelay (1);
-      Timeout--;
-      if (Timeout == 0) {
-        DEBUG ((DEBUG_ERROR, "%a: Timeout waiting for to send packet header Free\r\n", __FUNCTION__));
-        return EFI_TIMEOUT;
-      }
-    }
-  } while (Data32 < 3);
-
   MmioWrite32 (Private->BaseAddress + I2C_I2C_TX_PACKET_FIFO_0_OFFSET, PacketHeader[0]);
   MmioWrite32 (Private->BaseAddress + I2C_I2C_TX_PACKET_FIFO_0_OFFSET, PacketHeader[1]);
   MmioWrite32 (Private->BaseAddress + I2C_I2C_TX_PACKET_FIFO_0_OFFSET, PacketHeader[2]);
@@ -360,17 +386,448 @@ TegraI2cSendHeader (
   return EFI_SUCCESS;
 }
 
+/**
+  Returns the time by which a request waiting on the controller must make
+  progress.
+
+  @retval Deadline in nanoseconds
+
+**/
+STATIC
+UINT64
+TegraI2cGetDeadline (
+  VOID
+  )
+{
+  return GetTimeInNanoSecond (GetPerformanceCounter ()) + MultU64x32 (I2C_TIMEOUT, 1000);
+}
+
+/**
+  Raises the TPL to serialize access to the request queue with the service
+  timers. Callers above TPL_NOTIFY stay at their TPL.
+
+  @retval Previous TPL
+
+**/
+STATIC
+EFI_TPL
+TegraI2cRaiseTpl (
+  VOID
+  )
+{
+  EFI_TPL  OldTpl;
+
+  if (EfiAtRuntime ()) {
+    return TPL_HIGH_LEVEL;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  gBS->RestoreTPL (MAX (OldTpl, TPL_NOTIFY));
+
+  return OldTpl;
+}
+
+/**
+  Restores the TPL raised by TegraI2cRaiseTpl.
+
+  @param[in] OldTpl             TPL returned by TegraI2cRaiseTpl
+
+**/
+STATIC
+VOID
+TegraI2cRestoreTpl (
+  IN EFI_TPL  OldTpl
+  )
+{
+  if (!EfiAtRuntime ()) {
+    gBS->RestoreTPL (OldTpl);
+  }
+}
+
+/**
+  Checks if the device did not acknowledge the current packet while waiting
+  on a FIFO.
+
+  @param[in] Private            Pointer to an NVIDIA_TEGRA_I2C_PRIVATE_DATA structure
+  @param[in] NakStatus          Status to return when a NAK was received
+
+  @retval EFI_NOT_READY         No NAK, keep waiting.
+  @retval NakStatus             The device did not acknowledge.
+
+**/
+STATIC
+EFI_STATUS
+TegraI2cCheckNak (
+  IN NVIDIA_TEGRA_I2C_PRIVATE_DATA  *Private,
+  IN EFI_STATUS                     NakStatus
+  )
+{
+  UINT32  Data32;
+
+  Data32 = MmioRead32 (Private->BaseAddress + I2C_PACKET_TRANSFER_STATUS_0_OFFSET);
+  if ((Data32 & (PACKET_TRANSFER_NOACK_FOR_ADDR | PACKET_TRANSFER_NOACK_FOR_DATA)) != 0) {
+    DEBUG ((DEBUG_ERROR, "%a: NAK for %a\r\n", __FUNCTION__, (NakStatus == EFI_NO_RESPONSE) ? "RX" : "TX"));
+    return NakStatus;
+  }
+
+  return EFI_NOT_READY;
+}
+
+/**
+  Advances a transaction as far as the controller FIFOs allow without
+  waiting.
+
+  @param[in] Private            Pointer to an NVIDIA_TEGRA_I2C_PRIVATE_DATA structure
+  @param[in] Request            Request at the head of the controller queue
+
+  @retval EFI_NOT_READY         The request is waiting on the controller.
+  @retval EFI_SUCCESS           The transaction completed successfully.
+  @retval Others                The transaction failed.
+
+**/
+STATIC
+EFI_STATUS
+TegraI2cProcessRequest (
+  IN NVIDIA_TEGRA_I2C_PRIVATE_DATA  *Private,
+  IN TEGRA_I2C_REQUEST              *Request
+  )
+{
+  EFI_I2C_OPERATION  *Operation;
+  EFI_STATUS         Status;
+  UINT32             Data32;
+  UINT32             Entries;
+  UINT32             TransferSize;
+  UINT8              AddressCrc8;
+
+  while (TRUE) {
+    Operation = &Request->RequestPacket->Operation[Request->OperationIndex];
+
+    switch (Request->State) {
+      case TegraI2cRequestStateOperation:
+        Request->ReadOperation   = ((Operation->Flags & I2C_FLAG_READ) != 0);
+        Request->LastOperation   = (Request->OperationIndex == (Request->RequestPacket->OperationCount - 1));
+        Request->LengthRemaining = Operation->LengthInBytes;
+        Request->BufferOffset    = 0;
+
+        if (Request->PecSupported) {
+          AddressCrc8 = (UINT8)(Request->SlaveAddress << 1);
+          if (Request->ReadOperation) {
+            AddressCrc8 |= 1;
+          }
+
+          Request->Crc8 = CalculateCrc8 (&AddressCrc8, 1, Request->Crc8, TYPE_CRC8);
+          if (!Request->ReadOperation && (Operation->LengthInBytes != 0)) {
+            Request->Crc8 = CalculateCrc8 (Operation->Buffer, Operation->LengthInBytes, Request->Crc8, TYPE_CRC8);
+          }
+        }
+
+        Request->State = TegraI2cRequestStateHeader;
+        break;
+
+      case TegraI2cRequestStateHeader:
+        //
+        // The packet header takes three TX FIFO entries
+        //
+        Data32 = MmioRead32 (Private->BaseAddress + I2C_MST_FIFO_STATUS_0_OFFSET);
+        if (((Data32 & TX_FIFO_EMPTY_CNT_MASK) >> TX_FIFO_EMPTY_CNT_SHIFT) < 3) {
+          return EFI_NOT_READY;
+        }
+
+        if (Request->PecSupported && Request->LastOperation && (Request->BufferOffset == 0)) {
+          Request->LengthRemaining++;
+        }
+
+        if (!Request->ReadOperation) {
+          Request->PacketRemaining = MIN (Request->LengthRemaining, I2C_MAX_PACKET_SIZE - I2C_PACKET_HEADER_SIZE);
+        } else if ((Request->BufferOffset == 0) && Request->BlockTransfer) {
+          Request->PacketRemaining = 1;
+        } else {
+          Request->PacketRemaining = MIN (Request->LengthRemaining, I2C_MAX_PACKET_SIZE);
+        }
+
+        Status = TegraI2cSendHeader (
+                   Private,
+                   Request->SlaveAddress,
+                   Request->PacketRemaining,
+                   Request->ReadOperation,
+                   Request->LastOperation,
+                   (Request->PacketRemaining != Request->LengthRemaining)
+                   );
+        if (EFI_ERROR (Status)) {
+          DEBUG ((DEBUG_ERROR, "%a: Header send failed (%r)\r\n", __FUNCTION__, Status));
+          return Status;
+        }
+
+        Request->State = Request->ReadOperation ? TegraI2cRequestStateReceive : TegraI2cRequestStateTransmit;
+        break;
+
+      case TegraI2cRequestStateTransmit:
+        while (Request->PacketRemaining != 0) {
+          Data32  = MmioRead32 (Private->BaseAddress + I2C_MST_FIFO_STATUS_0_OFFSET);
+          Entries = (Data32 & TX_FIFO_EMPTY_CNT_MASK) >> TX_FIFO_EMPTY_CNT_SHIFT;
+          if (Entries == 0) {
+            return TegraI2cCheckNak (Private, EFI_DEVICE_ERROR);
+          }
+
+          for ( ; (Entries != 0) && (Request->PacketRemaining != 0); Entries--) {
+            TransferSize = MIN (sizeof (UINT32), Request->PacketRemaining);
+            Data32       = 0;
+            if (Request->PecSupported && Request->LastOperation && (TransferSize == Request->LengthRemaining)) {
+              CopyMem ((VOID *)&Data32, Operation->Buffer + Request->BufferOffset, TransferSize - 1);
+              ((UINT8 *)&Data32)[TransferSize - 1] = Request->Crc8;
+            } else {
+              CopyMem ((VOID *)&Data32, Operation->Buffer + Request->BufferOffset, TransferSize);
+            }
+
+            MmioWrite32 (Private->BaseAddress + I2C_I2C_TX_PACKET_FIFO_0_OFFSET, Data32);
+            Request->PacketRemaining -= TransferSize;
+            Request->LengthRemaining -= TransferSize;
+            Request->BufferOffset    += TransferSize;
+          }
+
+          Request->Deadline = TegraI2cGetDeadline ();
+        }
+
+        Request->State = (Request->LengthRemaining != 0) ? TegraI2cRequestStateHeader : TegraI2cRequestStateComplete;
+        break;
+
+      case TegraI2cRequestStateReceive:
+        while (Request->PacketRemaining != 0) {
+          Data32  = MmioRead32 (Private->BaseAddress + I2C_MST_FIFO_STATUS_0_OFFSET);
+          Entries = (Data32 & RX_FIFO_FULL_CNT_MASK) >> RX_FIFO_FULL_CNT_SHIFT;
+          if (Entries == 0) {
+            return TegraI2cCheckNak (Private, EFI_NO_RESPONSE);
+          }
+
+          for ( ; (Entries != 0) && (Request->PacketRemaining != 0); Entries--) {
+            TransferSize = MIN (sizeof (UINT32), Request->PacketRemaining);
+            Data32       = MmioRead32 (Private->BaseAddress + I2C_I2C_RX_FIFO_0_OFFSET);
+            if (Request->PecSupported && Request->LastOperation && (Request->LengthRemaining == TransferSize)) {
+              CopyMem (Operation->Buffer + Request->BufferOffset, (VOID *)&Data32, TransferSize - 1);
+              Request->ReadCrc8 = ((UINT8 *)&Data32)[TransferSize - 1];
+            } else {
+              CopyMem (Operation->Buffer + Request->BufferOffset, (VOID *)&Data32, TransferSize);
+            }
+
+            if ((Request->BufferOffset == 0) && Request->BlockTransfer) {
+              if (Operation->LengthInBytes < (*Operation->Buffer + 1)) {
+                return EFI_BUFFER_TOO_SMALL;
+              }
+
+              Operation->LengthInBytes = *Operation->Buffer + 1;
+              Request->LengthRemaining = *Operation->Buffer;
+              if (Request->PecSupported && Request->LastOperation) {
+                Request->LengthRemaining++;
+              }
+            } else {
+              Request->LengthRemaining -= TransferSize;
+            }
+
+            Request->PacketRemaining -= TransferSize;
+            Request->BufferOffset    += TransferSize;
+          }
+
+          Request->Deadline = TegraI2cGetDeadline ();
+        }
+
+        if (Request->LengthRemaining != 0) {
+          Request->State = TegraI2cRequestStateHeader;
+          break;
+        }
+
+        if (Request->PecSupported && (Operation->LengthInBytes != 0)) {
+          Request->Crc8 = CalculateCrc8 (Operation->Buffer, Operation->LengthInBytes, Request->Crc8, TYPE_CRC8);
+        }
+
+        Request->State = TegraI2cRequestStateComplete;
+        break;
+
+      case TegraI2cRequestStateComplete:
+        Data32 = MmioRead32 (Private->BaseAddress + I2C_INTERRUPT_STATUS_REGISTER_0_OFFSET);
+        MmioWrite32 (Private->BaseAddress + I2C_INTERRUPT_STATUS_REGISTER_0_OFFSET, Data32);
+        if ((Data32 & INTERRUPT_STATUS_NOACK) != 0) {
+          DEBUG ((DEBUG_INFO, "%a: No ACK received\r\n", __FUNCTION__));
+          return EFI_NO_RESPONSE;
+        }
+
+        if ((Data32 & INTERRUPT_STATUS_ARB_LOST) != 0) {
+          DEBUG ((DEBUG_ERROR, "%a: ARB Lost\r\n", __FUNCTION__));
+          return EFI_DEVICE_ERROR;
+        }
+
+        if ((Data32 & INTERRUPT_STATUS_PACKET_XFER_COMPLETE) == 0) {
+          return EFI_NOT_READY;
+        }
+
+        Request->OperationIndex++;
+        if (Request->OperationIndex < Request->RequestPacket->OperationCount) {
+          Request->State    = TegraI2cRequestStateOperation;
+          Request->Deadline = TegraI2cGetDeadline ();
+          break;
+        }
+
+        if (Request->PecSupported && Request->ReadOperation && (Request->ReadCrc8 != Request->Crc8)) {
+          DEBUG ((DEBUG_ERROR, "%a: PEC Mismatch, got: 0x%02x expected 0x%02x\r\n", __FUNCTION__, Request->ReadCrc8, Request->Crc8));
+          return EFI_DEVICE_ERROR;
+        }
+
+        return EFI_SUCCESS;
+
+      default:
+        ASSERT (FALSE);
+        return EFI_DEVICE_ERROR;
+    }
+  }
+}
+
+/**
+  Services the requests queued on a controller in order, as far as the
+  controller allows without waiting.
+
+  Must be called with the TPL raised by TegraI2cRaiseTpl.
+
+  @param[in] Private            Pointer to an NVIDIA_TEGRA_I2C_PRIVATE_DATA structure
+
+  @retval EFI_SUCCESS           The queue is empty.
+  @retval EFI_NOT_READY         The request at the head of the queue is waiting
+                                on the controller.
+
+**/
+STATIC
+EFI_STATUS
+TegraI2cServiceQueue (
+  IN NVIDIA_TEGRA_I2C_PRIVATE_DATA  *Private
+  )
+{
+  TEGRA_I2C_REQUEST  *Request;
+  EFI_STATUS         Status;
+
+  while (!IsListEmpty (&Private->RequestQueue)) {
+    Request = TEGRA_I2C_REQUEST_FROM_LINK (GetFirstNode (&Private->RequestQueue));
+    if (Request->Deadline == 0) {
+      Request->Deadline = TegraI2cGetDeadline ();
+    }
+
+    Status = TegraI2cProcessRequest (Private, Request);
+    if (Status == EFI_NOT_READY) {
+      if (GetTimeInNanoSecond (GetPerformanceCounter ()) < Request->Deadline) {
+        return EFI_NOT_READY;
+      }
+
+      DEBUG ((DEBUG_ERROR, "%a: Timeout in state %u\r\n", __FUNCTION__, Request->State));
+      Status = EFI_TIMEOUT;
+    }
+
+    RemoveEntryList (&Request->Link);
+
+    if (EFI_ERROR (Status)) {
+      TegraI2cResetController (Private);
+    }
+
+    Request->Status = Status;
+    Request->Done   = TRUE;
+
+    //
+    // Synchronous requests live on the caller's stack and are completed by
+    // the caller.
+    //
+    if (Request->Event != NULL) {
+      if (Request->I2cStatus != NULL) {
+        *Request->I2cStatus = Status;
+      }
+
+      gBS->SignalEvent (Request->Event);
+      FreePool (Request);
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Timer servicing the asynchronous requests of a controller.
+
+  @param[in]  Event             The timer event.
+  @param[in]  Context           Pointer to an NVIDIA_TEGRA_I2C_PRIVATE_DATA structure
+
+**/
+STATIC
+VOID
+EFIAPI
+TegraI2cServiceTimer (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  NVIDIA_TEGRA_I2C_PRIVATE_DATA  *Private;
+
+  Private = (NVIDIA_TEGRA_I2C_PRIVATE_DATA *)Context;
+  if (TegraI2cServiceQueue (Private) == EFI_SUCCESS) {
+    gBS->SetTimer (Private->ServiceTimer, TimerCancel, 0);
+  }
+}
+
+/**
+  Fails the asynchronous requests still queued on a controller when boot
+  services exit, so runtime calls do not process them.
+
+  The requests are completed with EFI_ABORTED in their I2cStatus.  Their
+  events are not signaled and they are not freed, as neither is allowed
+  once ExitBootServices has started.
+
+  @param[in] Private            Pointer to an NVIDIA_TEGRA_I2C_PRIVATE_DATA structure
+
+**/
+STATIC
+VOID
+TegraI2cAbortQueue (
+  IN NVIDIA_TEGRA_I2C_PRIVATE_DATA  *Private
+  )
+{
+  TEGRA_I2C_REQUEST  *Request;
+  EFI_TPL            OldTpl;
+
+  OldTpl = TegraI2cRaiseTpl ();
+  if (Private->ServiceTimer != NULL) {
+    gBS->SetTimer (Private->ServiceTimer, TimerCancel, 0);
+  }
+
+  if (IsListEmpty (&Private->RequestQueue)) {
+    TegraI2cRestoreTpl (OldTpl);
+    return;
+  }
+
+  DEBUG ((DEBUG_WARN, "%a: Aborting queued requests\r\n", __FUNCTION__));
+
+  //
+  // The request at the head may have been stopped mid-transaction
+  //
+  TegraI2cResetController (Private);
+
+  while (!IsListEmpty (&Private->RequestQueue)) {
+    Request = TEGRA_I2C_REQUEST_FROM_LINK (GetFirstNode (&Private->RequestQueue));
+    RemoveEntryList (&Request->Link);
+
+    Request->Status = EFI_ABORTED;
+    Request->Done   = TRUE;
+    if (Request->I2cStatus != NULL) {
+      *Request->I2cStatus = EFI_ABORTED;
+    }
+  }
+
+  TegraI2cRestoreTpl (OldTpl);
+}
+
 /**
   Start an I2C transaction on the host controller.
 
   This routine must be called at or below TPL_NOTIFY.  For synchronous
   requests this routine must be called at or below TPL_CALLBACK.
 
-  This function initiates an I2C transaction on the controller.  To
-  enable proper error handling by the I2C protocol stack, the I2C
-  master protocol does not support queuing but instead only manages
-  one I2C transaction at a time.  This API requires that the I2C bus
-  is in the correct configuration for the I2C transaction.
+  This function initiates an I2C transaction on the controller.  Each
+  controller keeps a queue of transactions and performs them one at a
+  time, in order.  This API requires that the I2C bus is in the correct
+  configuration for the I2C transaction.
 
   The transaction is performed by sending a start-bit and selecting the
   I2C device with the specified I2C slave address and then performing
@@ -383,10 +840,11 @@ TegraI2cSendHeader (
 
   When Event is not NULL, StartRequest synchronously returns EFI_SUCCESS
   indicating that the I2C transaction was started asynchronously.  The
-  transaction status value is returned in the buffer pointed to by
-  I2cStatus upon the completion of the I2C transaction when I2cStatus
-  is not NULL.  After the transaction status is returned the Event is
-  signaled.
+  controller FIFOs are then serviced from a timer, so transactions on
+  different controllers progress concurrently.  The transaction status
+  value is returned in the buffer pointed to by I2cStatus upon the
+  completion of the I2C transaction when I2cStatus is not NULL.  After
+  the transaction status is returned the Event is signaled.
 
   Note: The typical consumer of this API is the I2C host protocol.
   Extreme care must be taken by other consumers of this API to prevent
@@ -438,16 +896,12 @@ TegraI2cStartRequest (
 {
   NVIDIA_TEGRA_I2C_PRIVATE_DATA  *Private = NULL;
   EFI_STATUS                     Status;
-  UINTN                          PacketIndex   = 0;
   BOOLEAN                        BlockTransfer = FALSE;
-  BOOLEAN                        LastOperation;
-  BOOLEAN                        PecSupported = FALSE;
-  UINT8                          Crc8         = 0;
-  UINT8                          AddressCrc8  = 0;
-  UINT8                          ReadCrc8     = 0;
-  UINT32                         Data32;
-  UINT32                         Timeout;
-  BOOLEAN                        ReadOperation;
+  BOOLEAN                        PecSupported  = FALSE;
+  BOOLEAN                        Asynchronous;
+  TEGRA_I2C_REQUEST              SyncRequest;
+  TEGRA_I2C_REQUEST              *Request;
+  EFI_TPL                        OldTpl;
   NVIDIA_PIN_CONTROL_PROTOCOL    *PinControl;
 
   if ((This == NULL) ||
@@ -504,232 +958,58 @@ TegraI2cStartRequest (
     Private->PinControlConfigured = TRUE;
   }
 
-  for (PacketIndex = 0; PacketIndex < RequestPacket->OperationCount; PacketIndex++) {
-    BOOLEAN  ContinueTransfer = FALSE;
-    UINT32   LengthRemaining  = RequestPacket->Operation[PacketIndex].LengthInBytes;
-    UINT32   BufferOffset     = 0;
-
-    if ((RequestPacket->Operation[PacketIndex].Flags & I2C_FLAG_READ) != 0) {
-      ReadOperation = TRUE;
-    } else {
-      ReadOperation = FALSE;
-    }
-
-    if (PecSupported) {
-      AddressCrc8 = SlaveAddress << 1;
-      if (ReadOperation) {
-        AddressCrc8 |= 1;
-      }
-
-      Crc8 = CalculateCrc8 (&AddressCrc8, 1, Crc8, TYPE_CRC8);
-      if (!ReadOperation) {
-        if (RequestPacket->Operation[PacketIndex].LengthInBytes != 0) {
-          Crc8 = CalculateCrc8 (RequestPacket->Operation[PacketIndex].Buffer, RequestPacket->Operation[PacketIndex].LengthInBytes, Crc8, TYPE_CRC8);
-        }
-      }
+  //
+  // Asynchronous requests need the service timer, which is not available at
+  // runtime. Otherwise the request is completed before returning.
+  //
+  Asynchronous = (Event != NULL) && (Private->ServiceTimer != NULL) && !EfiAtRuntime ();
+  if (Asynchronous) {
+    Request = AllocateZeroPool (sizeof (TEGRA_I2C_REQUEST));
+    if (Request == NULL) {
+      return EFI_OUT_OF_RESOURCES;
     }
 
-    LastOperation = (PacketIndex == (RequestPacket->OperationCount - 1));
-
-    do {
-      UINT32  PayloadSize = 0;
-      if (!ReadOperation) {
-        if (PecSupported && (BufferOffset == 0) && LastOperation) {
-          LengthRemaining++;
-        }
-
-        PayloadSize      = MIN (LengthRemaining, I2C_MAX_PACKET_SIZE - I2C_PACKET_HEADER_SIZE);
-        ContinueTransfer = ((PayloadSize != LengthRemaining));
-        Status           = TegraI2cSendHeader (Private, SlaveAddress, PayloadSize, ReadOperation, LastOperation, ContinueTransfer);
-        if (EFI_ERROR (Status)) {
-          DEBUG ((DEBUG_ERROR, "%a: Header send failed (%r)\r\n", __FUNCTION__, Status));
-          goto Exit;
-        }
-
-        while (PayloadSize != 0) {
-          UINT32  WriteSize = MIN (sizeof (UINT32), PayloadSize);
-          Timeout = I2C_TIMEOUT;
-          do {
-            Data32 = MmioRead32 (Private->BaseAddress + I2C_MST_FIFO_STATUS_0_OFFSET);
-            Data32 = (Data32 & TX_FIFO_EMPTY_CNT_MASK) >> TX_FIFO_EMPTY_CNT_SHIFT;
-            if (Data32 != 0) {
-              MicroSecondDelay (1);
-              Timeout--;
-              if (Timeout == 0) {
-                DEBUG ((DEBUG_ERROR, "%a: Timeout waiting for TX Free\r\n", __FUNCTION__));
-                Status = EFI_TIMEOUT;
-                goto Exit;
-              }
-
-              Data32 = MmioRead32 (Private->BaseAddress + I2C_PACKET_TRANSFER_STATUS_0_OFFSET);
-              if ((Data32 & (PACKET_TRANSFER_NOACK_FOR_ADDR| PACKET_TRANSFER_NOACK_FOR_DATA)) != 0) {
-                DEBUG ((DEBUG_ERROR, "%a: NAK for TX\r\n", __FUNCTION__));
-                Status = EFI_DEVICE_ERROR;
-                goto Exit;
-              }
-
-              Data32 = MmioRead32 (Private->BaseAddress + I2C_MST_FIFO_STATUS_0_OFFSET);
-              Data32 = (Data32 & TX_FIFO_EMPTY_CNT_MASK) >> TX_FIFO_EMPTY_CNT_SHIFT;
-            }
-          } while (Data32 == 0);
-
-          Data32 = 0;
-          if (PecSupported && LastOperation && (WriteSize == LengthRemaining)) {
-            CopyMem (
-              (VOID *)&Data32,
-              RequestPacket->Operation[PacketIndex].Buffer + BufferOffset,
-              WriteSize-1
-              );
-            ((UINT8 *)&Data32)[WriteSize-1] = Crc8;
-          } else {
-            CopyMem (
-              (VOID *)&Data32,
-              RequestPacket->Operation[PacketIndex].Buffer + BufferOffset,
-              WriteSize
-              );
-          }
-
-          MmioWrite32 (Private->BaseAddress + I2C_I2C_TX_PACKET_FIFO_0_OFFSET, Data32);
-          PayloadSize     -= WriteSize;
-          LengthRemaining -= WriteSize;
-          BufferOffset    += WriteSize;
-        }
-      } else {
-        UINT32  ReadPacketSize;
-        if (PecSupported && LastOperation && (BufferOffset == 0)) {
-          LengthRemaining++;
-        }
-
-        if ((BufferOffset == 0) && BlockTransfer) {
-          ReadPacketSize = 1;
-        } else {
-          ReadPacketSize = MIN (LengthRemaining, I2C_MAX_PACKET_SIZE);
-        }
-
-        ContinueTransfer = (LengthRemaining != ReadPacketSize);
-        Status           = TegraI2cSendHeader (Private, SlaveAddress, ReadPacketSize, ReadOperation, LastOperation, ContinueTransfer);
-        while (ReadPacketSize != 0) {
-          UINT32  ReadSize = MIN (sizeof (UINT32), ReadPacketSize);
-          Timeout = I2C_TIMEOUT;
-          do {
-            Data32 = MmioRead32 (Private->BaseAddress + I2C_MST_FIFO_STATUS_0_OFFSET);
-            Data32 = (Data32 & RX_FIFO_FULL_CNT_MASK) >> RX_FIFO_FULL_CNT_SHIFT;
-            if (Data32 == 0) {
-              MicroSecondDelay (1);
-              Timeout--;
-              if (Timeout == 0) {
-                DEBUG ((DEBUG_ERROR, "%a: Timeout waiting for RX Full\r\n", __FUNCTION__));
-                Status = EFI_TIMEOUT;
-                goto Exit;
-              }
-
-              Data32 = MmioRead32 (Private->BaseAddress + I2C_PACKET_TRANSFER_STATUS_0_OFFSET);
-              if ((Data32 & (PACKET_TRANSFER_NOACK_FOR_ADDR| PACKET_TRANSFER_NOACK_FOR_DATA)) != 0) {
-                DEBUG ((DEBUG_ERROR, "%a: NAK for RX\r\n", __FUNCTION__));
-                Status = EFI_NO_RESPONSE;
-                goto Exit;
-              }
-
-              Data32 = MmioRead32 (Private->BaseAddress + I2C_MST_FIFO_STATUS_0_OFFSET);
-              Data32 = (Data32 & RX_FIFO_FULL_CNT_MASK) >> RX_FIFO_FULL_CNT_SHIFT;
-            }
-          } while (Data32 == 0);
-
-          Data32 = MmioRead32 (Private->BaseAddress + I2C_I2C_RX_FIFO_0_OFFSET);
-          if (PecSupported && LastOperation && (LengthRemaining == ReadSize)) {
-            CopyMem (
-              RequestPacket->Operation[PacketIndex].Buffer + BufferOffset,
-              (VOID *)&Data32,
-              ReadSize-1
-              );
-            ReadCrc8 = ((UINT8 *)&Data32)[ReadSize-1];
-          } else {
-            CopyMem (
-              RequestPacket->Operation[PacketIndex].Buffer + BufferOffset,
-              (VOID *)&Data32,
-              ReadSize
-              );
-          }
-
-          if ((BufferOffset == 0) && BlockTransfer) {
-            if (RequestPacket->Operation[PacketIndex].LengthInBytes < (*RequestPacket->Operation[PacketIndex].Buffer + 1)) {
-              Status = EFI_BUFFER_TOO_SMALL;
-              goto Exit;
-            }
+    Request->Event     = Event;
+    Request->I2cStatus = I2cStatus;
+  } else {
+    Request = &SyncRequest;
+    ZeroMem (Request, sizeof (TEGRA_I2C_REQUEST));
+  }
 
-            RequestPacket->Operation[PacketIndex].LengthInBytes = *RequestPacket->Operation[PacketIndex].Buffer + 1;
-            LengthRemaining                                     = *RequestPacket->Operation[PacketIndex].Buffer;
-            if (PecSupported && LastOperation) {
-              LengthRemaining++;
-            }
-          } else {
-            LengthRemaining -= ReadSize;
-          }
+  Request->Signature     = TEGRA_I2C_REQUEST_SIGNATURE;
+  Request->SlaveAddress  = SlaveAddress;
+  Request->RequestPacket = RequestPacket;
+  Request->State         = TegraI2cRequestStateOperation;
+  Request->BlockTransfer = BlockTransfer;
+  Request->PecSupported  = PecSupported;
 
-          ReadPacketSize -= ReadSize;
-          BufferOffset   += ReadSize;
-        }
-      }
-    } while (LengthRemaining != 0);
+  OldTpl = TegraI2cRaiseTpl ();
+  InsertTailList (&Private->RequestQueue, &Request->Link);
+  Status = TegraI2cServiceQueue (Private);
 
-    if (ReadOperation && PecSupported) {
-      if (RequestPacket->Operation[PacketIndex].LengthInBytes != 0) {
-        Crc8 = CalculateCrc8 (RequestPacket->Operation[PacketIndex].Buffer, RequestPacket->Operation[PacketIndex].LengthInBytes, Crc8, TYPE_CRC8);
-      }
+  if (Asynchronous) {
+    if (Status == EFI_NOT_READY) {
+      gBS->SetTimer (Private->ServiceTimer, TimerPeriodic, I2C_SERVICE_INTERVAL);
     }
 
-    // Error Check
-    Timeout = I2C_TIMEOUT;
-    do {
-      MicroSecondDelay (1);
-      Timeout--;
-      if (Timeout == 0) {
-        DEBUG ((DEBUG_ERROR, "%a: Timeout waiting for Packet Complete\r\n", __FUNCTION__));
-        Status = EFI_TIMEOUT;
-        break;
-      }
-
-      Data32 = MmioRead32 (Private->BaseAddress + I2C_INTERRUPT_STATUS_REGISTER_0_OFFSET);
-      MmioWrite32 (Private->BaseAddress + I2C_INTERRUPT_STATUS_REGISTER_0_OFFSET, Data32);
-      if ((Data32 & INTERRUPT_STATUS_NOACK) != 0) {
-        DEBUG ((DEBUG_INFO, "%a: No ACK received\r\n", __FUNCTION__));
-        Status = EFI_NO_RESPONSE;
-        break;
-      }
-
-      if ((Data32 & INTERRUPT_STATUS_ARB_LOST) != 0) {
-        DEBUG ((DEBUG_ERROR, "%a: ARB Lost\r\n", __FUNCTION__));
-        Status = EFI_DEVICE_ERROR;
-        break;
-      }
-
-      if ((Data32 & INTERRUPT_STATUS_PACKET_XFER_COMPLETE) != 0) {
-        Status = EFI_SUCCESS;
-        break;
-      }
-    } while (TRUE);
-
-    if (EFI_ERROR (Status)) {
-      break;
-    }
+    TegraI2cRestoreTpl (OldTpl);
+    return EFI_SUCCESS;
   }
 
-  if (!EFI_ERROR (Status)) {
-    if (PecSupported &&
-        ((RequestPacket->Operation[RequestPacket->OperationCount-1].Flags & I2C_FLAG_READ) != 0) &&
-        (ReadCrc8 != Crc8))
-    {
-      DEBUG ((DEBUG_ERROR, "%a: PEC Mismatch, got: 0x%02x expected 0x%02x\r\n", __FUNCTION__, ReadCrc8, Crc8));
-      Status = EFI_DEVICE_ERROR;
-      goto Exit;
-    }
+  //
+  // Drop the TPL between polls so the service timers of other controllers
+  // keep their transactions moving.
+  //
+  while (!Request->Done) {
+    TegraI2cRestoreTpl (OldTpl);
+    MicroSecondDelay (1);
+    OldTpl = TegraI2cRaiseTpl ();
+    TegraI2cServiceQueue (Private);
   }
 
-Exit:
+  TegraI2cRestoreTpl (OldTpl);
 
-  if (EFI_ERROR (Status)) {
-    This->Reset (This);
-  }
+  Status = Request->Status;
 
   // synchronous transactions just return Status, but
   // asynchronous transactions update I2cStatus and return success
@@ -739,7 +1019,9 @@ Exit:
     }
 
     Status = EFI_SUCCESS;
-    gBS->SignalEvent (Event);
+    if (!EfiAtRuntime ()) {
+      gBS->SignalEvent (Event);
+    }
   }
 
   return Status;
@@ -1056,6 +1338,19 @@ TegraI2CDriverBindingStart (
   Private->DeviceTreeNode                                 = DeviceTreeNode;
   Private->PacketId                                       = 0;
   Private->HighSpeed                                      = FALSE;
+  InitializeListHead (&Private->RequestQueue);
+
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_NOTIFY,
+                  TegraI2cServiceTimer,
+                  Private,
+                  &Private->ServiceTimer
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "%a: Failed to create service timer, requests will complete synchronously (%r)\r\n", __FUNCTION__, Status));
+    Private->ServiceTimer = NULL;
+  }
 
   Private->PinControlConfigured = FALSE;
   Property                      = FdtGetProp (DeviceTreeNode->DeviceTreeBase, DeviceTreeNode->NodeOffset, "pinctrl-0", NULL);
@@ -1459,6 +1754,10 @@ ErrorExit:
                );
       }
 
+      if (Private->ServiceTimer != NULL) {
+        gBS->CloseEvent (Private->ServiceTimer);
+      }
+
       FreePool (Private);
       // remove the invalid i2c master descriptor.
       mI2cPrivate[--mI2cMasterCount] = NULL;
@@ -1524,6 +1823,10 @@ TegraI2CDriverBindingStop (
     return Status;
   }
 
+  if (Private->ServiceTimer != NULL) {
+    gBS->CloseEvent (Private->ServiceTimer);
+  }
+
   FreePool (Private);
   return EFI_SUCCESS;
 }
@@ -1573,6 +1876,7 @@ DeviceDiscoveryNotify (
       }
 
       Private = TEGRA_I2C_PRIVATE_DATA_FROM_MASTER (I2cMaster);
+      TegraI2cAbortQueue (Private);
       if (Private->SkipOnExitDisabled) {
         Status = EFI_UNSUPPORTED;
       } else {
@@ -1639,6 +1943,8 @@ TegraI2cVirtualNotifyEvent (
       EfiConvertPointer (0x0, (VOID **)&Private->DeviceTreeBase);
       EfiConvertPointer (0x0, (VOID **)&Private->DeviceTreeNode);
       EfiConvertPointer (0x0, (VOID **)&Private->BaseAddress);
+      EfiConvertPointer (0x0, (VOID **)&Private->RequestQueue.ForwardLink);
+      EfiConvertPointer (0x0, (VOID **)&Private->RequestQueue.BackLink);
       EfiConvertPointer (0x0, (VOID **)&mI2cPrivate[Index]);
     }
   }
@@ -56,10 +56,27 @@ typedef enum {
   UfsUicDmeTestMode       = 0x1A
 } UFS_UIC_OPCODE;
 
+// Interrupt Status
+#define UFS_HC_IS_OFFSET  0x0020
+#define UFS_HC_IS_UE      BIT2
+#define UFS_HC_IS_UPMS    BIT4
+
+// Host Controller Status
+#define UFS_HC_STATUS_OFFSET        0x0030
+#define UFS_HC_STATUS_UPMCRS_SHIFT  8
+#define UFS_HC_STATUS_UPMCRS_MASK   0x00000700U
+
 // Host Controller Enable
 #define UFS_HC_ENABLE_OFFSET  0x0034
 #define UFS_HC_HCE_EN         0x00000001U
 
+// UIC power mode change request status (UPMCRS)
+#define UFS_UPMCRS_PWR_LOCAL  0x1U
+
+// Time allowed for a power mode change, long enough for the PWM fallback
+#define UFS_PWR_MODE_CHANGE_TIMEOUT_US  500000
+#define UFS_PWR_MODE_CHANGE_POLL_US     10
+
 /** UIC MIB Attributes */
 #define PA_AVAIL_TX_DATA_LANES      0x1520U
 #define PA_AVAIL_RX_DATA_LANES      0x1540U
@@ -120,6 +137,7 @@ typedef enum {
 #define SET_ST_SCT(x)  (((x) & 0x3UL) << 0)
 
 STATIC UINT32  TxBurstClosureDelay = 0;
+STATIC UINT64  mLinkStartupTime    = 0;
 
 /** Unipro powerchange mode.
  * SLOW : PWM
@@ -206,6 +224,233 @@ UfsDmeCmd (
   return EFI_SUCCESS;
 }
 
+/**
+  Wait for the result of a power mode change requested through PA_PWR_MODE.
+
+  @param[in]  BaseAddress       Base address of the UFS host controller.
+
+  @retval EFI_SUCCESS           The link entered the requested power mode.
+  @retval EFI_TIMEOUT           The controller did not report a result.
+  @retval EFI_DEVICE_ERROR      The power mode change failed.
+**/
+STATIC
+EFI_STATUS
+UfsWaitPowerModeChange (
+  IN EFI_PHYSICAL_ADDRESS  BaseAddress
+  )
+{
+  UINTN   Elapsed;
+  UINT32  Is;
+  UINT32  Result;
+
+  for (Elapsed = 0; ; Elapsed += UFS_PWR_MODE_CHANGE_POLL_US) {
+    Is = MmioRead32 (BaseAddress + UFS_HC_IS_OFFSET) & (UFS_HC_IS_UPMS | UFS_HC_IS_UE);
+    if (Is != 0) {
+      break;
+    }
+
+    if (Elapsed >= UFS_PWR_MODE_CHANGE_TIMEOUT_US) {
+      return EFI_TIMEOUT;
+    }
+
+    MicroSecondDelay (UFS_PWR_MODE_CHANGE_POLL_US);
+  }
+
+  MmioWrite32 (BaseAddress + UFS_HC_IS_OFFSET, Is);
+
+  Result = (MmioRead32 (BaseAddress + UFS_HC_STATUS_OFFSET) & UFS_HC_STATUS_UPMCRS_MASK) >> UFS_HC_STATUS_UPMCRS_SHIFT;
+  if (((Is & UFS_HC_IS_UPMS) == 0) || (Result != UFS_UPMCRS_PWR_LOCAL)) {
+    DEBUG ((DEBUG_WARN, "%a: power mode change failed is=0x%x upmcrs=%u\n", __FUNCTION__, Is, Result));
+    return EFI_DEVICE_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Request a power mode with the given gear, series and lane counts.
+
+  @param[in]  DriverInterface   UFS host controller driver interface.
+  @param[in]  BaseAddress       Base address of the UFS host controller.
+  @param[in]  Mode              PWRMODE_* for both directions.
+  @param[in]  Gear              Gear for both directions.
+  @param[in]  Series            UFS_HS_RATE_* series.
+  @param[in]  TxLanes           Number of active TX data lanes.
+  @param[in]  RxLanes           Number of active RX data lanes.
+  @param[in]  Wait              Wait for and check the result of the change.
+
+  @retval EFI_SUCCESS           The power mode change was requested, and
+                                completed if Wait is TRUE.
+  @retval Others                The power mode change failed.
+**/
+STATIC
+EFI_STATUS
+UfsSetPowerMode (
+  IN EDKII_UFS_HC_DRIVER_INTERFACE  *DriverInterface,
+  IN EFI_PHYSICAL_ADDRESS           BaseAddress,
+  IN UINT32                         Mode,
+  IN UINT32                         Gear,
+  IN UINT32                         Series,
+  IN UINT32                         TxLanes,
+  IN UINT32                         RxLanes,
+  IN BOOLEAN                        Wait
+  )
+{
+  EFI_STATUS  Status;
+
+  UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_ACTIVE_TX_DATA_LANES, TxLanes, NULL);
+  UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_ACTIVE_RX_DATA_LANES, RxLanes, NULL);
+  UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_RX_GEAR, Gear, NULL);
+  UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_TX_GEAR, Gear, NULL);
+  UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_RX_TERMINATION, 1, NULL);
+  UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_TX_TERMINATION, 1, NULL);
+  UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_HS_SERIES, Series, NULL);
+  UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_TX_HS_ADAPT_TYPE, PA_INITIAL_ADAPT_TYPE, NULL);
+
+  MmioWrite32 (BaseAddress + UFS_HC_IS_OFFSET, UFS_HC_IS_UPMS | UFS_HC_IS_UE);
+
+  Status = UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_PWR_MODE, ((Mode << 4) | Mode), NULL);
+  if (EFI_ERROR (Status) || !Wait) {
+    return Status;
+  }
+
+  return UfsWaitPowerModeChange (BaseAddress);
+}
+
+/**
+  Get the highest HS gear that both the host and the device can receive.
+
+  @param[in]  DriverInterface   UFS host controller driver interface.
+  @param[in]  MaxGearOverride   Gear to use instead, if non-zero.
+
+  @retval Highest mutually supported gear, at least 1
+**/
+STATIC
+UINT32
+UfsGetMaxHsGear (
+  IN EDKII_UFS_HC_DRIVER_INTERFACE  *DriverInterface,
+  IN UINT32                         MaxGearOverride
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      LocalGear;
+  UINT32      PeerGear;
+
+  if (MaxGearOverride != 0) {
+    return MaxGearOverride;
+  }
+
+  Status = UfsDmeCmd (DriverInterface, UfsUicDmeGet, PA_MAXRXHSGEAR, 0, &LocalGear);
+  if (EFI_ERROR (Status) || (LocalGear == 0)) {
+    LocalGear = 1;
+  }
+
+  Status = UfsDmeCmd (DriverInterface, UfsUicDmePeerGet, PA_MAXRXHSGEAR, 0, &PeerGear);
+  if (EFI_ERROR (Status) || (PeerGear == 0)) {
+    DEBUG ((DEBUG_ERROR, "%a: peer max gear unknown, using local=%u\n", __FUNCTION__, LocalGear));
+    PeerGear = LocalGear;
+  }
+
+  DEBUG ((DEBUG_INFO, "%a: max rx gear local=%u peer=%u\n", __FUNCTION__, LocalGear, PeerGear));
+
+  return MIN (LocalGear, PeerGear);
+}
+
+/**
+  Move the link to the fastest power mode that actually works.
+
+  HS is tried from the highest mutually supported gear downwards. At each
+  gear the configured series is tried first and rate B falls back to rate A.
+  If no HS gear works on all connected lanes, HS-G1 is tried on a single lane
+  and finally PWM-G1, which every device supports.
+
+  @param[in]  DriverInterface   UFS host controller driver interface.
+  @param[in]  BaseAddress       Base address of the UFS host controller.
+  @param[in]  Mode              PWRMODE_FAST_MODE or PWRMODE_SLOW_MODE.
+  @param[in]  MaxGear           Highest gear to try.
+  @param[in]  TxLanes           Number of connected TX data lanes.
+  @param[in]  RxLanes           Number of connected RX data lanes.
+
+  @retval EFI_SUCCESS           The link is in one of the power modes.
+  @retval Others                No power mode change succeeded.
+**/
+STATIC
+EFI_STATUS
+UfsNegotiatePowerMode (
+  IN EDKII_UFS_HC_DRIVER_INTERFACE  *DriverInterface,
+  IN EFI_PHYSICAL_ADDRESS           BaseAddress,
+  IN UINT32                         Mode,
+  IN UINT32                         MaxGear,
+  IN UINT32                         TxLanes,
+  IN UINT32                         RxLanes
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Gear;
+  UINT32      Series;
+  UINT64      StartTime;
+
+  Series = PcdGet32 (PcdUfsHsSeries);
+
+  //
+  // Slow mode is a bring-up setting, keep requesting it without negotiation.
+  //
+  if (Mode != PWRMODE_FAST_MODE) {
+    return UfsSetPowerMode (DriverInterface, BaseAddress, Mode, MaxGear, Series, TxLanes, RxLanes, FALSE);
+  }
+
+  StartTime = GetTimeInNanoSecond (GetPerformanceCounter ());
+  Status    = EFI_DEVICE_ERROR;
+
+  for (Gear = MaxGear; Gear >= 1; Gear--) {
+    Status = UfsSetPowerMode (DriverInterface, BaseAddress, Mode, Gear, Series, TxLanes, RxLanes, TRUE);
+    if (!EFI_ERROR (Status)) {
+      goto Done;
+    }
+
+    if (Series == UFS_HS_RATE_B) {
+      DEBUG ((DEBUG_WARN, "%a: HS-G%u rate B failed, trying rate A\n", __FUNCTION__, Gear));
+      Series = UFS_HS_RATE_A;
+      Status = UfsSetPowerMode (DriverInterface, BaseAddress, Mode, Gear, Series, TxLanes, RxLanes, TRUE);
+      if (!EFI_ERROR (Status)) {
+        goto Done;
+      }
+    }
+
+    DEBUG ((DEBUG_WARN, "%a: HS-G%u failed: %r\n", __FUNCTION__, Gear, Status));
+  }
+
+  Gear = 1;
+  if ((TxLanes > 1) || (RxLanes > 1)) {
+    TxLanes = 1;
+    RxLanes = 1;
+    Status  = UfsSetPowerMode (DriverInterface, BaseAddress, Mode, Gear, Series, TxLanes, RxLanes, TRUE);
+    if (!EFI_ERROR (Status)) {
+      goto Done;
+    }
+  }
+
+  DEBUG ((DEBUG_ERROR, "%a: HS failed, falling back to PWM-G1\n", __FUNCTION__));
+  Mode   = PWRMODE_SLOW_MODE;
+  Status = UfsSetPowerMode (DriverInterface, BaseAddress, Mode, Gear, Series, TxLanes, RxLanes, TRUE);
+
+Done:
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: mode=%u gear=%u series=%u lanes tx=%u rx=%u in %lu us: %r\n",
+    __FUNCTION__,
+    Mode,
+    Gear,
+    Series,
+    TxLanes,
+    RxLanes,
+    DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter ()) - StartTime, 1000),
+    Status
+    ));
+
+  return Status;
+}
+
 /**
   Callback function for platform driver.
 
@@ -234,6 +479,8 @@ UfsCallback (
   UINT32                         Value;
   UINT32                         Mode;
   UINT32                         MaxGearOverride;
+  UINT32                         TxLanes;
+  UINT32                         RxLanes;
 
   TxBurstClosureDelay = 0;
   Value               = 0;
@@ -281,12 +528,20 @@ UfsCallback (
       break;
 
     case EdkiiUfsHcPreLinkStartup:
+      mLinkStartupTime = GetTimeInNanoSecond (GetPerformanceCounter ());
       UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_LOCAL_TX_LCC_ENABLE, 0, NULL);
       UfsDmeCmd (DriverInterface, UfsUicDmeGet, VS_TXBURSTCLOSUREDELAY, 0, &TxBurstClosureDelay);
       UfsDmeCmd (DriverInterface, UfsUicDmeSet, VS_TXBURSTCLOSUREDELAY, 0, NULL);
       break;
 
     case EdkiiUfsHcPostLinkStartup:
+      DEBUG ((
+        DEBUG_INFO,
+        "%a: link startup took %lu us\n",
+        __FUNCTION__,
+        DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter ()) - mLinkStartupTime, 1000)
+        ));
+
       MaxGearOverride = PcdGet32 (PcdUfsMaxGearOverride);
       if (MaxGearOverride != 0) {
         DEBUG ((DEBUG_ERROR, "%a: using max gear override=%u\n", __FUNCTION__, MaxGearOverride));
@@ -307,19 +562,20 @@ UfsCallback (
 
       UfsDmeCmd (DriverInterface, UfsUicDmeSet, VS_TXBURSTCLOSUREDELAY, TxBurstClosureDelay, NULL);
 
-      Status = UfsDmeCmd (DriverInterface, UfsUicDmeGet, PA_CONNECTED_TX_DATA_LANES, 0, &Value);
-      if (!EFI_ERROR (Status)) {
-        DEBUG ((DEBUG_INFO, "%a: set tx data lanes=%u", __FUNCTION__, Value));
-
-        UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_ACTIVE_TX_DATA_LANES, Value, NULL);
+      TxLanes = 1;
+      RxLanes = 1;
+      Status  = UfsDmeCmd (DriverInterface, UfsUicDmeGet, PA_CONNECTED_TX_DATA_LANES, 0, &Value);
+      if (!EFI_ERROR (Status) && (Value != 0)) {
+        TxLanes = Value;
       }
 
       Status = UfsDmeCmd (DriverInterface, UfsUicDmeGet, PA_CONNECTED_RX_DATA_LANES, 0, &Value);
-      if (!EFI_ERROR (Status)) {
-        DEBUG ((DEBUG_INFO, "%a: set rx data lanes=%u\n", __FUNCTION__, Value));
-        UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_ACTIVE_RX_DATA_LANES, Value, NULL);
+      if (!EFI_ERROR (Status) && (Value != 0)) {
+        RxLanes = Value;
       }
 
+      DEBUG ((DEBUG_INFO, "%a: connected data lanes tx=%u rx=%u\n", __FUNCTION__, TxLanes, RxLanes));
+
       UfsDmeCmd (DriverInterface, UfsUicDmeGet, VS_DEBUGSAVECONFIGTIME, 0, &Value);
       Value &= ~(SET_TREF (~0UL));
       Value |= SET_TREF (VS_DEBUGSAVECONFIGTIME_TREF);
@@ -327,46 +583,22 @@ UfsCallback (
       Value |= SET_TREF (VS_DEBUGSAVECONFIGTIME_ST_SCT);
       UfsDmeCmd (DriverInterface, UfsUicDmeSet, VS_DEBUGSAVECONFIGTIME, Value, NULL);
 
-      Status = UfsDmeCmd (DriverInterface, UfsUicDmeGet, PA_MAXRXHSGEAR, 0, &Value);
-      if (!EFI_ERROR (Status)) {
-        if (MaxGearOverride != 0) {
-          Value = MaxGearOverride;
-        }
-
-        DEBUG ((DEBUG_INFO, "%a: set rx gear=%u\n", __FUNCTION__, Value));
-        UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_RX_GEAR, Value, NULL);
-      }
-
-      Status = UfsDmeCmd (DriverInterface, UfsUicDmePeerGet, PA_MAXRXHSGEAR, 0, &Value);
-      if (!EFI_ERROR (Status)) {
-        if (MaxGearOverride != 0) {
-          Value = MaxGearOverride;
-        }
-
-        DEBUG ((DEBUG_INFO, "%a: set tx gear to peer=%u\n", __FUNCTION__, Value));
-        UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_TX_GEAR, Value, NULL);
-      } else {
-        Status = UfsDmeCmd (DriverInterface, UfsUicDmeGet, PA_MAXRXHSGEAR, 0, &Value);
-        if (!EFI_ERROR (Status)) {
-          if (MaxGearOverride != 0) {
-            Value = MaxGearOverride;
-          }
-
-          DEBUG ((DEBUG_ERROR, "%a: setting tx gear to rx=%u\n", __FUNCTION__, Value));
-          UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_TX_GEAR, Value, NULL);
-        }
-      }
-
-      UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_RX_TERMINATION, 1, NULL);
-      UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_TX_TERMINATION, 1, NULL);
       UfsDmeCmd (DriverInterface, UfsUicDmeGet, PA_HS_SERIES, 0, &Value);
       DEBUG ((DEBUG_INFO, "%a: HS Series pcd=%u value=%u\n", __FUNCTION__, PcdGet32 (PcdUfsHsSeries), Value));
-      Value = PcdGet32 (PcdUfsHsSeries);
-      UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_HS_SERIES, Value, NULL);
-      UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_TX_HS_ADAPT_TYPE, PA_INITIAL_ADAPT_TYPE, NULL);
       DEBUG ((DEBUG_INFO, "%a: HS pcd=%u mode=%u adapt type=%u\n", __FUNCTION__, PcdGetBool (PcdUfsEnableHighSpeed), Mode, PA_INITIAL_ADAPT_TYPE));
 
-      UfsDmeCmd (DriverInterface, UfsUicDmeSet, PA_PWR_MODE, ((Mode << 4) | Mode), NULL);
+      Status = UfsNegotiatePowerMode (
+                 DriverInterface,
+                 BaseAddress,
+                 Mode,
+                 UfsGetMaxHsGear (DriverInterface, MaxGearOverride),
+                 TxLanes,
+                 RxLanes
+                 );
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "%a: power mode change failed: %r\n", __FUNCTION__, Status));
+      }
+
       break;
 
     default:
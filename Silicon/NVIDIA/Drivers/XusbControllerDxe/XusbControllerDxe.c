@@ -15,6 +15,7 @@
 #include <Library/HobLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiLib.h>
+#include <Library/CoroutineLib.h>
 #include <Library/DeviceDiscoveryDriverLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/PlatformResourceLib.h>
@@ -1957,25 +1958,7 @@ XudcPollField (
   UINT32  timeout
   )
 {
-  UINT32      reg_data;
-  EFI_STATUS  Status = EFI_SUCCESS;
-
-  do {
-    reg_data = MmioRead32 (reg_addr);
-
-    if ((reg_data & mask) == expected_value) {
-      return EFI_SUCCESS;
-    }
-
-    DeviceDiscoveryThreadMicroSecondDelay (1);
-    timeout--;
-  } while (timeout != 0U);
-
-  Status   = EFI_TIMEOUT;
-  reg_data = MmioRead32 (reg_addr);
-  // DEBUG ((EFI_D_ERROR, "%a, pending interrupt 0x%08x\r\n", __FUNCTION__, reg_data));
-
-  return Status;
+  return CoroutinePollMmio32 (reg_addr, mask, expected_value, 1, timeout);
 }
 
 static EFI_STATUS
@@ -0,0 +1,94 @@
+/** @file
+
+  Timing and reporting helpers for host based benchmarks.
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __HOST_BENCHMARK_LIB_H__
+#define __HOST_BENCHMARK_LIB_H__
+
+#include <Uefi.h>
+#include <HostBasedTestStubLib/NorFlashStubLib.h>
+
+typedef struct {
+  CONST CHAR8                  *Name;
+  NVIDIA_NOR_FLASH_PROTOCOL    *NorFlash;
+  UINT64                       StartNs;
+} HOST_BENCHMARK;
+
+/**
+  Create an erased virtual NOR flash device with the typical latencies of a
+  quad SPI NOR device.
+
+  @param  Size                  Size of the device in bytes
+  @param  BlockSize             Size of an erase block in bytes
+  @param  Memory                Where to return the backing memory of the device
+  @param  Protocol              Where to return the protocol of the device
+
+  @retval EFI_SUCCESS           The device was created
+  @retval EFI_OUT_OF_RESOURCES  The device couldn't be allocated
+
+**/
+EFI_STATUS
+EFIAPI
+HostBenchmarkCreateNorFlash (
+  IN  UINT32                     Size,
+  IN  UINT32                     BlockSize,
+  OUT UINT8                      **Memory,
+  OUT NVIDIA_NOR_FLASH_PROTOCOL  **Protocol
+  );
+
+/**
+  Free a virtual NOR flash device created by HostBenchmarkCreateNorFlash
+
+  @param  Memory                Backing memory of the device
+  @param  Protocol              Protocol of the device
+
+**/
+VOID
+EFIAPI
+HostBenchmarkDestroyNorFlash (
+  IN UINT8                      *Memory,
+  IN NVIDIA_NOR_FLASH_PROTOCOL  *Protocol
+  );
+
+/**
+  Start timing a benchmark. The operation counts of the NOR flash device are
+  cleared so that only the flash operations of the benchmark are reported.
+
+  @param  Benchmark             Benchmark to start
+  @param  Name                  Name to report the benchmark under
+  @param  NorFlash              Virtual NOR flash device used, or NULL
+
+**/
+VOID
+EFIAPI
+HostBenchmarkStart (
+  OUT HOST_BENCHMARK             *Benchmark,
+  IN  CONST CHAR8                *Name,
+  IN  NVIDIA_NOR_FLASH_PROTOCOL  *NorFlash OPTIONAL
+  );
+
+/**
+  Stop timing a benchmark and report its results.
+
+  Operations per second are reported both for the host alone and with the
+  simulated time of the NOR flash device added, along with the number of
+  flash operations done per benchmark operation.
+
+  @param  Benchmark             Benchmark to stop
+  @param  Operations            Number of operations done by the benchmark
+
+**/
+VOID
+EFIAPI
+HostBenchmarkStop (
+  IN HOST_BENCHMARK  *Benchmark,
+  IN UINT64          Operations
+  );
+
+#endif
@@ -2,7 +2,7 @@
 
 NOR Flash stub definitions.
 
-Copyright (c) 2020-2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+Copyright (c) 2020-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -14,6 +14,42 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Uefi.h>
 #include <Protocol/NorFlash.h>
 
+//
+// Latencies of a typical quad SPI NOR device
+//
+#define VIRTUAL_NOR_FLASH_TYPICAL_READ_COMMAND_NS   5000
+#define VIRTUAL_NOR_FLASH_TYPICAL_READ_BYTE_NS      20
+#define VIRTUAL_NOR_FLASH_TYPICAL_WRITE_COMMAND_NS  5000
+#define VIRTUAL_NOR_FLASH_TYPICAL_WRITE_PAGE_NS     700000
+#define VIRTUAL_NOR_FLASH_TYPICAL_ERASE_BLOCK_NS    150000000
+
+//
+// Simulated latencies of a virtual NOR flash device. The latencies are not
+// waited for, they are accumulated in VIRTUAL_NOR_FLASH_STATS.DeviceTimeNs
+// so that results don't depend on the host scheduler.
+//
+typedef struct {
+  UINT64    ReadCommandNs;            // Cost of each read
+  UINT64    ReadByteNs;               // Cost of each byte read
+  UINT64    WriteCommandNs;           // Cost of each write
+  UINT64    WritePageNs;              // Cost of each program page written
+  UINT64    EraseBlockNs;             // Cost of each block erased
+} VIRTUAL_NOR_FLASH_LATENCY;
+
+//
+// Operations done on a virtual NOR flash device
+//
+typedef struct {
+  UINT64    Reads;
+  UINT64    Writes;
+  UINT64    Erases;
+  UINT64    BytesRead;
+  UINT64    BytesWritten;
+  UINT64    PagesWritten;
+  UINT64    BlocksErased;
+  UINT64    DeviceTimeNs;             // Simulated time spent in the device
+} VIRTUAL_NOR_FLASH_STATS;
+
 /**
   Create a virtual NOR flash device and return its protocol
 
@@ -51,6 +87,42 @@ VirtualNorFlashStubDestroy (
   IN NVIDIA_NOR_FLASH_PROTOCOL  *Protocol
   );
 
+/**
+  Set the simulated latencies of a virtual NOR flash device
+
+  @param  Protocol              Protocol of the virtual device
+  @param  Latency               Latencies to simulate, or NULL for none
+
+  @retval EFI_SUCCESS           The latencies were set
+  @retval EFI_INVALID_PARAMETER A Null parameter was found
+
+**/
+EFI_STATUS
+EFIAPI
+VirtualNorFlashSetLatency (
+  IN NVIDIA_NOR_FLASH_PROTOCOL        *Protocol,
+  IN CONST VIRTUAL_NOR_FLASH_LATENCY  *Latency OPTIONAL
+  );
+
+/**
+  Get the operations done on a virtual NOR flash device
+
+  @param  Protocol              Protocol of the virtual device
+  @param  Stats                 Where to copy the operation counts
+  @param  Reset                 Clear the operation counts after copying them
+
+  @retval EFI_SUCCESS           The operation counts were copied
+  @retval EFI_INVALID_PARAMETER A Null parameter was found
+
+**/
+EFI_STATUS
+EFIAPI
+VirtualNorFlashGetStats (
+  IN  NVIDIA_NOR_FLASH_PROTOCOL  *Protocol,
+  OUT VIRTUAL_NOR_FLASH_STATS    *Stats,
+  IN  BOOLEAN                    Reset
+  );
+
 /**
   Create a faulty NOR flash device and return its protocol
 
@@ -0,0 +1,258 @@
+/** @file
+
+  Coroutine Library
+
+  Cooperative coroutines for DXE drivers. Each coroutine runs on its own stack
+  and yields back to the dispatcher whenever it waits on a delay, an event, or
+  a polled condition, allowing hardware bring-up latencies of independent
+  controllers to overlap.
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef COROUTINE_LIB_H__
+#define COROUTINE_LIB_H__
+
+#include <Uefi/UefiBaseType.h>
+
+#define COROUTINE_DEFAULT_STACK_SIZE  SIZE_64KB
+
+///
+/// Wait forever when passed as a timeout.  A timeout of 0 checks once
+/// without waiting.
+///
+#define COROUTINE_TIMEOUT_INFINITE  MAX_UINTN
+
+typedef VOID *COROUTINE_HANDLE;
+
+/**
+  Coroutine entry point
+
+  @param[in]  Context          Context passed to CoroutineSpawn
+
+  @retval Status reported for the coroutine
+**/
+typedef
+EFI_STATUS
+(EFIAPI *COROUTINE_ENTRY)(
+  IN VOID  *Context
+  );
+
+/**
+  Condition callback used by CoroutineWaitForCondition
+
+  @param[in]  Context          Context passed to CoroutineWaitForCondition
+
+  @retval TRUE                 Condition is met
+  @retval FALSE                Condition is not met
+**/
+typedef
+BOOLEAN
+(EFIAPI *COROUTINE_CONDITION)(
+  IN VOID  *Context
+  );
+
+/**
+  Spawns a new coroutine.
+
+  If called outside of a coroutine the new coroutine runs immediately until it
+  first yields. If called from a coroutine the new coroutine is scheduled for
+  the next timer tick. Must be called at TPL_APPLICATION or TPL_CALLBACK.
+
+  @param[in]  Name              Name of the coroutine, used in the report.
+  @param[in]  Entry             Entry point of the coroutine.
+  @param[in]  Context           Context passed to Entry.
+  @param[in]  StackSize         Stack size, 0 for COROUTINE_DEFAULT_STACK_SIZE.
+  @param[in]  CompletionEvent   Optional event signaled when Entry returns.
+  @param[out] Handle            Optional handle for CoroutineWait. Without a
+                                handle the coroutine is freed when it returns,
+                                otherwise the caller frees it with CoroutineFree.
+
+  @retval EFI_SUCCESS           Coroutine was started
+  @retval EFI_INVALID_PARAMETER Name or Entry is NULL
+  @retval EFI_OUT_OF_RESOURCES  Failed to allocate coroutine
+  @retval others                Error occurred
+**/
+EFI_STATUS
+EFIAPI
+CoroutineSpawn (
+  IN  CONST CHAR8       *Name,
+  IN  COROUTINE_ENTRY   Entry,
+  IN  VOID              *Context,
+  IN  UINTN             StackSize,
+  IN  EFI_EVENT         CompletionEvent OPTIONAL,
+  OUT COROUTINE_HANDLE  *Handle OPTIONAL
+  );
+
+/**
+  Checks if the caller is running in a coroutine.
+
+  @retval TRUE                  Caller is running in a coroutine
+  @retval FALSE                 Caller is running in the main context
+**/
+BOOLEAN
+EFIAPI
+CoroutineIsActive (
+  VOID
+  );
+
+/**
+  Returns the number of coroutines that have not yet completed.
+
+  @retval Number of pending coroutines
+**/
+UINTN
+EFIAPI
+CoroutinesPending (
+  VOID
+  );
+
+/**
+  Stalls for at least the given number of microseconds.
+
+  When called from a coroutine, yields to other work for the duration of the
+  delay. Otherwise behaves like MicroSecondDelay.
+
+  @param[in]  MicroSeconds      The minimum number of microseconds to delay.
+
+  @return The value of MicroSeconds inputted.
+**/
+UINTN
+EFIAPI
+CoroutineMicroSecondDelay (
+  IN UINTN  MicroSeconds
+  );
+
+/**
+  Waits until a condition is met.
+
+  @param[in]  Condition         Condition callback.
+  @param[in]  Context           Context passed to Condition.
+  @param[in]  PollIntervalUs    Interval between checks in microseconds.
+  @param[in]  TimeoutUs         Timeout in microseconds, or COROUTINE_TIMEOUT_INFINITE.
+
+  @retval EFI_SUCCESS           Condition was met
+  @retval EFI_TIMEOUT           Condition was not met before timeout
+  @retval EFI_INVALID_PARAMETER Condition is NULL
+**/
+EFI_STATUS
+EFIAPI
+CoroutineWaitForCondition (
+  IN COROUTINE_CONDITION  Condition,
+  IN VOID                 *Context,
+  IN UINTN                PollIntervalUs,
+  IN UINTN                TimeoutUs
+  );
+
+/**
+  Waits until an event is signaled.
+
+  Intended for tokens such as BPMP IPC or I2C request events. The event must
+  not be of type EVT_NOTIFY_SIGNAL. On success the event is reset to the
+  non-signaled state.
+
+  @param[in]  Event             Event to wait on.
+  @param[in]  TimeoutUs         Timeout in microseconds, or COROUTINE_TIMEOUT_INFINITE.
+
+  @retval EFI_SUCCESS           Event was signaled
+  @retval EFI_TIMEOUT           Event was not signaled before timeout
+  @retval others                Error occurred
+**/
+EFI_STATUS
+EFIAPI
+CoroutineWaitForEvent (
+  IN EFI_EVENT  Event,
+  IN UINTN      TimeoutUs
+  );
+
+/**
+  Polls a 16-bit register until (Register & Mask) == Value.
+
+  @param[in]  Address           Address of the register.
+  @param[in]  Mask              Mask to apply to the register.
+  @param[in]  Value             Expected value after masking.
+  @param[in]  PollIntervalUs    Interval between reads in microseconds.
+  @param[in]  TimeoutUs         Timeout in microseconds, or COROUTINE_TIMEOUT_INFINITE.
+
+  @retval EFI_SUCCESS           Register matched
+  @retval EFI_TIMEOUT           Register did not match before timeout
+**/
+EFI_STATUS
+EFIAPI
+CoroutinePollMmio16 (
+  IN UINTN   Address,
+  IN UINT16  Mask,
+  IN UINT16  Value,
+  IN UINTN   PollIntervalUs,
+  IN UINTN   TimeoutUs
+  );
+
+/**
+  Polls a 32-bit register until (Register & Mask) == Value.
+
+  @param[in]  Address           Address of the register.
+  @param[in]  Mask              Mask to apply to the register.
+  @param[in]  Value             Expected value after masking.
+  @param[in]  PollIntervalUs    Interval between reads in microseconds.
+  @param[in]  TimeoutUs         Timeout in microseconds, or COROUTINE_TIMEOUT_INFINITE.
+
+  @retval EFI_SUCCESS           Register matched
+  @retval EFI_TIMEOUT           Register did not match before timeout
+**/
+EFI_STATUS
+EFIAPI
+CoroutinePollMmio32 (
+  IN UINTN   Address,
+  IN UINT32  Mask,
+  IN UINT32  Value,
+  IN UINTN   PollIntervalUs,
+  IN UINTN   TimeoutUs
+  );
+
+/**
+  Waits for a coroutine to complete.
+
+  @param[in]  Handle            Handle returned by CoroutineSpawn.
+  @param[out] CoroutineStatus   Optional status returned by the coroutine.
+
+  @retval EFI_SUCCESS           Coroutine completed
+  @retval EFI_INVALID_PARAMETER Handle is invalid
+  @retval EFI_UNSUPPORTED       Called from main context at or above TPL_CALLBACK
+**/
+EFI_STATUS
+EFIAPI
+CoroutineWait (
+  IN  COROUTINE_HANDLE  Handle,
+  OUT EFI_STATUS        *CoroutineStatus OPTIONAL
+  );
+
+/**
+  Frees a completed coroutine. The handle is invalid afterwards.
+
+  @param[in]  Handle            Handle returned by CoroutineSpawn.
+
+  @retval EFI_SUCCESS           Coroutine was freed
+  @retval EFI_INVALID_PARAMETER Handle is invalid
+  @retval EFI_NOT_READY         Coroutine has not completed
+**/
+EFI_STATUS
+EFIAPI
+CoroutineFree (
+  IN  COROUTINE_HANDLE  Handle
+  );
+
+/**
+  Prints the run and wait time of every coroutine spawned by this module.
+
+  Called automatically at ReadyToBoot.
+**/
+VOID
+EFIAPI
+CoroutineReport (
+  VOID
+  );
+
+#endif
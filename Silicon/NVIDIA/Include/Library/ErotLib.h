@@ -2,7 +2,7 @@
 
   Erot library
 
-  Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  Copyright (c) 2022-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -24,6 +24,24 @@ EFI_STATUS
   IN UINTN                  ResponseLength
   );
 
+// default time to wait for all fan-out responses, MCTP MT2 max
+#define EROT_FANOUT_TIMEOUT_MS  (5 * 1000)
+
+typedef struct {
+  // input
+  NVIDIA_MCTP_PROTOCOL    *Protocol;
+  VOID                    *ResponseBuffer;
+  UINTN                   ResponseBufferLength;
+
+  // output
+  UINTN                   ResponseLength;
+  EFI_STATUS              Status;
+
+  // private
+  UINT8                   MsgTag;
+  BOOLEAN                 Pending;
+} EROT_FANOUT_ENTRY;
+
 /**
   Get number of erots.  Must call ErotLibInit() before using.
 
@@ -87,6 +105,31 @@ ErotSendRequestToAll (
   IN  EROT_RESPONSE_CHECK  ResponseCheck
   );
 
+/**
+  Send the same MCTP request to several erots at once and gather the
+  responses against a single deadline.  Each entry's Status is set to the
+  result of its request, EFI_TIMEOUT if no response arrived in time.
+
+  @param[in]     Request           Pointer to request message.
+  @param[in]     RequestLength     Length of request message.
+  @param[in out] Entries           Array of per-erot protocols and responses.
+  @param[in]     NumEntries        Number of entries.
+  @param[in]     TimeoutMs         Ms to wait for all responses.
+
+  @retval EFI_SUCCESS     All requests completed normally.
+  @retval Others          At least one request failed.
+
+**/
+EFI_STATUS
+EFIAPI
+ErotDoRequestFanOut (
+  IN     VOID               *Request,
+  IN     UINTN              RequestLength,
+  IN OUT EROT_FANOUT_ENTRY  *Entries,
+  IN     UINTN              NumEntries,
+  IN     UINTN              TimeoutMs
+  );
+
 /**
   Send boot complete message to erot.
 
@@ -104,6 +147,23 @@ ErotSendBootComplete (
   IN UINTN  BootSlot
   );
 
+/**
+  Send boot complete message to the erots of all sockets in a mask at once.
+
+  @param[in]  SocketMask           Mask of sockets to send to.
+  @param[in]  BootSlot             BootSlot that sockets booted from.
+
+  @retval EFI_SUCCESS     Operation completed normally.
+  @retval Others          Failure occurred for at least one socket.
+
+**/
+EFI_STATUS
+EFIAPI
+ErotSendBootCompleteAll (
+  IN UINT32  SocketMask,
+  IN UINTN   BootSlot
+  );
+
 /**
   Deinitialize Erot Library.
 
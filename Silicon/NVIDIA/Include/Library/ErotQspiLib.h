@@ -2,7 +2,7 @@
 
   Erot Qspi Library
 
-  Copyright (c) 2022-2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  Copyright (c) 2022-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -86,6 +86,13 @@ typedef struct {
   BOOLEAN                            ErotIsInitialized;
   BOOLEAN                            HasMessageAvailable;
 
+  // statistics
+  UINT64                             TxBytes;
+  UINT64                             TxNs;
+  UINT64                             RxBytes;
+  UINT64                             RxNs;
+  UINT64                             Xfers;
+
   // protocol
   EFI_HANDLE                         Handle;
   NVIDIA_MCTP_PROTOCOL               Protocol;
@@ -113,6 +113,9 @@ struct _FW_PARTITION_PRIVATE_DATA {
   // Protocol info
   EFI_HANDLE                      Handle;
   NVIDIA_FW_PARTITION_PROTOCOL    Protocol;
+
+  // Incremented on every write attempt through the protocol
+  UINT32                          WriteCount;
 };
 
 /**
@@ -294,6 +297,18 @@ FwPartitionGetPrivateArray (
   VOID
   );
 
+/**
+  Get the number of slots in the partition name index.
+
+  @retval UINTN                 Number of slots, 0 if there is no index
+
+**/
+UINTN
+EFIAPI
+FwPartitionGetNameIndexSize (
+  VOID
+  );
+
 /**
   Add FW pseudo-partition that updates inactive partition meta-data on write.
 
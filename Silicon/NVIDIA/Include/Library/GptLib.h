@@ -3,7 +3,7 @@
   GPT - GUID Partition Table Library Public Interface
         This implementation of GPT uses just the secondary GPT table.
 
-  SPDX-FileCopyrightText: Copyright (c) 2021-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2021-2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -98,6 +98,21 @@ GptFindPartitionByName (
   IN CONST CHAR16                      *Name
   );
 
+/**
+  Hash a partition name
+
+  @param[in]    Name            Pointer to the name string to hash
+  @param[in]    MaxLength       Maximum number of characters to hash
+
+  @retval       UINT32          Hash of the name
+**/
+UINT32
+EFIAPI
+GptPartitionNameHash (
+  IN CONST CHAR16  *Name,
+  IN UINTN         MaxLength
+  );
+
 /**
   Return the size of a partition in blocks
 
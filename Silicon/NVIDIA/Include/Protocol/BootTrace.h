@@ -0,0 +1,136 @@
+/** @file
+  NVIDIA Boot Trace Protocol
+
+  Records begin/end spans and instant events in a compact binary format in the
+  profiler carveout. The buffer layout is:
+
+    NVIDIA_BOOT_TRACE_HEADER
+    NVIDIA_BOOT_TRACE_RECORD[MaxRecords]
+    String table (NUL terminated ASCII names referenced by NameOffset)
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef BOOT_TRACE_PROTOCOL_H__
+#define BOOT_TRACE_PROTOCOL_H__
+
+#include <Uefi/UefiBaseType.h>
+
+#define NVIDIA_BOOT_TRACE_PROTOCOL_GUID \
+  { \
+    0x8c1a4e57, 0x2d3b, 0x4f60, { 0x9a, 0x1e, 0x5b, 0x7c, 0x44, 0x0d, 0x93, 0xe2 } \
+  }
+
+#define NVIDIA_BOOT_TRACE_SIGNATURE  SIGNATURE_32 ('N', 'V', 'B', 'T')
+#define NVIDIA_BOOT_TRACE_VERSION    1
+
+///
+/// Span id returned when a span could not be recorded
+///
+#define NVIDIA_BOOT_TRACE_INVALID_SPAN  0
+
+typedef enum {
+  BootTraceRecordBegin = 1,
+  BootTraceRecordEnd,
+  BootTraceRecordInstant
+} NVIDIA_BOOT_TRACE_RECORD_TYPE;
+
+typedef enum {
+  BootTraceCategoryDriver,
+  BootTraceCategoryDeviceDiscovery,
+  BootTraceCategoryConnect,
+  BootTraceCategoryBpmpIpc,
+  BootTraceCategoryFlash,
+  BootTraceCategoryImage,
+  BootTraceCategoryOther
+} NVIDIA_BOOT_TRACE_CATEGORY;
+
+#pragma pack(1)
+typedef struct {
+  UINT32    Signature;
+  UINT16    Version;
+  UINT16    HeaderSize;
+  UINT32    RecordSize;
+  UINT32    MaxRecords;
+  UINT32    RecordCount;
+  UINT32    DroppedRecords;
+  UINT64    TimerFrequency;
+  UINT32    StringTableOffset;      // From the start of the header
+  UINT32    StringTableSize;
+  UINT32    StringTableUsed;
+  UINT32    Reserved;
+} NVIDIA_BOOT_TRACE_HEADER;
+
+typedef struct {
+  UINT64    Timestamp;              // Performance counter ticks
+  UINT32    Argument;               // Span id for end records, caller defined otherwise
+  UINT16    NameOffset;             // Offset into the string table
+  UINT8     Type;                   // NVIDIA_BOOT_TRACE_RECORD_TYPE
+  UINT8     Category;               // NVIDIA_BOOT_TRACE_CATEGORY
+} NVIDIA_BOOT_TRACE_RECORD;
+#pragma pack()
+
+typedef struct _NVIDIA_BOOT_TRACE_PROTOCOL NVIDIA_BOOT_TRACE_PROTOCOL;
+
+/**
+  Records the beginning of a span.
+
+  @param[in]  This              Instance of the protocol.
+  @param[in]  Category          NVIDIA_BOOT_TRACE_CATEGORY of the span.
+  @param[in]  Name              Name of the span.
+  @param[in]  Argument          Caller defined argument.
+
+  @retval Span id to pass to End, or NVIDIA_BOOT_TRACE_INVALID_SPAN
+**/
+typedef
+UINT32
+(EFIAPI *NVIDIA_BOOT_TRACE_BEGIN)(
+  IN NVIDIA_BOOT_TRACE_PROTOCOL  *This,
+  IN UINT8                       Category,
+  IN CONST CHAR8                 *Name,
+  IN UINT32                      Argument
+  );
+
+/**
+  Records the end of a span.
+
+  @param[in]  This              Instance of the protocol.
+  @param[in]  SpanId            Span id returned by Begin.
+**/
+typedef
+VOID
+(EFIAPI *NVIDIA_BOOT_TRACE_END)(
+  IN NVIDIA_BOOT_TRACE_PROTOCOL  *This,
+  IN UINT32                      SpanId
+  );
+
+/**
+  Records an instant event.
+
+  @param[in]  This              Instance of the protocol.
+  @param[in]  Category          NVIDIA_BOOT_TRACE_CATEGORY of the event.
+  @param[in]  Name              Name of the event.
+  @param[in]  Argument          Caller defined argument.
+**/
+typedef
+VOID
+(EFIAPI *NVIDIA_BOOT_TRACE_INSTANT)(
+  IN NVIDIA_BOOT_TRACE_PROTOCOL  *This,
+  IN UINT8                       Category,
+  IN CONST CHAR8                 *Name,
+  IN UINT32                      Argument
+  );
+
+/// NVIDIA_BOOT_TRACE_PROTOCOL protocol structure.
+struct _NVIDIA_BOOT_TRACE_PROTOCOL {
+  NVIDIA_BOOT_TRACE_BEGIN      Begin;
+  NVIDIA_BOOT_TRACE_END        End;
+  NVIDIA_BOOT_TRACE_INSTANT    Instant;
+};
+
+extern EFI_GUID  gNVIDIABootTraceProtocolGuid;
+
+#endif
@@ -1,7 +1,7 @@
 /** @file
   Clock node protocol Protocol
 
-  Copyright (c) 2018-2021, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  Copyright (c) 2018-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -17,6 +17,14 @@
   0x6fa542ef, 0xec08, 0x4450, { 0xb1, 0x7b, 0xf6, 0x31, 0x5d, 0x32, 0xc5, 0x40 } \
   }
 
+//
+// Clock ids carry the BPMP phandle in the upper 16 bits
+//
+#define NVIDIA_CLOCK_MASK                ((UINT32)0x0000FFFF)
+#define NVIDIA_CLOCK_BPMP_PHANDLE_SHIFT  16
+#define NVIDIA_CLOCK_ID(ID)              ((ID) & NVIDIA_CLOCK_MASK)
+#define NVIDIA_CLOCK_BPMP_PHANDLE(ID)    ((ID) >> NVIDIA_CLOCK_BPMP_PHANDLE_SHIFT)
+
 //
 // Define for forward reference.
 //
@@ -1,7 +1,7 @@
 /** @file
   Power Gate node protocol Protocol
 
-  Copyright (c) 2018-2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  Copyright (c) 2018-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -81,14 +81,30 @@ EFI_STATUS
   OUT UINT32                            *PowerGateState
   );
 
+/**
+  This function allows for deassert of all power gate nodes.
+
+  @param[in]     This                The instance of the NVIDIA_POWER_GATE_NODE_PROTOCOL.
+
+  @return EFI_SUCCESS                All powergates deasserted.
+  @return EFI_NOT_READY              BPMP-IPC protocol is not installed.
+  @return EFI_DEVICE_ERROR           Failed to deassert all powergates
+**/
+typedef
+EFI_STATUS
+(EFIAPI *POWER_GATE_NODE_DEASSERT_ALL)(
+  IN  NVIDIA_POWER_GATE_NODE_PROTOCOL   *This
+  );
+
 /// NVIDIA_POWER_GATE_NODE_PROTOCOL protocol structure.
 struct _NVIDIA_POWER_GATE_NODE_PROTOCOL {
-  POWER_GATE_NODE_DEASSERT     Deassert;
-  POWER_GATE_NODE_ASSERT       Assert;
-  POWER_GATE_NODE_GET_STATE    GetState;
-  UINT32                       BpmpPhandle;
-  UINT32                       NumberOfPowerGates;
-  UINT32                       PowerGateId[1];
+  POWER_GATE_NODE_DEASSERT        Deassert;
+  POWER_GATE_NODE_ASSERT          Assert;
+  POWER_GATE_NODE_GET_STATE       GetState;
+  POWER_GATE_NODE_DEASSERT_ALL    DeassertAll;
+  UINT32                          BpmpPhandle;
+  UINT32                          NumberOfPowerGates;
+  UINT32                          PowerGateId[1];
 };
 
 extern EFI_GUID  gNVIDIAPowerGateNodeProtocolGuid;
@@ -25,10 +25,12 @@
 #include <Library/OpteeNvLib.h>
 #include <Library/AndroidBcbLib.h>
 #include <Library/FdtLib.h>
+#include <Library/TimerLib.h>
 
 #include <Protocol/PartitionInfo.h>
 #include <Protocol/BlockIo.h>
 #include <Protocol/DiskIo.h>
+#include <Protocol/DiskIo2.h>
 
 #include "libavb/libavb/libavb.h"
 #include "Library/AvbLib.h"
@@ -43,8 +45,31 @@
 #define MAX_SN_LEN              32
 #define PatchLevelStrFormatLen  10
 
+// Enough for every partition libavb touches in one avb_slot_verify call
+#define AVB_PARTITION_CACHE_MAX  16
+#define AVB_PRELOAD_MAX          8
+
+typedef struct {
+  CHAR8                    Name[MAX_PARTITION_NAME_LEN];
+  EFI_BLOCK_IO_PROTOCOL    *BlockIo;
+  EFI_DISK_IO_PROTOCOL     *DiskIo;
+  EFI_DISK_IO2_PROTOCOL    *DiskIo2;
+} AVB_PARTITION;
+
+typedef struct {
+  CHAR8                 Name[MAX_PARTITION_NAME_LEN];
+  UINT8                 *Buffer;
+  UINTN                 Size;
+  EFI_DISK_IO2_TOKEN    Token;
+  BOOLEAN               Consumed;
+} AVB_PRELOAD;
+
 STATIC EFI_HANDLE      mControllerHandle;
 STATIC AVB_BOOT_STATE  mAvbBootState = VERIFIED_BOOT_UNKNOWN_STATE;
+STATIC AVB_PARTITION   mPartitionCache[AVB_PARTITION_CACHE_MAX];
+STATIC UINTN           mPartitionCacheCount;
+STATIC AVB_PRELOAD     mPreload[AVB_PRELOAD_MAX];
+STATIC UINTN           mPreloadCount;
 
 EFI_STATUS
 AvbShowUi (
@@ -156,30 +181,41 @@ Exit:
 }
 
 /**
-  Get size of a given partition.
+  Look up the protocols of an AVB partition.
 
-  @param[in]  Ops             A pointer to the AvbOps struct.
-  @param[in]  Partition       Partition name string.
-  @param[out] OutSizeNumBytes Output buffer to store partition size
+  libavb asks for the same few partitions many times per verification, so the
+  active partition name and sibling handle are resolved once and cached until
+  AvbPartitionCacheReset is called.
 
-  @retval AVB_IO_RESULT_OK  The operation completed successfully.
+  @param[in]  Partition   Partition name string.
+  @param[out] Entry       Cached protocols of the partition.
+
+  @retval EFI_SUCCESS             The partition was found.
+  @retval EFI_INVALID_PARAMETER   The active partition name could not be resolved.
+  @retval EFI_NOT_FOUND           No sibling partition has that name.
+  @retval EFI_UNSUPPORTED         The partition has no block io protocol.
 
 **/
 STATIC
-AvbIOResult
-GetSizeOfPartition (
-  IN  AvbOps      *Ops,
-  IN  const char  *Partition,
-  OUT uint64_t    *OutSizeNumBytes
+EFI_STATUS
+AvbGetPartition (
+  IN  CONST CHAR8    *Partition,
+  OUT AVB_PARTITION  **Entry
   )
 {
-  EFI_STATUS             Status = EFI_SUCCESS;
-  EFI_HANDLE             PartitionHandle;
-  EFI_BLOCK_IO_PROTOCOL  *BlockIo;
-  UINTN                  PartitionSize;
-  CHAR16                 PartitionName[MAX_PARTITION_NAME_LEN];
-  CHAR16                 ActivePartitionName[MAX_PARTITION_NAME_LEN];
-  AvbIOResult            AvbResult = AVB_IO_RESULT_OK;
+  EFI_STATUS     Status;
+  EFI_HANDLE     PartitionHandle;
+  AVB_PARTITION  *Cached;
+  UINTN          Index;
+  CHAR16         PartitionName[MAX_PARTITION_NAME_LEN];
+  CHAR16         ActivePartitionName[MAX_PARTITION_NAME_LEN];
+
+  for (Index = 0; Index < mPartitionCacheCount; Index++) {
+    if (AsciiStrCmp (mPartitionCache[Index].Name, Partition) == 0) {
+      *Entry = &mPartitionCache[Index];
+      return EFI_SUCCESS;
+    }
+  }
 
   if (AsciiStrCmp (Partition, "recovery") == 0) {
     UnicodeSPrintAsciiFormat (ActivePartitionName, sizeof (ActivePartitionName), "%a", Partition);
@@ -188,8 +224,7 @@ GetSizeOfPartition (
 
     Status = GetActivePartitionName (PartitionName, ActivePartitionName);
     if (EFI_ERROR (Status)) {
-      AvbResult = AVB_IO_RESULT_ERROR_NO_SUCH_PARTITION;
-      goto Exit;
+      return EFI_INVALID_PARAMETER;
     }
   }
 
@@ -197,24 +232,91 @@ GetSizeOfPartition (
                       mControllerHandle,
                       ActivePartitionName
                       );
-
   if (PartitionHandle == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a: Unable to found sibling partition handle for %s\r\n", __FUNCTION__, ActivePartitionName));
-    AvbResult = AVB_IO_RESULT_ERROR_NO_SUCH_PARTITION;
-    goto Exit;
+    DEBUG ((DEBUG_ERROR, "%a: Unable to get sibling partition handle: %s\n", __FUNCTION__, ActivePartitionName));
+    return EFI_NOT_FOUND;
   }
 
+  //
+  // Names too long to cache, or a full cache, use the last slot as scratch.
+  //
+  if ((mPartitionCacheCount < AVB_PARTITION_CACHE_MAX) &&
+      (AsciiStrSize (Partition) <= sizeof (Cached->Name)))
+  {
+    Cached = &mPartitionCache[mPartitionCacheCount];
+  } else {
+    Cached = &mPartitionCache[AVB_PARTITION_CACHE_MAX - 1];
+  }
+
+  ZeroMem (Cached, sizeof (*Cached));
+
   Status = gBS->HandleProtocol (
                   PartitionHandle,
                   &gEfiBlockIoProtocolGuid,
-                  (VOID **)&BlockIo
+                  (VOID **)&Cached->BlockIo
                   );
-  if (EFI_ERROR (Status) || (BlockIo == NULL)) {
-    DEBUG ((DEBUG_ERROR, "%a: Unable to locate block io protocol on partition\r\n", __FUNCTION__));
-    AvbResult = AVB_IO_RESULT_ERROR_IO;
+  if (EFI_ERROR (Status) || (Cached->BlockIo == NULL)) {
+    DEBUG ((DEBUG_ERROR, "%a: Got %r to locate block io protocol on partition\r\n", __FUNCTION__, Status));
+    return EFI_UNSUPPORTED;
+  }
+
+  gBS->HandleProtocol (PartitionHandle, &gEfiDiskIoProtocolGuid, (VOID **)&Cached->DiskIo);
+  gBS->HandleProtocol (PartitionHandle, &gEfiDiskIo2ProtocolGuid, (VOID **)&Cached->DiskIo2);
+
+  if (Cached == &mPartitionCache[mPartitionCacheCount]) {
+    AsciiStrCpyS (Cached->Name, sizeof (Cached->Name), Partition);
+    mPartitionCacheCount++;
+  }
+
+  *Entry = Cached;
+  return EFI_SUCCESS;
+}
+
+/**
+  Forget all cached partitions.
+
+**/
+STATIC
+VOID
+AvbPartitionCacheReset (
+  VOID
+  )
+{
+  ZeroMem (mPartitionCache, sizeof (mPartitionCache));
+  mPartitionCacheCount = 0;
+}
+
+/**
+  Get size of a given partition.
+
+  @param[in]  Ops             A pointer to the AvbOps struct.
+  @param[in]  Partition       Partition name string.
+  @param[out] OutSizeNumBytes Output buffer to store partition size
+
+  @retval AVB_IO_RESULT_OK  The operation completed successfully.
+
+**/
+STATIC
+AvbIOResult
+GetSizeOfPartition (
+  IN  AvbOps      *Ops,
+  IN  const char  *Partition,
+  OUT uint64_t    *OutSizeNumBytes
+  )
+{
+  EFI_STATUS             Status = EFI_SUCCESS;
+  AVB_PARTITION          *Entry;
+  EFI_BLOCK_IO_PROTOCOL  *BlockIo;
+  UINTN                  PartitionSize;
+  AvbIOResult            AvbResult = AVB_IO_RESULT_OK;
+
+  Status = AvbGetPartition (Partition, &Entry);
+  if (EFI_ERROR (Status)) {
+    AvbResult = (Status == EFI_UNSUPPORTED) ? AVB_IO_RESULT_ERROR_IO : AVB_IO_RESULT_ERROR_NO_SUCH_PARTITION;
     goto Exit;
   }
 
+  BlockIo          = Entry->BlockIo;
   PartitionSize    = (UINTN)(BlockIo->Media->LastBlock + 1) * BlockIo->Media->BlockSize;
   *OutSizeNumBytes = (uint64_t)PartitionSize;
 
@@ -247,53 +349,21 @@ ReadFromPartition (
   )
 {
   EFI_STATUS             Status = EFI_SUCCESS;
-  EFI_HANDLE             PartitionHandle;
+  AVB_PARTITION          *Entry;
   EFI_BLOCK_IO_PROTOCOL  *BlockIo;
   EFI_DISK_IO_PROTOCOL   *DiskIo;
-  CHAR16                 PartitionName[MAX_PARTITION_NAME_LEN];
-  CHAR16                 ActivePartitionName[MAX_PARTITION_NAME_LEN];
   AvbIOResult            AvbResult = AVB_IO_RESULT_OK;
 
-  if (AsciiStrCmp (Partition, "recovery") == 0) {
-    UnicodeSPrintAsciiFormat (ActivePartitionName, sizeof (ActivePartitionName), "%a", Partition);
-  } else {
-    UnicodeSPrintAsciiFormat (PartitionName, sizeof (PartitionName), "%a", Partition);
-
-    Status = GetActivePartitionName (PartitionName, ActivePartitionName);
-    if (EFI_ERROR (Status)) {
-      AvbResult = AVB_IO_RESULT_ERROR_NO_SUCH_PARTITION;
-      goto Exit;
-    }
-  }
-
-  PartitionHandle = GetSiblingPartitionHandle (
-                      mControllerHandle,
-                      ActivePartitionName
-                      );
-  if (PartitionHandle == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a: Unable to get sibling partition handle: %s\n", __FUNCTION__, ActivePartitionName));
-    AvbResult = AVB_IO_RESULT_ERROR_IO;
-    goto Exit;
-  }
-
-  Status = gBS->HandleProtocol (
-                  PartitionHandle,
-                  &gEfiBlockIoProtocolGuid,
-                  (VOID **)&BlockIo
-                  );
-  if (EFI_ERROR (Status) || (BlockIo == NULL)) {
-    DEBUG ((DEBUG_ERROR, "%a: Got %r to locate block io protocol on partition\r\n", __FUNCTION__, Status));
-    AvbResult = AVB_IO_RESULT_ERROR_IO;
+  Status = AvbGetPartition (Partition, &Entry);
+  if (EFI_ERROR (Status)) {
+    AvbResult = (Status == EFI_INVALID_PARAMETER) ? AVB_IO_RESULT_ERROR_NO_SUCH_PARTITION : AVB_IO_RESULT_ERROR_IO;
     goto Exit;
   }
 
-  Status = gBS->HandleProtocol (
-                  PartitionHandle,
-                  &gEfiDiskIoProtocolGuid,
-                  (VOID **)&DiskIo
-                  );
-  if (EFI_ERROR (Status) || (DiskIo == NULL)) {
-    DEBUG ((DEBUG_ERROR, "%a: Got %r to locate disk io protocol on partition\r\n", __FUNCTION__, Status));
+  BlockIo = Entry->BlockIo;
+  DiskIo  = Entry->DiskIo;
+  if (DiskIo == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a: Unable to locate disk io protocol on partition\r\n", __FUNCTION__));
     AvbResult = AVB_IO_RESULT_ERROR_IO;
     goto Exit;
   }
@@ -328,6 +398,202 @@ Exit:
   return AvbResult;
 }
 
+/**
+  Start reading the signed image of a partition in the background.
+
+  The image size comes from the AVB footer at the end of the partition. The
+  read is skipped when the partition has no footer or its disk does not
+  support non-blocking reads, and libavb then reads the image itself.
+
+  @param[in]  Partition   Partition name string.
+
+**/
+STATIC
+VOID
+AvbPreloadPartition (
+  IN CONST CHAR8  *Partition
+  )
+{
+  EFI_STATUS     Status;
+  AVB_PARTITION  *Entry;
+  AVB_PRELOAD    *Preload;
+  AvbFooter      RawFooter;
+  AvbFooter      Footer;
+  UINT64         PartitionSize;
+
+  if ((mPreloadCount >= AVB_PRELOAD_MAX) ||
+      (AsciiStrSize (Partition) > sizeof (Preload->Name)))
+  {
+    return;
+  }
+
+  Status = AvbGetPartition (Partition, &Entry);
+  if (EFI_ERROR (Status) || (Entry->DiskIo == NULL) || (Entry->DiskIo2 == NULL)) {
+    return;
+  }
+
+  PartitionSize = MultU64x32 (Entry->BlockIo->Media->LastBlock + 1, Entry->BlockIo->Media->BlockSize);
+  if (PartitionSize < AVB_FOOTER_SIZE) {
+    return;
+  }
+
+  Status = Entry->DiskIo->ReadDisk (
+                            Entry->DiskIo,
+                            Entry->BlockIo->Media->MediaId,
+                            PartitionSize - AVB_FOOTER_SIZE,
+                            AVB_FOOTER_SIZE,
+                            &RawFooter
+                            );
+  if (EFI_ERROR (Status) || !avb_footer_validate_and_byteswap (&RawFooter, &Footer)) {
+    return;
+  }
+
+  if ((Footer.original_image_size == 0) ||
+      (Footer.original_image_size > PartitionSize - AVB_FOOTER_SIZE) ||
+      (Footer.original_image_size > MAX_UINTN))
+  {
+    return;
+  }
+
+  Preload = &mPreload[mPreloadCount];
+  ZeroMem (Preload, sizeof (*Preload));
+  AsciiStrCpyS (Preload->Name, sizeof (Preload->Name), Partition);
+  Preload->Size   = (UINTN)Footer.original_image_size;
+  Preload->Buffer = AllocatePool (Preload->Size);
+  if (Preload->Buffer == NULL) {
+    return;
+  }
+
+  Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &Preload->Token.Event);
+  if (EFI_ERROR (Status)) {
+    FreePool (Preload->Buffer);
+    return;
+  }
+
+  Status = Entry->DiskIo2->ReadDiskEx (
+                             Entry->DiskIo2,
+                             Entry->BlockIo->Media->MediaId,
+                             0,
+                             &Preload->Token,
+                             Preload->Size,
+                             Preload->Buffer
+                             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "%a: %a: preload not started: %r\n", __FUNCTION__, Partition, Status));
+    gBS->CloseEvent (Preload->Token.Event);
+    FreePool (Preload->Buffer);
+    return;
+  }
+
+  mPreloadCount++;
+}
+
+/**
+  Wait for a background partition read to complete.
+
+  @param[in]  Preload     Preload to wait for.
+
+**/
+STATIC
+VOID
+AvbPreloadWait (
+  IN AVB_PRELOAD  *Preload
+  )
+{
+  if (Preload->Token.Event == NULL) {
+    return;
+  }
+
+  while (gBS->CheckEvent (Preload->Token.Event) == EFI_NOT_READY) {
+    CpuPause ();
+  }
+
+  gBS->CloseEvent (Preload->Token.Event);
+  Preload->Token.Event = NULL;
+}
+
+/**
+  Wait for all background reads and free the images libavb did not take.
+
+  Images handed to libavb are referenced by the slot data and stay allocated.
+
+**/
+STATIC
+VOID
+AvbPreloadRelease (
+  VOID
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < mPreloadCount; Index++) {
+    AvbPreloadWait (&mPreload[Index]);
+    if (!mPreload[Index].Consumed) {
+      FreePool (mPreload[Index].Buffer);
+    }
+  }
+
+  ZeroMem (mPreload, sizeof (mPreload));
+  mPreloadCount = 0;
+}
+
+/**
+  Return a partition image read in the background by AvbPreloadPartition.
+
+  While libavb checks vbmeta and hashes one partition, the reads of the others
+  are still in flight. If the partition was not preloaded or its read failed,
+  no buffer is returned and libavb falls back to ReadFromPartition.
+
+  @param[in]  Ops                   A pointer to the AvbOps struct.
+  @param[in]  Partition             Partition name string.
+  @param[in]  NumBytes              Num of bytes libavb will hash.
+  @param[out] OutPointer            Preloaded image, or NULL.
+  @param[out] OutNumBytesPreloaded  Num of bytes available at OutPointer.
+
+  @retval AVB_IO_RESULT_OK  The operation completed successfully.
+
+**/
+STATIC
+AvbIOResult
+GetPreloadedPartition (
+  IN  AvbOps      *Ops,
+  IN  const char  *Partition,
+  IN  size_t      NumBytes,
+  OUT uint8_t     **OutPointer,
+  OUT size_t      *OutNumBytesPreloaded
+  )
+{
+  AVB_PRELOAD  *Preload;
+  UINTN        Index;
+
+  *OutPointer           = NULL;
+  *OutNumBytesPreloaded = 0;
+
+  for (Index = 0; Index < mPreloadCount; Index++) {
+    Preload = &mPreload[Index];
+    if (Preload->Consumed || (AsciiStrCmp (Preload->Name, Partition) != 0)) {
+      continue;
+    }
+
+    AvbPreloadWait (Preload);
+    if (EFI_ERROR (Preload->Token.TransactionStatus)) {
+      DEBUG ((DEBUG_ERROR, "%a: %a: preload failed: %r\n", __FUNCTION__, Partition, Preload->Token.TransactionStatus));
+      break;
+    }
+
+    if (NumBytes > Preload->Size) {
+      break;
+    }
+
+    Preload->Consumed     = TRUE;
+    *OutPointer           = Preload->Buffer;
+    *OutNumBytesPreloaded = NumBytes;
+    break;
+  }
+
+  return AVB_IO_RESULT_OK;
+}
+
 /**
   Read parition data from given offset.
 
@@ -749,6 +1015,7 @@ VerifiedBootGetBootState (
   // Use libavb API to verify boot chain
   AvbOps               Ops = {
     .read_from_partition               = ReadFromPartition,
+    .get_preloaded_partition           = GetPreloadedPartition,
     .read_is_device_unlocked           = ReadIsDeviceUnlocked,
     .validate_vbmeta_public_key        = ValidateVbmetaPublicKey,
     .validate_public_key_for_partition = ValidatePublicKeyForPartition,
@@ -767,6 +1034,10 @@ VerifiedBootGetBootState (
   const char           *NormalRequestedPartitions[]   = { "boot", "vendor_boot", NULL };
   const char           *RecoveryRequestedPartitions[] = { NULL };
   const char *const    *RequestedPartitions;
+  UINTN                Index;
+  UINT64               StartTime;
+
+  AvbPartitionCacheReset ();
 
   if (ReadIsDeviceUnlocked (&Ops, &DeviceUnlocked) != AVB_IO_RESULT_OK) {
     return EFI_UNSUPPORTED;
@@ -782,6 +1053,16 @@ VerifiedBootGetBootState (
     Flags |= AVB_SLOT_VERIFY_FLAGS_RESTART_CAUSED_BY_HASHTREE_CORRUPTION;
   }
 
+  StartTime = GetTimeInNanoSecond (GetPerformanceCounter ());
+
+  //
+  // Queue the reads of every hashed image up front so the disk streams them
+  // while libavb checks vbmeta and hashes the images that already arrived.
+  //
+  for (Index = 0; RequestedPartitions[Index] != NULL; Index++) {
+    AvbPreloadPartition (RequestedPartitions[Index]);
+  }
+
   AvbRes = avb_slot_verify (
              &Ops,
              RequestedPartitions,
@@ -791,6 +1072,16 @@ VerifiedBootGetBootState (
              SlotData
              );
 
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: avb_slot_verify took %llu us, %u partitions preloaded\n",
+    __FUNCTION__,
+    DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter ()) - StartTime, 1000),
+    mPreloadCount
+    ));
+
+  AvbPreloadRelease ();
+
   /**
     * Orange state:
     * Device is unlocked
@@ -0,0 +1,207 @@
+/** @file
+
+  Boot Trace Library
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+
+#include <Library/BootTraceLib.h>
+#include <Library/DebugLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+STATIC NVIDIA_BOOT_TRACE_PROTOCOL  *mBootTrace            = NULL;
+STATIC EFI_EVENT                   mBootTraceNotifyEvent  = NULL;
+STATIC EFI_EVENT                   mExitBootServicesEvent = NULL;
+STATIC VOID                        *mBootTraceRegistration;
+
+/**
+  Caches the boot trace protocol once it is installed.
+
+  @param[in]  Event            Event
+  @param[in]  Context          Unused
+**/
+STATIC
+VOID
+EFIAPI
+BootTraceLibProtocolNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = gBS->LocateProtocol (&gNVIDIABootTraceProtocolGuid, NULL, (VOID **)&mBootTrace);
+  if (!EFI_ERROR (Status)) {
+    gBS->CloseEvent (Event);
+    mBootTraceNotifyEvent = NULL;
+  }
+}
+
+/**
+  Stops tracing at ExitBootServices, the protocol is no longer valid.
+
+  @param[in]  Event            Event
+  @param[in]  Context          Unused
+**/
+STATIC
+VOID
+EFIAPI
+BootTraceLibOnExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  mBootTrace = NULL;
+  if (mBootTraceNotifyEvent != NULL) {
+    gBS->CloseEvent (mBootTraceNotifyEvent);
+    mBootTraceNotifyEvent = NULL;
+  }
+}
+
+/**
+  Records the beginning of a span.
+
+  @param[in]  Category          NVIDIA_BOOT_TRACE_CATEGORY of the span.
+  @param[in]  Name              Name of the span.
+  @param[in]  Argument          Caller defined argument.
+
+  @retval Span id to pass to BootTraceEnd, or NVIDIA_BOOT_TRACE_INVALID_SPAN
+**/
+UINT32
+EFIAPI
+BootTraceBegin (
+  IN UINT8        Category,
+  IN CONST CHAR8  *Name,
+  IN UINT32       Argument
+  )
+{
+  if ((mBootTrace == NULL) || (Name == NULL)) {
+    return NVIDIA_BOOT_TRACE_INVALID_SPAN;
+  }
+
+  return mBootTrace->Begin (mBootTrace, Category, Name, Argument);
+}
+
+/**
+  Records the end of a span.
+
+  @param[in]  SpanId            Span id returned by BootTraceBegin.
+**/
+VOID
+EFIAPI
+BootTraceEnd (
+  IN UINT32  SpanId
+  )
+{
+  if ((mBootTrace == NULL) || (SpanId == NVIDIA_BOOT_TRACE_INVALID_SPAN)) {
+    return;
+  }
+
+  mBootTrace->End (mBootTrace, SpanId);
+}
+
+/**
+  Records an instant event.
+
+  @param[in]  Category          NVIDIA_BOOT_TRACE_CATEGORY of the event.
+  @param[in]  Name              Name of the event.
+  @param[in]  Argument          Caller defined argument.
+**/
+VOID
+EFIAPI
+BootTraceInstant (
+  IN UINT8        Category,
+  IN CONST CHAR8  *Name,
+  IN UINT32       Argument
+  )
+{
+  if ((mBootTrace == NULL) || (Name == NULL)) {
+    return;
+  }
+
+  mBootTrace->Instant (mBootTrace, Category, Name, Argument);
+}
+
+/**
+  Library constructor. Locates the boot trace protocol, or registers a notify
+  to pick it up once BasicProfilerDxe installs it, and creates the
+  ExitBootServices event that stops tracing.
+
+  @param[in]  ImageHandle      Image handle of the module
+  @param[in]  SystemTable      Pointer to the system table
+
+  @retval EFI_SUCCESS          Always returned, tracing is best effort
+**/
+EFI_STATUS
+EFIAPI
+BootTraceLibConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = gBS->LocateProtocol (&gNVIDIABootTraceProtocolGuid, NULL, (VOID **)&mBootTrace);
+  if (EFI_ERROR (Status)) {
+    mBootTrace            = NULL;
+    mBootTraceNotifyEvent = EfiCreateProtocolNotifyEvent (
+                              &gNVIDIABootTraceProtocolGuid,
+                              TPL_CALLBACK,
+                              BootTraceLibProtocolNotify,
+                              NULL,
+                              &mBootTraceRegistration
+                              );
+  }
+
+  Status = gBS->CreateEventEx (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_NOTIFY,
+                  BootTraceLibOnExitBootServices,
+                  NULL,
+                  &gEfiEventExitBootServicesGuid,
+                  &mExitBootServicesEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "%a: Failed to create ExitBootServices event: %r\r\n", __FUNCTION__, Status));
+    mBootTrace = NULL;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Library destructor. Closes the events created by the constructor so that
+  they do not call back into an image that failed to start and was unloaded.
+
+  @param[in]  ImageHandle      Image handle of the module
+  @param[in]  SystemTable      Pointer to the system table
+
+  @retval EFI_SUCCESS          Always returned
+**/
+EFI_STATUS
+EFIAPI
+BootTraceLibDestructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  if (mBootTraceNotifyEvent != NULL) {
+    gBS->CloseEvent (mBootTraceNotifyEvent);
+    mBootTraceNotifyEvent = NULL;
+  }
+
+  if (mExitBootServicesEvent != NULL) {
+    gBS->CloseEvent (mExitBootServicesEvent);
+    mExitBootServicesEvent = NULL;
+  }
+
+  mBootTrace = NULL;
+
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,61 @@
+/** @file
+
+  Null Boot Trace Library
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/BootTraceLib.h>
+
+/**
+  Records the beginning of a span.
+
+  @param[in]  Category          NVIDIA_BOOT_TRACE_CATEGORY of the span.
+  @param[in]  Name              Name of the span.
+  @param[in]  Argument          Caller defined argument.
+
+  @retval Span id to pass to BootTraceEnd, or NVIDIA_BOOT_TRACE_INVALID_SPAN
+**/
+UINT32
+EFIAPI
+BootTraceBegin (
+  IN UINT8        Category,
+  IN CONST CHAR8  *Name,
+  IN UINT32       Argument
+  )
+{
+  return NVIDIA_BOOT_TRACE_INVALID_SPAN;
+}
+
+/**
+  Records the end of a span.
+
+  @param[in]  SpanId            Span id returned by BootTraceBegin.
+**/
+VOID
+EFIAPI
+BootTraceEnd (
+  IN UINT32  SpanId
+  )
+{
+}
+
+/**
+  Records an instant event.
+
+  @param[in]  Category          NVIDIA_BOOT_TRACE_CATEGORY of the event.
+  @param[in]  Name              Name of the event.
+  @param[in]  Argument          Caller defined argument.
+**/
+VOID
+EFIAPI
+BootTraceInstant (
+  IN UINT8        Category,
+  IN CONST CHAR8  *Name,
+  IN UINT32       Argument
+  )
+{
+}
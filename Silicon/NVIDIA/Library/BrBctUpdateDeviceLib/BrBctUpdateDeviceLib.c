@@ -2,12 +2,13 @@
 
   BR-BCT Update Device Library
 
-  SPDX-FileCopyrightText: Copyright (c) 2021-2025 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2021-2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 
+#include <Library/BaseCryptLib.h>
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/BootChainInfoLib.h>
@@ -32,6 +33,72 @@ STATIC BOOLEAN                     mPcdBootChainIsMarkerBased       = FALSE;
 STATIC VOID                        *mInvalidateBuffer               = NULL;
 STATIC VOID                        *mBackupPartitionBuffer          = NULL;
 
+// SHA256 digests of on-media data, valid once read back or verified after
+// write and only while the partition's WriteCount is unchanged
+STATIC UINT8    mSlotDigest[BR_BCT_SLOT_MAX][SHA256_DIGEST_SIZE];
+STATIC BOOLEAN  mSlotDigestValid[BR_BCT_SLOT_MAX];
+STATIC UINT32   mSlotDigestWriteCount;
+STATIC UINT8    mBackupDigest[BOOT_CHAIN_COUNT][SHA256_DIGEST_SIZE];
+STATIC BOOLEAN  mBackupDigestValid[BOOT_CHAIN_COUNT];
+STATIC UINT32   mBackupDigestWriteCount;
+STATIC UINT8    mInvalidateDigest[SHA256_DIGEST_SIZE];
+
+/**
+  Invalidate cached on-media digests if their partition has been written
+  since they were recorded, e.g. by a FW partition protocol client outside
+  this library.
+
+  @param[in]  Private           Pointer to private data structure
+
+  @retval None
+
+**/
+STATIC
+VOID
+EFIAPI
+BrBctCheckDigestCache (
+  IN  BR_BCT_UPDATE_PRIVATE_DATA  *Private
+  )
+{
+  if (Private->BrBctPartition->WriteCount != mSlotDigestWriteCount) {
+    SetMem (mSlotDigestValid, sizeof (mSlotDigestValid), 0);
+    mSlotDigestWriteCount = Private->BrBctPartition->WriteCount;
+  }
+
+  if (Private->BrBctBackupPartition->WriteCount != mBackupDigestWriteCount) {
+    SetMem (mBackupDigestValid, sizeof (mBackupDigestValid), 0);
+    mBackupDigestWriteCount = Private->BrBctBackupPartition->WriteCount;
+  }
+}
+
+/**
+  Compute SHA256 digest of data.
+
+  @param[in]  Data              Address of data
+  @param[in]  Bytes             Number of bytes of data
+  @param[out] Digest            Address to store digest
+
+  @retval EFI_SUCCESS           Operation successful
+  @retval others                Error occurred
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BrBctHash (
+  IN  CONST VOID  *Data,
+  IN  UINTN       Bytes,
+  OUT UINT8       *Digest
+  )
+{
+  if (!Sha256HashAll (Data, Bytes, Digest)) {
+    DEBUG ((DEBUG_ERROR, "%a: hash failed\n", __FUNCTION__));
+    return EFI_DEVICE_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Get device offset of given BR-BCT slot data.
 
@@ -105,13 +172,14 @@ BrBctReadSlot (
 }
 
 /**
-  Verify slot's data in a BR-BCT partition.
+  Verify slot's data in a BR-BCT partition against a digest.  The digest of
+  the data read is saved as the slot's on-media digest.
 
   @param[in]  Private           Pointer to private data structure
   @param[in]  Partition         Partition to read
   @param[in]  Slot              Slot number
   @param[in]  Bytes             Bytes to read/verify
-  @param[out] Buffer            Address of data for comparison
+  @param[in]  Digest            Expected SHA256 digest of slot data
 
   @retval EFI_SUCCESS           Operation successful
   @retval others                Error occurred
@@ -125,7 +193,7 @@ BrBctVerifySlot (
   IN  FW_PARTITION_PRIVATE_DATA   *Partition,
   IN  UINTN                       Slot,
   IN  UINTN                       Bytes,
-  IN  CONST VOID                  *Buffer
+  IN  CONST UINT8                 *Digest
   )
 {
   EFI_STATUS  Status;
@@ -149,10 +217,19 @@ BrBctVerifySlot (
              mVerifyBuffer
              );
   if (EFI_ERROR (Status)) {
+    mSlotDigestValid[Slot] = FALSE;
     return Status;
   }
 
-  if (CompareMem (mVerifyBuffer, Buffer, Bytes) != 0) {
+  Status = BrBctHash (mVerifyBuffer, Bytes, mSlotDigest[Slot]);
+  if (EFI_ERROR (Status)) {
+    mSlotDigestValid[Slot] = FALSE;
+    return Status;
+  }
+
+  mSlotDigestValid[Slot] = TRUE;
+
+  if (CompareMem (mSlotDigest[Slot], Digest, SHA256_DIGEST_SIZE) != 0) {
     return EFI_VOLUME_CORRUPTED;
   }
 
@@ -215,14 +292,16 @@ BrBctWriteSlot (
 
 /**
   Write and verify a slot's data in a BR-BCT partition.
-  If PcdBrBctVerifyUpdateBeforeWrite is TRUE, slot data is verified to need
-  updating before performing a new write/verify.
+  If PcdBrBctVerifyUpdateBeforeWrite is TRUE, slot data is re-read and
+  verified to need updating before performing a new write/verify.
+  Otherwise, nothing is done if the slot's cached on-media digest matches.
 
   @param[in]  Private           Pointer to private data structure
   @param[in]  Partition         Partition to write
   @param[in]  Slot              Slot number
   @param[in]  Bytes             Bytes to write
-  @param[out] Buffer            Address of data to write
+  @param[in]  Buffer            Address of data to write
+  @param[in]  Digest            SHA256 digest of data to write
 
   @retval EFI_SUCCESS           Operation successful
   @retval others                Error occurred
@@ -236,13 +315,30 @@ BrBctWriteAndVerifySlot (
   IN  FW_PARTITION_PRIVATE_DATA   *Partition,
   IN  UINTN                       Slot,
   IN  UINTN                       Bytes,
-  IN  CONST VOID                  *Buffer
+  IN  CONST VOID                  *Buffer,
+  IN  CONST UINT8                 *Digest
   )
 {
   EFI_STATUS  Status;
 
+  BrBctCheckDigestCache (Private);
+
+  if (!mPcdBrBctVerifyUpdateBeforeWrite &&
+      mSlotDigestValid[Slot] &&
+      (CompareMem (mSlotDigest[Slot], Digest, SHA256_DIGEST_SIZE) == 0))
+  {
+    DEBUG ((
+      DEBUG_INFO,
+      "%a: Slot=%u Bytes=%u digest matches, no update needed\n",
+      __FUNCTION__,
+      Slot,
+      Bytes
+      ));
+    return EFI_SUCCESS;
+  }
+
   if (mPcdBrBctVerifyUpdateBeforeWrite) {
-    Status = BrBctVerifySlot (Private, Partition, Slot, Bytes, Buffer);
+    Status = BrBctVerifySlot (Private, Partition, Slot, Bytes, Digest);
     if (Status == EFI_SUCCESS) {
       DEBUG ((
         DEBUG_INFO,
@@ -255,12 +351,15 @@ BrBctWriteAndVerifySlot (
     }
   }
 
-  Status = BrBctWriteSlot (Private, Partition, Slot, Bytes, Buffer);
+  mSlotDigestValid[Slot] = FALSE;
+
+  Status                = BrBctWriteSlot (Private, Partition, Slot, Bytes, Buffer);
+  mSlotDigestWriteCount = Partition->WriteCount;
   if (EFI_ERROR (Status)) {
     return Status;
   }
 
-  Status = BrBctVerifySlot (Private, Partition, Slot, Bytes, Buffer);
+  Status = BrBctVerifySlot (Private, Partition, Slot, Bytes, Digest);
 
   return Status;
 }
@@ -321,11 +420,20 @@ BrBctUpdateBctSlots (
   IN  UINTN                   NewFwChain
   )
 {
-  UINTN       Index;
-  UINTN       Slot;
-  CONST VOID  *BufferToWrite = Buffer;
-  EFI_STATUS  Status         = EFI_SUCCESS;
+  UINTN        Index;
+  UINTN        Slot;
+  CONST VOID   *BufferToWrite = Buffer;
+  CONST UINT8  *DigestToWrite;
+  UINT8        Digest[SHA256_DIGEST_SIZE];
+  EFI_STATUS   Status = EFI_SUCCESS;
+
+  // digest of new data is computed once for all slots
+  Status = BrBctHash (Buffer, Bytes, Digest);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
+  DigestToWrite = Digest;
   for (Index = 0; Index < Private->BctPartitionSlots; Index++) {
     Slot = Private->BctPartitionSlots - Index - 1;
     if (!SlotShouldBeUpdated (Slot, NewFwChain)) {
@@ -336,6 +444,7 @@ BrBctUpdateBctSlots (
     if (SlotShouldBeInvalidated (Slot, NewFwChain)) {
       DEBUG ((DEBUG_INFO, "%a: Slot=%u invalidated\n", __FUNCTION__, Slot));
       BufferToWrite = mInvalidateBuffer;
+      DigestToWrite = mInvalidateDigest;
     }
 
     Status = BrBctWriteAndVerifySlot (
@@ -343,7 +452,8 @@ BrBctUpdateBctSlots (
                Private->BrBctPartition,
                Slot,
                Bytes,
-               BufferToWrite
+               BufferToWrite,
+               DigestToWrite
                );
     if (EFI_ERROR (Status)) {
       return Status;
@@ -431,6 +541,8 @@ BrBctUpdateBackupPartition (
   UINT32                        PartitionDataSize;
   UINT64                        BackupOffset;
   UINTN                         UpdateFwChain;
+  UINTN                         Chain;
+  UINT8                         Digest[SHA256_DIGEST_SIZE];
 
   DEBUG ((DEBUG_INFO, "%a: ActiveChain=%u\n", __FUNCTION__, mActiveBootChain));
 
@@ -454,7 +566,24 @@ BrBctUpdateBackupPartition (
               );
   PartitionDataSize = BR_BCT_BACKUP_PARTITION_DATA_SIZE;
   PartitionProtocol = &Private->BrBctBackupPartition->Protocol;
-  Status            = PartitionProtocol->Read (
+  BackupOffset      = UpdateFwChain * BR_BCT_BACKUP_PARTITION_CHAIN_OFFSET;
+
+  Status = BrBctHash (Data + BackupOffset, Private->BrBctDataSize, Digest);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  BrBctCheckDigestCache (Private);
+
+  if (!mPcdBrBctVerifyUpdateBeforeWrite &&
+      mBackupDigestValid[UpdateFwChain] &&
+      (CompareMem (mBackupDigest[UpdateFwChain], Digest, sizeof (Digest)) == 0))
+  {
+    DEBUG ((DEBUG_INFO, "%a: digest matches, no update needed at offset=0x%x\n", __FUNCTION__, BackupOffset));
+    return EFI_SUCCESS;
+  }
+
+  Status = PartitionProtocol->Read (
                                            PartitionProtocol,
                                            0,
                                            PartitionDataSize,
@@ -465,8 +594,6 @@ BrBctUpdateBackupPartition (
     return Status;
   }
 
-  BackupOffset = UpdateFwChain * BR_BCT_BACKUP_PARTITION_CHAIN_OFFSET;
-
   if (CompareMem (
         mBackupPartitionBuffer + BackupOffset,
         Data + BackupOffset,
@@ -474,6 +601,8 @@ BrBctUpdateBackupPartition (
         ) == 0)
   {
     DEBUG ((DEBUG_INFO, "%a: no update needed at offset=0x%x\n", __FUNCTION__, BackupOffset));
+    CopyMem (mBackupDigest[UpdateFwChain], Digest, sizeof (Digest));
+    mBackupDigestValid[UpdateFwChain] = TRUE;
     return EFI_SUCCESS;
   }
 
@@ -485,12 +614,17 @@ BrBctUpdateBackupPartition (
 
   DEBUG ((DEBUG_INFO, "%a: Updating partition at offset=0x%x bytes=%u\n", __FUNCTION__, BackupOffset, Private->BrBctDataSize));
 
+  for (Chain = 0; Chain < BOOT_CHAIN_COUNT; Chain++) {
+    mBackupDigestValid[Chain] = FALSE;
+  }
+
   Status = PartitionProtocol->Write (
                                 PartitionProtocol,
                                 0,
                                 PartitionDataSize,
                                 mBackupPartitionBuffer
                                 );
+  mBackupDigestWriteCount = Private->BrBctBackupPartition->WriteCount;
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "%a: write failed: %r\n", __FUNCTION__, Status));
     return Status;
@@ -512,6 +646,9 @@ BrBctUpdateBackupPartition (
     return EFI_VOLUME_CORRUPTED;
   }
 
+  CopyMem (mBackupDigest[UpdateFwChain], Digest, sizeof (Digest));
+  mBackupDigestValid[UpdateFwChain] = TRUE;
+
   return Status;
 }
 
@@ -567,6 +704,8 @@ BrBctUpdateDeviceLibDeinit (
 
   mActiveBootChain = MAX_UINT32;
   SetMem (&mPrivate, sizeof (mPrivate), 0);
+  SetMem (mSlotDigestValid, sizeof (mSlotDigestValid), 0);
+  SetMem (mBackupDigestValid, sizeof (mBackupDigestValid), 0);
 }
 
 EFI_STATUS
@@ -578,6 +717,7 @@ BrBctUpdateDeviceLibInit (
 {
   BR_BCT_UPDATE_PRIVATE_DATA  *Private;
   UINTN                       MaxBctSlotsSupported;
+  EFI_STATUS                  Status;
 
   mActiveBootChain                 = ActiveBootChain;
   mPcdBrBctVerifyUpdateBeforeWrite = PcdGetBool (PcdBrBctVerifyUpdateBeforeWrite);
@@ -659,6 +799,11 @@ BrBctUpdateDeviceLibInit (
     }
 
     SetMem (mInvalidateBuffer, Private->BrBctDataSize, 0xff);
+
+    Status = BrBctHash (mInvalidateBuffer, Private->BrBctDataSize, mInvalidateDigest);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
   }
 
   return EFI_SUCCESS;
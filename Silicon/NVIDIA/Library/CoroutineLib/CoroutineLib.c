@@ -0,0 +1,782 @@
+/** @file
+
+  Coroutine Library
+
+  Coroutines are resumed from timer event notifications at TPL_CALLBACK, so
+  only one coroutine of a module runs at a time and no locking is required.
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/CoroutineLib.h>
+#include <Library/DebugLib.h>
+#include <Library/IoLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SystemContextLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+#include "CoroutineLibPrivate.h"
+
+STATIC EFI_SYSTEM_CONTEXT_AARCH64  mSchedulerContext  = { 0 };
+STATIC COROUTINE_INSTANCE          *mCurrentCoroutine = NULL;
+STATIC LIST_ENTRY                  mCoroutineList     = INITIALIZE_LIST_HEAD_VARIABLE (mCoroutineList);
+STATIC UINTN                       mCoroutinesPending = 0;
+STATIC EFI_EVENT                   mReadyToBootEvent  = NULL;
+
+// Accounting of coroutines that have been freed
+STATIC UINTN   mCoroutinesFreed = 0;
+STATIC UINT64  mFreedRunTimeNs  = 0;
+STATIC UINT64  mFreedWaitTimeNs = 0;
+STATIC UINT64  mFreedYields     = 0;
+
+/**
+  Returns the time in nanoseconds between two performance counter values.
+
+  @param[in]  Start            Start counter value
+  @param[in]  End              End counter value
+
+  @retval Elapsed time in nanoseconds
+**/
+STATIC
+UINT64
+CoroutineElapsedNs (
+  IN UINT64  Start,
+  IN UINT64  End
+  )
+{
+  if ((Start == 0) || (End < Start)) {
+    return 0;
+  }
+
+  return GetTimeInNanoSecond (End - Start);
+}
+
+/**
+  Frees the stack and timer of a completed coroutine. The instance itself is
+  kept until it is destroyed so that it can be included in the report.
+
+  @param[in]  Instance         Coroutine instance
+**/
+STATIC
+VOID
+CoroutineRelease (
+  IN COROUTINE_INSTANCE  *Instance
+  )
+{
+  if (Instance->Timer != NULL) {
+    gBS->CloseEvent (Instance->Timer);
+    Instance->Timer = NULL;
+  }
+
+  if (Instance->StackBase != 0) {
+    FreePages ((VOID *)(UINTN)Instance->StackBase, EFI_SIZE_TO_PAGES (Instance->StackSize));
+    Instance->StackBase = 0;
+  }
+}
+
+/**
+  Unlinks and frees a completed coroutine. Its accounting is kept in the
+  module totals for the report.
+
+  @param[in]  Instance         Coroutine instance
+**/
+STATIC
+VOID
+CoroutineDestroy (
+  IN COROUTINE_INSTANCE  *Instance
+  )
+{
+  ASSERT (Instance->State == CoroutineStateDone);
+
+  mCoroutinesFreed++;
+  mFreedRunTimeNs  += Instance->RunTimeNs;
+  mFreedWaitTimeNs += Instance->WaitTimeNs;
+  mFreedYields     += Instance->Yields;
+
+  RemoveEntryList (&Instance->Link);
+  CoroutineRelease (Instance);
+  Instance->Signature = 0;
+  FreePool (Instance);
+}
+
+/**
+  Switches from the scheduler to the coroutine until it yields or completes.
+
+  @param[in]  Instance         Coroutine instance
+**/
+STATIC
+VOID
+CoroutineResume (
+  IN COROUTINE_INSTANCE  *Instance
+  )
+{
+  UINT64  Now;
+
+  ASSERT (mCurrentCoroutine == NULL);
+
+  Now                   = GetPerformanceCounter ();
+  Instance->WaitTimeNs += CoroutineElapsedNs (Instance->LastYield, Now);
+  Instance->LastResume  = Now;
+  Instance->State       = CoroutineStateRunning;
+  mCurrentCoroutine     = Instance;
+
+  SwapSystemContext (
+    (EFI_SYSTEM_CONTEXT)&mSchedulerContext,
+    (EFI_SYSTEM_CONTEXT)&Instance->SystemContext
+    );
+
+  if (Instance->State == CoroutineStateDone) {
+    if (Instance->Detached) {
+      CoroutineDestroy (Instance);
+    } else {
+      CoroutineRelease (Instance);
+    }
+  }
+}
+
+/**
+  Switches from the current coroutine back to the scheduler. The coroutine is
+  resumed after at least the given number of microseconds.
+
+  @param[in]  MicroSeconds     The minimum number of microseconds to yield.
+**/
+STATIC
+VOID
+CoroutineYield (
+  IN UINTN  MicroSeconds
+  )
+{
+  COROUTINE_INSTANCE  *Instance;
+
+  Instance = mCurrentCoroutine;
+  ASSERT (Instance != NULL);
+
+  Instance->LastYield  = GetPerformanceCounter ();
+  Instance->RunTimeNs += CoroutineElapsedNs (Instance->LastResume, Instance->LastYield);
+  Instance->State      = CoroutineStateWaiting;
+  Instance->Yields++;
+
+  gBS->SetTimer (Instance->Timer, TimerRelative, MultU64x32 (MicroSeconds, 10));
+  mCurrentCoroutine = NULL;
+  SwapSystemContext (
+    (EFI_SYSTEM_CONTEXT)&Instance->SystemContext,
+    (EFI_SYSTEM_CONTEXT)&mSchedulerContext
+    );
+}
+
+/**
+  @brief Timer event callback. When this fires we switch back to the coroutine
+  context until it yields again.
+
+  @param[in]  Event            Timer event
+  @param[in]  Context          Coroutine instance
+**/
+STATIC
+VOID
+EFIAPI
+CoroutineTimerCallback (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  CoroutineResume ((COROUTINE_INSTANCE *)Context);
+}
+
+/**
+  @brief Wrapper around the coroutine entry point
+
+  @param[in]  Instance         Coroutine instance
+**/
+STATIC
+VOID
+CoroutineMain (
+  IN COROUTINE_INSTANCE  *Instance
+  )
+{
+  Instance->Status = Instance->Entry (Instance->Context);
+
+  Instance->RunTimeNs += CoroutineElapsedNs (Instance->LastResume, GetPerformanceCounter ());
+  Instance->State      = CoroutineStateDone;
+  mCoroutinesPending--;
+
+  if (Instance->CompletionEvent != NULL) {
+    gBS->SignalEvent (Instance->CompletionEvent);
+  }
+
+  mCurrentCoroutine = NULL;
+  SwapSystemContext (
+    (EFI_SYSTEM_CONTEXT)&Instance->SystemContext,
+    (EFI_SYSTEM_CONTEXT)&mSchedulerContext
+    );
+
+  // Should never get here
+  ASSERT (FALSE);
+  CpuDeadLoop ();
+}
+
+/**
+  Prints the coroutine report at ReadyToBoot.
+
+  @param[in]  Event            Event
+  @param[in]  Context          Unused
+**/
+STATIC
+VOID
+EFIAPI
+CoroutineOnReadyToBoot (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  gBS->CloseEvent (Event);
+  mReadyToBootEvent = NULL;
+  CoroutineReport ();
+}
+
+/**
+  Spawns a new coroutine.
+
+  If called outside of a coroutine the new coroutine runs immediately until it
+  first yields. If called from a coroutine the new coroutine is scheduled for
+  the next timer tick. Must be called at TPL_APPLICATION or TPL_CALLBACK.
+
+  @param[in]  Name              Name of the coroutine, used in the report.
+  @param[in]  Entry             Entry point of the coroutine.
+  @param[in]  Context           Context passed to Entry.
+  @param[in]  StackSize         Stack size, 0 for COROUTINE_DEFAULT_STACK_SIZE.
+  @param[in]  CompletionEvent   Optional event signaled when Entry returns.
+  @param[out] Handle            Optional handle for CoroutineWait. Without a
+                                handle the coroutine is freed when it returns,
+                                otherwise the caller frees it with CoroutineFree.
+
+  @retval EFI_SUCCESS           Coroutine was started
+  @retval EFI_INVALID_PARAMETER Name or Entry is NULL
+  @retval EFI_OUT_OF_RESOURCES  Failed to allocate coroutine
+  @retval others                Error occurred
+**/
+EFI_STATUS
+EFIAPI
+CoroutineSpawn (
+  IN  CONST CHAR8       *Name,
+  IN  COROUTINE_ENTRY   Entry,
+  IN  VOID              *Context,
+  IN  UINTN             StackSize,
+  IN  EFI_EVENT         CompletionEvent OPTIONAL,
+  OUT COROUTINE_HANDLE  *Handle OPTIONAL
+  )
+{
+  EFI_STATUS                  Status;
+  COROUTINE_INSTANCE          *Instance;
+  EFI_SYSTEM_CONTEXT_AARCH64  CurrentContext;
+  EFI_TPL                     OldTpl;
+
+  if ((Name == NULL) || (Entry == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (StackSize == 0) {
+    StackSize = COROUTINE_DEFAULT_STACK_SIZE;
+  }
+
+  StackSize = EFI_PAGES_TO_SIZE (EFI_SIZE_TO_PAGES (StackSize));
+
+  Instance = (COROUTINE_INSTANCE *)AllocateZeroPool (sizeof (COROUTINE_INSTANCE));
+  if (Instance == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Instance->Signature       = COROUTINE_SIGNATURE;
+  Instance->Entry           = Entry;
+  Instance->Context         = Context;
+  Instance->CompletionEvent = CompletionEvent;
+  Instance->State           = CoroutineStateReady;
+  Instance->Status          = EFI_NOT_READY;
+  Instance->Detached        = (Handle == NULL);
+  Instance->StackSize       = StackSize;
+  AsciiStrnCpyS (Instance->Name, sizeof (Instance->Name), Name, sizeof (Instance->Name) - 1);
+
+  Instance->StackBase = (EFI_PHYSICAL_ADDRESS)(UINTN)AllocatePages (EFI_SIZE_TO_PAGES (StackSize));
+  if (Instance->StackBase == 0) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto ErrorExit;
+  }
+
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  CoroutineTimerCallback,
+                  Instance,
+                  &Instance->Timer
+                  );
+  if (EFI_ERROR (Status)) {
+    goto ErrorExit;
+  }
+
+  if (mReadyToBootEvent == NULL) {
+    Status = EfiCreateEventReadyToBootEx (
+               TPL_CALLBACK,
+               CoroutineOnReadyToBoot,
+               NULL,
+               &mReadyToBootEvent
+               );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_WARN, "%a: Failed to create ReadyToBoot event: %r\r\n", __FUNCTION__, Status));
+      mReadyToBootEvent = NULL;
+    }
+  }
+
+  // Don't change the special registers
+  GetSystemContext ((EFI_SYSTEM_CONTEXT)&CurrentContext);
+  Instance->SystemContext.ELR  = CurrentContext.ELR;
+  Instance->SystemContext.SPSR = CurrentContext.SPSR;
+  Instance->SystemContext.FPSR = CurrentContext.FPSR;
+  Instance->SystemContext.ESR  = CurrentContext.ESR;
+  Instance->SystemContext.FAR  = CurrentContext.FAR;
+
+  Instance->SystemContext.LR = (UINT64)(UINTN)CoroutineMain;
+  Instance->SystemContext.SP = Instance->StackBase + StackSize;
+  Instance->SystemContext.X0 = (UINT64)(UINTN)Instance;
+
+  InsertTailList (&mCoroutineList, &Instance->Link);
+  mCoroutinesPending++;
+
+  if (Handle != NULL) {
+    *Handle = (COROUTINE_HANDLE)Instance;
+  }
+
+  if (mCurrentCoroutine != NULL) {
+    Instance->LastYield = GetPerformanceCounter ();
+    Instance->State     = CoroutineStateWaiting;
+    gBS->SetTimer (Instance->Timer, TimerRelative, 0);
+  } else {
+    OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+    CoroutineResume (Instance);
+    gBS->RestoreTPL (OldTpl);
+  }
+
+  return EFI_SUCCESS;
+
+ErrorExit:
+  CoroutineRelease (Instance);
+  FreePool (Instance);
+  return Status;
+}
+
+/**
+  Checks if the caller is running in a coroutine.
+
+  @retval TRUE                  Caller is running in a coroutine
+  @retval FALSE                 Caller is running in the main context
+**/
+BOOLEAN
+EFIAPI
+CoroutineIsActive (
+  VOID
+  )
+{
+  return (mCurrentCoroutine != NULL);
+}
+
+/**
+  Returns the number of coroutines that have not yet completed.
+
+  @retval Number of pending coroutines
+**/
+UINTN
+EFIAPI
+CoroutinesPending (
+  VOID
+  )
+{
+  return mCoroutinesPending;
+}
+
+/**
+  Stalls for at least the given number of microseconds.
+
+  When called from a coroutine, yields to other work for the duration of the
+  delay. Otherwise behaves like MicroSecondDelay.
+
+  @param[in]  MicroSeconds      The minimum number of microseconds to delay.
+
+  @return The value of MicroSeconds inputted.
+**/
+UINTN
+EFIAPI
+CoroutineMicroSecondDelay (
+  IN UINTN  MicroSeconds
+  )
+{
+  if (mCurrentCoroutine == NULL) {
+    return MicroSecondDelay (MicroSeconds);
+  }
+
+  CoroutineYield (MicroSeconds);
+  return MicroSeconds;
+}
+
+/**
+  Waits until a condition is met.
+
+  @param[in]  Condition         Condition callback.
+  @param[in]  Context           Context passed to Condition.
+  @param[in]  PollIntervalUs    Interval between checks in microseconds.
+  @param[in]  TimeoutUs         Timeout in microseconds, or COROUTINE_TIMEOUT_INFINITE.
+
+  @retval EFI_SUCCESS           Condition was met
+  @retval EFI_TIMEOUT           Condition was not met before timeout
+  @retval EFI_INVALID_PARAMETER Condition is NULL
+**/
+EFI_STATUS
+EFIAPI
+CoroutineWaitForCondition (
+  IN COROUTINE_CONDITION  Condition,
+  IN VOID                 *Context,
+  IN UINTN                PollIntervalUs,
+  IN UINTN                TimeoutUs
+  )
+{
+  UINTN  Waited;
+
+  if (Condition == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (PollIntervalUs == 0) {
+    PollIntervalUs = 1;
+  }
+
+  Waited = 0;
+  while (!Condition (Context)) {
+    if (TimeoutUs != COROUTINE_TIMEOUT_INFINITE) {
+      if (Waited >= TimeoutUs) {
+        return EFI_TIMEOUT;
+      }
+
+      Waited += PollIntervalUs;
+    }
+
+    CoroutineMicroSecondDelay (PollIntervalUs);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Condition callback for CoroutineWaitForEvent.
+
+  @param[in]  Context          Event
+
+  @retval TRUE                 Event is signaled
+  @retval FALSE                Event is not signaled
+**/
+STATIC
+BOOLEAN
+EFIAPI
+CoroutineEventSignaled (
+  IN VOID  *Context
+  )
+{
+  return !EFI_ERROR (gBS->CheckEvent ((EFI_EVENT)Context));
+}
+
+/**
+  Waits until an event is signaled.
+
+  Intended for tokens such as BPMP IPC or I2C request events. The event must
+  not be of type EVT_NOTIFY_SIGNAL. On success the event is reset to the
+  non-signaled state.
+
+  @param[in]  Event             Event to wait on.
+  @param[in]  TimeoutUs         Timeout in microseconds, or COROUTINE_TIMEOUT_INFINITE.
+
+  @retval EFI_SUCCESS           Event was signaled
+  @retval EFI_TIMEOUT           Event was not signaled before timeout
+  @retval others                Error occurred
+**/
+EFI_STATUS
+EFIAPI
+CoroutineWaitForEvent (
+  IN EFI_EVENT  Event,
+  IN UINTN      TimeoutUs
+  )
+{
+  if (Event == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return CoroutineWaitForCondition (
+           CoroutineEventSignaled,
+           Event,
+           COROUTINE_EVENT_POLL_INTERVAL_US,
+           TimeoutUs
+           );
+}
+
+typedef struct {
+  UINTN     Address;
+  UINT32    Mask;
+  UINT32    Value;
+  BOOLEAN   Is16Bit;
+} COROUTINE_MMIO_POLL;
+
+/**
+  Condition callback for register polling.
+
+  @param[in]  Context          COROUTINE_MMIO_POLL
+
+  @retval TRUE                 Register matched
+  @retval FALSE                Register did not match
+**/
+STATIC
+BOOLEAN
+EFIAPI
+CoroutineMmioMatches (
+  IN VOID  *Context
+  )
+{
+  COROUTINE_MMIO_POLL  *Poll;
+  UINT32               Data;
+
+  Poll = (COROUTINE_MMIO_POLL *)Context;
+  if (Poll->Is16Bit) {
+    Data = MmioRead16 (Poll->Address);
+  } else {
+    Data = MmioRead32 (Poll->Address);
+  }
+
+  return ((Data & Poll->Mask) == Poll->Value);
+}
+
+/**
+  Polls a 16-bit register until (Register & Mask) == Value.
+
+  @param[in]  Address           Address of the register.
+  @param[in]  Mask              Mask to apply to the register.
+  @param[in]  Value             Expected value after masking.
+  @param[in]  PollIntervalUs    Interval between reads in microseconds.
+  @param[in]  TimeoutUs         Timeout in microseconds, or COROUTINE_TIMEOUT_INFINITE.
+
+  @retval EFI_SUCCESS           Register matched
+  @retval EFI_TIMEOUT           Register did not match before timeout
+**/
+EFI_STATUS
+EFIAPI
+CoroutinePollMmio16 (
+  IN UINTN   Address,
+  IN UINT16  Mask,
+  IN UINT16  Value,
+  IN UINTN   PollIntervalUs,
+  IN UINTN   TimeoutUs
+  )
+{
+  COROUTINE_MMIO_POLL  Poll;
+
+  Poll.Address = Address;
+  Poll.Mask    = Mask;
+  Poll.Value   = Value;
+  Poll.Is16Bit = TRUE;
+
+  return CoroutineWaitForCondition (CoroutineMmioMatches, &Poll, PollIntervalUs, TimeoutUs);
+}
+
+/**
+  Polls a 32-bit register until (Register & Mask) == Value.
+
+  @param[in]  Address           Address of the register.
+  @param[in]  Mask              Mask to apply to the register.
+  @param[in]  Value             Expected value after masking.
+  @param[in]  PollIntervalUs    Interval between reads in microseconds.
+  @param[in]  TimeoutUs         Timeout in microseconds, or COROUTINE_TIMEOUT_INFINITE.
+
+  @retval EFI_SUCCESS           Register matched
+  @retval EFI_TIMEOUT           Register did not match before timeout
+**/
+EFI_STATUS
+EFIAPI
+CoroutinePollMmio32 (
+  IN UINTN   Address,
+  IN UINT32  Mask,
+  IN UINT32  Value,
+  IN UINTN   PollIntervalUs,
+  IN UINTN   TimeoutUs
+  )
+{
+  COROUTINE_MMIO_POLL  Poll;
+
+  Poll.Address = Address;
+  Poll.Mask    = Mask;
+  Poll.Value   = Value;
+  Poll.Is16Bit = FALSE;
+
+  return CoroutineWaitForCondition (CoroutineMmioMatches, &Poll, PollIntervalUs, TimeoutUs);
+}
+
+/**
+  Condition callback for CoroutineWait.
+
+  @param[in]  Context          Coroutine instance
+
+  @retval TRUE                 Coroutine is done
+  @retval FALSE                Coroutine is still running
+**/
+STATIC
+BOOLEAN
+EFIAPI
+CoroutineIsDone (
+  IN VOID  *Context
+  )
+{
+  return (((COROUTINE_INSTANCE *)Context)->State == CoroutineStateDone);
+}
+
+/**
+  Waits for a coroutine to complete.
+
+  @param[in]  Handle            Handle returned by CoroutineSpawn.
+  @param[out] CoroutineStatus   Optional status returned by the coroutine.
+
+  @retval EFI_SUCCESS           Coroutine completed
+  @retval EFI_INVALID_PARAMETER Handle is invalid
+  @retval EFI_UNSUPPORTED       Called from main context at or above TPL_CALLBACK
+**/
+EFI_STATUS
+EFIAPI
+CoroutineWait (
+  IN  COROUTINE_HANDLE  Handle,
+  OUT EFI_STATUS        *CoroutineStatus OPTIONAL
+  )
+{
+  COROUTINE_INSTANCE  *Instance;
+  EFI_TPL             OldTpl;
+
+  Instance = (COROUTINE_INSTANCE *)Handle;
+  if ((Instance == NULL) || (Instance->Signature != COROUTINE_SIGNATURE)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Instance == mCurrentCoroutine) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (mCurrentCoroutine != NULL) {
+    CoroutineWaitForCondition (CoroutineIsDone, Instance, COROUTINE_EVENT_POLL_INTERVAL_US, COROUTINE_TIMEOUT_INFINITE);
+  } else {
+    // Timer callbacks can only resume coroutines below TPL_CALLBACK
+    OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+    gBS->RestoreTPL (OldTpl);
+    if ((OldTpl >= TPL_CALLBACK) && !CoroutineIsDone (Instance)) {
+      return EFI_UNSUPPORTED;
+    }
+
+    while (!CoroutineIsDone (Instance)) {
+      gBS->Stall (COROUTINE_MAIN_WAIT_STALL_US);
+    }
+  }
+
+  if (CoroutineStatus != NULL) {
+    *CoroutineStatus = Instance->Status;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Frees a completed coroutine. The handle is invalid afterwards.
+
+  @param[in]  Handle            Handle returned by CoroutineSpawn.
+
+  @retval EFI_SUCCESS           Coroutine was freed
+  @retval EFI_INVALID_PARAMETER Handle is invalid
+  @retval EFI_NOT_READY         Coroutine has not completed
+**/
+EFI_STATUS
+EFIAPI
+CoroutineFree (
+  IN  COROUTINE_HANDLE  Handle
+  )
+{
+  COROUTINE_INSTANCE  *Instance;
+
+  Instance = (COROUTINE_INSTANCE *)Handle;
+  if ((Instance == NULL) || (Instance->Signature != COROUTINE_SIGNATURE)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Instance->State != CoroutineStateDone) {
+    return EFI_NOT_READY;
+  }
+
+  CoroutineDestroy (Instance);
+  return EFI_SUCCESS;
+}
+
+/**
+  Prints the run and wait time of every coroutine spawned by this module.
+
+  Called automatically at ReadyToBoot.
+**/
+VOID
+EFIAPI
+CoroutineReport (
+  VOID
+  )
+{
+  LIST_ENTRY          *Link;
+  COROUTINE_INSTANCE  *Instance;
+  UINT64              TotalRunNs;
+  UINT64              TotalWaitNs;
+
+  if (IsListEmpty (&mCoroutineList) && (mCoroutinesFreed == 0)) {
+    return;
+  }
+
+  TotalRunNs  = mFreedRunTimeNs;
+  TotalWaitNs = mFreedWaitTimeNs;
+  DEBUG ((DEBUG_INFO, "%a: Coroutine report, %Lu pending\r\n", gEfiCallerBaseName, (UINT64)mCoroutinesPending));
+  BASE_LIST_FOR_EACH (Link, &mCoroutineList) {
+    Instance = COROUTINE_INSTANCE_FROM_LINK (Link);
+    DEBUG ((
+      DEBUG_INFO,
+      "%a:   %a: run %lu us, wait %lu us, %lu yields, %a %r\r\n",
+      gEfiCallerBaseName,
+      Instance->Name,
+      DivU64x32 (Instance->RunTimeNs, 1000),
+      DivU64x32 (Instance->WaitTimeNs, 1000),
+      Instance->Yields,
+      (Instance->State == CoroutineStateDone) ? "done" : "pending",
+      Instance->Status
+      ));
+    TotalRunNs  += Instance->RunTimeNs;
+    TotalWaitNs += Instance->WaitTimeNs;
+  }
+
+  if (mCoroutinesFreed != 0) {
+    DEBUG ((
+      DEBUG_INFO,
+      "%a:   %Lu freed: run %lu us, wait %lu us, %lu yields\r\n",
+      gEfiCallerBaseName,
+      (UINT64)mCoroutinesFreed,
+      DivU64x32 (mFreedRunTimeNs, 1000),
+      DivU64x32 (mFreedWaitTimeNs, 1000),
+      mFreedYields
+      ));
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: Coroutine total run %lu us, overlapped wait %lu us\r\n",
+    gEfiCallerBaseName,
+    DivU64x32 (TotalRunNs, 1000),
+    DivU64x32 (TotalWaitNs, 1000)
+    ));
+}
@@ -0,0 +1,61 @@
+/** @file
+
+  Coroutine Library private structures
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __COROUTINE_LIBRARY_PRIVATE_H__
+#define __COROUTINE_LIBRARY_PRIVATE_H__
+
+#include <PiDxe.h>
+#include <Library/CoroutineLib.h>
+#include <Protocol/DebugSupport.h>
+
+#define COROUTINE_SIGNATURE  SIGNATURE_32('C','O','R','O')
+
+#define COROUTINE_MAX_NAME_LENGTH  32
+
+// Interval used when the main context waits for a coroutine to complete
+#define COROUTINE_MAIN_WAIT_STALL_US  10
+
+// Default interval used to poll events when none is specified
+#define COROUTINE_EVENT_POLL_INTERVAL_US  10
+
+typedef enum {
+  CoroutineStateReady,
+  CoroutineStateRunning,
+  CoroutineStateWaiting,
+  CoroutineStateDone
+} COROUTINE_STATE;
+
+typedef struct {
+  UINT32                        Signature;
+  LIST_ENTRY                    Link;
+  CHAR8                         Name[COROUTINE_MAX_NAME_LENGTH];
+  COROUTINE_ENTRY               Entry;
+  VOID                          *Context;
+  COROUTINE_STATE               State;
+  EFI_STATUS                    Status;
+  EFI_EVENT                     CompletionEvent;
+  BOOLEAN                       Detached;         // No handle, freed when done
+
+  EFI_PHYSICAL_ADDRESS          StackBase;
+  UINTN                         StackSize;
+  EFI_EVENT                     Timer;
+  EFI_SYSTEM_CONTEXT_AARCH64    SystemContext;
+
+  // Accounting
+  UINT64                        LastResume;
+  UINT64                        LastYield;
+  UINT64                        RunTimeNs;
+  UINT64                        WaitTimeNs;
+  UINT64                        Yields;
+} COROUTINE_INSTANCE;
+
+#define COROUTINE_INSTANCE_FROM_LINK(a)  CR(a, COROUTINE_INSTANCE, Link, COROUTINE_SIGNATURE)
+
+#endif
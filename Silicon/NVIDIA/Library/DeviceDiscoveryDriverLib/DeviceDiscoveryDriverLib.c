@@ -2,7 +2,7 @@
 
   Device Discovery Driver Library
 
-  SPDX-FileCopyrightText: Copyright (c) 2018-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2018-2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -13,6 +13,7 @@
 #include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/BootTraceLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiLib.h>
 #include <Library/IoLib.h>
@@ -23,7 +24,8 @@
 #include <Library/PlatformResourceLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/TimerLib.h>
-#include <Library/SystemContextLib.h>
+#include <Library/CoroutineLib.h>
+#include <Library/FdtLib.h>
 
 #include <Protocol/AsyncDriverStatus.h>
 #include <Protocol/NonDiscoverableDevice.h>
@@ -40,12 +42,61 @@
 SCMI_CLOCK2_PROTOCOL                           *gScmiClockProtocol    = NULL;
 NVIDIA_CLOCK_PARENTS_PROTOCOL                  *gClockParentsProtocol = NULL;
 STATIC EFI_HANDLE                              mImageHandle           = NULL;
-STATIC EFI_SYSTEM_CONTEXT_AARCH64              MainContext            = { 0 };
 STATIC UINTN                                   SubThreadsRunning      = 0;
 STATIC NVIDIA_ASYNC_DRIVER_STATUS_PROTOCOL     *AsyncProtocol         = NULL;
-STATIC NVIDIA_DEVICE_DISCOVERY_THREAD_CONTEXT  *CurrentThread         = NULL;
 BOOLEAN                                        EnumerationCompleted   = FALSE;
 
+STATIC CONST CHAR8  *mDeviceDiscoveryPhaseNames[DeviceDiscoveryMax] = {
+  "DriverStart",
+  "DeviceTreeCompatibility",
+  "BindingSupported",
+  "BindingStart",
+  "BindingStop",
+  "OnExit",
+  "EnumerationCompleted"
+};
+
+/**
+  Calls DeviceDiscoveryNotify inside a boot trace span named after the
+  driver with a nested span named after the phase. Both spans carry the
+  device tree node offset as their argument so that only the driver and
+  phase names are added to the trace string table.
+
+  @param[in] Phase                    Current phase of the driver initialization
+  @param[in] DriverHandle             Handle of the driver.
+  @param[in] ControllerHandle         Handle of the controller.
+  @param[in] DeviceTreeNode           Pointer to the device tree node protocol is available.
+
+  @retval Status returned by DeviceDiscoveryNotify
+**/
+STATIC
+EFI_STATUS
+DeviceDiscoveryTracedNotify (
+  IN  NVIDIA_DEVICE_DISCOVERY_PHASES          Phase,
+  IN  EFI_HANDLE                              DriverHandle,
+  IN  EFI_HANDLE                              ControllerHandle,
+  IN  CONST NVIDIA_DEVICE_TREE_NODE_PROTOCOL  *DeviceTreeNode OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      NodeOffset;
+  UINT32      DriverSpanId;
+  UINT32      PhaseSpanId;
+
+  NodeOffset = MAX_UINT32;
+  if (DeviceTreeNode != NULL) {
+    NodeOffset = (UINT32)DeviceTreeNode->NodeOffset;
+  }
+
+  DriverSpanId = BootTraceBegin (BootTraceCategoryDeviceDiscovery, gEfiCallerBaseName, NodeOffset);
+  PhaseSpanId  = BootTraceBegin (BootTraceCategoryDeviceDiscovery, mDeviceDiscoveryPhaseNames[Phase], NodeOffset);
+  Status       = DeviceDiscoveryNotify (Phase, DriverHandle, ControllerHandle, DeviceTreeNode);
+  BootTraceEnd (PhaseSpanId);
+  BootTraceEnd (DriverSpanId);
+
+  return Status;
+}
+
 /**
   Gets info on if an async driver is still running.
 
@@ -195,25 +246,6 @@ DeviceDiscoveryOnExitBootServices (
   return;
 }
 
-/**
-  @brief Timer event callback. When this fires we switch back to the driver
-  context until it yields again.
-
-  @param Context Thread Context
-**/
-VOID
-DeviceDiscoveryThreadCallback (
-  IN EFI_EVENT  Event,
-  IN VOID       *Context
-  )
-{
-  CurrentThread = (NVIDIA_DEVICE_DISCOVERY_THREAD_CONTEXT *)Context;
-  SwapSystemContext (
-    (EFI_SYSTEM_CONTEXT)&MainContext,
-    (EFI_SYSTEM_CONTEXT)&CurrentThread->Context
-    );
-}
-
 /**
   Stalls for at least the given number of microseconds.
 
@@ -230,40 +262,30 @@ DeviceDiscoveryThreadMicroSecondDelay (
   IN      UINTN  MicroSeconds
   )
 {
-  NVIDIA_DEVICE_DISCOVERY_THREAD_CONTEXT  *ThreadContext;
-
-  if (CurrentThread == NULL) {
-    return MicroSecondDelay (MicroSeconds);
-  }
-
-  ThreadContext = CurrentThread;
-  gBS->SetTimer (ThreadContext->Timer, TimerRelative, MicroSeconds*10);
-  CurrentThread = NULL;
-  SwapSystemContext (
-    (EFI_SYSTEM_CONTEXT)&ThreadContext->Context,
-    (EFI_SYSTEM_CONTEXT)&MainContext
-    );
-  return MicroSeconds;
+  return CoroutineMicroSecondDelay (MicroSeconds);
 }
 
 /**
   @brief Wrapper function for driver start
 
-  @param ThreadContext Thread context info
+  @param Context  Thread context info
 
+  @retval Status returned by the driver start notification
 **/
 STATIC
-VOID
+EFI_STATUS
+EFIAPI
 DeviceThreadMain (
-  IN NVIDIA_DEVICE_DISCOVERY_THREAD_CONTEXT  *ThreadContext
+  IN VOID  *Context
   )
 {
-  EFI_STATUS  Status;
+  EFI_STATUS                              Status;
+  NVIDIA_DEVICE_DISCOVERY_THREAD_CONTEXT  *ThreadContext;
 
-  CurrentThread = ThreadContext;
+  ThreadContext = (NVIDIA_DEVICE_DISCOVERY_THREAD_CONTEXT *)Context;
   SubThreadsRunning++;
 
-  Status = DeviceDiscoveryNotify (
+  Status = DeviceDiscoveryTracedNotify (
              DeviceDiscoveryDriverBindingStart,
              ThreadContext->DriverHandle,
              ThreadContext->Controller,
@@ -273,31 +295,23 @@ DeviceThreadMain (
     DEBUG ((DEBUG_ERROR, "%a, driver returned %r to start notification\r\n", __FUNCTION__, Status));
   }
 
-  CurrentThread = NULL;
+  FreePool (ThreadContext);
   SubThreadsRunning--;
-  gBS->CloseEvent (ThreadContext->Timer);
 
   if (EnumerationCompleted && (SubThreadsRunning == 0)) {
-    Status = DeviceDiscoveryNotify (
-               DeviceDiscoveryEnumerationCompleted,
-               mImageHandle,
-               NULL,
-               NULL
-               );
+    DeviceDiscoveryTracedNotify (
+      DeviceDiscoveryEnumerationCompleted,
+      mImageHandle,
+      NULL,
+      NULL
+      );
   }
 
-  SwapSystemContext (
-    (EFI_SYSTEM_CONTEXT)&ThreadContext->Context,
-    (EFI_SYSTEM_CONTEXT)&MainContext
-    );
-
-  // Should never get here
-  ASSERT (FALSE);
-  CpuDeadLoop ();
+  return Status;
 }
 
 /**
-  @brief Start device initialization in a subthread
+  @brief Start device initialization in a coroutine
 
   @param DriverHandle  Handle of Driver
   @param Controller    Handle of Contoller
@@ -317,84 +331,47 @@ ThreadedDeviceStart (
 {
   EFI_STATUS                              Status;
   NVIDIA_DEVICE_DISCOVERY_THREAD_CONTEXT  *NewContext;
-  EFI_TPL                                 OldTpl;
-  UINTN                                   ThreadStackPages;
+  CONST CHAR8                             *Name;
 
   NewContext = (NVIDIA_DEVICE_DISCOVERY_THREAD_CONTEXT *)AllocateZeroPool (sizeof (NVIDIA_DEVICE_DISCOVERY_THREAD_CONTEXT));
   if (NewContext == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-    goto ErrorExit;
-  }
-
-  ThreadStackPages = EFI_SIZE_TO_PAGES (THREAD_STACK_SIZE);
-
-  NewContext->StackBase = (EFI_PHYSICAL_ADDRESS)AllocatePages (ThreadStackPages);
-  if (NewContext->StackBase == 0) {
-    Status = EFI_OUT_OF_RESOURCES;
-    goto ErrorExit;
-  }
-
-  Status = gBS->CreateEvent (
-                  EVT_TIMER|EVT_NOTIFY_SIGNAL,
-                  TPL_CALLBACK,
-                  DeviceDiscoveryThreadCallback,
-                  NewContext,
-                  &NewContext->Timer
-                  );
-  if (EFI_ERROR (Status)) {
-    goto ErrorExit;
+    return EFI_OUT_OF_RESOURCES;
   }
 
   NewContext->Controller   = Controller;
   NewContext->DriverHandle = DriverHandle;
   NewContext->Node         = Node;
 
-  // Don't change the special registers
-  GetSystemContext ((EFI_SYSTEM_CONTEXT)&MainContext);
-  NewContext->Context.ELR  = MainContext.ELR;
-  NewContext->Context.SPSR = MainContext.SPSR;
-  NewContext->Context.FPSR = MainContext.FPSR;
-  NewContext->Context.ESR  = MainContext.ESR;
-  NewContext->Context.FAR  = MainContext.FAR;
+  Name = NULL;
+  if (Node != NULL) {
+    Name = FdtGetName (Node->DeviceTreeBase, Node->NodeOffset, NULL);
+  }
 
-  NewContext->Context.LR = (UINT64)DeviceThreadMain;
-  NewContext->Context.SP = NewContext->StackBase + THREAD_STACK_SIZE;
-  NewContext->Context.X0 = (UINT64)NewContext;
+  if (Name == NULL) {
+    Name = gEfiCallerBaseName;
+  }
 
   if (AsyncProtocol == NULL) {
     AsyncProtocol = (NVIDIA_ASYNC_DRIVER_STATUS_PROTOCOL *)AllocatePool (sizeof (NVIDIA_ASYNC_DRIVER_STATUS_PROTOCOL));
     if (AsyncProtocol == NULL) {
-      Status = EFI_OUT_OF_RESOURCES;
-      goto ErrorExit;
+      FreePool (NewContext);
+      return EFI_OUT_OF_RESOURCES;
     }
 
     AsyncProtocol->GetStatus = DeviceDiscoveryAsyncStatus;
     gBS->InstallMultipleProtocolInterfaces (&DriverHandle, &gNVIDIAAsyncDriverStatusProtocol, (VOID *)AsyncProtocol, NULL);
   }
 
-  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
-  SwapSystemContext (
-    (EFI_SYSTEM_CONTEXT)&MainContext,
-    (EFI_SYSTEM_CONTEXT)&NewContext->Context
-    );
-  gBS->RestoreTPL (OldTpl);
-
-ErrorExit:
+  Status = CoroutineSpawn (
+             Name,
+             DeviceThreadMain,
+             NewContext,
+             THREAD_STACK_SIZE,
+             NULL,
+             NULL
+             );
   if (EFI_ERROR (Status)) {
-    if (NewContext != NULL) {
-      if (NewContext->Timer != 0) {
-        gBS->CloseEvent (NewContext->Timer);
-        NewContext->Timer = 0;
-      }
-
-      if (NewContext->StackBase != 0) {
-        FreePages ((VOID *)NewContext->StackBase, ThreadStackPages);
-        NewContext->StackBase = 0;
-      }
-
-      FreePool (NewContext);
-      NewContext = NULL;
-    }
+    FreePool (NewContext);
   }
 
   return Status;
@@ -423,7 +400,7 @@ DeviceDiscoveryStart (
   NVIDIA_RESET_NODE_PROTOCOL        *ResetProtocol           = NULL;
   NVIDIA_POWER_GATE_NODE_PROTOCOL   *PgProtocol              = NULL;
   NVIDIA_DEVICE_TREE_NODE_PROTOCOL  *Node                    = NULL;
-  UINTN                             Index;
+  UINT64                            StartTime;
   NVIDIA_DEVICE_DISCOVERY_CONTEXT   *DeviceDiscoveryContext = NULL;
 
   //
@@ -447,7 +424,7 @@ DeviceDiscoveryStart (
     Node = NULL;
   }
 
-  Status = DeviceDiscoveryNotify (
+  Status = DeviceDiscoveryTracedNotify (
              DeviceDiscoveryDriverBindingSupported,
              mImageHandle,
              Controller,
@@ -458,6 +435,8 @@ DeviceDiscoveryStart (
     goto ErrorExit;
   }
 
+  StartTime = GetPerformanceCounter ();
+
   if (gDeviceDiscoverDriverConfig.AutoDeassertPg) {
     Status = gBS->HandleProtocol (Controller, &gNVIDIAPowerGateNodeProtocolGuid, (VOID **)&PgProtocol);
     if (EFI_ERROR (Status)) {
@@ -465,12 +444,10 @@ DeviceDiscoveryStart (
       goto ErrorExit;
     }
 
-    for (Index = 0; Index < PgProtocol->NumberOfPowerGates; Index++) {
-      Status = PgProtocol->Deassert (PgProtocol, PgProtocol->PowerGateId[Index]);
-      if (EFI_ERROR (Status)) {
-        DEBUG ((DEBUG_ERROR, "%a, failed to deassert Pg %x: %r\r\n", __FUNCTION__, PgProtocol->PowerGateId[Index], Status));
-        goto ErrorExit;
-      }
+    Status = PgProtocol->DeassertAll (PgProtocol);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a, failed to deassert Pgs %r\r\n", __FUNCTION__, Status));
+      goto ErrorExit;
     }
   }
 
@@ -514,6 +491,14 @@ DeviceDiscoveryStart (
     }
   }
 
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: %a power gates, clocks and resets took %lu ns\r\n",
+    __FUNCTION__,
+    gEfiCallerBaseName,
+    GetTimeInNanoSecond (GetPerformanceCounter () - StartTime)
+    ));
+
   Status = gBS->AllocatePool (
                   EfiBootServicesData,
                   sizeof (NVIDIA_DEVICE_DISCOVERY_CONTEXT),
@@ -556,7 +541,7 @@ DeviceDiscoveryStart (
       goto ErrorExit;
     }
   } else {
-    Status = DeviceDiscoveryNotify (
+    Status = DeviceDiscoveryTracedNotify (
                DeviceDiscoveryDriverBindingStart,
                mImageHandle,
                Controller,
@@ -797,7 +782,7 @@ DeviceDiscoveryEnumerateDevices (
 
   EnumerationCompleted = TRUE;
   if (!gDeviceDiscoverDriverConfig.ThreadedDeviceStart || (SubThreadsRunning == 0)) {
-    Status = DeviceDiscoveryNotify (
+    Status = DeviceDiscoveryTracedNotify (
                DeviceDiscoveryEnumerationCompleted,
                mImageHandle,
                NULL,
@@ -828,6 +813,7 @@ DeviceDiscoveryDriverInitialize (
   EFI_STATUS                    Status;
   VOID                          *Hob;
   TEGRA_PLATFORM_RESOURCE_INFO  *PlatformResourceInfo;
+  UINT32                        SpanId;
 
   Hob = GetFirstGuidHob (&gNVIDIAPlatformResourceDataGuid);
   if ((Hob != NULL) &&
@@ -858,13 +844,16 @@ DeviceDiscoveryDriverInitialize (
     return Status;
   }
 
-  Status = DeviceDiscoveryNotify (
+  SpanId = BootTraceBegin (BootTraceCategoryDriver, gEfiCallerBaseName, 0);
+
+  Status = DeviceDiscoveryTracedNotify (
              DeviceDiscoveryDriverStart,
              mImageHandle,
              NULL,
              NULL
              );
   if (EFI_ERROR (Status)) {
+    BootTraceEnd (SpanId);
     return Status;
   }
 
@@ -873,5 +862,6 @@ DeviceDiscoveryDriverInitialize (
     ASSERT_EFI_ERROR (Status);
   }
 
+  BootTraceEnd (SpanId);
   return Status;
 }
@@ -2,7 +2,7 @@
 
   Device Discovery Driver Library private structures
 
-  SPDX-FileCopyrightText: Copyright (c) 2018-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2018-2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -25,9 +25,6 @@ typedef struct {
 } NVIDIA_DEVICE_DISCOVERY_CONTEXT;
 
 typedef struct {
-  EFI_PHYSICAL_ADDRESS                   StackBase;
-  EFI_EVENT                              Timer;
-  EFI_SYSTEM_CONTEXT_AARCH64             Context;
   EFI_HANDLE                             DriverHandle;
   EFI_HANDLE                             Controller;
   IN NVIDIA_DEVICE_TREE_NODE_PROTOCOL    *Node;
@@ -673,6 +673,187 @@ BpmpProcessResetCommand (
   return Status;
 }
 
+/**
+  This function sends a batch of BPMP requests and waits for them once.
+
+  All but the last request are queued with a token and the last one is sent
+  blocking. The channel completes requests in order, so the blocking call
+  polls the channel until every request ahead of it is done as well.
+
+  @param[in]     BpmpIpcProtocol     The instance of the NVIDIA_BPMP_IPC_PROTOCOL.
+  @param[in]     BpmpPhandle         Phandle of the BPMP to send the requests to
+  @param[in,out] Requests            Requests to send, Status is set for each
+  @param[in]     Count               Number of requests
+
+  @return EFI_SUCCESS                All requests sent, see Status of each.
+  @return EFI_OUT_OF_RESOURCES       Failed to allocate tokens, nothing sent.
+**/
+STATIC
+EFI_STATUS
+BpmpCommunicateBatch (
+  IN     NVIDIA_BPMP_IPC_PROTOCOL  *BpmpIpcProtocol,
+  IN     UINT32                    BpmpPhandle,
+  IN OUT BPMP_BATCH_REQUEST        *Requests,
+  IN     UINTN                     Count
+  )
+{
+  EFI_STATUS             Status;
+  NVIDIA_BPMP_IPC_TOKEN  *Tokens;
+  UINTN                  Queued;
+  UINTN                  Index;
+  UINTN                  Timeout;
+  BOOLEAN                Pending;
+
+  if (Count == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Tokens = (NVIDIA_BPMP_IPC_TOKEN *)AllocateZeroPool (Count * sizeof (NVIDIA_BPMP_IPC_TOKEN));
+  if (Tokens == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Queued = 0; Queued < (Count - 1); Queued++) {
+    Status = gBS->CreateEvent (0, TPL_NOTIFY, NULL, NULL, &Tokens[Queued].Event);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    Tokens[Queued].TransactionStatus = EFI_NOT_READY;
+    Status                           = BpmpIpcProtocol->Communicate (
+                                                          BpmpIpcProtocol,
+                                                          &Tokens[Queued],
+                                                          BpmpPhandle,
+                                                          Requests[Queued].MessageRequest,
+                                                          Requests[Queued].TxData,
+                                                          Requests[Queued].TxDataSize,
+                                                          Requests[Queued].RxData,
+                                                          Requests[Queued].RxDataSize,
+                                                          NULL
+                                                          );
+    if (EFI_ERROR (Status)) {
+      gBS->CloseEvent (Tokens[Queued].Event);
+      break;
+    }
+  }
+
+  //
+  // Whatever could not be queued is sent blocking, normally just the last
+  // request, which drains the queued ones ahead of it.
+  //
+  for (Index = Queued; Index < Count; Index++) {
+    Requests[Index].Status = BpmpIpcProtocol->Communicate (
+                                                BpmpIpcProtocol,
+                                                NULL,
+                                                BpmpPhandle,
+                                                Requests[Index].MessageRequest,
+                                                Requests[Index].TxData,
+                                                Requests[Index].TxDataSize,
+                                                Requests[Index].RxData,
+                                                Requests[Index].RxDataSize,
+                                                NULL
+                                                );
+  }
+
+  //
+  // The queued requests are normally done by now, the wait only covers a
+  // blocking send that failed early and is bounded for the whole batch.
+  //
+  Timeout = BPMP_BATCH_TIMEOUT_US / BPMP_BATCH_STALL_US;
+  Pending = FALSE;
+  for (Index = 0; Index < Queued; Index++) {
+    while (((Status = gBS->CheckEvent (Tokens[Index].Event)) == EFI_NOT_READY) && (Timeout != 0)) {
+      gBS->Stall (BPMP_BATCH_STALL_US);
+      Timeout--;
+    }
+
+    if (Status == EFI_NOT_READY) {
+      Requests[Index].Status = EFI_TIMEOUT;
+      Pending                = TRUE;
+      continue;
+    }
+
+    Requests[Index].Status = Tokens[Index].TransactionStatus;
+    gBS->CloseEvent (Tokens[Index].Event);
+  }
+
+  DEBUG ((DEBUG_INFO, "%a: MRQ %u, %u requests, %u blocking waits\r\n", __FUNCTION__, Requests[0].MessageRequest, (UINT32)Count, (UINT32)(Count - Queued)));
+
+  //
+  // Tokens of timed out requests are still owned by the IPC channel
+  //
+  if (Pending) {
+    DEBUG ((DEBUG_ERROR, "%a: MRQ %u, timed out waiting for queued requests\r\n", __FUNCTION__, Requests[0].MessageRequest));
+  } else {
+    FreePool (Tokens);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  This function processes a reset command for all reset nodes.
+
+  @param[in]     BpmpIpcProtocol     The instance of the NVIDIA_BPMP_IPC_PROTOCOL.
+  @param[in]     This                The instance of the NVIDIA_RESET_NODE_PROTOCOL.
+  @param[in]     Command             Reset command
+
+  @return EFI_SUCCESS                All resets processed.
+  @return EFI_DEVICE_ERROR           Failed to process all resets
+**/
+STATIC
+EFI_STATUS
+BpmpProcessAllResetCommands (
+  IN NVIDIA_BPMP_IPC_PROTOCOL    *BpmpIpcProtocol,
+  IN NVIDIA_RESET_NODE_PROTOCOL  *This,
+  IN MRQ_RESET_COMMANDS          Command
+  )
+{
+  EFI_STATUS          Status;
+  BPMP_BATCH_REQUEST  *Requests;
+  UINT32              *Packets;
+  UINTN               Index;
+
+  Requests = (BPMP_BATCH_REQUEST *)AllocatePool (This->Resets * (sizeof (BPMP_BATCH_REQUEST) + (sizeof (UINT32) * 2)));
+  if (Requests != NULL) {
+    Packets = (UINT32 *)&Requests[This->Resets];
+    for (Index = 0; Index < This->Resets; Index++) {
+      Packets[2 * Index]             = (UINT32)Command;
+      Packets[2 * Index + 1]         = This->ResetEntries[Index].ResetId;
+      Requests[Index].MessageRequest = MRQ_RESET;
+      Requests[Index].TxData         = &Packets[2 * Index];
+      Requests[Index].TxDataSize     = sizeof (UINT32) * 2;
+      Requests[Index].RxData         = NULL;
+      Requests[Index].RxDataSize     = 0;
+      Requests[Index].Status         = EFI_NOT_READY;
+    }
+
+    Status = BpmpCommunicateBatch (BpmpIpcProtocol, This->BpmpPhandle, Requests, This->Resets);
+    if (!EFI_ERROR (Status)) {
+      for (Index = 0; Index < This->Resets; Index++) {
+        if (EFI_ERROR (Requests[Index].Status) && (Requests[Index].Status != EFI_UNSUPPORTED)) {
+          DEBUG ((DEBUG_ERROR, "%a: reset %u command %u failed: %r\r\n", __FUNCTION__, This->ResetEntries[Index].ResetId, Command, Requests[Index].Status));
+          Status = EFI_DEVICE_ERROR;
+        }
+      }
+
+      FreePool (Requests);
+      return Status;
+    }
+
+    FreePool (Requests);
+  }
+
+  for (Index = 0; Index < This->Resets; Index++) {
+    Status = BpmpProcessResetCommand (BpmpIpcProtocol, This->BpmpPhandle, This->ResetEntries[Index].ResetId, Command);
+    if (EFI_ERROR (Status)) {
+      return EFI_DEVICE_ERROR;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   This function allows for deassert of all reset nodes.
 
@@ -689,7 +870,6 @@ DeassertAllResetNodes (
 {
   NVIDIA_BPMP_IPC_PROTOCOL  *BpmpIpcProtocol = NULL;
   EFI_STATUS                Status;
-  UINTN                     Index;
 
   if (This->Resets == 0) {
     return EFI_SUCCESS;
@@ -700,14 +880,7 @@ DeassertAllResetNodes (
     return EFI_NOT_READY;
   }
 
-  for (Index = 0; Index < This->Resets; Index++) {
-    Status = BpmpProcessResetCommand (BpmpIpcProtocol, This->BpmpPhandle, This->ResetEntries[Index].ResetId, CmdResetDeassert);
-    if (EFI_ERROR (Status)) {
-      return EFI_DEVICE_ERROR;
-    }
-  }
-
-  return EFI_SUCCESS;
+  return BpmpProcessAllResetCommands (BpmpIpcProtocol, This, CmdResetDeassert);
 }
 
 /**
@@ -726,7 +899,6 @@ AssertAllResetNodes (
 {
   NVIDIA_BPMP_IPC_PROTOCOL  *BpmpIpcProtocol = NULL;
   EFI_STATUS                Status;
-  UINTN                     Index;
 
   if (This->Resets == 0) {
     return EFI_SUCCESS;
@@ -737,14 +909,7 @@ AssertAllResetNodes (
     return EFI_NOT_READY;
   }
 
-  for (Index = 0; Index < This->Resets; Index++) {
-    Status = BpmpProcessResetCommand (BpmpIpcProtocol, This->BpmpPhandle, This->ResetEntries[Index].ResetId, CmdResetAssert);
-    if (EFI_ERROR (Status)) {
-      return EFI_DEVICE_ERROR;
-    }
-  }
-
-  return EFI_SUCCESS;
+  return BpmpProcessAllResetCommands (BpmpIpcProtocol, This, CmdResetAssert);
 }
 
 /**
@@ -763,7 +928,6 @@ ModuleResetAllResetNodes (
 {
   NVIDIA_BPMP_IPC_PROTOCOL  *BpmpIpcProtocol = NULL;
   EFI_STATUS                Status;
-  UINTN                     Index;
 
   if (This->Resets == 0) {
     return EFI_SUCCESS;
@@ -774,14 +938,7 @@ ModuleResetAllResetNodes (
     return EFI_NOT_READY;
   }
 
-  for (Index = 0; Index < This->Resets; Index++) {
-    Status = BpmpProcessResetCommand (BpmpIpcProtocol, This->BpmpPhandle, This->ResetEntries[Index].ResetId, CmdResetModule);
-    if (EFI_ERROR (Status)) {
-      return EFI_DEVICE_ERROR;
-    }
-  }
-
-  return EFI_SUCCESS;
+  return BpmpProcessAllResetCommands (BpmpIpcProtocol, This, CmdResetModule);
 }
 
 /**
@@ -990,9 +1147,86 @@ GetResetNodeProtocol (
   ResetNodeProtocol[ListEntry]  = &gNVIDIAResetNodeProtocolGuid;
 }
 
+/**
+  This function gets the enable state of all clock nodes in one batch.
+
+  @param[in]     BpmpIpcProtocol     The instance of the NVIDIA_BPMP_IPC_PROTOCOL.
+  @param[in]     This                The instance of the NVIDIA_CLOCK_NODE_PROTOCOL.
+
+  @return Array of This->Clocks enable states, caller must free, or NULL on failure
+**/
+STATIC
+UINT32 *
+BpmpGetAllClockStates (
+  IN  NVIDIA_BPMP_IPC_PROTOCOL    *BpmpIpcProtocol,
+  IN  NVIDIA_CLOCK_NODE_PROTOCOL  *This
+  )
+{
+  EFI_STATUS              Status;
+  BPMP_BATCH_REQUEST      *Requests;
+  MRQ_CLK_COMMAND_PACKET  *Packets;
+  UINT32                  *ClockStates;
+  UINTN                   Index;
+
+  ClockStates = (UINT32 *)AllocateZeroPool (This->Clocks * sizeof (UINT32));
+  Requests    = (BPMP_BATCH_REQUEST *)AllocateZeroPool (This->Clocks * (sizeof (BPMP_BATCH_REQUEST) + sizeof (MRQ_CLK_COMMAND_PACKET)));
+  if ((ClockStates == NULL) || (Requests == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
+  }
+
+  Packets = (MRQ_CLK_COMMAND_PACKET *)&Requests[This->Clocks];
+  for (Index = 0; Index < This->Clocks; Index++) {
+    Packets[Index].ClockId         = NVIDIA_CLOCK_ID (This->ClockEntries[Index].ClockId);
+    Packets[Index].Command         = CmdClkIsEnabled;
+    Requests[Index].MessageRequest = MRQ_CLK;
+    Requests[Index].TxData         = &Packets[Index];
+    Requests[Index].TxDataSize     = sizeof (MRQ_CLK_COMMAND_PACKET);
+    Requests[Index].RxData         = &ClockStates[Index];
+    Requests[Index].RxDataSize     = sizeof (UINT32);
+  }
+
+  //
+  // All clocks of a node are provided by the same BPMP
+  //
+  Status = BpmpCommunicateBatch (
+             BpmpIpcProtocol,
+             NVIDIA_CLOCK_BPMP_PHANDLE (This->ClockEntries[0].ClockId),
+             Requests,
+             This->Clocks
+             );
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  for (Index = 0; Index < This->Clocks; Index++) {
+    if (EFI_ERROR (Requests[Index].Status)) {
+      Status = Requests[Index].Status;
+      break;
+    }
+  }
+
+Exit:
+  if (Requests != NULL) {
+    FreePool (Requests);
+  }
+
+  if (EFI_ERROR (Status) && (ClockStates != NULL)) {
+    FreePool (ClockStates);
+    ClockStates = NULL;
+  }
+
+  return ClockStates;
+}
+
 /**
   This function allows for simple enablement of all clock nodes.
 
+  The enable state of all clocks is read in one BPMP batch. A clock that was
+  off may be turned on as the parent of another clock of the node, so once a
+  clock has been enabled the state of the remaining ones is read again before
+  enabling them.
+
   @param[in]     This                The instance of the NVIDIA_CLOCK_NODE_PROTOCOL.
 
   @return EFI_SUCCESS                All clocks enabled.
@@ -1004,12 +1238,16 @@ EnableAllClockNodes (
   IN  NVIDIA_CLOCK_NODE_PROTOCOL  *This
   )
 {
-  SCMI_CLOCK2_PROTOCOL  *ClockProtocol = NULL;
-  EFI_STATUS            Status;
-  UINTN                 Index;
-  UINT32                ClockId;
-  BOOLEAN               ClockStatus;
-  CHAR8                 ClockName[SCMI_MAX_STR_LEN];
+  SCMI_CLOCK2_PROTOCOL      *ClockProtocol   = NULL;
+  NVIDIA_BPMP_IPC_PROTOCOL  *BpmpIpcProtocol = NULL;
+  EFI_STATUS                Status;
+  UINTN                     Index;
+  UINTN                     ClockIndex;
+  UINT32                    ClockId;
+  UINT32                    *ClockStates;
+  BOOLEAN                   ClockStatus;
+  BOOLEAN                   ClockEnabled;
+  CHAR8                     ClockName[SCMI_MAX_STR_LEN];
 
   if (This->Clocks == 0) {
     return EFI_SUCCESS;
@@ -1020,22 +1258,47 @@ EnableAllClockNodes (
     return EFI_NOT_READY;
   }
 
+  ClockStates = NULL;
+  Status      = gBS->LocateProtocol (&gNVIDIABpmpIpcProtocolGuid, NULL, (VOID **)&BpmpIpcProtocol);
+  if (!EFI_ERROR (Status)) {
+    ClockStates = BpmpGetAllClockStates (BpmpIpcProtocol, This);
+  }
+
+  ClockEnabled = FALSE;
+  Status       = EFI_SUCCESS;
   for (Index = 0; Index < This->Clocks; Index++) {
-    ClockId = This->ClockEntries[This->Clocks - Index - 1].ClockId;
-    Status  = ClockProtocol->GetClockAttributes (ClockProtocol, ClockId, &ClockStatus, ClockName);
-    if (EFI_ERROR (Status)) {
-      return EFI_DEVICE_ERROR;
+    ClockIndex = This->Clocks - Index - 1;
+    ClockId    = This->ClockEntries[ClockIndex].ClockId;
+    if ((ClockStates != NULL) && (ClockStates[ClockIndex] != 0)) {
+      continue;
     }
 
-    if (!ClockStatus) {
-      Status = ClockProtocol->Enable (ClockProtocol, ClockId, TRUE);
+    if ((ClockStates == NULL) || ClockEnabled) {
+      Status = ClockProtocol->GetClockAttributes (ClockProtocol, ClockId, &ClockStatus, ClockName);
       if (EFI_ERROR (Status)) {
-        return EFI_DEVICE_ERROR;
+        Status = EFI_DEVICE_ERROR;
+        break;
+      }
+
+      if (ClockStatus) {
+        continue;
       }
     }
+
+    Status = ClockProtocol->Enable (ClockProtocol, ClockId, TRUE);
+    if (EFI_ERROR (Status)) {
+      Status = EFI_DEVICE_ERROR;
+      break;
+    }
+
+    ClockEnabled = TRUE;
   }
 
-  return EFI_SUCCESS;
+  if (ClockStates != NULL) {
+    FreePool (ClockStates);
+  }
+
+  return Status;
 }
 
 /**
@@ -1186,7 +1449,7 @@ GetClockNodeProtocol (
   for (Index = 0; Index < NumberOfClocks; Index++) {
     ClockNode->ClockEntries[Index].ClockId = SwapBytes32 (ClockIds[2 * Index + 1]);
     ASSERT (ClockNode->ClockEntries[Index].ClockId <= MAX_UINT16);
-    ClockNode->ClockEntries[Index].ClockId   = ClockNode->ClockEntries[Index].ClockId | (BpmpPhandle << 16);
+    ClockNode->ClockEntries[Index].ClockId   = ClockNode->ClockEntries[Index].ClockId | (BpmpPhandle << NVIDIA_CLOCK_BPMP_PHANDLE_SHIFT);
     ClockNode->ClockEntries[Index].ClockName = NULL;
     ClockNode->ClockEntries[Index].Parent    = FALSE;
     if (ClockNames != NULL) {
@@ -1262,31 +1525,26 @@ GetStatePgNodes (
 }
 
 /**
-  This function allows for deassert of specified power gate nodes.
+  This function increases the active vote count of a power gate.
 
   @param[in]     This                The instance of the NVIDIA_POWER_GATE_NODE_PROTOCOL.
-  @param[in]     PgId                Id to de-assert
+  @param[in]     PgId                Id to vote for
 
-  @return EFI_SUCCESS                power gate deasserted.
-  @return EFI_NOT_READY              BPMP-IPC protocol is not installed.
-  @return EFI_DEVICE_ERROR           Failed to deassert powergate
+  @return EFI_SUCCESS                Vote added.
+  @return EFI_DEVICE_ERROR           Failed to track the vote
 **/
+STATIC
 EFI_STATUS
-DeassertPgNodes (
+AddPgVote (
   IN  NVIDIA_POWER_GATE_NODE_PROTOCOL  *This,
   IN  UINT32                           PgId
   )
 {
-  NVIDIA_BPMP_IPC_PROTOCOL      *BpmpIpcProtocol = NULL;
-  EFI_STATUS                    Status;
-  MRQ_PG_COMMAND_PACKET         Request;
-  UINT32                        PowerGateState;
   VOID                          *Hob;
   TEGRA_PLATFORM_RESOURCE_INFO  *PlatformResourceInfo;
   UINT32                        Count;
 
-  PowerGateState = 0;
-  Count          = 0;
+  Count = 0;
 
   // Increase the PG active vote count for the resource.
   Hob = GetFirstGuidHob (&gNVIDIAPlatformResourceDataGuid);
@@ -1320,12 +1578,38 @@ DeassertPgNodes (
 
   PlatformResourceInfo->BpmpPgVotesTracker.BpmpPgVotes[Count].Votes++;
 
-  Status = gBS->LocateProtocol (&gNVIDIABpmpIpcProtocolGuid, NULL, (VOID **)&BpmpIpcProtocol);
-  if (EFI_ERROR (Status)) {
-    return EFI_NOT_READY;
-  }
+  return EFI_SUCCESS;
+}
 
-  Status = GetStatePgNodes (This, PgId, &PowerGateState);
+/**
+  This function powers on a power gate if it is off.
+
+  @param[in]     BpmpIpcProtocol     The instance of the NVIDIA_BPMP_IPC_PROTOCOL.
+  @param[in]     This                The instance of the NVIDIA_POWER_GATE_NODE_PROTOCOL.
+  @param[in]     PgId                Id to power on
+
+  @return EFI_SUCCESS                power gate deasserted.
+  @return EFI_DEVICE_ERROR           Failed to deassert powergate
+**/
+STATIC
+EFI_STATUS
+BpmpPowerOnPg (
+  IN  NVIDIA_BPMP_IPC_PROTOCOL         *BpmpIpcProtocol,
+  IN  NVIDIA_POWER_GATE_NODE_PROTOCOL  *This,
+  IN  UINT32                           PgId
+  )
+{
+  EFI_STATUS             Status;
+  MRQ_PG_COMMAND_PACKET  Request;
+  UINT32                 PowerGateState;
+
+  PowerGateState = 0;
+
+  Request.Command  = CmdPgGetState;
+  Request.PgId     = PgId;
+  Request.Argument = MAX_UINT32;
+
+  Status = BpmpProcessPgCommand (BpmpIpcProtocol, This->BpmpPhandle, &Request, &PowerGateState, sizeof (PowerGateState));
   if (EFI_ERROR (Status)) {
     return EFI_DEVICE_ERROR;
   }
@@ -1341,6 +1625,188 @@ DeassertPgNodes (
   return EFI_SUCCESS;
 }
 
+/**
+  This function allows for deassert of specified power gate nodes.
+
+  @param[in]     This                The instance of the NVIDIA_POWER_GATE_NODE_PROTOCOL.
+  @param[in]     PgId                Id to de-assert
+
+  @return EFI_SUCCESS                power gate deasserted.
+  @return EFI_NOT_READY              BPMP-IPC protocol is not installed.
+  @return EFI_DEVICE_ERROR           Failed to deassert powergate
+**/
+EFI_STATUS
+DeassertPgNodes (
+  IN  NVIDIA_POWER_GATE_NODE_PROTOCOL  *This,
+  IN  UINT32                           PgId
+  )
+{
+  NVIDIA_BPMP_IPC_PROTOCOL  *BpmpIpcProtocol = NULL;
+  EFI_STATUS                Status;
+
+  Status = AddPgVote (This, PgId);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->LocateProtocol (&gNVIDIABpmpIpcProtocolGuid, NULL, (VOID **)&BpmpIpcProtocol);
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_READY;
+  }
+
+  return BpmpPowerOnPg (BpmpIpcProtocol, This, PgId);
+}
+
+/**
+  This function allows for deassert of all power gate nodes.
+
+  The state of all power gates is read in one BPMP batch and the ones that
+  are off are then powered on in a second batch.
+
+  @param[in]     This                The instance of the NVIDIA_POWER_GATE_NODE_PROTOCOL.
+
+  @return EFI_SUCCESS                All power gates deasserted.
+  @return EFI_NOT_READY              BPMP-IPC protocol is not installed.
+  @return EFI_DEVICE_ERROR           Failed to deassert all powergates
+**/
+EFI_STATUS
+DeassertAllPgNodes (
+  IN  NVIDIA_POWER_GATE_NODE_PROTOCOL  *This
+  )
+{
+  NVIDIA_BPMP_IPC_PROTOCOL  *BpmpIpcProtocol = NULL;
+  EFI_STATUS                Status;
+  BPMP_BATCH_REQUEST        *Requests;
+  MRQ_PG_COMMAND_PACKET     *Packets;
+  UINT32                    *PowerGateStates;
+  UINTN                     Index;
+  UINTN                     Count;
+  UINTN                     SetCount;
+  UINTN                     Previous;
+
+  for (Index = 0; Index < This->NumberOfPowerGates; Index++) {
+    Status = AddPgVote (This, This->PowerGateId[Index]);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  if (This->NumberOfPowerGates == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Status = gBS->LocateProtocol (&gNVIDIABpmpIpcProtocolGuid, NULL, (VOID **)&BpmpIpcProtocol);
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_READY;
+  }
+
+  Requests = (BPMP_BATCH_REQUEST *)AllocateZeroPool (
+                                     This->NumberOfPowerGates *
+                                     (sizeof (BPMP_BATCH_REQUEST) + sizeof (MRQ_PG_COMMAND_PACKET) + sizeof (UINT32))
+                                     );
+  if (Requests == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Fallback;
+  }
+
+  Packets         = (MRQ_PG_COMMAND_PACKET *)&Requests[This->NumberOfPowerGates];
+  PowerGateStates = (UINT32 *)&Packets[This->NumberOfPowerGates];
+
+  Count = 0;
+  for (Index = 0; Index < This->NumberOfPowerGates; Index++) {
+    if (This->PowerGateId[Index] == MAX_UINT32) {
+      continue;
+    }
+
+    Packets[Count].Command         = CmdPgGetState;
+    Packets[Count].PgId            = This->PowerGateId[Index];
+    Packets[Count].Argument        = MAX_UINT32;
+    Requests[Count].MessageRequest = MRQ_PG;
+    Requests[Count].TxData         = &Packets[Count];
+    Requests[Count].TxDataSize     = sizeof (MRQ_PG_COMMAND_PACKET);
+    Requests[Count].RxData         = &PowerGateStates[Count];
+    Requests[Count].RxDataSize     = sizeof (UINT32);
+    Count++;
+  }
+
+  Status = BpmpCommunicateBatch (BpmpIpcProtocol, This->BpmpPhandle, Requests, Count);
+  if (EFI_ERROR (Status)) {
+    goto Fallback;
+  }
+
+  //
+  // Reuse the entries in place for the power on requests
+  //
+  SetCount = 0;
+  for (Index = 0; Index < Count; Index++) {
+    if (Requests[Index].Status == EFI_UNSUPPORTED) {
+      PowerGateStates[Index] = CmdPgStateOff;
+    } else if (EFI_ERROR (Requests[Index].Status)) {
+      DEBUG ((DEBUG_ERROR, "%a: failed to get state of Pg %x: %r\r\n", __FUNCTION__, Packets[Index].PgId, Requests[Index].Status));
+      Status = EFI_DEVICE_ERROR;
+      goto Exit;
+    }
+
+    if (PowerGateStates[Index] != CmdPgStateOff) {
+      continue;
+    }
+
+    for (Previous = 0; Previous < SetCount; Previous++) {
+      if (Packets[Previous].PgId == Packets[Index].PgId) {
+        break;
+      }
+    }
+
+    if (Previous < SetCount) {
+      continue;
+    }
+
+    Packets[SetCount].PgId            = Packets[Index].PgId;
+    Packets[SetCount].Command         = CmdPgSetState;
+    Packets[SetCount].Argument        = CmdPgStateOn;
+    Requests[SetCount].MessageRequest = MRQ_PG;
+    Requests[SetCount].TxData         = &Packets[SetCount];
+    Requests[SetCount].TxDataSize     = sizeof (MRQ_PG_COMMAND_PACKET);
+    Requests[SetCount].RxData         = NULL;
+    Requests[SetCount].RxDataSize     = 0;
+    SetCount++;
+  }
+
+  Status = BpmpCommunicateBatch (BpmpIpcProtocol, This->BpmpPhandle, Requests, SetCount);
+  if (EFI_ERROR (Status)) {
+    for (Index = 0; Index < SetCount; Index++) {
+      Requests[Index].Status = BpmpProcessPgCommand (BpmpIpcProtocol, This->BpmpPhandle, &Packets[Index], NULL, 0);
+    }
+
+    Status = EFI_SUCCESS;
+  }
+
+  for (Index = 0; Index < SetCount; Index++) {
+    if (EFI_ERROR (Requests[Index].Status) && (Requests[Index].Status != EFI_UNSUPPORTED)) {
+      DEBUG ((DEBUG_ERROR, "%a: failed to deassert Pg %x: %r\r\n", __FUNCTION__, Packets[Index].PgId, Requests[Index].Status));
+      Status = EFI_DEVICE_ERROR;
+    }
+  }
+
+Exit:
+  FreePool (Requests);
+  return Status;
+
+Fallback:
+  if (Requests != NULL) {
+    FreePool (Requests);
+  }
+
+  for (Index = 0; Index < This->NumberOfPowerGates; Index++) {
+    Status = BpmpPowerOnPg (BpmpIpcProtocol, This, This->PowerGateId[Index]);
+    if (EFI_ERROR (Status)) {
+      return EFI_DEVICE_ERROR;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   This function allows for assert of specified power gate nodes.
 
@@ -1597,9 +2063,10 @@ GetPowerGateNodeProtocol (
     return;
   }
 
-  PgNode->Deassert = DeassertPgNodes;
-  PgNode->Assert   = AssertPgNodes;
-  PgNode->GetState = GetStatePgNodes;
+  PgNode->Deassert    = DeassertPgNodes;
+  PgNode->Assert      = AssertPgNodes;
+  PgNode->GetState    = GetStatePgNodes;
+  PgNode->DeassertAll = DeassertAllPgNodes;
   if (NumberOfPgs > 0) {
     if (gBS->LocateProtocol (&gNVIDIADummyBpmpIpcProtocolGuid, NULL, &Protocol) == EFI_SUCCESS) {
       DEBUG ((DEBUG_ERROR, "%a, Dummy BPMP-IPC protocol installed, ignoring Power Gates\r\n", __func__));
@@ -2,7 +2,7 @@
 
   Device discovery library private data structures
 
-  Copyright (c) 2018-2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  Copyright (c) 2018-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -40,6 +40,13 @@ typedef enum {
   CmdResetMax,
 } MRQ_RESET_COMMANDS;
 
+typedef enum {
+  CmdClkIsEnabled = 6,
+} MRQ_CLK_COMMANDS;
+
+#define BPMP_BATCH_STALL_US    10
+#define BPMP_BATCH_TIMEOUT_US  100000 // Wait for queued requests of a batch
+
 typedef enum {
   CmdPgQueryAbi = 0,
   CmdPgSetState = 1,
@@ -71,6 +78,13 @@ typedef enum {
 } MRQ_C2C_COMMANDS;
 
 #pragma pack (1)
+typedef struct {
+  UINT32    ClockId : 24;
+  UINT32    Command : 8;
+  UINT32    ParentId;
+  UINT64    Rate;
+} MRQ_CLK_COMMAND_PACKET;
+
 typedef struct {
   UINT32    Command;
   UINT32    PgId;
@@ -90,4 +104,16 @@ typedef struct {
 } MRQ_C2C_COMMAND_PACKET;
 #pragma pack ()
 
+//
+// One request of a batch sent by BpmpCommunicateBatch
+//
+typedef struct {
+  UINT32        MessageRequest;
+  VOID          *TxData;
+  UINTN         TxDataSize;
+  VOID          *RxData;
+  UINTN         RxDataSize;
+  EFI_STATUS    Status;
+} BPMP_BATCH_REQUEST;
+
 #endif
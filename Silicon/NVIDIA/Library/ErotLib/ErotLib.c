@@ -2,7 +2,7 @@
 
   Erot library
 
-  SPDX-FileCopyrightText: Copyright (c) 2022-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2022-2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -10,18 +10,26 @@
 
 #include <Uefi/UefiBaseType.h>
 #include <Uefi/UefiSpec.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/ErotLib.h>
 #include <Library/MctpNvVdmLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/PldmBaseLib.h>
+#include <Library/TimerLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Protocol/MctpProtocol.h>
 #include <Library/TegraPlatformInfoLib.h>
 
+#define EROT_NO_STALE_MSG_TAG  MAX_UINT8
+
 STATIC BOOLEAN               mErotLibInitialized = FALSE;
 STATIC UINTN                 mNumErots           = 0;
 STATIC NVIDIA_MCTP_PROTOCOL  **mErots            = NULL;
 
+// per-erot tag of a fan-out request whose response may still arrive
+STATIC UINT8  *mErotStaleMsgTag = NULL;
+
 /**
   Locate MCTP protocol interfaces for erots.
 
@@ -71,6 +79,15 @@ ErotLocateProtocols (
     goto Done;
   }
 
+  mErotStaleMsgTag = (UINT8 *)AllocateRuntimePool (NumHandles);
+  if (mErotStaleMsgTag == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    DEBUG ((DEBUG_ERROR, "%a: mErotStaleMsgTag allocate failed\n", __FUNCTION__));
+    goto Done;
+  }
+
+  SetMem (mErotStaleMsgTag, NumHandles, EROT_NO_STALE_MSG_TAG);
+
   mNumErots = 0;
   for (Index = 0; Index < NumHandles; Index++) {
     Status = gBS->HandleProtocol (
@@ -123,6 +140,11 @@ Done:
       mErots = NULL;
     }
 
+    if (mErotStaleMsgTag != NULL) {
+      FreePool (mErotStaleMsgTag);
+      mErotStaleMsgTag = NULL;
+    }
+
     mNumErots = 0;
   }
 
@@ -175,6 +197,244 @@ ErotGetMctpProtocolBySocket (
   return NULL;
 }
 
+/**
+  Get free-running millisecond counter.
+
+  @retval UINT64          Counter value.
+
+**/
+STATIC
+UINT64
+EFIAPI
+ErotMsCounter (
+  VOID
+  )
+{
+  return DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter ()), 1000 * 1000);
+}
+
+/**
+  Check if a received message is the late response to a timed out fan-out
+  request and clear the erot's stale tag if so.
+
+  @param[in]  Protocol        MCTP protocol of the erot.
+  @param[in]  MsgTag          Tag of the received message.
+
+  @retval BOOLEAN         TRUE if message should be discarded.
+
+**/
+STATIC
+BOOLEAN
+EFIAPI
+ErotIsStaleResponse (
+  IN  NVIDIA_MCTP_PROTOCOL  *Protocol,
+  IN  UINT8                 MsgTag
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < mNumErots; Index++) {
+    if (mErots[Index] == Protocol) {
+      if (mErotStaleMsgTag[Index] == MsgTag) {
+        mErotStaleMsgTag[Index] = EROT_NO_STALE_MSG_TAG;
+        return TRUE;
+      }
+
+      break;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Discard messages already queued by an erot that still owes the response
+  to a timed out fan-out request, so they are not taken as the response to
+  a new request.
+
+  @param[in]  Entry           Fan-out entry of the erot.
+
+  @retval None
+
+**/
+STATIC
+VOID
+EFIAPI
+ErotDrainStaleResponses (
+  IN  EROT_FANOUT_ENTRY  *Entry
+  )
+{
+  NVIDIA_MCTP_PROTOCOL  *Protocol;
+  EFI_STATUS            Status;
+  UINTN                 Index;
+  UINTN                 Length;
+  UINT8                 MsgTag;
+
+  Protocol = Entry->Protocol;
+  for (Index = 0; Index < mNumErots; Index++) {
+    if (mErots[Index] == Protocol) {
+      break;
+    }
+  }
+
+  if ((Index == mNumErots) || (mErotStaleMsgTag[Index] == EROT_NO_STALE_MSG_TAG)) {
+    return;
+  }
+
+  do {
+    Length = Entry->ResponseBufferLength;
+    Status = Protocol->Recv (Protocol, 0, Entry->ResponseBuffer, &Length, &MsgTag);
+    if (!EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_INFO, "%a: discarded msg tag=%u len=%u\n", __FUNCTION__, MsgTag, Length));
+      ErotIsStaleResponse (Protocol, MsgTag);
+    }
+  } while (!EFI_ERROR (Status));
+}
+
+EFI_STATUS
+EFIAPI
+ErotDoRequestFanOut (
+  IN     VOID               *Request,
+  IN     UINTN              RequestLength,
+  IN OUT EROT_FANOUT_ENTRY  *Entries,
+  IN     UINTN              NumEntries,
+  IN     UINTN              TimeoutMs
+  )
+{
+  EROT_FANOUT_ENTRY       *Entry;
+  NVIDIA_MCTP_PROTOCOL    *Protocol;
+  MCTP_DEVICE_ATTRIBUTES  Attributes;
+  EFI_STATUS              Status;
+  UINTN                   Index;
+  UINTN                   ErotIndex;
+  UINTN                   NumPending;
+  UINT64                  EndMs;
+  UINT8                   RecvMsgTag;
+  BOOLEAN                 Error;
+
+  if ((Request == NULL) || (Entries == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // issue all requests before waiting for any response
+  NumPending = 0;
+  for (Index = 0; Index < NumEntries; Index++) {
+    Entry                 = &Entries[Index];
+    Protocol              = Entry->Protocol;
+    Entry->ResponseLength = 0;
+    Entry->Pending        = FALSE;
+
+    ErotDrainStaleResponses (Entry);
+
+    Entry->Status = Protocol->Send (Protocol, TRUE, Request, RequestLength, &Entry->MsgTag);
+    if (EFI_ERROR (Entry->Status)) {
+      Status = Protocol->GetDeviceAttributes (Protocol, &Attributes);
+      ASSERT_EFI_ERROR (Status);
+      DEBUG ((DEBUG_ERROR, "%a: send to %s failed: %r\n", __FUNCTION__, Attributes.DeviceName, Entry->Status));
+      continue;
+    }
+
+    Entry->Pending = TRUE;
+    NumPending++;
+  }
+
+  // gather responses in whatever order the erots complete
+  EndMs = ErotMsCounter () + TimeoutMs;
+  while (NumPending > 0) {
+    for (Index = 0; Index < NumEntries; Index++) {
+      Entry = &Entries[Index];
+      if (!Entry->Pending) {
+        continue;
+      }
+
+      Protocol              = Entry->Protocol;
+      Entry->ResponseLength = Entry->ResponseBufferLength;
+      Entry->Status         = Protocol->Recv (
+                                          Protocol,
+                                          0,
+                                          Entry->ResponseBuffer,
+                                          &Entry->ResponseLength,
+                                          &RecvMsgTag
+                                          );
+      if (Entry->Status == EFI_TIMEOUT) {
+        continue;
+      }
+
+      if (!EFI_ERROR (Entry->Status) &&
+          (RecvMsgTag != Entry->MsgTag) &&
+          ErotIsStaleResponse (Protocol, RecvMsgTag))
+      {
+        DEBUG ((DEBUG_INFO, "%a: discarded late response tag=%u\n", __FUNCTION__, RecvMsgTag));
+        continue;
+      }
+
+      Entry->Pending = FALSE;
+      NumPending--;
+
+      Status = Protocol->GetDeviceAttributes (Protocol, &Attributes);
+      ASSERT_EFI_ERROR (Status);
+
+      if (EFI_ERROR (Entry->Status)) {
+        DEBUG ((DEBUG_ERROR, "%a: recv from %s failed: %r\n", __FUNCTION__, Attributes.DeviceName, Entry->Status));
+        continue;
+      }
+
+      if (((CONST MCTP_CONTROL_COMMON *)Request)->Type == MCTP_TYPE_PLDM) {
+        Entry->Status = PldmValidateResponse (
+                          Request,
+                          Entry->ResponseBuffer,
+                          Entry->ResponseLength,
+                          Entry->MsgTag,
+                          RecvMsgTag,
+                          Attributes.DeviceName
+                          );
+      } else {
+        Entry->Status = MctpValidateResponse (
+                          Request,
+                          Entry->ResponseBuffer,
+                          Entry->MsgTag,
+                          RecvMsgTag,
+                          Attributes.DeviceName
+                          );
+      }
+    }
+
+    if ((NumPending > 0) && (ErotMsCounter () >= EndMs)) {
+      break;
+    }
+  }
+
+  Error = FALSE;
+  for (Index = 0; Index < NumEntries; Index++) {
+    Entry = &Entries[Index];
+    if (Entry->Pending) {
+      Status = Entry->Protocol->GetDeviceAttributes (Entry->Protocol, &Attributes);
+      ASSERT_EFI_ERROR (Status);
+      DEBUG ((DEBUG_ERROR, "%a: %s timed out after %ums\n", __FUNCTION__, Attributes.DeviceName, TimeoutMs));
+
+      // a late response is discarded by the next request to this erot
+      for (ErotIndex = 0; ErotIndex < mNumErots; ErotIndex++) {
+        if (mErots[ErotIndex] == Entry->Protocol) {
+          mErotStaleMsgTag[ErotIndex] = Entry->MsgTag;
+        }
+      }
+
+      Entry->Status  = EFI_TIMEOUT;
+      Entry->Pending = FALSE;
+    }
+
+    if (EFI_ERROR (Entry->Status)) {
+      Error = TRUE;
+    }
+  }
+
+  if (Error) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
 EFI_STATUS
 EFIAPI
 ErotSendRequestToAll (
@@ -185,10 +445,12 @@ ErotSendRequestToAll (
   IN  EROT_RESPONSE_CHECK  ResponseCheck
   )
 {
-  NVIDIA_MCTP_PROTOCOL    *Protocol;
+  EROT_FANOUT_ENTRY       *Entries;
+  EROT_FANOUT_ENTRY       *Entry;
   MCTP_DEVICE_ATTRIBUTES  Attributes;
+  UINT8                   *Responses;
   EFI_STATUS              Status;
-  UINTN                   ResponseLength;
+  UINTN                   NumErots;
   UINTN                   Index;
   BOOLEAN                 Error;
 
@@ -197,36 +459,53 @@ ErotSendRequestToAll (
     return Status;
   }
 
-  Error = FALSE;
-  for (Index = 0; Index < ErotGetNumErots (); Index++) {
-    Protocol = ErotGetMctpProtocolByIndex (Index);
-    Status   = Protocol->GetDeviceAttributes (Protocol, &Attributes);
-    ASSERT_EFI_ERROR (Status);
+  NumErots = ErotGetNumErots ();
+  if (NumErots == 0) {
+    return EFI_SUCCESS;
+  }
 
-    DEBUG ((DEBUG_INFO, "%a: sending req to %s\n", __FUNCTION__, Attributes.DeviceName));
+  Entries = (EROT_FANOUT_ENTRY *)AllocateZeroPool (NumErots * sizeof (*Entries));
+  if (Entries == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
 
-    Protocol->DoRequest (
-                Protocol,
-                Request,
-                RequestLength,
-                ResponseBuffer,
-                ResponseBufferLength,
-                &ResponseLength
-                );
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a: req to %s failed: %r\n", __FUNCTION__, Attributes.DeviceName, Status));
-      Error = TRUE;
+  // last erot's response goes directly into caller's buffer, +1 keeps the
+  // allocation non-empty with a single erot
+  Responses = (UINT8 *)AllocatePool ((NumErots - 1) * ResponseBufferLength + 1);
+  if (Responses == NULL) {
+    FreePool (Entries);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < NumErots; Index++) {
+    Entry                       = &Entries[Index];
+    Entry->Protocol             = ErotGetMctpProtocolByIndex (Index);
+    Entry->ResponseBuffer       = (Index == NumErots - 1) ? ResponseBuffer : &Responses[Index * ResponseBufferLength];
+    Entry->ResponseBufferLength = ResponseBufferLength;
+  }
+
+  DEBUG ((DEBUG_INFO, "%a: sending req to %u erots\n", __FUNCTION__, NumErots));
+
+  Status = ErotDoRequestFanOut (Request, RequestLength, Entries, NumErots, EROT_FANOUT_TIMEOUT_MS);
+
+  Error = EFI_ERROR (Status);
+  for (Index = 0; Index < NumErots; Index++) {
+    Entry = &Entries[Index];
+    if (EFI_ERROR (Entry->Status)) {
       continue;
     }
 
-    Status = ResponseCheck (Protocol, Request, RequestLength, ResponseBuffer, ResponseLength);
+    Status = ResponseCheck (Entry->Protocol, Request, RequestLength, Entry->ResponseBuffer, Entry->ResponseLength);
     if (EFI_ERROR (Status)) {
+      Entry->Protocol->GetDeviceAttributes (Entry->Protocol, &Attributes);
       DEBUG ((DEBUG_ERROR, "%a: req to %s failed rsp: %r\n", __FUNCTION__, Attributes.DeviceName, Status));
       Error = TRUE;
-      continue;
     }
   }
 
+  FreePool (Responses);
+  FreePool (Entries);
+
   if (Error) {
     return EFI_DEVICE_ERROR;
   }
@@ -234,22 +513,92 @@ ErotSendRequestToAll (
   return EFI_SUCCESS;
 }
 
+/**
+  Check boot complete response from erot.
+
+  @param[in]  Rsp                  Pointer to response.
+  @param[in]  ResponseLength       Length of response.
+  @param[in]  DeviceName           Name of erot.
+
+  @retval EFI_SUCCESS     Response is valid.
+  @retval Others          Failure occurred.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+ErotBootCompleteCheckRsp (
+  IN CONST MCTP_NV_BOOT_COMPLETE_RESPONSE  *Rsp,
+  IN UINTN                                 ResponseLength,
+  IN CONST CHAR16                          *DeviceName
+  )
+{
+  if (ResponseLength != sizeof (*Rsp)) {
+    DEBUG ((
+      DEBUG_ERROR,
+      "%a: %s bad resp length: %u!=%u\n",
+      __FUNCTION__,
+      DeviceName,
+      ResponseLength,
+      sizeof (*Rsp)
+      ));
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (Rsp->CompletionCode != MCTP_SUCCESS) {
+    DEBUG ((
+      DEBUG_ERROR,
+      "%a: %s failed: 0x%x\n",
+      __FUNCTION__,
+      DeviceName,
+      Rsp->CompletionCode
+      ));
+    return EFI_DEVICE_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
 EFI_STATUS
 EFIAPI
 ErotSendBootComplete (
   IN UINTN  Socket,
   IN UINTN  BootSlot
   )
+{
+  return ErotSendBootCompleteAll ((UINT32)(1UL << Socket), BootSlot);
+}
+
+EFI_STATUS
+EFIAPI
+ErotSendBootCompleteAll (
+  IN UINT32  SocketMask,
+  IN UINTN   BootSlot
+  )
 {
   EFI_STATUS                      Status;
   MCTP_NV_BOOT_COMPLETE_REQUEST   Req;
-  MCTP_NV_BOOT_COMPLETE_RESPONSE  Rsp;
+  MCTP_NV_BOOT_COMPLETE_RESPONSE  *Rsp;
   MCTP_DEVICE_ATTRIBUTES          Attributes;
+  EROT_FANOUT_ENTRY               *Entries;
+  EROT_FANOUT_ENTRY               *Entry;
   NVIDIA_MCTP_PROTOCOL            *Protocol;
-  UINTN                           ResponseLength;
+  UINTN                           NumEntries;
+  UINTN                           Socket;
+  UINTN                           Index;
+  BOOLEAN                         Socket0Complete;
+  BOOLEAN                         Error;
   EFI_HANDLE                      Handle;
+  EFI_STATUS                      InstallStatus;
+
+  Entries         = NULL;
+  Rsp             = NULL;
+  Error           = FALSE;
+  Socket0Complete = FALSE;
+  Status          = EFI_SUCCESS;
 
   if (TegraGetPlatform () != TEGRA_PLATFORM_SILICON) {
+    Socket0Complete = TRUE;
     goto Done;
   }
 
@@ -260,67 +609,93 @@ ErotSendBootComplete (
       // For EROT-less system, go ahead to install eROT boot complete protocol to
       // satisfy FmpDxe dependency for SMBIOS type 45.
       //
+      Socket0Complete = TRUE;
+      Status          = EFI_SUCCESS;
       goto Done;
     }
 
     return Status;
   }
 
-  Protocol = ErotGetMctpProtocolBySocket (Socket);
-  if (Protocol == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a: no protocol for socket %u\n", __FUNCTION__, Socket));
-    return EFI_INVALID_PARAMETER;
+  Entries = (EROT_FANOUT_ENTRY *)AllocateZeroPool (ErotGetNumErots () * sizeof (*Entries));
+  Rsp     = (MCTP_NV_BOOT_COMPLETE_RESPONSE *)AllocateZeroPool (ErotGetNumErots () * sizeof (*Rsp));
+  if ((Entries == NULL) || (Rsp == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
   }
 
-  Status = Protocol->GetDeviceAttributes (Protocol, &Attributes);
-  ASSERT_EFI_ERROR (Status);
+  NumEntries = 0;
+  for (Socket = 0; (SocketMask >> Socket) != 0; Socket++) {
+    if ((SocketMask & (1UL << Socket)) == 0) {
+      continue;
+    }
 
-  MctpNvBootCompleteFillReq (&Req, BootSlot);
+    Protocol = ErotGetMctpProtocolBySocket (Socket);
+    if (Protocol == NULL) {
+      DEBUG ((DEBUG_ERROR, "%a: no protocol for socket %u\n", __FUNCTION__, Socket));
+      Error = TRUE;
+      continue;
+    }
 
-  Status = Protocol->DoRequest (Protocol, &Req, sizeof (Req), &Rsp, sizeof (Rsp), &ResponseLength);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a: %s request failed: %r\n", __FUNCTION__, Attributes.DeviceName, Status));
-    return Status;
+    Entry                       = &Entries[NumEntries];
+    Entry->Protocol             = Protocol;
+    Entry->ResponseBuffer       = &Rsp[NumEntries];
+    Entry->ResponseBufferLength = sizeof (*Rsp);
+    NumEntries++;
   }
 
-  if (ResponseLength != sizeof (Rsp)) {
-    DEBUG ((
-      DEBUG_ERROR,
-      "%a: %s bad resp length: %u!=%u\n",
-      __FUNCTION__,
-      Attributes.DeviceName,
-      ResponseLength,
-      sizeof (Rsp)
-      ));
-    return EFI_DEVICE_ERROR;
-  }
+  MctpNvBootCompleteFillReq (&Req, BootSlot);
 
-  if (Rsp.CompletionCode != MCTP_SUCCESS) {
-    DEBUG ((
-      DEBUG_ERROR,
-      "%a: %s failed: 0x%x\n",
-      __FUNCTION__,
-      Attributes.DeviceName,
-      Rsp.CompletionCode
-      ));
-    return EFI_DEVICE_ERROR;
+  ErotDoRequestFanOut (&Req, sizeof (Req), Entries, NumEntries, EROT_FANOUT_TIMEOUT_MS);
+
+  for (Index = 0; Index < NumEntries; Index++) {
+    Entry  = &Entries[Index];
+    Status = Entry->Protocol->GetDeviceAttributes (Entry->Protocol, &Attributes);
+    ASSERT_EFI_ERROR (Status);
+
+    if (EFI_ERROR (Entry->Status)) {
+      DEBUG ((DEBUG_ERROR, "%a: %s request failed: %r\n", __FUNCTION__, Attributes.DeviceName, Entry->Status));
+      Error = TRUE;
+      continue;
+    }
+
+    Status = ErotBootCompleteCheckRsp (Entry->ResponseBuffer, Entry->ResponseLength, Attributes.DeviceName);
+    if (EFI_ERROR (Status)) {
+      Error = TRUE;
+      continue;
+    }
+
+    DEBUG ((DEBUG_INFO, "%a: %s boot complete\n", __FUNCTION__, Attributes.DeviceName));
+    if (Attributes.Socket == 0) {
+      Socket0Complete = TRUE;
+    }
   }
 
+  Status = (Error) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+
 Done:
-  if (Socket == 0) {
-    Handle = NULL;
-    Status = gBS->InstallMultipleProtocolInterfaces (
-                    &Handle,
-                    &gNVIDIAErotBootCompleteProtocolGuid,
-                    NULL,
-                    NULL
-                    );
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a: install protocol failed: %r\n", __FUNCTION__, Status));
+  if ((SocketMask & BIT0) && Socket0Complete) {
+    Handle        = NULL;
+    InstallStatus = gBS->InstallMultipleProtocolInterfaces (
+                           &Handle,
+                           &gNVIDIAErotBootCompleteProtocolGuid,
+                           NULL,
+                           NULL
+                           );
+    if (EFI_ERROR (InstallStatus)) {
+      DEBUG ((DEBUG_ERROR, "%a: install protocol failed: %r\n", __FUNCTION__, InstallStatus));
     }
   }
 
-  return EFI_SUCCESS;
+  if (Entries != NULL) {
+    FreePool (Entries);
+  }
+
+  if (Rsp != NULL) {
+    FreePool (Rsp);
+  }
+
+  return Status;
 }
 
 EFI_STATUS
@@ -338,6 +713,11 @@ ErotLibDeinit (
     mErots = NULL;
   }
 
+  if (mErotStaleMsgTag != NULL) {
+    FreePool (mErotStaleMsgTag);
+    mErotStaleMsgTag = NULL;
+  }
+
   mNumErots           = 0;
   mErotLibInitialized = TRUE;
 
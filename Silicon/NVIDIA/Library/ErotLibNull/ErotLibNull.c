@@ -2,7 +2,7 @@
 
   Null Erot library
 
-  SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2022-2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -53,6 +53,19 @@ ErotSendRequestToAll (
   return EFI_UNSUPPORTED;
 }
 
+EFI_STATUS
+EFIAPI
+ErotDoRequestFanOut (
+  IN     VOID               *Request,
+  IN     UINTN              RequestLength,
+  IN OUT EROT_FANOUT_ENTRY  *Entries,
+  IN     UINTN              NumEntries,
+  IN     UINTN              TimeoutMs
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
 EFI_STATUS
 EFIAPI
 ErotSendBootComplete (
@@ -63,6 +76,16 @@ ErotSendBootComplete (
   return EFI_UNSUPPORTED;
 }
 
+EFI_STATUS
+EFIAPI
+ErotSendBootCompleteAll (
+  IN UINT32  SocketMask,
+  IN UINTN   BootSlot
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
 EFI_STATUS
 EFIAPI
 ErotLibDeinit (
@@ -2,7 +2,7 @@
 
   Erot Qspi library core routines
 
-  Copyright (c) 2022-2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  Copyright (c) 2022-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -51,9 +51,10 @@
 #define EROT_RX_MEM_START  0x0000
 #define EROT_TX_MEM_START  0x8000
 
-#define EROT_MEM_MAX_BYTES_PER_XFER     32
-#define EROT_MEM_BYTES_PER_SINGLE_READ  4
-#define EROT_MEM_BLOCK_SIZE             4
+// block commands encode the number of 4-byte blocks - 1 in their low 5 bits
+#define EROT_MEM_BLOCK_SIZE           4
+#define EROT_MEM_MAX_BLOCKS_PER_XFER  32
+#define EROT_MEM_MAX_BYTES_PER_XFER   (EROT_MEM_MAX_BLOCKS_PER_XFER * EROT_MEM_BLOCK_SIZE)
 
 // commands
 #define EROT_CMD_SREG_W8   0x09
@@ -61,13 +62,10 @@
 #define EROT_CMD_SREG_R8   0x0d
 #define EROT_CMD_SREG_R32  0x0f
 
-#define EROT_CMD_MEM_W8      0x21
-#define EROT_CMD_MEM_R8      0x25
 #define EROT_CMD_MEM_BLK_W1  0x80
 #define EROT_CMD_MEM_BLK_R1  0xA0
 
-#define EROT_CMD_BLK_RD_FIFO_FSR    0xE0
-#define EROT_CMD_RD_SNGL_FIFO8_FSR  0x68
+#define EROT_CMD_BLK_RD_FIFO_FSR  0xE0
 
 #define EROT_CMD_GET_POLL_ALL  0x2F
 
@@ -82,6 +80,10 @@
 #define EROT_SREG_BUSY_TIMEOUT_MS               100
 #define EROT_MEM_BUSY_TIMEOUT_MS                100
 
+// delay between status polls, doubled after each miss up to the max
+#define EROT_POLL_MIN_DELAY_US  1
+#define EROT_POLL_MAX_DELAY_US  64
+
 #define EROT_WAIT_CYCLES      0
 #define EROT_TAR_CYCLES       1
 #define EROT_TAR_WAIT_CYCLES  (EROT_WAIT_CYCLES + EROT_TAR_CYCLES)
@@ -189,12 +191,46 @@ ErotQspiGpioIsAsserted (
 }
 
 /**
-  Copy and reverse bytes between buffers.  Last byte in src buffer becomes
-  first byte in destination buffer.
+  Wait for erot interrupt gpio to be asserted or time out.  The gpio is
+  sampled with an exponentially increasing delay so the wait does not
+  saturate the gpio controller.
+
+  @param[in]  Private       Pointer to private structure for erot.
+  @param[in]  EndNs         ErotQspiNsCounter() value at which to time out.
 
-  @param[out] DstBuffer     Pointer to destination buffer.
-  @param[in]  SrcBuffer     Pointer to source buffer.
-  @param[in]  Bytes         Number of bytes to copy and reverse.
+  @retval BOOLEAN           TRUE if gpio is asserted.
+
+**/
+STATIC
+BOOLEAN
+EFIAPI
+ErotQspiWaitForGpio (
+  IN EROT_QSPI_PRIVATE_DATA  *Private,
+  IN UINT64                  EndNs
+  )
+{
+  UINTN  DelayUs;
+
+  DelayUs = EROT_POLL_MIN_DELAY_US;
+  while (!ErotQspiGpioIsAsserted (Private)) {
+    if (ErotQspiNsCounter () >= EndNs) {
+      return FALSE;
+    }
+
+    MicroSecondDelay (DelayUs);
+    DelayUs = MIN (DelayUs * 2, EROT_POLL_MAX_DELAY_US);
+  }
+
+  return TRUE;
+}
+
+/**
+  Reverse the bytes of each 4-byte block of a buffer in place.  Erot memory
+  is accessed in big-endian blocks, so the last byte of each block in the
+  buffer becomes the first byte of the block in erot memory.
+
+  @param[in out] Buffer     Pointer to buffer.
+  @param[in]     Bytes      Number of bytes to reverse, multiple of block size.
 
   @retval None
 
@@ -202,16 +238,20 @@ ErotQspiGpioIsAsserted (
 STATIC
 VOID
 EFIAPI
-ErotQSpiCopyAndReverseBuffer (
-  OUT UINT8        *DstBuffer,
-  IN  CONST UINT8  *SrcBuffer,
-  IN  UINTN        Bytes
+ErotQspiReverseBlocks (
+  IN OUT UINT8  *Buffer,
+  IN     UINTN  Bytes
   )
 {
   UINTN  Index;
 
-  for (Index = 0; Index < Bytes; Index++) {
-    DstBuffer[Index] = SrcBuffer[Bytes - Index - 1];
+  ASSERT ((Bytes % EROT_MEM_BLOCK_SIZE) == 0);
+
+  for (Index = 0; Index < Bytes; Index += EROT_MEM_BLOCK_SIZE) {
+    WriteUnaligned32 (
+      (UINT32 *)&Buffer[Index],
+      SwapBytes32 (ReadUnaligned32 ((CONST UINT32 *)&Buffer[Index]))
+      );
   }
 }
 
@@ -254,6 +294,7 @@ ErotQspiXfer (
   Packet.ChipSelect = Private->ChipSelect;
   Packet.Control    = QSPI_CONTROLLER_CONTROL_FAST_MODE;
 
+  Private->Xfers++;
   Status = Private->Qspi->PerformTransaction (Private->Qspi, &Packet);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "%a: %s Failed TxLen=%u, RxLen=%u: %r\n", __FUNCTION__, Private->Name, TxLength, RxLength, Status));
@@ -318,14 +359,19 @@ ErotQspiPollForStatus (
 {
   UINT32  Reg;
   UINT64  EndNs;
+  UINTN   DelayUs;
 
-  EndNs = ErotQspiNsCounter () + EROT_QSPI_MS_TO_NS (TimeoutMs);
+  EndNs   = ErotQspiNsCounter () + EROT_QSPI_MS_TO_NS (TimeoutMs);
+  DelayUs = EROT_POLL_MIN_DELAY_US;
 
   while (((Reg = ErotQspiGetPollAll (Private)) & StatusBitMask) == PollWhile) {
     if (ErotQspiNsCounter () >= EndNs) {
       DEBUG ((DEBUG_ERROR, "%a: Timeout Reg=0x%x mask=0x%x while=0x%x\n", __FUNCTION__, Reg, StatusBitMask, PollWhile));
       return EFI_TIMEOUT;
     }
+
+    MicroSecondDelay (DelayUs);
+    DelayUs = MIN (DelayUs * 2, EROT_POLL_MAX_DELAY_US);
   }
 
   return EFI_SUCCESS;
@@ -682,8 +728,8 @@ ErotQspiPollHostMbox (
   EndNs  = ErotQspiNsCounter () + EROT_QSPI_MS_TO_NS (PollMs);
   Status = EFI_TIMEOUT;
   do {
-    if (!ErotQspiGpioIsAsserted (Private)) {
-      continue;
+    if (!ErotQspiWaitForGpio (Private, EndNs)) {
+      break;
     }
 
     MboxStatus = ErotQspiSregRead32 (Private, EROT_REG_HOST_MBOX, &Mbox);
@@ -815,7 +861,10 @@ ErotQspiDoWriteMemCommand (
 }
 
 /**
-  Write erot memory.
+  Write erot memory.  Data is sent with block commands of up to
+  EROT_MEM_MAX_BYTES_PER_XFER bytes.  A trailing partial block is padded
+  with zeros, as the erot only consumes the number of bytes posted to its
+  mailbox.
 
   @param[in]  Private       Pointer to private structure for erot.
   @param[in]  Offset        Offset in erot Rx buffer to write.
@@ -840,41 +889,31 @@ ErotQspiWriteMem (
   CONST UINT8             *Payload;
   UINT32                  XferBytes;
   UINT32                  XferOffset;
-  UINTN                   Index;
+  UINT32                  BlockBytes;
+  EFI_STATUS              Status;
 
   ErotQspiPrintBuffer (__FUNCTION__, Data, Bytes);
 
   Payload    = (CONST UINT8 *)Data;
   XferOffset = 0;
   while (Bytes > 0) {
-    XferBytes = (Bytes > EROT_MEM_MAX_BYTES_PER_XFER) ?
-                EROT_MEM_MAX_BYTES_PER_XFER : Bytes;
-    if (XferBytes >= EROT_MEM_BLOCK_SIZE) {
-      XferBytes &= ~(EROT_MEM_BLOCK_SIZE - 1);
-      Tx.Cmd     = EROT_CMD_MEM_BLK_W1 + (XferBytes / EROT_MEM_BLOCK_SIZE - 1);
-      MctpUint16ToBEBuffer (Tx.Addr, Offset + XferOffset);
-      for (Index = 0; Index < XferBytes; Index += EROT_MEM_BLOCK_SIZE) {
-        ErotQSpiCopyAndReverseBuffer (&Tx.Data[Index], &Payload[XferOffset + Index], EROT_MEM_BLOCK_SIZE);
-      }
-
-      DEBUG ((DEBUG_VERBOSE, "%a: writing %u bytes\n", __FUNCTION__, XferBytes));
-      ErotQspiDoWriteMemCommand (
-        Private,
-        OFFSET_OF (EROT_QSPI_WRITE_MEM_TX, Data) + XferBytes,
-        &Tx
-        );
-    } else {
-      for (Index = 0; Index < XferBytes; Index++) {
-        DEBUG ((DEBUG_VERBOSE, "%a: writing single byte\n", __FUNCTION__));
-        Tx.Cmd = EROT_CMD_MEM_W8;
-        MctpUint16ToBEBuffer (Tx.Addr, Offset + XferOffset + Index);
-        Tx.Data[0] = Payload[XferOffset + Index];
-        ErotQspiDoWriteMemCommand (
-          Private,
-          OFFSET_OF (EROT_QSPI_WRITE_MEM_TX, Data) + 1,
-          &Tx
-          );
-      }
+    XferBytes  = MIN (Bytes, EROT_MEM_MAX_BYTES_PER_XFER);
+    BlockBytes = ALIGN_VALUE (XferBytes, EROT_MEM_BLOCK_SIZE);
+
+    Tx.Cmd = EROT_CMD_MEM_BLK_W1 + (BlockBytes / EROT_MEM_BLOCK_SIZE - 1);
+    MctpUint16ToBEBuffer (Tx.Addr, Offset + XferOffset);
+    CopyMem (Tx.Data, &Payload[XferOffset], XferBytes);
+    ZeroMem (&Tx.Data[XferBytes], BlockBytes - XferBytes);
+    ErotQspiReverseBlocks (Tx.Data, BlockBytes);
+
+    DEBUG ((DEBUG_VERBOSE, "%a: writing %u bytes\n", __FUNCTION__, BlockBytes));
+    Status = ErotQspiDoWriteMemCommand (
+               Private,
+               OFFSET_OF (EROT_QSPI_WRITE_MEM_TX, Data) + BlockBytes,
+               &Tx
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
     }
 
     XferOffset += XferBytes;
@@ -885,11 +924,15 @@ ErotQspiWriteMem (
 }
 
 /**
-  Do erot read memory command.
+  Do erot read memory command.  The FIFO read returns a status word ahead of
+  the data, so the data is copied from the rx packet into Buffer.
 
   @param[in]  Private       Pointer to private structure for erot.
+  @param[in]  Cmd1          Memory read command.
+  @param[in]  Cmd2          FIFO read command.
+  @param[in]  Addr          Erot memory address to read.
   @param[in]  Bytes         Number of bytes to read from erot.
-  @param[in]  Buffer        Pointer to store data from erot.
+  @param[out] Buffer        Pointer to store data from erot.
 
   @retval EFI_SUCCESS       Operation completed normally.
   @retval Others            Failure occurred.
@@ -953,7 +996,10 @@ ErotQspiDoReadMemCommand (
 }
 
 /**
-  Read erot memory.
+  Read erot memory.  Data is read with block commands of up to
+  EROT_MEM_MAX_BYTES_PER_XFER bytes into the caller's buffer and reversed
+  in place.  A trailing partial block is read whole and only the requested
+  bytes are returned.
 
   @param[in]  Private       Pointer to private structure for erot.
   @param[in]  Offset        Offset in erot Tx buffer to read.
@@ -974,10 +1020,10 @@ ErotQspiReadMem (
   OUT VOID                   *Data
   )
 {
-  UINT8       Buffer[EROT_MEM_MAX_BYTES_PER_XFER];
+  UINT8       Block[EROT_MEM_BLOCK_SIZE];
   UINT32      XferOffset;
   UINT32      XferBytes;
-  UINTN       Index;
+  UINT32      Blocks;
   EFI_STATUS  Status;
   UINT8       *Payload;
   UINT32      BytesRequested;
@@ -985,51 +1031,47 @@ ErotQspiReadMem (
   BytesRequested = Bytes;
   Payload        = (UINT8 *)Data;
   XferOffset     = 0;
-  while (Bytes > 0) {
-    XferBytes = (Bytes > EROT_MEM_MAX_BYTES_PER_XFER) ?
-                EROT_MEM_MAX_BYTES_PER_XFER : Bytes;
-    if (XferBytes >= EROT_MEM_BLOCK_SIZE) {
-      XferBytes &= ~(EROT_MEM_BLOCK_SIZE - 1);
-
-      DEBUG ((DEBUG_VERBOSE, "%a: Reading %u bytes\n", __FUNCTION__, XferBytes));
-      Status = ErotQspiDoReadMemCommand (
-                 Private,
-                 EROT_CMD_MEM_BLK_R1 + ((XferBytes / EROT_MEM_BLOCK_SIZE) - 1),
-                 EROT_CMD_BLK_RD_FIFO_FSR + ((XferBytes / EROT_MEM_BLOCK_SIZE) - 1),
-                 Offset + XferOffset,
-                 XferBytes,
-                 Buffer
-                 );
-      if (EFI_ERROR (Status)) {
-        return Status;
-      }
-
-      for (Index = 0; Index < XferBytes; Index += EROT_MEM_BLOCK_SIZE) {
-        ErotQSpiCopyAndReverseBuffer (&Payload[XferOffset + Index], &Buffer[Index], EROT_MEM_BLOCK_SIZE);
-      }
-    } else {
-      for (Index = 0; Index < XferBytes; Index++) {
-        DEBUG ((DEBUG_VERBOSE, "%a: Reading single byte\n", __FUNCTION__));
-        Status = ErotQspiDoReadMemCommand (
-                   Private,
-                   EROT_CMD_MEM_R8,
-                   EROT_CMD_RD_SNGL_FIFO8_FSR,
-                   Offset + XferOffset + Index,
-                   EROT_MEM_BYTES_PER_SINGLE_READ,
-                   Buffer
-                   );
-        if (EFI_ERROR (Status)) {
-          return Status;
-        }
-
-        Payload[XferOffset + Index] = Buffer[EROT_MEM_BYTES_PER_SINGLE_READ - 1];
-      }
+  while (Bytes >= EROT_MEM_BLOCK_SIZE) {
+    XferBytes = MIN (Bytes, EROT_MEM_MAX_BYTES_PER_XFER) & ~(EROT_MEM_BLOCK_SIZE - 1);
+    Blocks    = XferBytes / EROT_MEM_BLOCK_SIZE;
+
+    DEBUG ((DEBUG_VERBOSE, "%a: Reading %u bytes\n", __FUNCTION__, XferBytes));
+    Status = ErotQspiDoReadMemCommand (
+               Private,
+               EROT_CMD_MEM_BLK_R1 + (Blocks - 1),
+               EROT_CMD_BLK_RD_FIFO_FSR + (Blocks - 1),
+               Offset + XferOffset,
+               XferBytes,
+               &Payload[XferOffset]
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
     }
 
+    ErotQspiReverseBlocks (&Payload[XferOffset], XferBytes);
+
     XferOffset += XferBytes;
     Bytes      -= XferBytes;
   }
 
+  if (Bytes > 0) {
+    DEBUG ((DEBUG_VERBOSE, "%a: Reading %u byte tail\n", __FUNCTION__, Bytes));
+    Status = ErotQspiDoReadMemCommand (
+               Private,
+               EROT_CMD_MEM_BLK_R1,
+               EROT_CMD_BLK_RD_FIFO_FSR,
+               Offset + XferOffset,
+               sizeof (Block),
+               Block
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    ErotQspiReverseBlocks (Block, sizeof (Block));
+    CopyMem (&Payload[XferOffset], Block, Bytes);
+  }
+
   ErotQspiPrintBuffer (__FUNCTION__, Data, BytesRequested);
 
   return EFI_SUCCESS;
@@ -1044,8 +1086,10 @@ ErotQspiSendPacket (
 {
   CONST EROT_QSPI_PACKET  *Packet;
   EFI_STATUS              Status;
+  UINT64                  StartNs;
 
-  Packet = &Private->Packet;
+  Packet  = &Private->Packet;
+  StartNs = ErotQspiNsCounter ();
 
   ErotQspiPrintBuffer ("SendPacket", Packet, Length);
 
@@ -1085,6 +1129,10 @@ ErotQspiSendPacket (
              EROT_HOST_MBOX_CMD_ACK,
              NULL
              );
+  if (!EFI_ERROR (Status)) {
+    Private->TxBytes += Length;
+    Private->TxNs    += ErotQspiNsCounter () - StartNs;
+  }
 
   return Status;
 }
@@ -1162,6 +1210,30 @@ ErotQspiSpbInit (
   return Status;
 }
 
+/**
+  Compute throughput in KB/s.
+
+  @param[in]  Bytes         Number of bytes transferred.
+  @param[in]  Ns            Number of ns spent transferring.
+
+  @retval UINT64            Throughput in KB/s.
+
+**/
+STATIC
+UINT64
+EFIAPI
+ErotQspiKBPerSec (
+  IN UINT64  Bytes,
+  IN UINT64  Ns
+  )
+{
+  if (Ns == 0) {
+    return 0;
+  }
+
+  return DivU64x64Remainder (MultU64x32 (Bytes, 1000000), Ns, NULL);
+}
+
 EFI_STATUS
 EFIAPI
 ErotQspiSpbDeinit (
@@ -1170,6 +1242,18 @@ ErotQspiSpbDeinit (
 {
   EFI_STATUS  Status;
 
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: %s tx %lu bytes %lu KB/s, rx %lu bytes %lu KB/s, %lu qspi xfers\n",
+    __FUNCTION__,
+    Private->Name,
+    Private->TxBytes,
+    ErotQspiKBPerSec (Private->TxBytes, Private->TxNs),
+    Private->RxBytes,
+    ErotQspiKBPerSec (Private->RxBytes, Private->RxNs),
+    Private->Xfers
+    ));
+
   Status = ErotQspiSpbReset (Private);
 
   return Status;
@@ -1225,8 +1309,10 @@ ErotQspiRecvPacket (
   EFI_STATUS        Status;
   UINT8             PacketLength;
   EROT_QSPI_PACKET  *Packet;
+  UINT64            StartNs;
 
-  Packet = &Private->Packet;
+  Packet  = &Private->Packet;
+  StartNs = ErotQspiNsCounter ();
 
   Status = ErotQspiWriteErotMbox (Private, EROT_MBOX_CMD_READY_TO_READ);
   if (EFI_ERROR (Status)) {
@@ -1270,6 +1356,9 @@ ErotQspiRecvPacket (
 
   *Length = PacketLength;
 
+  Private->RxBytes += PacketLength;
+  Private->RxNs    += ErotQspiNsCounter () - StartNs;
+
   ErotQspiPrintBuffer ("Resp", Packet, PacketLength);
 
   return EFI_SUCCESS;
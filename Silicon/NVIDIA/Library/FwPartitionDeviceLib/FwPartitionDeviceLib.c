@@ -22,6 +22,7 @@
 #include <Library/StandaloneMmOpteeDeviceMem.h>
 
 #define FW_PARTITION_PSEUDO_DEVICE_SIGNATURE  SIGNATURE_32 ('F','W','P','P')
+#define FW_PARTITION_NAME_INDEX_MIN_SIZE      16
 
 typedef struct {
   UINT32                      Signature;
@@ -37,6 +38,8 @@ STATIC UINT32                     mActiveBootChain            = MAX_UINT32;
 STATIC BOOLEAN                    mOverwriteActiveFwPartition = FALSE;
 STATIC UINTN                      mChipId                     = MAX_UINTN;
 STATIC UINT32                     mGptBootChain               = MAX_UINT32;
+STATIC UINT32                     *mNameIndex                 = NULL;
+STATIC UINTN                      mNameIndexSize              = 0;
 
 // non-A/B partition names
 STATIC CONST CHAR16  *NonABPartitionNames[] = {
@@ -84,6 +87,42 @@ NameIsInList (
   return FALSE;
 }
 
+/**
+  Add the next partition to the name index.  If a partition with the same
+  name is already indexed it is kept so lookups return the first one added.
+
+  @param[in]  PartitionIndex            Index of the partition in mPrivate
+
+  @retval None
+
+**/
+STATIC
+VOID
+EFIAPI
+FwPartitionNameIndexAdd (
+  IN  UINTN  PartitionIndex
+  )
+{
+  CONST CHAR16  *Name;
+  UINTN         Slot;
+
+  if (mNameIndex == NULL) {
+    return;
+  }
+
+  Name = mPrivate[PartitionIndex].PartitionInfo.Name;
+  Slot = GptPartitionNameHash (Name, FW_PARTITION_NAME_LENGTH) & (mNameIndexSize - 1);
+  while (mNameIndex[Slot] != 0) {
+    if (StrCmp (mPrivate[mNameIndex[Slot] - 1].PartitionInfo.Name, Name) == 0) {
+      return;
+    }
+
+    Slot = (Slot + 1) & (mNameIndexSize - 1);
+  }
+
+  mNameIndex[Slot] = (UINT32)(PartitionIndex + 1);
+}
+
 /**
   Check if partition is part of the active FW boot chain
 
@@ -360,6 +399,8 @@ FwPartitionWrite (
     Buffer
     ));
 
+  Private->WriteCount++;
+
   Status = DeviceInfo->DeviceWrite (
                          PartitionInfo->Name,
                          DeviceInfo,
@@ -652,7 +693,8 @@ FwDeviceAddAsPartition (
   Private       = &mPrivate[mNumFwPartitions];
   PartitionInfo = &Private->PartitionInfo;
 
-  Private->Signature = FW_PARTITION_PRIVATE_DATA_SIGNATURE;
+  Private->Signature  = FW_PARTITION_PRIVATE_DATA_SIGNATURE;
+  Private->WriteCount = 0;
 
   StrnCpyS (PartitionInfo->Name, FW_PARTITION_NAME_LENGTH, Name, StrLen (Name));
   PartitionInfo->Offset            = Offset;
@@ -667,6 +709,7 @@ FwDeviceAddAsPartition (
   Private->Protocol.Write         = FwPartitionWrite;
   Private->Protocol.GetAttributes = FwPartitionGetAttributes;
 
+  FwPartitionNameIndexAdd (mNumFwPartitions);
   mNumFwPartitions++;
 
   DEBUG ((
@@ -716,7 +759,8 @@ FwPartitionAdd (
   Private       = &mPrivate[mNumFwPartitions];
   PartitionInfo = &Private->PartitionInfo;
 
-  Private->Signature = FW_PARTITION_PRIVATE_DATA_SIGNATURE;
+  Private->Signature  = FW_PARTITION_PRIVATE_DATA_SIGNATURE;
+  Private->WriteCount = 0;
 
   StrnCpyS (PartitionInfo->Name, FW_PARTITION_NAME_LENGTH, Name, StrLen (Name));
   PartitionInfo->Offset            = Offset;
@@ -731,6 +775,7 @@ FwPartitionAdd (
   Private->Protocol.Write         = FwPartitionWrite;
   Private->Protocol.GetAttributes = FwPartitionGetAttributes;
 
+  FwPartitionNameIndexAdd (mNumFwPartitions);
   mNumFwPartitions++;
 
   DEBUG ((
@@ -1033,6 +1078,9 @@ FwPartitionAddressChangeHandler (
   }
 
   ConvertFunction ((VOID **)&mPrivate);
+  if (mNameIndex != NULL) {
+    ConvertFunction ((VOID **)&mNameIndex);
+  }
 }
 
 EFI_STATUS
@@ -1062,6 +1110,21 @@ FwPartitionFindByName (
 {
   FW_PARTITION_PRIVATE_DATA  *Private;
   UINTN                      Index;
+  UINTN                      Slot;
+
+  if (mNameIndex != NULL) {
+    Slot = GptPartitionNameHash (Name, FW_PARTITION_NAME_LENGTH) & (mNameIndexSize - 1);
+    while (mNameIndex[Slot] != 0) {
+      Private = &mPrivate[mNameIndex[Slot] - 1];
+      if (StrCmp (Private->PartitionInfo.Name, Name) == 0) {
+        return Private;
+      }
+
+      Slot = (Slot + 1) & (mNameIndexSize - 1);
+    }
+
+    return NULL;
+  }
 
   Private = mPrivate;
   for (Index = 0; Index < mNumFwPartitions; Index++, Private++) {
@@ -1091,6 +1154,15 @@ FwPartitionGetPrivateArray (
   return mPrivate;
 }
 
+UINTN
+EFIAPI
+FwPartitionGetNameIndexSize (
+  VOID
+  )
+{
+  return mNameIndexSize;
+}
+
 VOID
 EFIAPI
 FwPartitionDeviceLibDeinit (
@@ -1102,6 +1174,12 @@ FwPartitionDeviceLibDeinit (
     mPrivate = NULL;
   }
 
+  if (mNameIndex != NULL) {
+    FreePool (mNameIndex);
+    mNameIndex = NULL;
+  }
+
+  mNameIndexSize              = 0;
   mNumFwPartitions            = 0;
   mMaxFwPartitions            = 0;
   mActiveBootChain            = MAX_UINT32;
@@ -1137,5 +1215,17 @@ FwPartitionDeviceLibInit (
     return EFI_OUT_OF_RESOURCES;
   }
 
+  // name index is kept at most half full, lookups fall back to a scan without it
+  mNameIndexSize = FW_PARTITION_NAME_INDEX_MIN_SIZE;
+  while (mNameIndexSize < (2 * mMaxFwPartitions)) {
+    mNameIndexSize *= 2;
+  }
+
+  mNameIndex = (UINT32 *)AllocateRuntimeZeroPool (mNameIndexSize * sizeof (UINT32));
+  if (mNameIndex == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a: name index allocation failed, size=%u\n", __FUNCTION__, mNameIndexSize));
+    mNameIndexSize = 0;
+  }
+
   return EFI_SUCCESS;
 }
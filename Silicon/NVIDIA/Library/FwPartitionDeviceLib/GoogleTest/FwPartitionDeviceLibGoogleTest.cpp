@@ -0,0 +1,465 @@
+/** @file
+  Unit tests for the partition name index of FwPartitionDeviceLib.
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include <Library/GoogleTestLib.h>
+#include <string>
+#include <vector>
+
+extern "C" {
+  #include <Uefi.h>
+  #include <Library/BaseLib.h>
+  #include <Library/BaseMemoryLib.h>
+  #include <Library/FwPartitionDeviceLib.h>
+  #include <Library/GptLib.h>
+  #include <Library/MemoryAllocationLib.h>
+}
+
+using namespace testing;
+
+#define MAX_PARTITIONS  8
+
+#define GPT_NUM_ENTRIES       4096
+#define GPT_UNUSED_EVERY      7     // Every 7th entry is unused
+#define GPT_DUPLICATE_ENTRY   4095  // Last used entry, repeats the name of GPT_DUPLICATED
+#define GPT_DUPLICATED        1001
+#define GPT_FULL_NAME_ENTRY   4000  // Entry with a name filling the whole field
+#define GPT_FIRST_USABLE_LBA  34
+
+STATIC CONST CHAR16  mDeviceName[] = { 'T', 'e', 's', 't', 0 };
+
+STATIC FW_PARTITION_DEVICE_INFO  mDeviceInfo = {
+  mDeviceName,
+  NULL,
+  NULL,
+  NULL,
+  512,
+  4096
+};
+
+STATIC
+std::vector<CHAR16>
+ToChar16 (
+  const std::string  &Name
+  )
+{
+  std::vector<CHAR16>  Result (Name.begin (), Name.end ());
+
+  Result.push_back (0);
+  return Result;
+}
+
+STATIC
+UINTN
+NameSlot (
+  const std::string  &Name
+  )
+{
+  std::vector<CHAR16>  Name16 = ToChar16 (Name);
+
+  return GptPartitionNameHash (Name16.data (), FW_PARTITION_NAME_LENGTH) & (FwPartitionGetNameIndexSize () - 1);
+}
+
+/**
+  Generate names that all hash to the same index slot.
+
+  @param[in]  Slot              Index slot to collide in
+  @param[in]  Count             Number of names to generate
+
+  @retval Names
+**/
+STATIC
+std::vector<std::string>
+CollidingNames (
+  UINTN  Slot,
+  UINTN  Count
+  )
+{
+  std::vector<std::string>  Names;
+  std::string               Name;
+  UINTN                     Index;
+
+  for (Index = 0; Names.size () < Count; Index++) {
+    Name = "part-" + std::to_string (Index);
+    if (NameSlot (Name) == Slot) {
+      Names.push_back (Name);
+    }
+  }
+
+  return Names;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+class FwPartitionNameIndexTest : public Test {
+protected:
+  void
+  SetUp (
+    ) override
+  {
+    ASSERT_EQ (FwPartitionDeviceLibInit (0, MAX_PARTITIONS, FALSE, 0, 0), EFI_SUCCESS);
+  }
+
+  void
+  TearDown (
+    ) override
+  {
+    FwPartitionDeviceLibDeinit ();
+  }
+
+  EFI_STATUS
+  Add (
+    const std::string  &Name,
+    UINT64             Offset
+    )
+  {
+    std::vector<CHAR16>  Name16 = ToChar16 (Name);
+
+    return FwPartitionAdd (Name16.data (), &mDeviceInfo, Offset, SIZE_4KB);
+  }
+
+  FW_PARTITION_PRIVATE_DATA *
+  Find (
+    const std::string  &Name
+    )
+  {
+    std::vector<CHAR16>  Name16 = ToChar16 (Name);
+
+    return FwPartitionFindByName (Name16.data ());
+  }
+
+  void
+  ExpectFound (
+    const std::string  &Name,
+    UINT64             Offset
+    )
+  {
+    FW_PARTITION_PRIVATE_DATA  *Private;
+    std::vector<CHAR16>        Name16 = ToChar16 (Name);
+
+    Private = Find (Name);
+    ASSERT_NE (Private, nullptr) << Name;
+    EXPECT_EQ (StrCmp (Private->PartitionInfo.Name, Name16.data ()), 0) << Name;
+    EXPECT_EQ (Private->PartitionInfo.Offset, Offset) << Name;
+  }
+};
+
+TEST_F (FwPartitionNameIndexTest, EveryPartitionFound) {
+  FW_PARTITION_PRIVATE_DATA  *Private;
+  UINTN                      Index;
+
+  for (Index = 0; Index < MAX_PARTITIONS; Index++) {
+    ASSERT_EQ (Add ("A_part-" + std::to_string (Index), Index * SIZE_4KB), EFI_SUCCESS);
+  }
+
+  Private = FwPartitionGetPrivateArray ();
+  for (Index = 0; Index < MAX_PARTITIONS; Index++) {
+    ExpectFound ("A_part-" + std::to_string (Index), Index * SIZE_4KB);
+    EXPECT_EQ (Find ("A_part-" + std::to_string (Index)), &Private[Index]);
+  }
+}
+
+TEST_F (FwPartitionNameIndexTest, CollisionsProbeToNextSlot) {
+  std::vector<std::string>  Names;
+  UINTN                     Index;
+
+  // last slot so probing wraps around to the start of the index
+  Names = CollidingNames (FwPartitionGetNameIndexSize () - 1, 5);
+  for (Index = 0; Index < 4; Index++) {
+    ASSERT_EQ (Add (Names[Index], Index * SIZE_4KB), EFI_SUCCESS);
+  }
+
+  for (Index = 0; Index < 4; Index++) {
+    ExpectFound (Names[Index], Index * SIZE_4KB);
+  }
+
+  // a missing name in the same slot walks the whole chain and stops
+  EXPECT_EQ (Find (Names[4]), nullptr);
+}
+
+TEST_F (FwPartitionNameIndexTest, DuplicateKeepsFirst) {
+  ASSERT_EQ (Add ("A_part-0", 0), EFI_SUCCESS);
+  EXPECT_EQ (Add ("A_part-0", SIZE_4KB), EFI_ALREADY_STARTED);
+  EXPECT_EQ (FwPartitionGetCount (), 1U);
+  ExpectFound ("A_part-0", 0);
+}
+
+TEST_F (FwPartitionNameIndexTest, FullTable) {
+  std::vector<std::string>  Names;
+  UINTN                     Index;
+
+  // all partitions in one chain is the worst case for a full table
+  Names = CollidingNames (0, MAX_PARTITIONS + 2);
+  for (Index = 0; Index < MAX_PARTITIONS; Index++) {
+    ASSERT_EQ (Add (Names[Index], Index * SIZE_4KB), EFI_SUCCESS);
+  }
+
+  EXPECT_EQ (Add (Names[MAX_PARTITIONS], 0), EFI_OUT_OF_RESOURCES);
+  EXPECT_EQ (FwPartitionGetCount (), (UINTN)MAX_PARTITIONS);
+
+  for (Index = 0; Index < MAX_PARTITIONS; Index++) {
+    ExpectFound (Names[Index], Index * SIZE_4KB);
+  }
+
+  EXPECT_EQ (Find (Names[MAX_PARTITIONS]), nullptr);
+  EXPECT_EQ (Find (Names[MAX_PARTITIONS + 1]), nullptr);
+}
+
+TEST_F (FwPartitionNameIndexTest, NameNotPresent) {
+  EXPECT_EQ (Find ("A_part-0"), nullptr);
+
+  ASSERT_EQ (Add ("A_part-0", 0), EFI_SUCCESS);
+  EXPECT_EQ (Find ("B_part-0"), nullptr);
+  EXPECT_EQ (Find ("A_part-"), nullptr);
+  EXPECT_EQ (Find ("A_part-00"), nullptr);
+  EXPECT_EQ (Find (""), nullptr);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Relocates the partition array and name index like SetVirtualAddressMap.
+// FwPartitionAddressChangeHandler converts the per-partition pointers first,
+// then mPrivate and finally the name index.
+STATIC struct {
+  UINT8      *OldPrivate;
+  UINT8      *NewPrivate;
+  UINTN      PrivateBytes;
+  BOOLEAN    PrivateConverted;
+  UINT32     *OldIndex;
+  UINT32     *NewIndex;
+  UINTN      IndexConversions;
+} mRelocate;
+
+STATIC
+VOID
+EFIAPI
+RelocateConvert (
+  IN VOID  **Pointer
+  )
+{
+  UINT8  *Value;
+
+  Value = (UINT8 *)*Pointer;
+  if (mRelocate.PrivateConverted) {
+    mRelocate.OldIndex = (UINT32 *)Value;
+    mRelocate.NewIndex = (UINT32 *)AllocateCopyPool (FwPartitionGetNameIndexSize () * sizeof (UINT32), Value);
+    *Pointer           = mRelocate.NewIndex;
+    mRelocate.IndexConversions++;
+    return;
+  }
+
+  if (Value == mRelocate.OldPrivate) {
+    CopyMem (mRelocate.NewPrivate, mRelocate.OldPrivate, mRelocate.PrivateBytes);
+    *Pointer                   = mRelocate.NewPrivate;
+    mRelocate.PrivateConverted = TRUE;
+  } else if ((Value > mRelocate.OldPrivate) && (Value < mRelocate.OldPrivate + mRelocate.PrivateBytes)) {
+    *Pointer = mRelocate.NewPrivate + (Value - mRelocate.OldPrivate);
+  }
+}
+
+TEST_F (FwPartitionNameIndexTest, AddressChangeConvertsIndex) {
+  std::vector<std::string>   Names;
+  FW_PARTITION_PRIVATE_DATA  *Private;
+  UINTN                      Index;
+
+  Names = CollidingNames (3, 4);
+  for (Index = 0; Index < Names.size (); Index++) {
+    ASSERT_EQ (Add (Names[Index], Index * SIZE_4KB), EFI_SUCCESS);
+  }
+
+  ZeroMem (&mRelocate, sizeof (mRelocate));
+  mRelocate.OldPrivate   = (UINT8 *)FwPartitionGetPrivateArray ();
+  mRelocate.PrivateBytes = MAX_PARTITIONS * sizeof (FW_PARTITION_PRIVATE_DATA);
+  mRelocate.NewPrivate   = (UINT8 *)AllocatePool (mRelocate.PrivateBytes);
+  ASSERT_NE (mRelocate.NewPrivate, nullptr);
+
+  FwPartitionAddressChangeHandler (RelocateConvert);
+
+  ASSERT_TRUE (mRelocate.PrivateConverted);
+  ASSERT_EQ (mRelocate.IndexConversions, 1U);
+  ASSERT_NE (mRelocate.NewIndex, nullptr);
+  EXPECT_EQ ((UINT8 *)FwPartitionGetPrivateArray (), mRelocate.NewPrivate);
+
+  // stale lookups through the old buffers would find nothing
+  ZeroMem (mRelocate.OldPrivate, mRelocate.PrivateBytes);
+  ZeroMem (mRelocate.OldIndex, FwPartitionGetNameIndexSize () * sizeof (UINT32));
+
+  for (Index = 0; Index < Names.size (); Index++) {
+    ExpectFound (Names[Index], Index * SIZE_4KB);
+    Private = Find (Names[Index]);
+    EXPECT_EQ ((UINT8 *)Private, mRelocate.NewPrivate + (Index * sizeof (FW_PARTITION_PRIVATE_DATA)));
+    EXPECT_EQ (Private->Protocol.PartitionName, Private->PartitionInfo.Name);
+  }
+
+  EXPECT_EQ (Find ("part-missing"), nullptr);
+
+  FreePool (mRelocate.OldPrivate);
+  FreePool (mRelocate.OldIndex);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Registers a large synthetic GPT through FwPartitionAddFromPartitionTable and
+// checks every lookup against a linear scan of the table.
+class FwPartitionLargeGptTest : public Test {
+protected:
+  EFI_PARTITION_TABLE_HEADER Header;
+  std::vector<EFI_PARTITION_ENTRY> Table;
+  EFI_STATUS AddStatus;
+
+  STATIC
+  BOOLEAN
+  IsUnused (
+    UINTN  EntryIndex
+    )
+  {
+    return (EntryIndex % GPT_UNUSED_EVERY) == (GPT_UNUSED_EVERY - 1);
+  }
+
+  STATIC
+  std::string
+  EntryName (
+    UINTN  EntryIndex
+    )
+  {
+    if (EntryIndex == GPT_DUPLICATE_ENTRY) {
+      return EntryName (GPT_DUPLICATED);
+    }
+
+    if (EntryIndex == GPT_FULL_NAME_ENTRY) {
+      return "A_" + std::string (FW_PARTITION_NAME_LENGTH - 3, 'F');
+    }
+
+    return ((EntryIndex % 2) == 0 ? "A_" : "B_") + std::string ("partition-") + std::to_string (EntryIndex / 2);
+  }
+
+  void
+  SetUp (
+    ) override
+  {
+    std::string  Name;
+    UINTN        EntryIndex;
+    UINTN        Char;
+
+    ASSERT_EQ (FwPartitionDeviceLibInit (0, GPT_NUM_ENTRIES, FALSE, 0, 0), EFI_SUCCESS);
+    ASSERT_GE (FwPartitionGetNameIndexSize (), (UINTN)GPT_NUM_ENTRIES);
+
+    Table.assign (GPT_NUM_ENTRIES, EFI_PARTITION_ENTRY ());
+    ZeroMem (Table.data (), Table.size () * sizeof (EFI_PARTITION_ENTRY));
+    for (EntryIndex = 0; EntryIndex < GPT_NUM_ENTRIES; EntryIndex++) {
+      if (IsUnused (EntryIndex)) {
+        continue;
+      }
+
+      Table[EntryIndex].StartingLBA = GPT_FIRST_USABLE_LBA + (EntryIndex * 8);
+      Table[EntryIndex].EndingLBA   = GPT_FIRST_USABLE_LBA + (EntryIndex * 8) + 7;
+      Name                          = EntryName (EntryIndex);
+      for (Char = 0; Char < Name.size (); Char++) {
+        Table[EntryIndex].PartitionName[Char] = Name[Char];
+      }
+    }
+
+    ZeroMem (&Header, sizeof (Header));
+    Header.FirstUsableLBA           = GPT_FIRST_USABLE_LBA;
+    Header.LastUsableLBA            = GPT_FIRST_USABLE_LBA + (GPT_NUM_ENTRIES * 8);
+    Header.NumberOfPartitionEntries = GPT_NUM_ENTRIES;
+    Header.SizeOfPartitionEntry     = sizeof (EFI_PARTITION_ENTRY);
+    Header.PartitionEntryArrayCRC32 = CalculateCrc32 (Table.data (), Table.size () * sizeof (EFI_PARTITION_ENTRY));
+
+    AddStatus = FwPartitionAddFromPartitionTable (&Header, Table.data (), &mDeviceInfo);
+  }
+
+  void
+  TearDown (
+    ) override
+  {
+    FwPartitionDeviceLibDeinit ();
+  }
+
+  void
+  ExpectSameAsScan (
+    const std::string  &Name
+    )
+  {
+    std::vector<CHAR16>        Name16 = ToChar16 (Name);
+    CONST EFI_PARTITION_ENTRY  *Partition;
+    FW_PARTITION_PRIVATE_DATA  *Private;
+    FW_PARTITION_PRIVATE_DATA  *ScanPrivate;
+    UINTN                      Index;
+
+    // first partition of that name in the registered array
+    ScanPrivate = NULL;
+    Private     = FwPartitionGetPrivateArray ();
+    for (Index = 0; Index < FwPartitionGetCount (); Index++) {
+      if (StrCmp (Private[Index].PartitionInfo.Name, Name16.data ()) == 0) {
+        ScanPrivate = &Private[Index];
+        break;
+      }
+    }
+
+    Private = FwPartitionFindByName (Name16.data ());
+    EXPECT_EQ (Private, ScanPrivate) << Name;
+
+    // first entry of that name in the GPT, empty names are unused entries
+    Partition = NULL;
+    if (!Name.empty ()) {
+      Partition = GptFindPartitionByName (&Header, Table.data (), Name16.data ());
+    }
+
+    if (Partition == NULL) {
+      EXPECT_EQ (Private, nullptr) << Name;
+    } else {
+      ASSERT_NE (Private, nullptr) << Name;
+      EXPECT_EQ (Private->PartitionInfo.Offset, Partition->StartingLBA * NVIDIA_GPT_BLOCK_SIZE) << Name;
+    }
+  }
+};
+
+TEST_F (FwPartitionLargeGptTest, EveryEntryFound) {
+  UINTN  EntryIndex;
+  UINTN  Used;
+
+  // the duplicate is the last used entry and stops the add
+  EXPECT_EQ (AddStatus, EFI_ALREADY_STARTED);
+
+  Used = 0;
+  for (EntryIndex = 0; EntryIndex < GPT_DUPLICATE_ENTRY; EntryIndex++) {
+    if (!IsUnused (EntryIndex)) {
+      Used++;
+    }
+  }
+
+  EXPECT_EQ (FwPartitionGetCount (), Used);
+
+  for (EntryIndex = 0; EntryIndex < GPT_NUM_ENTRIES; EntryIndex++) {
+    if (!IsUnused (EntryIndex)) {
+      ExpectSameAsScan (EntryName (EntryIndex));
+    }
+  }
+}
+
+TEST_F (FwPartitionLargeGptTest, DuplicateReturnsFirst) {
+  FW_PARTITION_PRIVATE_DATA  *Private;
+  std::vector<CHAR16>        Name16 = ToChar16 (EntryName (GPT_DUPLICATE_ENTRY));
+
+  Private = FwPartitionFindByName (Name16.data ());
+  ASSERT_NE (Private, nullptr);
+  EXPECT_EQ (Private->PartitionInfo.Offset, Table[GPT_DUPLICATED].StartingLBA * NVIDIA_GPT_BLOCK_SIZE);
+  ExpectSameAsScan (EntryName (GPT_DUPLICATE_ENTRY));
+}
+
+TEST_F (FwPartitionLargeGptTest, MissingNames) {
+  ExpectSameAsScan ("C_partition-1");
+  ExpectSameAsScan ("A_partition");
+  ExpectSameAsScan ("A_partition-10000");
+  ExpectSameAsScan ("");
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  testing::InitGoogleTest (&argc, argv);
+  return RUN_ALL_TESTS ();
+}
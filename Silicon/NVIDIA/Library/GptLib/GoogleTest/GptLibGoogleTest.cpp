@@ -0,0 +1,61 @@
+/** @file
+  Unit tests for the partition name hash of GptLib.
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include <Library/GoogleTestLib.h>
+#include <string>
+#include <vector>
+
+extern "C" {
+  #include <Uefi.h>
+  #include <Library/GptLib.h>
+}
+
+using namespace testing;
+
+STATIC
+std::vector<CHAR16>
+ToChar16 (
+  const std::string  &Name
+  )
+{
+  std::vector<CHAR16>  Result (Name.begin (), Name.end ());
+
+  Result.push_back (0);
+  return Result;
+}
+
+TEST (GptLibNameHashTest, StopsAtMaxLengthAndNull) {
+  std::vector<CHAR16>  Short = ToChar16 ("abc");
+  std::vector<CHAR16>  Long  = ToChar16 ("abcdef");
+
+  EXPECT_EQ (GptPartitionNameHash (Short.data (), 3), GptPartitionNameHash (Long.data (), 3));
+  EXPECT_EQ (GptPartitionNameHash (Short.data (), MAX_UINTN), GptPartitionNameHash (Long.data (), 3));
+  EXPECT_NE (GptPartitionNameHash (Short.data (), MAX_UINTN), GptPartitionNameHash (Long.data (), MAX_UINTN));
+}
+
+TEST (GptLibNameHashTest, UsesHighByte) {
+  CHAR16  Low[]  = { 0x0041, 0 };
+  CHAR16  High[] = { 0x0141, 0 };
+
+  EXPECT_NE (GptPartitionNameHash (Low, MAX_UINTN), GptPartitionNameHash (High, MAX_UINTN));
+}
+
+TEST (GptLibNameHashTest, ABNamesDiffer) {
+  std::vector<CHAR16>  A = ToChar16 ("A_cpu-bootloader");
+  std::vector<CHAR16>  B = ToChar16 ("B_cpu-bootloader");
+
+  EXPECT_NE (GptPartitionNameHash (A.data (), MAX_UINTN), GptPartitionNameHash (B.data (), MAX_UINTN));
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  testing::InitGoogleTest (&argc, argv);
+  return RUN_ALL_TESTS ();
+}
@@ -3,7 +3,7 @@
   GPT - GUID Partition Table Library
         This implementation of GPT uses just the secondary GPT table.
 
-  SPDX-FileCopyrightText: Copyright (c) 2021-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2021-2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -13,6 +13,9 @@
 #include <Library/BaseLib.h>
 #include <Library/NVIDIADebugLib.h>
 
+#define GPT_NAME_HASH_OFFSET_BASIS  0x811C9DC5
+#define GPT_NAME_HASH_PRIME         0x01000193
+
 EFI_STATUS
 EFIAPI
 GptValidateHeader (
@@ -146,6 +149,26 @@ GptFindPartitionByName (
   return NULL;
 }
 
+UINT32
+EFIAPI
+GptPartitionNameHash (
+  IN CONST CHAR16  *Name,
+  IN UINTN         MaxLength
+  )
+{
+  UINT32  Hash;
+  UINTN   Length;
+
+  // FNV-1a over the low and high byte of each character
+  Hash = GPT_NAME_HASH_OFFSET_BASIS;
+  for (Length = 0; (Length < MaxLength) && (Name[Length] != L'\0'); Length++) {
+    Hash = (Hash ^ (Name[Length] & 0xFF)) * GPT_NAME_HASH_PRIME;
+    Hash = (Hash ^ (Name[Length] >> 8)) * GPT_NAME_HASH_PRIME;
+  }
+
+  return Hash;
+}
+
 UINT64
 EFIAPI
 GptPartitionSizeInBlocks (
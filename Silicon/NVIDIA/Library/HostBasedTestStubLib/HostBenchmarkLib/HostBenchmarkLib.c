@@ -0,0 +1,207 @@
+/** @file
+
+  Timing and reporting helpers for host based benchmarks.
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <time.h>
+
+#include <Uefi.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <HostBasedTestStubLib/HostBenchmarkLib.h>
+#include <HostBasedTestStubLib/NorFlashStubLib.h>
+
+#define NS_PER_SECOND  1000000000ULL
+
+STATIC CONST VIRTUAL_NOR_FLASH_LATENCY  mTypicalLatency = {
+  VIRTUAL_NOR_FLASH_TYPICAL_READ_COMMAND_NS,
+  VIRTUAL_NOR_FLASH_TYPICAL_READ_BYTE_NS,
+  VIRTUAL_NOR_FLASH_TYPICAL_WRITE_COMMAND_NS,
+  VIRTUAL_NOR_FLASH_TYPICAL_WRITE_PAGE_NS,
+  VIRTUAL_NOR_FLASH_TYPICAL_ERASE_BLOCK_NS
+};
+
+/**
+  Get the host wall clock time
+
+  @retval Time in nanoseconds
+**/
+STATIC
+UINT64
+HostBenchmarkGetTimeNs (
+  VOID
+  )
+{
+  struct timespec  Time;
+
+  timespec_get (&Time, TIME_UTC);
+  return ((UINT64)Time.tv_sec * NS_PER_SECOND) + (UINT64)Time.tv_nsec;
+}
+
+/**
+  Get the rate of Count events over TimeNs
+
+  @param  Count                 Number of events
+  @param  TimeNs                Time taken by the events
+
+  @retval Events per second
+**/
+STATIC
+UINT64
+HostBenchmarkPerSecond (
+  IN UINT64  Count,
+  IN UINT64  TimeNs
+  )
+{
+  if (TimeNs == 0) {
+    return 0;
+  }
+
+  return (UINT64)(((double)Count * NS_PER_SECOND) / TimeNs);
+}
+
+/**
+  Create an erased virtual NOR flash device with the typical latencies of a
+  quad SPI NOR device.
+
+  @param  Size                  Size of the device in bytes
+  @param  BlockSize             Size of an erase block in bytes
+  @param  Memory                Where to return the backing memory of the device
+  @param  Protocol              Where to return the protocol of the device
+
+  @retval EFI_SUCCESS           The device was created
+  @retval EFI_OUT_OF_RESOURCES  The device couldn't be allocated
+
+**/
+EFI_STATUS
+EFIAPI
+HostBenchmarkCreateNorFlash (
+  IN  UINT32                     Size,
+  IN  UINT32                     BlockSize,
+  OUT UINT8                      **Memory,
+  OUT NVIDIA_NOR_FLASH_PROTOCOL  **Protocol
+  )
+{
+  EFI_STATUS  Status;
+
+  *Memory = AllocatePool (Size);
+  if (*Memory == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  SetMem (*Memory, Size, 0xFF);
+
+  Status = VirtualNorFlashInitialize (*Memory, Size, BlockSize, Protocol);
+  if (EFI_ERROR (Status)) {
+    FreePool (*Memory);
+    *Memory = NULL;
+    return Status;
+  }
+
+  return VirtualNorFlashSetLatency (*Protocol, &mTypicalLatency);
+}
+
+/**
+  Free a virtual NOR flash device created by HostBenchmarkCreateNorFlash
+
+  @param  Memory                Backing memory of the device
+  @param  Protocol              Protocol of the device
+
+**/
+VOID
+EFIAPI
+HostBenchmarkDestroyNorFlash (
+  IN UINT8                      *Memory,
+  IN NVIDIA_NOR_FLASH_PROTOCOL  *Protocol
+  )
+{
+  if (Protocol != NULL) {
+    VirtualNorFlashStubDestroy (Protocol);
+  }
+
+  if (Memory != NULL) {
+    FreePool (Memory);
+  }
+}
+
+/**
+  Start timing a benchmark. The operation counts of the NOR flash device are
+  cleared so that only the flash operations of the benchmark are reported.
+
+  @param  Benchmark             Benchmark to start
+  @param  Name                  Name to report the benchmark under
+  @param  NorFlash              Virtual NOR flash device used, or NULL
+
+**/
+VOID
+EFIAPI
+HostBenchmarkStart (
+  OUT HOST_BENCHMARK             *Benchmark,
+  IN  CONST CHAR8                *Name,
+  IN  NVIDIA_NOR_FLASH_PROTOCOL  *NorFlash OPTIONAL
+  )
+{
+  VIRTUAL_NOR_FLASH_STATS  Stats;
+
+  Benchmark->Name     = Name;
+  Benchmark->NorFlash = NorFlash;
+  if (NorFlash != NULL) {
+    VirtualNorFlashGetStats (NorFlash, &Stats, TRUE);
+  }
+
+  Benchmark->StartNs = HostBenchmarkGetTimeNs ();
+}
+
+/**
+  Stop timing a benchmark and report its results.
+
+  Operations per second are reported both for the host alone and with the
+  simulated time of the NOR flash device added, along with the number of
+  flash operations done per benchmark operation.
+
+  @param  Benchmark             Benchmark to stop
+  @param  Operations            Number of operations done by the benchmark
+
+**/
+VOID
+EFIAPI
+HostBenchmarkStop (
+  IN HOST_BENCHMARK  *Benchmark,
+  IN UINT64          Operations
+  )
+{
+  UINT64                   HostNs;
+  VIRTUAL_NOR_FLASH_STATS  Stats;
+
+  HostNs = HostBenchmarkGetTimeNs () - Benchmark->StartNs;
+
+  ZeroMem (&Stats, sizeof (Stats));
+  if (Benchmark->NorFlash != NULL) {
+    VirtualNorFlashGetStats (Benchmark->NorFlash, &Stats, FALSE);
+  }
+
+  if (Operations == 0) {
+    Operations = 1;
+  }
+
+  printf (
+    "[BENCH] %-36s %8llu ops %12llu ops/s host %10llu ops/s modeled"
+    " | per op: %.2f reads %.2f writes %.2f erases %llu device ns\n",
+    Benchmark->Name,
+    (unsigned long long)Operations,
+    (unsigned long long)HostBenchmarkPerSecond (Operations, HostNs),
+    (unsigned long long)HostBenchmarkPerSecond (Operations, HostNs + Stats.DeviceTimeNs),
+    (double)Stats.Reads / Operations,
+    (double)Stats.Writes / Operations,
+    (double)Stats.Erases / Operations,
+    (unsigned long long)(Stats.DeviceTimeNs / Operations)
+    );
+}
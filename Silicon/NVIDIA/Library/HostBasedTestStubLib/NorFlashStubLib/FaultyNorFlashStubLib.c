@@ -2,7 +2,7 @@
 
 Stub implementation of a flash device that reports device errors.
 
-Copyright (c) 2020-2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+Copyright (c) 2020-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
 
 SPDX-License-Identifier: BSD-2-Clause-Patent
@@ -194,7 +194,7 @@ FaultyNorFlashInitialize (
 
   VIRTUAL_NOR_FLASH_DEVICE  *Device;
 
-  Device = AllocatePool (sizeof (VIRTUAL_NOR_FLASH_DEVICE));
+  Device = AllocateZeroPool (sizeof (VIRTUAL_NOR_FLASH_DEVICE));
   if (Device == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
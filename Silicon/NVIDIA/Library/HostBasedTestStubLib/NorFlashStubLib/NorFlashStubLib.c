@@ -2,7 +2,7 @@
 
 Stub implementation of a virtual NOR flash device.
 
-Copyright (c) 2020-2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+Copyright (c) 2020-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
 
 SPDX-License-Identifier: BSD-2-Clause-Patent
@@ -90,6 +90,10 @@ VirtualNorFlashRead (
   }
 
   CopyMem (Buffer, Device->Memory + Offset, Size);
+
+  Device->Stats.Reads++;
+  Device->Stats.BytesRead    += Size;
+  Device->Stats.DeviceTimeNs += Device->Latency.ReadCommandNs + (Device->Latency.ReadByteNs * Size);
   return EFI_SUCCESS;
 }
 
@@ -118,6 +122,7 @@ VirtualNorFlashWrite (
   UINT8                     *Src;
   UINT8                     *Dst;
   INTN                      Index;
+  UINT32                    Pages;
 
   if ((This == NULL) ||
       (Buffer == NULL))
@@ -137,6 +142,17 @@ VirtualNorFlashWrite (
     Dst[Index] &= Src[Index];
   }
 
+  // Programming is done one page at a time, count the pages the write touches
+  Pages = 0;
+  if (Size != 0) {
+    Pages = ((Offset + Size - 1) / Device->Attributes.ProgramPageSize) -
+            (Offset / Device->Attributes.ProgramPageSize) + 1;
+  }
+
+  Device->Stats.Writes++;
+  Device->Stats.BytesWritten += Size;
+  Device->Stats.PagesWritten += Pages;
+  Device->Stats.DeviceTimeNs += Device->Latency.WriteCommandNs + (Device->Latency.WritePageNs * Pages);
   return EFI_SUCCESS;
 }
 
@@ -177,6 +193,10 @@ VirtualNorFlashErase (
   }
 
   SetMem (Device->Memory + Offset, Size, 0xFF);
+
+  Device->Stats.Erases++;
+  Device->Stats.BlocksErased += NumLba;
+  Device->Stats.DeviceTimeNs += Device->Latency.EraseBlockNs * NumLba;
   return EFI_SUCCESS;
 }
 
@@ -210,7 +230,7 @@ VirtualNorFlashInitialize (
 
   VIRTUAL_NOR_FLASH_DEVICE  *Device;
 
-  Device = AllocatePool (sizeof (VIRTUAL_NOR_FLASH_DEVICE));
+  Device = AllocateZeroPool (sizeof (VIRTUAL_NOR_FLASH_DEVICE));
   if (Device == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
@@ -234,6 +254,77 @@ VirtualNorFlashInitialize (
   return EFI_SUCCESS;
 }
 
+/**
+  Set the simulated latencies of a virtual NOR flash device
+
+  @param  Protocol              Protocol of the virtual device
+  @param  Latency               Latencies to simulate, or NULL for none
+
+  @retval EFI_SUCCESS           The latencies were set
+  @retval EFI_INVALID_PARAMETER A Null parameter was found
+
+**/
+EFI_STATUS
+EFIAPI
+VirtualNorFlashSetLatency (
+  IN NVIDIA_NOR_FLASH_PROTOCOL        *Protocol,
+  IN CONST VIRTUAL_NOR_FLASH_LATENCY  *Latency OPTIONAL
+  )
+{
+  VIRTUAL_NOR_FLASH_DEVICE  *Device;
+
+  if (Protocol == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Device = NOR_FLASH_DEVICE_FROM_NOR_FLASH_PROTOCOL (Protocol);
+
+  if (Latency == NULL) {
+    ZeroMem (&Device->Latency, sizeof (Device->Latency));
+  } else {
+    CopyMem (&Device->Latency, Latency, sizeof (Device->Latency));
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Get the operations done on a virtual NOR flash device
+
+  @param  Protocol              Protocol of the virtual device
+  @param  Stats                 Where to copy the operation counts
+  @param  Reset                 Clear the operation counts after copying them
+
+  @retval EFI_SUCCESS           The operation counts were copied
+  @retval EFI_INVALID_PARAMETER A Null parameter was found
+
+**/
+EFI_STATUS
+EFIAPI
+VirtualNorFlashGetStats (
+  IN  NVIDIA_NOR_FLASH_PROTOCOL  *Protocol,
+  OUT VIRTUAL_NOR_FLASH_STATS    *Stats,
+  IN  BOOLEAN                    Reset
+  )
+{
+  VIRTUAL_NOR_FLASH_DEVICE  *Device;
+
+  if ((Protocol == NULL) ||
+      (Stats == NULL))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Device = NOR_FLASH_DEVICE_FROM_NOR_FLASH_PROTOCOL (Protocol);
+
+  CopyMem (Stats, &Device->Stats, sizeof (Device->Stats));
+  if (Reset) {
+    ZeroMem (&Device->Stats, sizeof (Device->Stats));
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Clean up the space used by the virtual NOR flash stub if necessary
 
@@ -2,7 +2,7 @@
 
 NorFlashStubLib private definitions.
 
-Copyright (c) 2022-2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+Copyright (c) 2022-2026, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
 
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -13,6 +13,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include <Uefi.h>
 #include <Protocol/NorFlash.h>
+#include <HostBasedTestStubLib/NorFlashStubLib.h>
 
 // Note: These values DO NOT need to be kept in sync with the real values used by the real driver
 // They simply need to be reasonably valid values
@@ -26,6 +27,8 @@ typedef struct {
   UINT32                       Signature;
   UINT8                        *Memory;
   NOR_FLASH_ATTRIBUTES         Attributes;
+  VIRTUAL_NOR_FLASH_LATENCY    Latency;
+  VIRTUAL_NOR_FLASH_STATS      Stats;
   NVIDIA_NOR_FLASH_PROTOCOL    Protocol;
 } VIRTUAL_NOR_FLASH_DEVICE;
 
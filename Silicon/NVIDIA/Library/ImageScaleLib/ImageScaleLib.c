@@ -6,16 +6,251 @@
 **/
 
 #include <Uefi.h>
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/ImageScaleLib.h>
 
+// Fraction bits of the reciprocals used to average a box of source pixels
+#define IMAGE_SCALE_RECIPROCAL_SHIFT  32
+
+// Largest box the reciprocals average exactly, larger boxes are divided
+#define IMAGE_SCALE_RECIPROCAL_MAX_COUNT  4096
+
+/**
+  Builds the table mapping each destination coordinate to its first source
+  coordinate, Table[Dst] = (Dst * SourceSize) / ScaledSize.
+
+  The table is built incrementally so no division is done per entry. It has
+  ScaledSize + 1 entries so that Table[Dst + 1] is the end of the source span
+  for Dst.
+
+  @param[in]  SourceSize     Size of the source dimension in pixels
+  @param[in]  ScaledSize     Size of the scaled dimension in pixels
+  @param[out] Table          Table of ScaledSize + 1 entries
+**/
+STATIC
+VOID
+ImageScaleBuildTable (
+  IN  UINTN   SourceSize,
+  IN  UINTN   ScaledSize,
+  OUT UINT32  *Table
+  )
+{
+  UINTN  Dst;
+  UINTN  Whole;
+  UINTN  Fraction;
+  UINTN  Src;
+  UINTN  Error;
+
+  Whole    = SourceSize / ScaledSize;
+  Fraction = SourceSize % ScaledSize;
+  Src      = 0;
+  Error    = 0;
+
+  for (Dst = 0; Dst <= ScaledSize; Dst++) {
+    Table[Dst] = (UINT32)Src;
+    Src       += Whole;
+    Error     += Fraction;
+    if (Error >= ScaledSize) {
+      Error -= ScaledSize;
+      Src++;
+    }
+  }
+}
+
+/**
+  Returns the fixed point reciprocal of the number of pixels in a box.
+
+  (Sum * Reciprocal) >> IMAGE_SCALE_RECIPROCAL_SHIFT matches Sum / Count for
+  boxes of up to IMAGE_SCALE_RECIPROCAL_MAX_COUNT pixels of 8 bit channels.
+  Larger boxes get no reciprocal and are averaged with a division.
+
+  @param[in]  Count          Number of pixels in the box
+
+  @retval Reciprocal of Count, 0 if the box is too large
+**/
+STATIC
+UINT64
+ImageScaleReciprocal (
+  IN UINTN  Count
+  )
+{
+  if (Count > IMAGE_SCALE_RECIPROCAL_MAX_COUNT) {
+    return 0;
+  }
+
+  return DivU64x64Remainder (
+           LShiftU64 (1, IMAGE_SCALE_RECIPROCAL_SHIFT) + Count - 1,
+           Count,
+           NULL
+           );
+}
+
+/**
+  Returns the average of one channel over a box of source pixels.
+
+  @param[in]  Sum            Sum of the channel over the box
+  @param[in]  Count          Number of pixels in the box
+  @param[in]  Reciprocal     Reciprocal of Count from ImageScaleReciprocal
+
+  @retval Average of the channel
+**/
+STATIC
+UINT8
+ImageScaleAverage (
+  IN UINT64  Sum,
+  IN UINTN   Count,
+  IN UINT64  Reciprocal
+  )
+{
+  if (Reciprocal == 0) {
+    return (UINT8)DivU64x64Remainder (Sum, Count, NULL);
+  }
+
+  return (UINT8)RShiftU64 (MultU64x64 (Reciprocal, Sum), IMAGE_SCALE_RECIPROCAL_SHIFT);
+}
+
+/**
+  Scales an image with nearest-neighbor sampling.
+
+  @param[in]  Image          Pointer to the source image bitmap
+  @param[in]  ImageWidth     Width of the source image in pixels
+  @param[in]  ScaledWidth    Width of the scaled image in pixels
+  @param[in]  ScaledHeight   Height of the scaled image in pixels
+  @param[in]  ColumnTable    Source column of each destination column
+  @param[in]  RowTable       Source row of each destination row
+  @param[out] ScaledImage    Scaled image bitmap
+**/
+STATIC
+VOID
+ImageScaleNearest (
+  IN  CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Image,
+  IN  UINTN                                ImageWidth,
+  IN  UINTN                                ScaledWidth,
+  IN  UINTN                                ScaledHeight,
+  IN  CONST UINT32                         *ColumnTable,
+  IN  CONST UINT32                         *RowTable,
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *ScaledImage
+  )
+{
+  UINTN                                DstX;
+  UINTN                                DstY;
+  CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *SrcRow;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *DstRow;
+
+  for (DstY = 0; DstY < ScaledHeight; ++DstY) {
+    DstRow = &ScaledImage[DstY * ScaledWidth];
+
+    //
+    // Consecutive destination rows often sample the same source row
+    //
+    if ((DstY > 0) && (RowTable[DstY] == RowTable[DstY - 1])) {
+      CopyMem (DstRow, DstRow - ScaledWidth, ScaledWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+      continue;
+    }
+
+    SrcRow = &Image[RowTable[DstY] * ImageWidth];
+    for (DstX = 0; DstX < ScaledWidth; ++DstX) {
+      DstRow[DstX] = SrcRow[ColumnTable[DstX]];
+    }
+  }
+}
+
+/**
+  Scales an image down with box/area resampling.
+
+  @param[in]  Image          Pointer to the source image bitmap
+  @param[in]  ImageWidth     Width of the source image in pixels
+  @param[in]  ScaledWidth    Width of the scaled image in pixels
+  @param[in]  ScaledHeight   Height of the scaled image in pixels
+  @param[in]  ColumnTable    Source column span of each destination column
+  @param[in]  RowTable       Source row span of each destination row
+  @param[out] ScaledImage    Scaled image bitmap
+**/
+STATIC
+VOID
+ImageScaleBox (
+  IN  CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Image,
+  IN  UINTN                                ImageWidth,
+  IN  UINTN                                ScaledWidth,
+  IN  UINTN                                ScaledHeight,
+  IN  CONST UINT32                         *ColumnTable,
+  IN  CONST UINT32                         *RowTable,
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *ScaledImage
+  )
+{
+  UINTN                                DstX;
+  UINTN                                DstY;
+  UINTN                                SrcX;
+  UINTN                                SrcY;
+  UINTN                                SrcX0;
+  UINTN                                SrcX1;
+  UINTN                                SrcY0;
+  UINTN                                SrcY1;
+  UINTN                                NarrowWidth;
+  UINT64                               NarrowReciprocal;
+  UINT64                               WideReciprocal;
+  UINT64                               Reciprocal;
+  UINTN                                Count;
+  UINT64                               SumRed;
+  UINT64                               SumGreen;
+  UINT64                               SumBlue;
+  UINT64                               SumReserved;
+  CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *SrcRow;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *Result;
+
+  //
+  // Every column span is either NarrowWidth or NarrowWidth + 1 pixels wide,
+  // so each row only needs two reciprocals.
+  //
+  NarrowWidth = ImageWidth / ScaledWidth;
+
+  for (DstY = 0; DstY < ScaledHeight; ++DstY) {
+    SrcY0            = RowTable[DstY];
+    SrcY1            = RowTable[DstY + 1];
+    NarrowReciprocal = ImageScaleReciprocal ((SrcY1 - SrcY0) * NarrowWidth);
+    WideReciprocal   = ImageScaleReciprocal ((SrcY1 - SrcY0) * (NarrowWidth + 1));
+
+    for (DstX = 0; DstX < ScaledWidth; ++DstX) {
+      SrcX0 = ColumnTable[DstX];
+      SrcX1 = ColumnTable[DstX + 1];
+
+      SumRed      = 0;
+      SumGreen    = 0;
+      SumBlue     = 0;
+      SumReserved = 0;
+      for (SrcY = SrcY0; SrcY < SrcY1; ++SrcY) {
+        SrcRow = &Image[SrcY * ImageWidth];
+        for (SrcX = SrcX0; SrcX < SrcX1; ++SrcX) {
+          SumRed      += SrcRow[SrcX].Red;
+          SumGreen    += SrcRow[SrcX].Green;
+          SumBlue     += SrcRow[SrcX].Blue;
+          SumReserved += SrcRow[SrcX].Reserved;
+        }
+      }
+
+      Reciprocal       = ((SrcX1 - SrcX0) == NarrowWidth) ? NarrowReciprocal : WideReciprocal;
+      Count            = (SrcY1 - SrcY0) * (SrcX1 - SrcX0);
+      Result           = &ScaledImage[DstY * ScaledWidth + DstX];
+      Result->Red      = ImageScaleAverage (SumRed, Count, Reciprocal);
+      Result->Green    = ImageScaleAverage (SumGreen, Count, Reciprocal);
+      Result->Blue     = ImageScaleAverage (SumBlue, Count, Reciprocal);
+      Result->Reserved = ImageScaleAverage (SumReserved, Count, Reciprocal);
+    }
+  }
+}
+
 /**
   Scales an image to a new width and height.
 
   Uses box/area resampling for downscaling (better quality) and
   nearest-neighbor for upscaling (fast).
 
+  Source coordinates are precomputed once per row and column with
+  incremental stepping and box averages use fixed point reciprocals, so no
+  division is done per pixel.
+
   @param[in]  Image          Pointer to the source image bitmap
   @param[in]  ImageWidth     Width of the source image in pixels
   @param[in]  ImageHeight    Height of the source image in pixels
@@ -38,23 +273,9 @@ ImageScale (
   OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  **ScaledImage
   )
 {
-  UINTN  PixelCount;
-  UINTN  DstX;
-  UINTN  DstY;
-  UINTN  SrcY;
-  UINTN  SrcX;
-  // Variables for box/area resampling
-  UINTN                          SrcY0;
-  UINTN                          SrcY1;
-  UINTN                          SrcX0;
-  UINTN                          SrcX1;
-  UINT32                         SumRed;
-  UINT32                         SumGreen;
-  UINT32                         SumBlue;
-  UINT32                         SumReserved;
-  UINTN                          Count;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  P;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Result;
+  UINTN   PixelCount;
+  UINT32  *ColumnTable;
+  UINT32  *RowTable;
 
   if ((Image == NULL) || (ScaledImage == NULL)) {
     return EFI_INVALID_PARAMETER;
@@ -79,63 +300,30 @@ ImageScale (
     return EFI_SUCCESS;
   }
 
-  //
-  // Upscaling or mixed - use nearest-neighbor (fast)
-  //
+  ColumnTable = AllocatePool ((ScaledWidth + 1 + ScaledHeight + 1) * sizeof (UINT32));
+  if (ColumnTable == NULL) {
+    FreePool (*ScaledImage);
+    *ScaledImage = NULL;
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  RowTable = &ColumnTable[ScaledWidth + 1];
+  ImageScaleBuildTable (ImageWidth, ScaledWidth, ColumnTable);
+  ImageScaleBuildTable (ImageHeight, ScaledHeight, RowTable);
+
   if ((ScaledWidth >= ImageWidth) || (ScaledHeight >= ImageHeight)) {
-    for (DstY = 0; DstY < ScaledHeight; ++DstY) {
-      SrcY = (DstY * ImageHeight) / ScaledHeight;
-      for (DstX = 0; DstX < ScaledWidth; ++DstX) {
-        SrcX                                      = (DstX * ImageWidth) / ScaledWidth;
-        (*ScaledImage)[DstY * ScaledWidth + DstX] = Image[SrcY * ImageWidth + SrcX];
-      }
-    }
+    //
+    // Upscaling or mixed - use nearest-neighbor (fast)
+    //
+    ImageScaleNearest (Image, ImageWidth, ScaledWidth, ScaledHeight, ColumnTable, RowTable, *ScaledImage);
   } else {
     //
     // Downscaling - use box/area resampling (better quality)
     //
-    for (DstY = 0; DstY < ScaledHeight; ++DstY) {
-      SrcY0 = (DstY * ImageHeight) / ScaledHeight;
-      SrcY1 = ((DstY + 1) * ImageHeight) / ScaledHeight;
-      if (SrcY1 > ImageHeight) {
-        SrcY1 = ImageHeight;
-      }
-
-      for (DstX = 0; DstX < ScaledWidth; ++DstX) {
-        SrcX0 = (DstX * ImageWidth) / ScaledWidth;
-        SrcX1 = ((DstX + 1) * ImageWidth) / ScaledWidth;
-        if (SrcX1 > ImageWidth) {
-          SrcX1 = ImageWidth;
-        }
-
-        SumRed      = 0;
-        SumGreen    = 0;
-        SumBlue     = 0;
-        SumReserved = 0;
-        Count       = 0;
-        for (SrcY = SrcY0; SrcY < SrcY1; ++SrcY) {
-          for (SrcX = SrcX0; SrcX < SrcX1; ++SrcX) {
-            P            = Image[SrcY * ImageWidth + SrcX];
-            SumRed      += P.Red;
-            SumGreen    += P.Green;
-            SumBlue     += P.Blue;
-            SumReserved += P.Reserved;
-            ++Count;
-          }
-        }
-
-        ZeroMem (&Result, sizeof (Result));
-        if (Count > 0) {
-          Result.Red      = (UINT8)(SumRed / Count);
-          Result.Green    = (UINT8)(SumGreen / Count);
-          Result.Blue     = (UINT8)(SumBlue / Count);
-          Result.Reserved = (UINT8)(SumReserved / Count);
-        }
-
-        (*ScaledImage)[DstY * ScaledWidth + DstX] = Result;
-      }
-    }
+    ImageScaleBox (Image, ImageWidth, ScaledWidth, ScaledHeight, ColumnTable, RowTable, *ScaledImage);
   }
 
+  FreePool (ColumnTable);
+
   return EFI_SUCCESS;
 }
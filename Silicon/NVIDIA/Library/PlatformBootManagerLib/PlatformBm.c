@@ -41,6 +41,7 @@
 #include <Library/UefiRuntimeLib.h>
 #include <Library/StatusRegLib.h>
 #include <Library/AndroidBcbLib.h>
+#include <Library/BootTraceLib.h>
 #include <Protocol/AsyncDriverStatus.h>
 #include <Protocol/BootChainProtocol.h>
 #include <Protocol/DeferredImageLoad.h>
@@ -61,6 +62,7 @@
 #include <Uefi/UefiSpec.h>
 #include <Guid/EventGroup.h>
 #include <Guid/FirmwarePerformance.h>
+#include <Guid/GlobalVariable.h>
 #include <Guid/RtPropertiesTable.h>
 #include <Guid/TtyTerm.h>
 #include <Guid/SerialPortLibVendor.h>
@@ -108,6 +110,27 @@ STATIC PLATFORM_USB_KEYBOARD  mUsbKeyboard = {
 STATIC PLATFORM_CONFIGURATION_DATA  CurrentPlatformConfigData;
 EFI_RSC_HANDLER_PROTOCOL            *mRscHandler = NULL;
 
+//
+// Set when only the boot target was connected and a full connect is still
+// outstanding, along with the connect policy used for this boot and the
+// total time spent connecting devices.
+//
+typedef enum {
+  PlatformConnectFull,
+  PlatformConnectTargeted,
+  PlatformConnectTargetedFallback
+} PLATFORM_CONNECT_POLICY;
+
+STATIC CONST CHAR8  *mConnectPolicyNames[] = {
+  "Full",
+  "Targeted",
+  "Targeted-fallback"
+};
+
+STATIC BOOLEAN                  mConnectAllDeferred = FALSE;
+STATIC PLATFORM_CONNECT_POLICY  mConnectPolicy      = PlatformConnectFull;
+STATIC UINT64                   mConnectTimeNs      = 0;
+
 /**
   Check if the handle satisfies a particular condition.
 
@@ -552,13 +575,16 @@ Connect (
   )
 {
   EFI_STATUS  Status;
+  UINT32      SpanId;
 
+  SpanId = BootTraceBegin (BootTraceCategoryConnect, __FUNCTION__, (UINT32)(UINTN)Handle);
   Status = gBS->ConnectController (
                   Handle, // ControllerHandle
                   NULL,   // DriverImageHandle
                   NULL,   // RemainingDevicePath -- produce all children
                   FALSE   // Recursive
                   );
+  BootTraceEnd (SpanId);
   DEBUG ((
     EFI_ERROR (Status) ? DEBUG_ERROR : DEBUG_VERBOSE,
     "%a: %s: %r\n",
@@ -568,6 +594,160 @@ Connect (
     ));
 }
 
+/**
+  Connects all the devices in the system, recording the time spent in the
+  boot trace.
+**/
+STATIC
+VOID
+PlatformConnectAll (
+  VOID
+  )
+{
+  UINT32  SpanId;
+  UINT64  StartTime;
+
+  StartTime = GetTimeInNanoSecond (GetPerformanceCounter ());
+  SpanId    = BootTraceBegin (BootTraceCategoryConnect, "ConnectAll", 0);
+  EfiBootManagerConnectAll ();
+  BootTraceEnd (SpanId);
+
+  mConnectAllDeferred = FALSE;
+  mConnectTimeNs     += GetTimeInNanoSecond (GetPerformanceCounter ()) - StartTime;
+}
+
+/**
+  Connects the device required by a boot option.
+
+  @param[in] Option             Boot option to connect.
+
+  @retval TRUE                  The device required by the option is connected.
+  @retval FALSE                 The device of the option could not be reached.
+**/
+STATIC
+BOOLEAN
+PlatformConnectBootOption (
+  IN EFI_BOOT_MANAGER_LOAD_OPTION  *Option
+  )
+{
+  EFI_STATUS                Status;
+  EFI_DEVICE_PATH_PROTOCOL  *FilePath;
+  EFI_DEVICE_PATH_PROTOCOL  *FullPath;
+  EFI_HANDLE                FvHandle;
+
+  FilePath = Option->FilePath;
+
+  //
+  // Applications in firmware volumes, such as L4TLauncher, only need the
+  // volume, which is produced before BDS.
+  //
+  Status = gBS->LocateDevicePath (&gEfiFirmwareVolume2ProtocolGuid, &FilePath, &FvHandle);
+  if (!EFI_ERROR (Status) &&
+      (EfiGetNameGuidFromFwVolDevicePathNode ((CONST MEDIA_FW_VOL_FILEPATH_DEVICE_PATH *)FilePath) != NULL))
+  {
+    return TRUE;
+  }
+
+  FilePath = Option->FilePath;
+  switch (DevicePathType (FilePath)) {
+    case HARDWARE_DEVICE_PATH:
+    case ACPI_DEVICE_PATH:
+      Status = EfiBootManagerConnectDevicePath (FilePath, NULL);
+      break;
+
+    default:
+      //
+      // Short-form device paths are expanded, connecting what they need, the
+      // same way the boot manager resolves them when booting the option.
+      //
+      FullPath = EfiBootManagerGetNextLoadOptionDevicePath (FilePath, NULL);
+      if (FullPath == NULL) {
+        Status = EFI_NOT_FOUND;
+      } else {
+        Status = EfiBootManagerConnectDevicePath (FullPath, NULL);
+        FreePool (FullPath);
+      }
+
+      break;
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: Failed to connect %s: %r\n", __FUNCTION__, Option->Description, Status));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Connects only the device of the boot target of this boot, BootNext if set
+  or the first active option in BootOrder otherwise.
+
+  @retval TRUE                  The boot target is connected.
+  @retval FALSE                 The boot target could not be resolved.
+**/
+STATIC
+BOOLEAN
+PlatformConnectBootTarget (
+  VOID
+  )
+{
+  EFI_STATUS                    Status;
+  UINT16                        *BootNext;
+  UINTN                         Size;
+  CHAR16                        OptionName[sizeof ("Boot####")];
+  EFI_BOOT_MANAGER_LOAD_OPTION  Option;
+  EFI_BOOT_MANAGER_LOAD_OPTION  *BootOptions;
+  UINTN                         BootOptionCount;
+  UINTN                         Index;
+  BOOLEAN                       Connected;
+  UINT32                        SpanId;
+  UINT64                        StartTime;
+
+  StartTime = GetTimeInNanoSecond (GetPerformanceCounter ());
+  SpanId    = BootTraceBegin (BootTraceCategoryConnect, "ConnectBootTarget", 0);
+  Connected = FALSE;
+
+  GetEfiGlobalVariable2 (EFI_BOOT_NEXT_VARIABLE_NAME, (VOID **)&BootNext, &Size);
+  if (BootNext != NULL) {
+    if (Size == sizeof (UINT16)) {
+      UnicodeSPrint (OptionName, sizeof (OptionName), L"Boot%04x", *BootNext);
+      Status = EfiBootManagerVariableToLoadOption (OptionName, &Option);
+      if (!EFI_ERROR (Status)) {
+        Connected = PlatformConnectBootOption (&Option);
+        EfiBootManagerFreeLoadOption (&Option);
+      }
+    }
+
+    FreePool (BootNext);
+  }
+
+  if (!Connected) {
+    //
+    // Options are returned in BootOrder. Only the first active one is
+    // targeted, the boot manager connects the others itself on failover.
+    //
+    BootOptions = EfiBootManagerGetLoadOptions (&BootOptionCount, LoadOptionTypeBoot);
+    for (Index = 0; Index < BootOptionCount; Index++) {
+      if (((BootOptions[Index].Attributes & LOAD_OPTION_ACTIVE) == 0) ||
+          ((BootOptions[Index].Attributes & LOAD_OPTION_CATEGORY) != LOAD_OPTION_CATEGORY_BOOT))
+      {
+        continue;
+      }
+
+      Connected = PlatformConnectBootOption (&BootOptions[Index]);
+      break;
+    }
+
+    EfiBootManagerFreeLoadOptions (BootOptions, BootOptionCount);
+  }
+
+  BootTraceEnd (SpanId);
+  mConnectTimeNs += GetTimeInNanoSecond (GetPerformanceCounter ()) - StartTime;
+
+  return Connected;
+}
+
 /**
   This CALLBACK_FUNCTION retrieves the EFI_DEVICE_PATH_PROTOCOL from the
   handle, and adds it to ConOut and ErrOut.
@@ -2085,7 +2265,7 @@ PlatformBootManagerBeforeConsole (
       //
       // Connect the rest of the devices.
       //
-      EfiBootManagerConnectAll ();
+      PlatformConnectAll ();
 
       //
       // Wait for any polled enumeration to finish
@@ -2176,11 +2356,32 @@ PlatformBootManagerBeforeConsole (
     // Process IPMI-directed BootOrder updates
     //
     ProcessIPMIBootOrderUpdates ();
+
+    if (!PlatformReconfigured && PcdGetBool (PcdBootTargetConnect)) {
+      //
+      // Connect the boot target up front, after any BMC override of
+      // BootOrder, so that it does not have to be resolved by a full
+      // connect. The remaining devices are only connected if no boot option
+      // can be launched. A target that can't be reached gets a full connect
+      // now.
+      //
+      if (PlatformConnectBootTarget ()) {
+        mConnectAllDeferred = TRUE;
+        mConnectPolicy      = PlatformConnectTargeted;
+      } else {
+        mConnectPolicy = PlatformConnectTargetedFallback;
+        PlatformConnectAll ();
+        WaitForPolledEnumeration ();
+        EfiEventGroupSignal (&gNVIDIAConnectCompleteEventGuid);
+      }
+    }
   } else {
     //
-    // Connect the rest of the devices.
+    // Connect the rest of the devices. The single boot application is in a
+    // firmware volume and needs the storage or network it loads from, so it
+    // is always fully connected.
     //
-    EfiBootManagerConnectAll ();
+    PlatformConnectAll ();
 
     //
     // Signal ConnectComplete Event
@@ -2246,7 +2447,7 @@ PlatformBootManagerBeforeConsole (
   // Connect drivers if new driver was dispatched.
   // Do this if the platform is doing full connects
   if (PlatformReconfigured && !EFI_ERROR (Status)) {
-    EfiBootManagerConnectAll ();
+    PlatformConnectAll ();
   }
 }
 
@@ -2678,6 +2879,14 @@ PlatformBootManagerAfterConsole (
   // Print the BootOrder information
   PrintCurrentBootOrder (DEBUG_ERROR);
 
+  DEBUG ((
+    DEBUG_ERROR,
+    "%a: %a connect took %llu us\n",
+    __FUNCTION__,
+    mConnectPolicyNames[mConnectPolicy],
+    mConnectTimeNs / 1000
+    ));
+
   // Configure the console
   ConfigureConsole ();
 
@@ -2781,6 +2990,36 @@ PlatformBootManagerUnableToBoot (
   VOID
   )
 {
+  EFI_BOOT_MANAGER_LOAD_OPTION  *BootOptions;
+  UINTN                         BootOptionCount;
+  UINTN                         Index;
+
+  //
+  // If only the boot target was connected, connect everything now and give
+  // the boot options another try before giving up.
+  //
+  if (mConnectAllDeferred) {
+    DEBUG ((DEBUG_ERROR, "%a: Boot target not bootable, connecting all devices\n", __FUNCTION__));
+    mConnectPolicy = PlatformConnectTargetedFallback;
+    PlatformConnectAll ();
+    WaitForPolledEnumeration ();
+    EfiEventGroupSignal (&gNVIDIAConnectCompleteEventGuid);
+    EfiBootManagerRefreshAllBootOption ();
+
+    BootOptions = EfiBootManagerGetLoadOptions (&BootOptionCount, LoadOptionTypeBoot);
+    for (Index = 0; Index < BootOptionCount; Index++) {
+      if (((BootOptions[Index].Attributes & LOAD_OPTION_ACTIVE) == 0) ||
+          ((BootOptions[Index].Attributes & LOAD_OPTION_CATEGORY) != LOAD_OPTION_CATEGORY_BOOT))
+      {
+        continue;
+      }
+
+      EfiBootManagerBoot (&BootOptions[Index]);
+    }
+
+    EfiBootManagerFreeLoadOptions (BootOptions, BootOptionCount);
+  }
+
   Print (L"Unable to boot, system will halt\r\n");
   return;
 }
@@ -923,7 +923,6 @@ ValidateActiveBootChain (
   )
 {
   UINT32      SocketMask;
-  UINTN       Socket;
   EFI_STATUS  Status;
   UINT32      BootChain;
   UINTN       CpuBootloaderAddress;
@@ -947,18 +946,13 @@ ValidateActiveBootChain (
     return Status;
   }
 
-  SocketMask = SocGetSocketMask (CpuBootloaderAddress);
-  for (Socket = 0; Socket < TH500_MAX_SOCKETS; Socket++) {
-    if (!(SocketMask & (1UL << Socket))) {
-      continue;
-    }
+  SocketMask = SocGetSocketMask (CpuBootloaderAddress) & ((1UL << TH500_MAX_SOCKETS) - 1);
 
-    Status = ErotSendBootComplete (Socket, BootChain);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a: ErotSendBootComplete failed socket %u: %r\n", __FUNCTION__, Socket, Status));
-    } else {
-      DEBUG ((DEBUG_ERROR, "BootComplete successful, socket %u\n", Socket));
-    }
+  Status = ErotSendBootCompleteAll (SocketMask, BootChain);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: ErotSendBootCompleteAll failed mask 0x%x: %r\n", __FUNCTION__, SocketMask, Status));
+  } else {
+    DEBUG ((DEBUG_ERROR, "BootComplete successful, socket mask 0x%x\n", SocketMask));
   }
 
   return EFI_SUCCESS;
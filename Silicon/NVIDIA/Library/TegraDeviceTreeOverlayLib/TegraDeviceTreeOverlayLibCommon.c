@@ -123,6 +123,29 @@ DT_MATCH_INFO  MatchInfoArray[] = {
 
 STATIC OVERLAY_BOARD_INFO  *BoardInfo = NULL;
 
+typedef struct {
+  CONST CHAR8    *BoardId;
+  INTN           BoardIdLen;
+  INTN           FabId;
+} OVERLAY_BOARD_ID;
+
+typedef struct {
+  UINT32     Value;
+  BOOLEAN    Valid;
+} OVERLAY_FUSE_VALUE;
+
+//
+// Board identity evaluated once per ApplyTegraDeviceTreeOverlayCommon() call
+// instead of for every board_config string of every fragment.
+//
+typedef struct {
+  OVERLAY_BOARD_ID      *BoardIds;
+  OVERLAY_FUSE_VALUE    *FuseValues;
+  INTN                  OdmDataNode;
+} OVERLAY_MATCH_CONTEXT;
+
+STATIC OVERLAY_MATCH_CONTEXT  MatchContext;
+
 STATIC INTN
 GetFabId (
   CONST CHAR8  *BoardId,
@@ -167,6 +190,62 @@ GetFabId (
   return FabId;
 }
 
+STATIC
+VOID
+OverlayMatchContextFree (
+  VOID
+  )
+{
+  if (MatchContext.BoardIds != NULL) {
+    FreePool (MatchContext.BoardIds);
+  }
+
+  if (MatchContext.FuseValues != NULL) {
+    FreePool (MatchContext.FuseValues);
+  }
+
+  ZeroMem (&MatchContext, sizeof (MatchContext));
+}
+
+STATIC
+EFI_STATUS
+OverlayMatchContextInit (
+  VOID
+  )
+{
+  UINTN             Index;
+  OVERLAY_BOARD_ID  *Id;
+
+  ZeroMem (&MatchContext, sizeof (MatchContext));
+
+  if (BoardInfo->IdCount > 0) {
+    MatchContext.BoardIds = AllocatePool (BoardInfo->IdCount * sizeof (OVERLAY_BOARD_ID));
+    if (MatchContext.BoardIds == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    for (Index = 0; Index < BoardInfo->IdCount; Index++) {
+      Id             = &MatchContext.BoardIds[Index];
+      Id->BoardId    = TegraBoardIdFromPartNumber (&BoardInfo->ProductIds[Index]);
+      Id->BoardIdLen = AsciiStrLen (Id->BoardId);
+      Id->FabId      = GetFabId (Id->BoardId, NULL);
+    }
+  }
+
+  // fuses are read on first use
+  if (BoardInfo->FuseCount > 0) {
+    MatchContext.FuseValues = AllocateZeroPool (BoardInfo->FuseCount * sizeof (OVERLAY_FUSE_VALUE));
+    if (MatchContext.FuseValues == NULL) {
+      OverlayMatchContextFree ();
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  MatchContext.OdmDataNode = FdtPathOffset (CpublDtb, "/chosen/odm-data");
+
+  return EFI_SUCCESS;
+}
+
 STATIC BOOLEAN
 MatchId (
   VOID         *Fdt,
@@ -241,9 +320,9 @@ match_type_done:
   }
 
   for (i = 0; i < BoardInfo->IdCount; i++) {
-    BoardId    = TegraBoardIdFromPartNumber (&BoardInfo->ProductIds[i]);
-    BoardIdLen = AsciiStrLen (BoardId);
-    BoardFabId = GetFabId (BoardId, NULL);
+    BoardId    = MatchContext.BoardIds[i].BoardId;
+    BoardIdLen = MatchContext.BoardIds[i].BoardIdLen;
+    BoardFabId = MatchContext.BoardIds[i].FabId;
     DEBUG ((
       DEBUG_INFO,
       "%a: check if overlay node id %a match with %a\n",
@@ -328,7 +407,7 @@ MatchOdmData (
   BOOLEAN  Matched = FALSE;
   INTN     OdmDataNode;
 
-  OdmDataNode = FdtPathOffset (CpublDtb, "/chosen/odm-data");
+  OdmDataNode = MatchContext.OdmDataNode;
   if (0 > OdmDataNode) {
     DEBUG ((DEBUG_ERROR, "%a: Failed to find node /chosen/odm-data\n", __FUNCTION__));
     goto ret_odm_match;
@@ -381,7 +460,12 @@ MatchFuseInfo (
       FuseInfo = &BoardInfo->FuseList[Index];
       if (!AsciiStrCmp (FuseStr, FuseInfo->Name)) {
         FuseAddr = BoardInfo->FuseBaseAddr + FuseInfo->Offset;
-        Value    = MmioRead32 (FuseAddr);
+        if (!MatchContext.FuseValues[Index].Valid) {
+          MatchContext.FuseValues[Index].Value = MmioRead32 (FuseAddr);
+          MatchContext.FuseValues[Index].Valid = TRUE;
+        }
+
+        Value = MatchContext.FuseValues[Index].Value;
         DEBUG ((DEBUG_INFO, "%a: %a address 0x%llx is 0x%x, checking bits 0x%x to be 0x%x\n", __FUNCTION__, FuseInfo->Name, FuseAddr, Value, FuseInfo->Value, (MatchIfNonZero) ? FuseInfo->Value : 0));
         if ((MatchIfNonZero && (Value & FuseInfo->Value)) ||
             (!MatchIfNonZero && !(Value & FuseInfo->Value)))
@@ -498,11 +582,71 @@ FdtDeleteSubNode (
   return EFI_SUCCESS;
 }
 
+/**
+  Check if a path refers to one of the given top level fragments, that is it
+  starts with "/<fragment>" followed by a '/' or, when AllowColon is set, a ':'.
+
+  @param[in]  Path          Path to check
+  @param[in]  PathLen       Length of Path, excluding the terminating NUL
+  @param[in]  NodeNames     Fragment names
+  @param[in]  NodeCount     Number of fragment names
+  @param[in]  AllowColon    Also match a ':' after the fragment name
+
+  @retval TRUE              Path refers to one of the fragments
+  @retval FALSE             Path does not refer to any of the fragments
+**/
+STATIC
+BOOLEAN
+IsFragmentPath (
+  CONST CHAR8  *Path,
+  UINTN        PathLen,
+  CONST CHAR8  **NodeNames,
+  UINTN        NodeCount,
+  BOOLEAN      AllowColon
+  )
+{
+  UINTN  Index;
+  UINTN  NodeLen;
+
+  if ((PathLen < 2) || (Path[0] != '/')) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < NodeCount; Index++) {
+    NodeLen = AsciiStrLen (NodeNames[Index]);
+    if (PathLen < NodeLen + 2) {
+      continue;
+    }
+
+    if (0 != CompareMem (Path + 1, NodeNames[Index], NodeLen)) {
+      continue;
+    }
+
+    if ((Path[NodeLen + 1] == '/') || (AllowColon && (Path[NodeLen + 1] == ':'))) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Remove the __symbols__, __local_fixups__ and __fixups__ references to the
+  given fragments, in a single pass over each of those nodes.
+
+  @param[in]  FdtBase       Overlay device tree
+  @param[in]  NodeNames     Names of the fragments being deleted
+  @param[in]  NodeCount     Number of fragment names
+
+  @retval EFI_SUCCESS       References removed
+  @retval others            Error occurred
+**/
 STATIC
 EFI_STATUS
 FdtCleanFixups (
   VOID         *FdtBase,
-  CONST CHAR8  *NodeName
+  CONST CHAR8  **NodeNames,
+  UINTN        NodeCount
   )
 {
   VOID         *FdtBuf;
@@ -518,54 +662,47 @@ FdtCleanFixups (
   INT32        PStrLen;
   CONST CHAR8  *PropName;
   CONST CHAR8  *PropStr;
-  CONST VOID   *Prop;
-  CHAR8        *NodePath = NULL;
-  UINT32       NodeLen;
-  CONST CHAR8  *NewProp;
+  CHAR8        *NewProp;
   UINTN        NewPropLen = 0;
-  UINT32       Index;
+  UINTN        Index;
   BOOLEAN      UpdateProp;
   EFI_STATUS   Status = EFI_SUCCESS;
   INTN         Err    = 0;
 
-  if (NodeName == NULL) {
+  if ((NodeNames == NULL) || (NodeCount == 0)) {
     return EFI_DEVICE_ERROR;
   }
 
-  FdtBuf = NULL;
-
-  NodeLen  = AsciiStrLen (NodeName);
-  NodePath = (CHAR8 *)AllocateZeroPool (NodeLen+2);
-  if (NodePath == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a: Failed to allocate memory for NodePath\n", __FUNCTION__));
-    return EFI_OUT_OF_RESOURCES;
-  }
-
-  CopyMem ((VOID *)NodePath+1, (VOID *)NodeName, NodeLen);
-  NodePath[0] = '/';
+  FdtBuf       = NULL;
+  BufPageCount = 0;
 
   SymbolsNode = FdtSubnodeOffset (FdtBase, 0, "__symbols__");
   if (SymbolsNode >= 0) {
     for (PropOffset = FdtFirstPropertyOffset (FdtBase, SymbolsNode); PropOffset >= 0; PropOffset = FdtNextPropertyOffset (FdtBase, PropOffset)) {
       PropStr = FdtGetPropertyValueByOffset (FdtBase, PropOffset, &PropName, &PropLen);
-      if (PropLen >= NodeLen+2) {
-        if (0 == CompareMem (NodePath, PropStr, NodeLen+1)) {
-          if (PropStr[NodeLen+1] == '/') {
-            FdtNopProperty (FdtBase, SymbolsNode, PropName);
-          }
-        }
+      if ((PropStr != NULL) && (PropLen > 0) &&
+          IsFragmentPath (PropStr, PropLen - 1, NodeNames, NodeCount, FALSE))
+      {
+        FdtNopProperty (FdtBase, SymbolsNode, PropName);
       }
     }
   }
 
   FixupsNode = FdtSubnodeOffset (FdtBase, 0, "__local_fixups__");
   if (FixupsNode >= 0) {
-    SubNode = FdtSubnodeOffset (FdtBase, FixupsNode, NodeName);
-    if (SubNode >= 0) {
-      if (0 > FdtDelNode (FdtBase, SubNode)) {
-        DEBUG ((DEBUG_ERROR, "Error deleting fragment %a from __local_fixups__\n", NodeName));
-        Status = EFI_DEVICE_ERROR;
-        goto ExitFixups;
+    for (Index = 0; Index < NodeCount; Index++) {
+      SubNode = FdtSubnodeOffset (FdtBase, FixupsNode, NodeNames[Index]);
+      if (SubNode >= 0) {
+        if (0 > FdtDelNode (FdtBase, SubNode)) {
+          DEBUG ((DEBUG_ERROR, "Error deleting fragment %a from __local_fixups__\n", NodeNames[Index]));
+          Status = EFI_DEVICE_ERROR;
+          goto ExitFixups;
+        }
+
+        FixupsNode = FdtSubnodeOffset (FdtBase, 0, "__local_fixups__");
+        if (FixupsNode < 0) {
+          break;
+        }
       }
     }
   }
@@ -591,24 +728,28 @@ FdtCleanFixups (
     goto ExitFixups;
   }
 
-  DEBUG ((DEBUG_INFO, "Removing fixups for fragment: %a\n", NodePath));
+  DEBUG ((DEBUG_INFO, "Removing fixups for %u fragments\n", NodeCount));
 
   for (PropOffset = FdtFirstPropertyOffset (FdtBuf, FixupsNode); PropOffset >= 0; PropOffset = FdtNextPropertyOffset (FdtBuf, PropOffset)) {
     UpdateProp = FALSE;
-    Prop       = FdtGetPropertyValueByOffset (FdtBuf, PropOffset, &PropName, &PropLen);
-    NewProp    = (CONST CHAR8 *)AllocateZeroPool (PropLen);
+    FdtGetPropertyValueByOffset (FdtBuf, PropOffset, &PropName, &PropLen);
+    NewProp = (CHAR8 *)AllocateZeroPool (PropLen);
+    if (NewProp == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto ExitFixups;
+    }
 
     PropCount = FdtStringListCount (FdtBuf, FixupsNode, PropName);
     if (PropCount > 0) {
       for (Index = 0; Index < PropCount; Index++) {
         PropStr = FdtStringListGet (FdtBuf, FixupsNode, PropName, Index, &PStrLen);
-        if (PStrLen >= NodeLen+2) {
-          if (0 == CompareMem (NodePath, PropStr, NodeLen+1)) {
-            if ((PropStr[NodeLen+1] == '/') || (PropStr[NodeLen+1] == ':')) {
-              UpdateProp = TRUE;
-              continue;
-            }
-          }
+        if ((PropStr == NULL) || (PStrLen < 0)) {
+          continue;
+        }
+
+        if (IsFragmentPath (PropStr, PStrLen, NodeNames, NodeCount, TRUE)) {
+          UpdateProp = TRUE;
+          continue;
         }
 
         CopyMem ((VOID *)(NewProp + NewPropLen), PropStr, PStrLen+1);
@@ -619,6 +760,7 @@ FdtCleanFixups (
     if (UpdateProp == TRUE) {
       FixupsNodeNew = FdtSubnodeOffset (FdtBase, 0, "__fixups__");
       if (FixupsNodeNew < 0) {
+        FreePool (NewProp);
         Status = EFI_DEVICE_ERROR;
         goto ExitFixups;
       }
@@ -634,16 +776,11 @@ FdtCleanFixups (
       }
     }
 
-    UpdateProp = FALSE;
-    FreePool ((VOID *)NewProp);
+    FreePool (NewProp);
     NewPropLen = 0;
   }
 
 ExitFixups:
-  if (NodePath) {
-    FreePool (NodePath);
-  }
-
   if (FdtBuf) {
     FreePages (FdtBuf, BufPageCount);
   }
@@ -664,7 +801,6 @@ ProcessOverlayDeviceTree (
   INTN           FrNode = 0;
   INTN           BufNode;
   CONST CHAR8    *FrName;
-  CONST CHAR8    *NodeName;
   INTN           ConfigNode;
   CONST CHAR8    *PropStr;
   INTN           PropCount;
@@ -676,12 +812,34 @@ ProcessOverlayDeviceTree (
   UINT32         Count;
   UINT32         NumberSubnodes;
   UINT32         MiscNodes = 0;
+  CONST CHAR8    **DeleteNames;
+  UINTN          DeleteCount;
 
   TargetName = FdtGetProp (FdtOverlay, 0, "overlay-name", &TargetLen);
   if ((TargetName != NULL) && (TargetLen != 0)) {
     DEBUG ((DEBUG_ERROR, "Processing \"%a\" DTB overlay\n", TargetName));
   }
 
+  //
+  // Fragments that are not selected are collected here and removed from
+  // FdtBuf together after all fragments have been filtered.
+  //
+  NumberSubnodes = 0;
+  FdtForEachSubnode (FrNode, FdtOverlay, 0) {
+    NumberSubnodes++;
+  }
+
+  if (NumberSubnodes == 0) {
+    DEBUG ((DEBUG_INFO, "No matching fragments in the overlay.\n"));
+    return EFI_NOT_FOUND;
+  }
+
+  DeleteCount = 0;
+  DeleteNames = (CONST CHAR8 **)AllocatePool (NumberSubnodes * sizeof (CONST CHAR8 *));
+  if (DeleteNames == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
   FdtForEachSubnode (FrNode, FdtOverlay, 0) {
     FrName = FdtGetName (FdtOverlay, FrNode, NULL);
     if ((AsciiStrCmp (FrName, "__fixups__") == 0) || (AsciiStrCmp (FrName, "__local_fixups__") == 0) || (AsciiStrCmp (FrName, "__symbols__") == 0)) {
@@ -759,7 +917,8 @@ process_deletes:
           PropStr = FdtStringListGet (FdtOverlay, FrNode, "delete_node", Count, NULL);
           if (EFI_ERROR (FdtDeleteSubNode (FdtBase, TargetName, PropStr))) {
             DEBUG ((DEBUG_ERROR, "Error deleting node: %a from %a\n", PropStr, TargetName));
-            return EFI_DEVICE_ERROR;
+            Status = EFI_DEVICE_ERROR;
+            goto Exit;
           }
 
           DEBUG ((DEBUG_INFO, "Node Deleted: %a from %a\n", PropStr, TargetName));
@@ -773,7 +932,8 @@ process_deletes:
           PropStr = FdtStringListGet (FdtOverlay, FrNode, "delete_prop", Count, NULL);
           if (EFI_ERROR (FdtDeleteProperty (FdtBase, TargetName, PropStr))) {
             DEBUG ((DEBUG_ERROR, "Error deleting property: %a from %a\n", PropStr, TargetName));
-            return EFI_DEVICE_ERROR;
+            Status = EFI_DEVICE_ERROR;
+            goto Exit;
           }
 
           DEBUG ((DEBUG_INFO, "Property Deleted: %a from %a\n", PropStr, TargetName));
@@ -787,37 +947,43 @@ process_deletes:
 
 delete_fragment:
     DEBUG ((DEBUG_INFO, "Deleting fragment %a\n", FrName));
+    DeleteNames[DeleteCount++] = FrName;
+  }
+
+  if (DeleteCount > 0) {
     // Delete matching __fixups__
-    if (EFI_ERROR (FdtCleanFixups (FdtBuf, FrName))) {
-      DEBUG ((DEBUG_ERROR, "Error removing reference to %a in __fixups__.\n", FrName));
-      return EFI_DEVICE_ERROR;
+    if (EFI_ERROR (FdtCleanFixups (FdtBuf, DeleteNames, DeleteCount))) {
+      DEBUG ((DEBUG_ERROR, "Error removing references to deleted fragments in __fixups__.\n"));
+      Status = EFI_DEVICE_ERROR;
+      goto Exit;
     }
 
-    FdtForEachSubnode (BufNode, FdtBuf, 0) {
-      NodeName = FdtGetName (FdtBuf, BufNode, NULL);
-      if (0 == AsciiStrCmp (FrName, NodeName)) {
-        FdtErr = FdtDelNode (FdtBuf, BufNode);
-        if (FdtErr < 0) {
-          DEBUG ((DEBUG_ERROR, "Error deleting fragment %a\n", FrName));
-          return EFI_DEVICE_ERROR;
-        }
+    for (Index = 0; Index < DeleteCount; Index++) {
+      BufNode = FdtSubnodeOffset (FdtBuf, 0, DeleteNames[Index]);
+      if (BufNode < 0) {
+        continue;
+      }
 
-        break;
+      FdtErr = FdtDelNode (FdtBuf, BufNode);
+      if (FdtErr < 0) {
+        DEBUG ((DEBUG_ERROR, "Error deleting fragment %a\n", DeleteNames[Index]));
+        Status = EFI_DEVICE_ERROR;
+        goto Exit;
       }
     }
   }
 
-  NumberSubnodes = 0;
-  FdtForEachSubnode (FrNode, FdtBuf, 0) {
-    NumberSubnodes++;
-  }
-
-  if (NumberSubnodes <= MiscNodes) {
+  if (NumberSubnodes - DeleteCount <= MiscNodes) {
     DEBUG ((DEBUG_INFO, "No matching fragments in the overlay.\n"));
-    return EFI_NOT_FOUND;
+    Status = EFI_NOT_FOUND;
+    goto Exit;
   }
 
-  return EFI_SUCCESS;
+  Status = EFI_SUCCESS;
+
+Exit:
+  FreePool (DeleteNames);
+  return Status;
 }
 
 EFI_STATUS
@@ -868,8 +1034,25 @@ ApplyTegraDeviceTreeOverlayCommon (
   ASSERT (CpublDtb != NULL);
 
   BoardInfo = OverlayBoardInfo;
-  Status    = EFI_SUCCESS;
-  FdtNext   = FdtOverlay;
+  SWModule  = ModuleStr;
+  if (PlatformType == TEGRA_PLATFORM_QT) {
+    Environment = "qt";
+  } else if (PlatformType == TEGRA_PLATFORM_SYSTEM_FPGA) {
+    Environment = "fpga";
+  } else if (PlatformType == TEGRA_PLATFORM_VDK) {
+    Environment = "sim";
+  } else {
+    Environment = "unknown";
+  }
+
+  Status = OverlayMatchContextInit ();
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: Failed to build overlay match context: %r\n", __FUNCTION__, Status));
+    FreePages (FdtBuf, BufPageCount);
+    return Status;
+  }
+
+  FdtNext = FdtOverlay;
   while (FdtCheckHeader ((VOID *)FdtNext) == 0) {
     /* Process and apply overlay */
     FdtSize = FdtTotalSize (FdtNext);
@@ -880,17 +1063,6 @@ ApplyTegraDeviceTreeOverlayCommon (
       goto Exit;
     }
 
-    SWModule = ModuleStr;
-    if (PlatformType == TEGRA_PLATFORM_QT) {
-      Environment = "qt";
-    } else if (PlatformType == TEGRA_PLATFORM_SYSTEM_FPGA) {
-      Environment = "fpga";
-    } else if (PlatformType == TEGRA_PLATFORM_VDK) {
-      Environment = "sim";
-    } else {
-      Environment = "unknown";
-    }
-
     Status = ProcessOverlayDeviceTree (FdtBase, FdtNext, FdtBuf);
     if (EFI_SUCCESS == Status) {
       Err = FdtOverlayApply (FdtBase, FdtBuf);
@@ -909,6 +1081,7 @@ ApplyTegraDeviceTreeOverlayCommon (
   }
 
 Exit:
+  OverlayMatchContextFree ();
   FreePages (FdtBuf, BufPageCount);
   return Status;
 }
@@ -0,0 +1,454 @@
+/** @file
+  Host based throughput benchmarks of the ErrorSerializationMmDxe driver,
+  run against a virtual NOR flash device with the latencies of a typical
+  quad SPI NOR device.
+
+  SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+#include <Library/IoLib.h> // MMIO calls
+
+// So that we can reference ErrorSerialization declarations
+#include "../ErrorSerializationMm.h"
+#include "../ErrorSerializationMemory.h"
+
+#include <HostBasedTestStubLib/HostBenchmarkLib.h>
+#include <HostBasedTestStubLib/NorFlashStubLib.h>
+#include <HostBasedTestStubLib/HobStubLib.h>
+#include <HostBasedTestStubLib/PlatformResourceStubLib.h>
+#include <HostBasedTestStubLib/StandaloneMmOpteeStubLib.h>
+
+#include <Library/StandaloneMmOpteeDeviceMem.h>
+
+typedef struct {
+  EFI_HOB_GUID_TYPE    GUID;
+  STMM_COMM_BUFFERS    Buffers;
+} STMM_COMM_BUFFERS_DATA;
+
+#define UNIT_TEST_APP_NAME     "ErrorSerializationMmDxe Benchmark Application"
+#define UNIT_TEST_APP_VERSION  "0.1"
+
+#define BLOCK_SIZE                  SIZE_64KB
+#define NUM_BLOCKS                  8
+#define TOTAL_NOR_FLASH_SIZE        (NUM_BLOCKS * BLOCK_SIZE)
+#define ERROR_LOG_INFO_BUFFER_SIZE  SIZE_16KB
+#define ERST_BUFFER_SIZE            (sizeof(ERST_COMM_STRUCT) + ERROR_LOG_INFO_BUFFER_SIZE)
+#define FIRST_RECORD_ID             0x1000
+#define INSERT_RECORDS              512     // Fit without needing a reclaim
+#define LOOKUP_ITERATIONS           4096
+#define UPDATE_ITERATIONS           1024
+
+typedef struct {
+  CONST CHAR8    *Name;
+  UINT32         PayloadSize;   // Bytes after the CPER header
+  UINT32         Prefill;       // Records written before timing starts
+} BENCHMARK_CONTEXT;
+
+extern ERST_PRIVATE_INFO  mErrorSerialization;
+extern UINT8              *mShadowFlash;
+
+STATIC STMM_COMM_BUFFERS_DATA     mStmmCommBuffersData;
+STATIC EFI_PHYSICAL_ADDRESS       mCpuBlAddr;
+STATIC UINT8                      *mFlashMemory;
+STATIC NVIDIA_NOR_FLASH_PROTOCOL  *mNorFlash;
+STATIC UINT8                      *mErstBuffer;
+
+STATIC BENCHMARK_CONTEXT  mInsert128 = { "Erst insert 128B", 128, 0 };
+STATIC BENCHMARK_CONTEXT  mInsert512 = { "Erst insert 512B", 512, 0 };
+STATIC BENCHMARK_CONTEXT  mLookup128 = { "Erst lookup 128B", 128, INSERT_RECORDS };
+STATIC BENCHMARK_CONTEXT  mUpdate128 = { "Erst update 128B", 128, INSERT_RECORDS };
+
+/**
+  Run a single ERST operation through the driver's event handler, the way
+  the OS drives it through the ERST actions.
+
+  @param[in]  Operation       ERST operation to run
+  @param[in]  RecordId        Record to read, ignored for writes
+  @param[out] CommandStatus   ERST status of the operation
+
+  @retval     TRUE            The driver cleared the busy status.
+  @retval     FALSE           The driver left the operation busy.
+**/
+STATIC
+BOOLEAN
+RunErstOperation (
+  IN  ERST_OPERATION_TYPE  Operation,
+  IN  UINT64               RecordId,
+  OUT UINT32               *CommandStatus
+  )
+{
+  ERST_COMM_STRUCT  *ErstComm;
+
+  ErstComm               = (ERST_COMM_STRUCT *)mErstBuffer;
+  ErstComm->Operation    = Operation;
+  ErstComm->RecordOffset = 0;
+  ErstComm->RecordID     = RecordId;
+
+  // IoStubLib routes all MMIO to the same UINT32, the driver writes a 1 to it
+  // when it clears the busy status.
+  MmioWrite32 (0, 0);
+  ErrorSerializationEventHandler (NULL, NULL, NULL, NULL);
+
+  *CommandStatus      = ErstComm->Status >> ERST_STATUS_BIT_OFFSET;
+  ErstComm->Operation = ERST_OPERATION_INVALID;
+
+  return MmioRead32 (0) == 1;
+}
+
+/**
+  Write a record through the ERST interface.
+
+  @param[in]  RecordId        Id of the record
+  @param[in]  PayloadSize     Bytes after the CPER header
+  @param[out] CommandStatus   ERST status of the write
+
+  @retval     TRUE            The driver cleared the busy status.
+  @retval     FALSE           The driver left the operation busy.
+**/
+STATIC
+BOOLEAN
+WriteRecord (
+  IN  UINT64  RecordId,
+  IN  UINT32  PayloadSize,
+  OUT UINT32  *CommandStatus
+  )
+{
+  ERST_COMM_STRUCT                *ErstComm;
+  EFI_COMMON_ERROR_RECORD_HEADER  *Cper;
+
+  ErstComm = (ERST_COMM_STRUCT *)mErstBuffer;
+  Cper     = (EFI_COMMON_ERROR_RECORD_HEADER *)ErstComm->ErrorLogAddressRange.PhysicalBase;
+
+  SetMem (Cper, sizeof (EFI_COMMON_ERROR_RECORD_HEADER) + PayloadSize, (UINT8)RecordId);
+  Cper->RecordID       = RecordId;
+  Cper->RecordLength   = PayloadSize + sizeof (EFI_COMMON_ERROR_RECORD_HEADER);
+  Cper->SignatureStart = EFI_ERROR_RECORD_SIGNATURE_START;
+  Cper->Revision       = EFI_ERROR_RECORD_REVISION;
+  Cper->SignatureEnd   = EFI_ERROR_RECORD_SIGNATURE_END;
+
+  return RunErstOperation (ERST_OPERATION_WRITE, RecordId, CommandStatus);
+}
+
+/**
+  Start the driver on an empty flash and write the records a benchmark
+  looks up or updates.
+
+  @param Context                      Benchmark to prepare for
+
+  @retval UNIT_TEST_PASSED            Setup succeeded.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BenchmarkSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  EFI_STATUS         Status;
+  UINT32             CommandStatus;
+  UINTN              Index;
+
+  Bench = (BENCHMARK_CONTEXT *)Context;
+
+  SetMem (mFlashMemory, TOTAL_NOR_FLASH_SIZE, 0xFF);
+  SetMem (mErstBuffer, ERST_BUFFER_SIZE, 0xFF);
+
+  Status = MockGetSocketNorFlashProtocol (0, mNorFlash);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  MockGetCpuBlParamsAddrStMm (&mCpuBlAddr, EFI_SUCCESS);
+  Status = MockGetPartitionInfoStMm ((UINTN)&mCpuBlAddr, TEGRABL_ERST, 0, 0, TOTAL_NOR_FLASH_SIZE, EFI_SUCCESS);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  MockGetFirstGuidHob (&gNVIDIAStMMBuffersGuid, &mStmmCommBuffersData);
+
+  ErstMemoryInit ();
+  Status = ErrorSerializationReInit ();
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+
+  for (Index = 0; Index < Bench->Prefill; Index++) {
+    UT_ASSERT_TRUE (WriteRecord (FIRST_RECORD_ID + Index, Bench->PayloadSize, &CommandStatus));
+    UT_ASSERT_EQUAL (CommandStatus, EFI_ACPI_6_6_ERST_STATUS_SUCCESS);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Release what the driver allocated when it was started.
+
+  @param Context                      Benchmark that ran
+**/
+STATIC
+VOID
+EFIAPI
+BenchmarkCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  ErstFreeRuntimeMemory ();
+  mErrorSerialization.BlockInfo = NULL;
+  mErrorSerialization.CperInfo  = NULL;
+  if (mShadowFlash != NULL) {
+    FreePool (mShadowFlash);
+    mShadowFlash = NULL;
+  }
+}
+
+/**
+  Insert new records.
+
+  @param Context                      Benchmark to run
+
+  @retval UNIT_TEST_PASSED            All assertions passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+InsertBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  HOST_BENCHMARK     Benchmark;
+  UINT32             CommandStatus;
+  UINTN              Index;
+
+  Bench = (BENCHMARK_CONTEXT *)Context;
+
+  HostBenchmarkStart (&Benchmark, Bench->Name, mNorFlash);
+  for (Index = 0; Index < INSERT_RECORDS; Index++) {
+    UT_ASSERT_TRUE (WriteRecord (FIRST_RECORD_ID + Index, Bench->PayloadSize, &CommandStatus));
+    UT_ASSERT_EQUAL (CommandStatus, EFI_ACPI_6_6_ERST_STATUS_SUCCESS);
+  }
+
+  HostBenchmarkStop (&Benchmark, INSERT_RECORDS);
+
+  UT_ASSERT_EQUAL (mErrorSerialization.RecordCount, INSERT_RECORDS);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Read records back by their id.
+
+  @param Context                      Benchmark to run
+
+  @retval UNIT_TEST_PASSED            All assertions passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LookupBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  HOST_BENCHMARK     Benchmark;
+  UINT32             CommandStatus;
+  UINTN              Index;
+
+  Bench = (BENCHMARK_CONTEXT *)Context;
+
+  HostBenchmarkStart (&Benchmark, Bench->Name, mNorFlash);
+  for (Index = 0; Index < LOOKUP_ITERATIONS; Index++) {
+    // Stride through the ids so lookups don't follow insertion order
+    UT_ASSERT_TRUE (RunErstOperation (ERST_OPERATION_READ, FIRST_RECORD_ID + ((Index * 7) % Bench->Prefill), &CommandStatus));
+    UT_ASSERT_EQUAL (CommandStatus, EFI_ACPI_6_6_ERST_STATUS_SUCCESS);
+  }
+
+  HostBenchmarkStop (&Benchmark, LOOKUP_ITERATIONS);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Overwrite existing records, which invalidates the old copies and forces
+  blocks to be reclaimed.
+
+  @param Context                      Benchmark to run
+
+  @retval UNIT_TEST_PASSED            All assertions passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+UpdateBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BENCHMARK_CONTEXT  *Bench;
+  HOST_BENCHMARK     Benchmark;
+  UINT32             CommandStatus;
+  UINTN              Index;
+
+  Bench = (BENCHMARK_CONTEXT *)Context;
+
+  HostBenchmarkStart (&Benchmark, Bench->Name, mNorFlash);
+  for (Index = 0; Index < UPDATE_ITERATIONS; Index++) {
+    UT_ASSERT_TRUE (WriteRecord (FIRST_RECORD_ID + (Index % Bench->Prefill), Bench->PayloadSize, &CommandStatus));
+    UT_ASSERT_EQUAL (CommandStatus, EFI_ACPI_6_6_ERST_STATUS_SUCCESS);
+  }
+
+  HostBenchmarkStop (&Benchmark, UPDATE_ITERATIONS);
+
+  UT_ASSERT_EQUAL (mErrorSerialization.RecordCount, Bench->Prefill);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Creates the virtual NOR flash device and the buffers shared with the OS.
+
+  @retval EFI_SUCCESS           The benchmark data was set up.
+  @retval EFI_OUT_OF_RESOURCES  The benchmark data couldn't be allocated.
+**/
+STATIC
+EFI_STATUS
+InitBenchmarkData (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = HostBenchmarkCreateNorFlash (TOTAL_NOR_FLASH_SIZE, BLOCK_SIZE, &mFlashMemory, &mNorFlash);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  mErstBuffer = AllocateZeroPool (ERST_BUFFER_SIZE);
+  if (mErstBuffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  PlatformResourcesStubLibInit ();
+  StandaloneMmOpteeStubLibInitialize ();
+
+  mStmmCommBuffersData.Buffers.NsErstUncachedBufAddr = (UINT64)mErstBuffer;
+  mStmmCommBuffersData.Buffers.NsErstUncachedBufSize = sizeof (ERST_COMM_STRUCT);
+  mStmmCommBuffersData.Buffers.NsErstCachedBufAddr   = (UINT64)mErstBuffer + sizeof (ERST_COMM_STRUCT);
+  mStmmCommBuffersData.Buffers.NsErstCachedBufSize   = ERROR_LOG_INFO_BUFFER_SIZE;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Frees the virtual NOR flash device and the shared buffers.
+**/
+STATIC
+VOID
+CleanUpBenchmarkData (
+  VOID
+  )
+{
+  PlatformResourcesStubLibDeinit ();
+  StandaloneMmOpteeStubLibDestroy ();
+  HostBenchmarkDestroyNorFlash (mFlashMemory, mNorFlash);
+
+  if (mErstBuffer != NULL) {
+    FreePool (mErstBuffer);
+  }
+}
+
+/**
+  Initialze the unit test framework and suite for the benchmarks and run
+  them.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Fw;
+  UNIT_TEST_SUITE_HANDLE      ErstSuite;
+
+  Fw = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  Status = InitBenchmarkData ();
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to setup Benchmark Data %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = InitUnitTestFramework (
+             &Fw,
+             UNIT_TEST_APP_NAME,
+             gEfiCallerBaseName,
+             UNIT_TEST_APP_VERSION
+             );
+  if (Status != EFI_SUCCESS) {
+    DEBUG (
+      (DEBUG_ERROR,
+       "Failed in InitUnitTestFramework. Status = %r\n",
+       Status)
+      );
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (
+             &ErstSuite,
+             Fw,
+             "Error Serialization Benchmarks",
+             "ErrorSerialization.BenchmarkSuite",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for ErrorSerialization\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  // AddTestCase Args:
+  //  Suite | Description
+  //  Class Name | Function
+  //  Pre | Post | Context
+
+  AddTestCase (ErstSuite, "128B record inserts", "Insert128", InsertBenchmark, BenchmarkSetup, BenchmarkCleanup, &mInsert128);
+  AddTestCase (ErstSuite, "512B record inserts", "Insert512", InsertBenchmark, BenchmarkSetup, BenchmarkCleanup, &mInsert512);
+  AddTestCase (ErstSuite, "128B record lookups", "Lookup128", LookupBenchmark, BenchmarkSetup, BenchmarkCleanup, &mLookup128);
+  AddTestCase (ErstSuite, "128B record updates", "Update128", UpdateBenchmark, BenchmarkSetup, BenchmarkCleanup, &mUpdate128);
+
+  Status = RunAllTestSuites (Fw);
+
+EXIT:
+  if (Fw) {
+    FreeUnitTestFramework (Fw);
+  }
+
+  CleanUpBenchmarkData ();
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UnitTestingEntry ();
+}
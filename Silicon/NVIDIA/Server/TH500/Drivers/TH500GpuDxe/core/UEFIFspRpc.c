@@ -2,7 +2,7 @@
 
   UEFI client code which implements simple transactions between FSP and UEFI client.
 
-  SPDX-FileCopyrightText: Copyright (c) 2021-2024 NVIDIA CORPORATION. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2021-2026 NVIDIA CORPORATION. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -18,6 +18,7 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/DebugLib.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/TimerLib.h>
 
 ///
 /// Protocol(s)
@@ -93,7 +94,59 @@ typedef UINT32 NvU32;
 #define NVDM_PAYLOAD_COMMAND_RESPONSE_SIZE \
        FSP_RPC_HEADER_SIZE_SINGLE_PACKET + sizeof(NVDM_PAYLOAD_COMMAND_RESPONSE)
 
+/* Asynchronous request servicing, timeout matches the synchronous poll */
+#define FSP_RPC_ASYNC_POLL_INTERVAL_US  100
+#define FSP_RPC_ASYNC_TIMEOUT_POLLS     5000
+/* Largest command sent asynchronously */
+#define FSP_RPC_ASYNC_COMMAND_DWORDS    (NV_ALIGN_UP (sizeof (FINAL_MESSAGE_EGM), sizeof (UINT32)) / sizeof (UINT32))
+#define FSP_RPC_RESPONSE_PACKET_DWORDS  (FSP_RPC_RESPONSE_PACKET_SIZE / FSP_RPC_BYTES_PER_DWORD)
+
+/* Bucket N counts round trips of [2^(N-1), 2^N) us, the last bucket counts the rest */
+#define FSP_RPC_LATENCY_BUCKETS  16
+
+typedef struct {
+  LIST_ENTRY             Link;
+  EFI_PCI_IO_PROTOCOL    *PciIo;
+  UINT32                 Command[FSP_RPC_ASYNC_COMMAND_DWORDS];
+  UINT32                 CommandSize;
+  BOOLEAN                Sent;
+  UINT32                 PollsLeft;
+  UINT64                 SendTicks;
+  EFI_EVENT              Event;
+  EFI_STATUS             *CompletionStatus;
+} FSP_RPC_ASYNC_REQUEST;
+
+#define FSP_RPC_ASYNC_REQUEST_FROM_LINK(a)  BASE_CR (a, FSP_RPC_ASYNC_REQUEST, Link)
+
 /* ------------------------ Static variables -------------------------------- */
+STATIC LIST_ENTRY  mFspRpcRequests = INITIALIZE_LIST_HEAD_VARIABLE (mFspRpcRequests);
+STATIC EFI_EVENT   mFspRpcTimer    = NULL;
+STATIC UINT32      mFspRpcLatencyHistogram[FSP_RPC_LATENCY_BUCKETS];
+STATIC UINT64      mFspRpcLatencyMaxUs;
+
+/*!
+ * @brief Record the round-trip latency of an FSP RPC in the histogram
+ *
+ * @param[in] StartTicks    Performance counter when the command was sent
+ */
+STATIC VOID
+EFIAPI
+uefifspRpcRecordLatency (
+  IN UINT64  StartTicks
+  )
+{
+  UINT64  LatencyUs;
+  UINTN   Bucket;
+
+  LatencyUs = DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - StartTicks), 1000);
+  Bucket    = 0;
+  if (LatencyUs != 0) {
+    Bucket = MIN ((UINTN)HighBitSet64 (LatencyUs) + 1, FSP_RPC_LATENCY_BUCKETS - 1);
+  }
+
+  mFspRpcLatencyHistogram[Bucket]++;
+  mFspRpcLatencyMaxUs = MAX (mFspRpcLatencyMaxUs, LatencyUs);
+}
 
 /* ------------------------- Function Prototypes ---------------------------- */
 STATIC VOID
@@ -243,6 +296,7 @@ uefifspPollForMsgQueueResponse (
 {
   EFI_STATUS  Status     = EFI_SUCCESS;
   UINT32      TimeoutIdx = UEFI_FSP_RPC_MSG_QUEUE_POLL_TIMEOUT_INDEX;
+  UINT64      StartTicks = GetPerformanceCounter ();
 
   while ((fspRpcIsMsgQueueEmpty (PciIo, channelId)) && (TimeoutIdx--)) {
     DEBUG_CODE_BEGIN ();
@@ -257,6 +311,8 @@ uefifspPollForMsgQueueResponse (
   if (TimeoutIdx == 0) {
     DEBUG ((DEBUG_ERROR, "%a: [%p][TimeoutIdx:%u] Poll for Message Queue response timed out.\n", __FUNCTION__, PciIo, TimeoutIdx));
     Status = EFI_TIMEOUT;
+  } else {
+    uefifspRpcRecordLatency (StartTicks);
   }
 
   return Status;
@@ -866,6 +922,9 @@ FspConfigurationAtsRange (
   UINT8              msgQueueSizeDwords;
   BOOLEAN            bResponseAck = TRUE;
 
+  /* Queued requests share the channel */
+  FspRpcWaitForCompletion (PciIo);
+
   /* Allocate command queue buffer (DWORD aligned) */
   cmdQueueBuffer = AllocateZeroPool (cmdQueueSize);
 
@@ -1275,6 +1334,9 @@ FspConfigurationEgmBaseAndSize (
   DEBUG ((DEBUG_ERROR, "%a: [%p] Params [egm-base-pa:0x%016lx,egm-size:0x%016lx]\n", __FUNCTION__, PciIo, EgmBasePa, EgmSize));
   DEBUG_CODE_END ();
 
+  /* Queued requests share the channel */
+  FspRpcWaitForCompletion (PciIo);
+
   /* Allocate command queue buffer (DWORD aligned) */
   cmdQueueBuffer = AllocateZeroPool (cmdQueueSize);
 
@@ -1701,6 +1763,9 @@ FspRpcGetC2CInitStatus (
     return EFI_INVALID_PARAMETER;
   }
 
+  /* Queued requests share the channel */
+  FspRpcWaitForCompletion (PciIo);
+
   /* Allocations */
   DEBUG ((DEBUG_INFO, "%a: [%p] Params [C2C buffers: command:%u,message:%u]\n", __FUNCTION__, PciIo, cmdQueueSize, msgQueueSizeBytes));
   DEBUG ((DEBUG_INFO, "%a: [%p] Params [C2C buffer: command:%u, old C2C message:%u]\n", __FUNCTION__, PciIo, sizeof (FINAL_MESSAGE_EGM), NVDM_PAYLOAD_COMMAND_RESPONSE_SIZE_GET_C2CINIT));
@@ -2082,3 +2147,485 @@ uefifspRpcCmdQueueBuffer_exit:
 
   return Status;
 }
+
+///
+/// Asynchronous FSP RPC requests
+///
+
+/*!
+ * @brief Send a single packet command without waiting for the response
+ *
+ * @param[in] PciIo         PciIo protocol handle
+ * @param[in] Command       Command, DWORD aligned
+ * @param[in] CommandSize   Size of the command in bytes
+ *
+ * @return EFI_SUCCESS, EFI_NOT_READY if the command queue is busy, or error
+ */
+STATIC EFI_STATUS
+EFIAPI
+uefifspRpcSendCommand (
+  IN EFI_PCI_IO_PROTOCOL  *PciIo,
+  IN UINT32               *Command,
+  IN UINT32               CommandSize
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      channelId = FSP_EMEM_CHANNEL_RM;
+  UINT32      queueHead = 0;
+  UINT32      queueTail = 0;
+
+  Status = uefifspRpcQueueHeadTailGet (PciIo, channelId, &queueHead, &queueTail);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (queueHead != queueTail) {
+    return EFI_NOT_READY;
+  }
+
+  /*                                         PciIo, offset, writeAutoInc, readAutoInc */
+  Status = FspConfigurationSetAutoIncrement (PciIo, 0, TRUE, FALSE);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  /* EMEMD auto increments, so the whole command is written as a FIFO */
+  Status = PciIo->Mem.Write (
+                        PciIo,
+                        EfiPciIoWidthFifoUint32,
+                        PCI_BAR_IDX0,
+                        NV_PFSP_EMEMD (channelId),
+                        CommandSize / sizeof (UINT32),
+                        Command
+                        );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  /* Trigger */
+  return uefifspRpcQueueHeadTailRequestSet (PciIo, channelId, 0, CommandSize - FSP_RPC_BYTES_PER_DWORD);
+}
+
+/*!
+ * @brief Read and acknowledge the response to a command sent with uefifspRpcSendCommand
+ *
+ * @param[in] PciIo         PciIo protocol handle
+ *
+ * @return EFI_SUCCESS, EFI_NOT_READY if there is no response yet,
+ *         EFI_DEVICE_ERROR if FSP failed the command, or error
+ */
+STATIC EFI_STATUS
+EFIAPI
+uefifspRpcReceiveResponse (
+  IN EFI_PCI_IO_PROTOCOL  *PciIo
+  )
+{
+  EFI_STATUS  Status;
+  EFI_STATUS  AckStatus;
+  UINT32      channelId    = FSP_EMEM_CHANNEL_RM;
+  UINT32      msgQueueHead = 0;
+  UINT32      msgQueueTail = 0;
+  UINT32      msgQueueBuffer[FSP_RPC_RESPONSE_PACKET_DWORDS];
+
+  Status = uefifspRpcMsgQueueHeadTailGet (PciIo, channelId, &msgQueueHead, &msgQueueTail);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (msgQueueHead == msgQueueTail) {
+    return EFI_NOT_READY;
+  }
+
+  if ((msgQueueTail - msgQueueHead + FSP_RPC_BYTES_PER_DWORD) < FSP_RPC_RESPONSE_PACKET_SIZE) {
+    DEBUG ((DEBUG_ERROR, "%a: [%p] ERROR: Short response [Head:0x%04x,Tail:0x%04x]\n", __FUNCTION__, PciIo, msgQueueHead, msgQueueTail));
+    Status = EFI_DEVICE_ERROR;
+    goto Ack;
+  }
+
+  /*                                         PciIo, offset, writeAutoInc, readAutoInc */
+  Status = FspConfigurationSetAutoIncrement (PciIo, 0, FALSE, TRUE);
+  if (EFI_ERROR (Status)) {
+    goto Ack;
+  }
+
+  Status = PciIo->Mem.Read (
+                        PciIo,
+                        EfiPciIoWidthFifoUint32,
+                        PCI_BAR_IDX0,
+                        NV_PFSP_EMEMD (channelId),
+                        FSP_RPC_RESPONSE_PACKET_DWORDS,
+                        msgQueueBuffer
+                        );
+  if (EFI_ERROR (Status)) {
+    goto Ack;
+  }
+
+  /* Current UEFI implementation only supports single packet */
+  if ((MCTP_PACKET_STATE_SINGLE_PACKET != uefifspGetPacketInfo (msgQueueBuffer[0])) ||
+      !uefifspRpcValidateMctpPayloadHeader (msgQueueBuffer[1]) ||
+      (NVDM_TYPE_FSP_RESPONSE != REF_VAL (MCTP_MSG_HEADER_NVDM_TYPE, msgQueueBuffer[1])) ||
+      (NVDM_TYPE_UEFI_RM != msgQueueBuffer[3]))
+  {
+    DEBUG ((DEBUG_ERROR, "%a: [%p] ERROR: Unexpected response '0x%08x' '0x%08x' '0x%08x'\n", __FUNCTION__, PciIo, msgQueueBuffer[0], msgQueueBuffer[1], msgQueueBuffer[3]));
+    Status = EFI_DEVICE_ERROR;
+  } else if (msgQueueBuffer[4] != FSP_OK) {
+    DEBUG ((DEBUG_ERROR, "%a: [%p] FSP Response Packet Thread ID '0x%08x'\n", __FUNCTION__, PciIo, msgQueueBuffer[2]));
+    DEBUG ((DEBUG_ERROR, "%a: [%p] FSP Response Packet Error Code '0x%08x'\n", __FUNCTION__, PciIo, msgQueueBuffer[4]));
+    Status = EFI_DEVICE_ERROR;
+  }
+
+Ack:
+  /* ACK packet with update where tail equals head */
+  AckStatus = uefifspRpcMsgQueueHeadTailSet (PciIo, channelId, msgQueueHead, msgQueueHead);
+  if (!EFI_ERROR (Status)) {
+    Status = AckStatus;
+  }
+
+  return Status;
+}
+
+/*!
+ * @brief Check whether a request is the oldest queued request for its GPU
+ *
+ * @param[in] Request       Queued request
+ *
+ * @return TRUE if no earlier request for the same GPU is queued
+ */
+STATIC BOOLEAN
+EFIAPI
+uefifspRpcIsOldestForGpu (
+  IN FSP_RPC_ASYNC_REQUEST  *Request
+  )
+{
+  LIST_ENTRY  *Link;
+
+  for (Link = GetFirstNode (&mFspRpcRequests); Link != &Request->Link; Link = GetNextNode (&mFspRpcRequests, Link)) {
+    if (FSP_RPC_ASYNC_REQUEST_FROM_LINK (Link)->PciIo == Request->PciIo) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/*!
+ * @brief Complete a queued request
+ *
+ * @param[in] Request       Queued request
+ * @param[in] Status        Status of the request
+ */
+STATIC VOID
+EFIAPI
+uefifspRpcCompleteRequest (
+  IN FSP_RPC_ASYNC_REQUEST  *Request,
+  IN EFI_STATUS             Status
+  )
+{
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: [%p] ERROR: FSP RPC request returned '%r'\n", __FUNCTION__, Request->PciIo, Status));
+  }
+
+  RemoveEntryList (&Request->Link);
+  if (Request->CompletionStatus != NULL) {
+    *Request->CompletionStatus = Status;
+  }
+
+  if (Request->Event != NULL) {
+    gBS->SignalEvent (Request->Event);
+  }
+
+  FreePool (Request);
+}
+
+/*!
+ * @brief Make progress on all queued requests, must be called at TPL_CALLBACK
+ */
+STATIC VOID
+EFIAPI
+uefifspRpcServiceRequests (
+  VOID
+  )
+{
+  EFI_STATUS             Status;
+  LIST_ENTRY             *Link;
+  LIST_ENTRY             *NextLink;
+  FSP_RPC_ASYNC_REQUEST  *Request;
+
+  for (Link = GetFirstNode (&mFspRpcRequests); !IsNull (&mFspRpcRequests, Link); Link = NextLink) {
+    NextLink = GetNextNode (&mFspRpcRequests, Link);
+    Request  = FSP_RPC_ASYNC_REQUEST_FROM_LINK (Link);
+
+    if (!Request->Sent) {
+      if (!uefifspRpcIsOldestForGpu (Request)) {
+        continue;
+      }
+
+      Status = uefifspRpcSendCommand (Request->PciIo, Request->Command, Request->CommandSize);
+      if (!EFI_ERROR (Status)) {
+        Request->Sent      = TRUE;
+        Request->PollsLeft = FSP_RPC_ASYNC_TIMEOUT_POLLS;
+        Request->SendTicks = GetPerformanceCounter ();
+        continue;
+      }
+    } else {
+      Status = uefifspRpcReceiveResponse (Request->PciIo);
+      if (Status != EFI_NOT_READY) {
+        uefifspRpcRecordLatency (Request->SendTicks);
+      }
+    }
+
+    if (Status == EFI_NOT_READY) {
+      if (Request->PollsLeft-- != 0) {
+        continue;
+      }
+
+      Status = EFI_TIMEOUT;
+    }
+
+    uefifspRpcCompleteRequest (Request, Status);
+  }
+
+  if (IsListEmpty (&mFspRpcRequests) && (mFspRpcTimer != NULL)) {
+    gBS->CloseEvent (mFspRpcTimer);
+    mFspRpcTimer = NULL;
+  }
+}
+
+/*!
+ * @brief Timer notification servicing queued requests
+ *
+ * @param[in] Event         Timer event
+ * @param[in] Context       Unused
+ */
+STATIC VOID
+EFIAPI
+uefifspRpcTimerNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  uefifspRpcServiceRequests ();
+}
+
+/*!
+ * @brief Queue a single packet command
+ *
+ * @param[in]  Request          Request with the command filled in
+ * @param[in]  PciIo            PciIo protocol handle
+ * @param[in]  Event            Optional event signaled when the request completes
+ * @param[out] CompletionStatus Optional status of the request
+ *
+ * @return EFI_SUCCESS, or error if the request could not be queued
+ */
+STATIC EFI_STATUS
+EFIAPI
+uefifspRpcSubmitRequest (
+  IN  FSP_RPC_ASYNC_REQUEST  *Request,
+  IN  EFI_PCI_IO_PROTOCOL    *PciIo,
+  IN  EFI_EVENT              Event OPTIONAL,
+  OUT EFI_STATUS             *CompletionStatus OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+  EFI_TPL     OldTpl;
+
+  Request->PciIo            = PciIo;
+  Request->Event            = Event;
+  Request->CompletionStatus = CompletionStatus;
+  Request->PollsLeft        = FSP_RPC_ASYNC_TIMEOUT_POLLS;
+  if (CompletionStatus != NULL) {
+    *CompletionStatus = EFI_NOT_READY;
+  }
+
+  PrintNvdmMessage ((UINT8 *)Request->Command, (UINT8)Request->CommandSize);
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  Status = EFI_SUCCESS;
+  if (mFspRpcTimer == NULL) {
+    Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_CALLBACK, uefifspRpcTimerNotify, NULL, &mFspRpcTimer);
+    if (!EFI_ERROR (Status)) {
+      Status = gBS->SetTimer (mFspRpcTimer, TimerPeriodic, EFI_TIMER_PERIOD_MICROSECONDS (FSP_RPC_ASYNC_POLL_INTERVAL_US));
+      if (EFI_ERROR (Status)) {
+        gBS->CloseEvent (mFspRpcTimer);
+        mFspRpcTimer = NULL;
+      }
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: [%p] ERROR: Timer setup returned '%r'\n", __FUNCTION__, PciIo, Status));
+    FreePool (Request);
+  } else {
+    InsertTailList (&mFspRpcRequests, &Request->Link);
+    /* Send now if the channel is idle */
+    uefifspRpcServiceRequests ();
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  return Status;
+}
+
+/*
+ * @brief Queue the ATS Range write via FSP RPC interface
+ *
+ * @param[in]  PciIo            PciIo protocol handle
+ * @param[in]  HbmBasePa        HbM  base physical address
+ * @param[in]  Event            Optional event signaled when the request completes
+ * @param[out] CompletionStatus Optional status of the request, valid once Event is
+ *                              signaled. Must remain valid until then.
+ *
+ * @return Status
+ *            EFI_SUCCESS           - request queued
+ *            EFI_OUT_OF_RESOURCES
+ *            EFI_INVALID_PARAMETER - NULL PciIo pointer
+ */
+EFI_STATUS
+EFIAPI
+FspConfigurationAtsRangeAsync (
+  IN  EFI_PCI_IO_PROTOCOL  *PciIo,
+  IN  UINT64               HbmBasePa,
+  IN  EFI_EVENT            Event OPTIONAL,
+  OUT EFI_STATUS           *CompletionStatus OPTIONAL
+  )
+{
+  FSP_RPC_ASYNC_REQUEST  *Request;
+  FINAL_MESSAGE_ATS      *Nvdm_Final_Message_Ats;
+
+  if (PciIo == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Request = AllocateZeroPool (sizeof (FSP_RPC_ASYNC_REQUEST));
+  if (Request == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Nvdm_Final_Message_Ats = (FINAL_MESSAGE_ATS *)Request->Command;
+  Request->CommandSize   = NV_ALIGN_UP (sizeof (FINAL_MESSAGE_ATS), sizeof (UINT32));
+
+  *((UINT32 *)&Nvdm_Final_Message_Ats->Mctp_Header_S)      = uefifspRpcCreateMctpTransportHeader (0, 0, TRUE);
+  *((UINT32 *)&Nvdm_Final_Message_Ats->Nvdm_Header_S)      = uefifspRpcCreateMctpPayloadHeader (NVDM_TYPE_UEFI_RM);
+  Nvdm_Final_Message_Ats->Nvdm_Uefi_Ats_Fsp_S.subMessageId = 0x3;  // Sub-Message for ATS Range Info from UEFI DXE to FSP
+  Nvdm_Final_Message_Ats->Nvdm_Uefi_Ats_Fsp_S.Hbm_Base     = HbmBasePa;
+
+  return uefifspRpcSubmitRequest (Request, PciIo, Event, CompletionStatus);
+}
+
+/*
+ * @brief Queue the EGM Base and Size write via FSP RPC interface
+ *
+ * @param[in]  PciIo            PciIo protocol handle
+ * @param[in]  EgmBasePa        EGM base physical address
+ * @param[in]  EgmSize          EGM size
+ * @param[in]  Event            Optional event signaled when the request completes
+ * @param[out] CompletionStatus Optional status of the request, valid once Event is
+ *                              signaled. Must remain valid until then.
+ *
+ * @return Status
+ *            EFI_SUCCESS           - request queued
+ *            EFI_OUT_OF_RESOURCES
+ *            EFI_INVALID_PARAMETER - NULL PciIo pointer
+ */
+EFI_STATUS
+EFIAPI
+FspConfigurationEgmBaseAndSizeAsync (
+  IN  EFI_PCI_IO_PROTOCOL  *PciIo,
+  IN  UINT64               EgmBasePa,
+  IN  UINT64               EgmSize,
+  IN  EFI_EVENT            Event OPTIONAL,
+  OUT EFI_STATUS           *CompletionStatus OPTIONAL
+  )
+{
+  FSP_RPC_ASYNC_REQUEST  *Request;
+  FINAL_MESSAGE_EGM      *Nvdm_Final_Message_Egm;
+
+  if (PciIo == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Request = AllocateZeroPool (sizeof (FSP_RPC_ASYNC_REQUEST));
+  if (Request == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Nvdm_Final_Message_Egm = (FINAL_MESSAGE_EGM *)Request->Command;
+  Request->CommandSize   = NV_ALIGN_UP (sizeof (FINAL_MESSAGE_EGM), sizeof (UINT32));
+
+  *((UINT32 *)&Nvdm_Final_Message_Egm->Mctp_Header_S)      = uefifspRpcCreateMctpTransportHeader (0, 0, TRUE);
+  *((UINT32 *)&Nvdm_Final_Message_Egm->Nvdm_Header_S)      = uefifspRpcCreateMctpPayloadHeader (NVDM_TYPE_UEFI_RM);
+  Nvdm_Final_Message_Egm->Nvdm_Uefi_Egm_Fsp_S.subMessageId = 0x1;  // Sub-Message for EGM Base and Size from UEFI DXE to FSP
+  Nvdm_Final_Message_Egm->Nvdm_Uefi_Egm_Fsp_S.Egm_Base     = EgmBasePa;
+  Nvdm_Final_Message_Egm->Nvdm_Uefi_Egm_Fsp_S.Egm_Size     = EgmSize;
+
+  return uefifspRpcSubmitRequest (Request, PciIo, Event, CompletionStatus);
+}
+
+/*
+ * @brief Wait for queued FSP RPC requests to complete
+ *
+ * @param[in] PciIo         PciIo protocol handle of the GPU to wait for, or NULL
+ *                          to wait for all GPUs
+ *
+ * @return Status
+ *            EFI_SUCCESS
+ */
+EFI_STATUS
+EFIAPI
+FspRpcWaitForCompletion (
+  IN EFI_PCI_IO_PROTOCOL  *PciIo OPTIONAL
+  )
+{
+  EFI_TPL     OldTpl;
+  LIST_ENTRY  *Link;
+  BOOLEAN     Pending;
+
+  do {
+    OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+    uefifspRpcServiceRequests ();
+
+    Pending = FALSE;
+    for (Link = GetFirstNode (&mFspRpcRequests); !IsNull (&mFspRpcRequests, Link); Link = GetNextNode (&mFspRpcRequests, Link)) {
+      if ((PciIo == NULL) || (FSP_RPC_ASYNC_REQUEST_FROM_LINK (Link)->PciIo == PciIo)) {
+        Pending = TRUE;
+        break;
+      }
+    }
+
+    gBS->RestoreTPL (OldTpl);
+
+    if (Pending) {
+      gBS->Stall (FSP_RPC_ASYNC_POLL_INTERVAL_US);
+    }
+  } while (Pending);
+
+  return EFI_SUCCESS;
+}
+
+/*
+ * @brief Log the histogram of FSP RPC round-trip latency
+ */
+VOID
+EFIAPI
+FspRpcDumpLatencyHistogram (
+  VOID
+  )
+{
+  UINTN  Bucket;
+
+  DEBUG ((DEBUG_INFO, "%a: FSP RPC round-trip latency, max %lu us\n", __FUNCTION__, mFspRpcLatencyMaxUs));
+  for (Bucket = 0; Bucket < FSP_RPC_LATENCY_BUCKETS; Bucket++) {
+    if (mFspRpcLatencyHistogram[Bucket] == 0) {
+      continue;
+    }
+
+    if (Bucket == 0) {
+      DEBUG ((DEBUG_INFO, "%a: [< 1 us] %u\n", __FUNCTION__, mFspRpcLatencyHistogram[Bucket]));
+    } else if (Bucket == (FSP_RPC_LATENCY_BUCKETS - 1)) {
+      DEBUG ((DEBUG_INFO, "%a: [>= %lu us] %u\n", __FUNCTION__, LShiftU64 (1, Bucket - 1), mFspRpcLatencyHistogram[Bucket]));
+    } else {
+      DEBUG ((DEBUG_INFO, "%a: [%lu - %lu us] %u\n", __FUNCTION__, LShiftU64 (1, Bucket - 1), LShiftU64 (1, Bucket) - 1, mFspRpcLatencyHistogram[Bucket]));
+    }
+  }
+}
@@ -2,7 +2,7 @@
 
   UEFI client code which implements simple transactions between FSP and UEFI client.
 
-  SPDX-FileCopyrightText: Copyright (c) 2021-2024 NVIDIA CORPORATION. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2021-2026 NVIDIA CORPORATION. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
@@ -244,4 +244,84 @@ FspRpcGetC2CInitStatus (
   UINT32                  *C2CInitStatus
   );
 
+///
+/// Asynchronous FSP RPC requests
+///
+/// Requests for the same GPU are sent one at a time in submission order, requests
+/// for different GPUs are in flight at the same time. Requests are serviced from a
+/// periodic timer, so the caller continues while FSP processes the command.
+///
+
+/*
+ * @brief Queue the ATS Range write via FSP RPC interface
+ *
+ * @param[in]  PciIo            PciIo protocol handle
+ * @param[in]  HbmBasePa        HbM  base physical address
+ * @param[in]  Event            Optional event signaled when the request completes
+ * @param[out] CompletionStatus Optional status of the request, valid once Event is
+ *                              signaled. Must remain valid until then.
+ *
+ * @return Status
+ *            EFI_SUCCESS           - request queued
+ *            EFI_OUT_OF_RESOURCES
+ *            EFI_INVALID_PARAMETER - NULL PciIo pointer
+ */
+EFI_STATUS
+EFIAPI
+FspConfigurationAtsRangeAsync (
+  IN  EFI_PCI_IO_PROTOCOL  *PciIo,
+  IN  UINT64               HbmBasePa,
+  IN  EFI_EVENT            Event OPTIONAL,
+  OUT EFI_STATUS           *CompletionStatus OPTIONAL
+  );
+
+/*
+ * @brief Queue the EGM Base and Size write via FSP RPC interface
+ *
+ * @param[in]  PciIo            PciIo protocol handle
+ * @param[in]  EgmBasePa        EGM base physical address
+ * @param[in]  EgmSize          EGM size
+ * @param[in]  Event            Optional event signaled when the request completes
+ * @param[out] CompletionStatus Optional status of the request, valid once Event is
+ *                              signaled. Must remain valid until then.
+ *
+ * @return Status
+ *            EFI_SUCCESS           - request queued
+ *            EFI_OUT_OF_RESOURCES
+ *            EFI_INVALID_PARAMETER - NULL PciIo pointer
+ */
+EFI_STATUS
+EFIAPI
+FspConfigurationEgmBaseAndSizeAsync (
+  IN  EFI_PCI_IO_PROTOCOL  *PciIo,
+  IN  UINT64               EgmBasePa,
+  IN  UINT64               EgmSize,
+  IN  EFI_EVENT            Event OPTIONAL,
+  OUT EFI_STATUS           *CompletionStatus OPTIONAL
+  );
+
+/*
+ * @brief Wait for queued FSP RPC requests to complete
+ *
+ * @param[in] PciIo         PciIo protocol handle of the GPU to wait for, or NULL
+ *                          to wait for all GPUs
+ *
+ * @return Status
+ *            EFI_SUCCESS
+ */
+EFI_STATUS
+EFIAPI
+FspRpcWaitForCompletion (
+  IN EFI_PCI_IO_PROTOCOL  *PciIo OPTIONAL
+  );
+
+/*
+ * @brief Log the histogram of FSP RPC round-trip latency
+ */
+VOID
+EFIAPI
+FspRpcDumpLatencyHistogram (
+  VOID
+  );
+
 #endif // __UEFI_FSP_RPC_H__
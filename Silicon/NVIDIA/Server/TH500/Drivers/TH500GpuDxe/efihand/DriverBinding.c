@@ -3,7 +3,7 @@
   Provides a driver binding protocol for supported NVIDIA GPUs
   as well as providing the NVIDIA GPU DSD AML Generation Protoocol.
 
-  SPDX-FileCopyrightText: Copyright (c) 2020-2025, NVIDIA CORPORATION. All rights reserved.
+  SPDX-FileCopyrightText: Copyright (c) 2020-2026, NVIDIA CORPORATION. All rights reserved.
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -874,10 +874,13 @@ NVIDIAGpuDriverStart (
         BOOLEAN  bMaskFspRpcDeviceError = TRUE;
         DEBUG ((DEBUG_ERROR, "%a: [Controller:%p] EGM_SOCKET_ADDRESS_MASK = 0x%016lx\n", __FUNCTION__, ControllerHandle, EGM_SOCKET_ADDRESS_MASK));
         DEBUG ((DEBUG_ERROR, "%a: [Controller:%p] EgmBasePaSocketMasked = 0x%016lx\n", __FUNCTION__, ControllerHandle, EgmBasePaSocketMasked));
-        /* Need to adjust for size */
-        Status = FspConfigurationEgmBaseAndSize (PciIo, EgmBasePaSocketMasked, EgmSize);
+        /*
+         * Queue the configuration so the next GPU is started while FSP processes it.
+         * Transaction failures are logged on completion and are not fatal.
+         */
+        Status = FspConfigurationEgmBaseAndSizeAsync (PciIo, EgmBasePaSocketMasked, EgmSize, NULL, NULL);
         if (EFI_ERROR (Status)) {
-          DEBUG ((DEBUG_ERROR, "ERROR: 'FspConfigurationEgmBaseAndSize' failed with status '%r'.\n", Status));
+          DEBUG ((DEBUG_ERROR, "ERROR: 'FspConfigurationEgmBaseAndSizeAsync' failed with status '%r'.\n", Status));
           /* Check for non-FATAL FSP RPC transaction failure */
           if ( bMaskFspRpcDeviceError && (Status == EFI_DEVICE_ERROR)) {
             Status = EFI_SUCCESS;
@@ -887,9 +890,9 @@ NVIDIAGpuDriverStart (
           ASSERT_EFI_ERROR (Status);
         }
 
-        Status = FspConfigurationAtsRange (PciIo, HbmBasePa);
+        Status = FspConfigurationAtsRangeAsync (PciIo, HbmBasePa, NULL, NULL);
         if (EFI_ERROR (Status)) {
-          DEBUG ((DEBUG_ERROR, "ERROR: 'FspConfigurationAtsRange' failed with status '%r'.\n", Status));
+          DEBUG ((DEBUG_ERROR, "ERROR: 'FspConfigurationAtsRangeAsync' failed with status '%r'.\n", Status));
           /* Check for non-FATAL FSP RPC transaction failure */
           if ( bMaskFspRpcDeviceError && (Status == EFI_DEVICE_ERROR)) {
             Status = EFI_SUCCESS;
@@ -958,7 +961,8 @@ NVIDIAGpuDriverStop (
   IN EFI_HANDLE                   *ChildHandleBuffer OPTIONAL
   )
 {
-  EFI_STATUS  Status = EFI_SUCCESS;
+  EFI_STATUS           Status = EFI_SUCCESS;
+  EFI_PCI_IO_PROTOCOL  *PciIo = NULL;
 
   DEBUG ((DEBUG_INFO, "%a: DriverBindingProtocol*: '%p'\n", __FUNCTION__, This));
   DEBUG ((DEBUG_INFO, "%a: ControllerHandle: '%p'\n", __FUNCTION__, ControllerHandle));
@@ -969,6 +973,12 @@ NVIDIAGpuDriverStop (
     return EFI_INVALID_PARAMETER;
   }
 
+  /* Complete FSP RPC requests queued by Start before releasing PciIo */
+  Status = gBS->HandleProtocol (ControllerHandle, &gEfiPciIoProtocolGuid, (VOID **)&PciIo);
+  if (!EFI_ERROR (Status)) {
+    FspRpcWaitForCompletion (PciIo);
+  }
+
   Status = UninstallGpuFirmwareBootCompleteProtocolInstance (ControllerHandle);
   DEBUG ((DEBUG_INFO, "%a: Uninstall GPU Firmware Boot Complete Protocol Instance on '%p': '%r'\n", __FUNCTION__, ControllerHandle, Status));
 
@@ -1019,6 +1029,24 @@ NVIDIA_GPU_DRIVER_BINDING_PRIVATE_DATA  mPrivateData = {
 /* Uncrustify: *INDENT-ON* */
 EFI_DRIVER_BINDING_PROTOCOL  *gNVIDIAGpuDeviceLibDriverBinding = &mPrivateData.DriverBinding;
 
+STATIC EFI_EVENT  mReadyToBootEvent = NULL;
+
+/** Ready to boot notification, FSP configuration must be complete before the OS boots
+    @param[in] Event    Ready to boot event
+    @param[in] Context  Unused
+**/
+STATIC
+VOID
+EFIAPI
+NVIDIAGpuDriverReadyToBoot (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  FspRpcWaitForCompletion (NULL);
+  FspRpcDumpLatencyHistogram ();
+}
+
 /** Install the driver binding on the ImageHandle
     @param[in] ImageHandle  ImageHandle to install the DriverBinding on
     @param{in} SystemTable  Pointer to the EFI System Table structure
@@ -1066,6 +1094,24 @@ NVIDIAGpuDriverEntryPoint (
       );
   /* coverity[cert_int31_c_violation] violation in EDKII-defined macro */
   ASSERT_EFI_ERROR (Status);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = EfiCreateEventReadyToBootEx (
+             TPL_CALLBACK,
+             NVIDIAGpuDriverReadyToBoot,
+             NULL,
+             &mReadyToBootEvent
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: Failed to create ready to boot event: '%r'\n", __FUNCTION__, Status));
+    EfiLibUninstallDriverBindingComponentName2 (
+      &mPrivateData.DriverBinding,
+      NULL,
+      &gNVIDIAGpuDriverComponentName2Protocol
+      );
+  }
 
   return Status;
 }
@@ -1143,5 +1189,10 @@ NVIDIAGpuDriverUnloadImage (
     FreePool (HandleBuffer);
   }
 
+  if (!EFI_ERROR (Status) && (mReadyToBootEvent != NULL)) {
+    gBS->CloseEvent (mReadyToBootEvent);
+    mReadyToBootEvent = NULL;
+  }
+
   return Status;
 }
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+
+# SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+
+"""
+Converts a boot trace buffer recorded by BasicProfilerDxe into the Chrome
+trace event JSON format, which can be loaded in chrome://tracing or Perfetto.
+
+The buffer is found at the end of the profiler carveout; its size is published
+in the "BootTraceSize" UEFI variable.
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+BOOT_TRACE_SIGNATURE = 0x5442564E    # 'NVBT'
+BOOT_TRACE_VERSION = 1
+
+HEADER_FORMAT = "<IHHIIIIQIIII"
+RECORD_FORMAT = "<QIHBB"
+
+RECORD_BEGIN = 1
+RECORD_END = 2
+RECORD_INSTANT = 3
+
+CATEGORY_NAMES = [
+    "Driver",
+    "DeviceDiscovery",
+    "Connect",
+    "BpmpIpc",
+    "Flash",
+    "Image",
+    "Other",
+]
+
+
+def check_file_exists(filename):
+    """
+    Checks that the given filename exists.
+
+    If the file does not exist, prints an error and exits.
+
+    Otherwise returns silently
+    """
+    if filename and not os.path.isfile(filename):
+        print("Error: could not find given file:\n"
+              "    {}".format(filename))
+        sys.exit(1)
+
+
+def parse_command_line_args():
+    """
+    Parses the command line arguments for the program.
+
+    The first positional argument is the raw trace dump and the second is the
+    output JSON file name.
+    """
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument(
+        "input_file",
+        metavar="INPUT_FILE",
+        help="Raw boot trace buffer dumped from the profiler carveout."
+    )
+    parser.add_argument(
+        "output_file",
+        metavar="OUTPUT_FILE",
+        help="Output Chrome trace JSON file name."
+    )
+    parser.add_argument(
+        "--offset",
+        type=lambda x: int(x, 0),
+        default=0,
+        help="Offset of the trace header within the input file. Default is 0."
+    )
+
+    args = parser.parse_args()
+
+    check_file_exists(args.input_file)
+
+    return (
+        args.input_file,
+        args.output_file,
+        args.offset,
+    )
+
+
+def get_name(data, string_table, offset):
+    """
+    Returns the NUL terminated name at the given string table offset.
+    """
+    start = string_table + offset
+    end = data.find(b"\0", start)
+    if end < 0:
+        end = len(data)
+    return data[start:end].decode("ascii", errors="replace")
+
+
+def get_category(category):
+    """
+    Returns the name of the given category.
+    """
+    if category < len(CATEGORY_NAMES):
+        return CATEGORY_NAMES[category]
+    return "Unknown{}".format(category)
+
+
+def convert_trace(data):
+    """
+    Parses the trace buffer and returns a list of trace events.
+    """
+    header_size = struct.calcsize(HEADER_FORMAT)
+    if len(data) < header_size:
+        print("Error: input file is too small to hold a trace header")
+        sys.exit(1)
+
+    (signature, version, hdr_size, record_size, max_records, record_count,
+     dropped, frequency, string_table, string_table_size, string_table_used,
+     _) = struct.unpack_from(HEADER_FORMAT, data)
+
+    if signature != BOOT_TRACE_SIGNATURE or version != BOOT_TRACE_VERSION:
+        print("Error: invalid boot trace header")
+        sys.exit(1)
+
+    if frequency == 0:
+        print("Error: boot trace timer frequency is zero")
+        sys.exit(1)
+
+    if dropped != 0:
+        print("Warning: {} records were dropped".format(dropped))
+
+    record_count = min(record_count, max_records)
+    events = []
+    for index in range(record_count):
+        offset = hdr_size + (index * record_size)
+        (timestamp, argument, name_offset, record_type,
+         category) = struct.unpack_from(RECORD_FORMAT, data, offset)
+
+        event = {
+            "name": get_name(data, string_table, name_offset),
+            "cat": get_category(category),
+            "ts": (timestamp * 1000000.0) / frequency,
+            "pid": 0,
+            "tid": 0,
+        }
+
+        if record_type == RECORD_BEGIN:
+            event["ph"] = "b"
+            event["id"] = index + 1
+            event["args"] = {"argument": argument}
+        elif record_type == RECORD_END:
+            event["ph"] = "e"
+            event["id"] = argument
+        elif record_type == RECORD_INSTANT:
+            event["ph"] = "i"
+            event["s"] = "g"
+            event["args"] = {"argument": argument}
+        else:
+            continue
+
+        events.append(event)
+
+    return events
+
+
+def main():
+    (input_filename, output_filename, offset) = parse_command_line_args()
+
+    with open(input_filename, "rb") as input_file:
+        input_file.seek(offset)
+        data = input_file.read()
+
+    events = convert_trace(data)
+
+    with open(output_filename, "w") as output_file:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ms"},
+                  output_file, indent=1)
+
+    print("Wrote {} events to {}".format(len(events), output_filename))
+
+
+if __name__ == "__main__":
+    main()